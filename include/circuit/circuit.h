@@ -0,0 +1,140 @@
+#ifndef CIRCUIT_H
+#define CIRCUIT_H
+
+#include <stdbool.h>
+
+#include "circuit/pcg.h"
+#include "circuit/sparse.h"
+
+// Condutância de cada nó para a terra: mantém a matriz definida positiva
+// mesmo com nós flutuantes
+#define CIRCUIT_GMIN 1e-12
+// Trabalho (flops) abaixo do qual as ilhas são resolvidas numa thread só
+#define CIRCUIT_PARALLEL_MIN_WORK (1 << 20)
+// Ilhas a partir deste tamanho usam Cholesky esparso em vez do denso
+#define CIRCUIT_SPARSE_MIN_NODES 256
+// Diodo cortado: fuga em vez de circuito aberto
+#define CIRCUIT_DIODE_OFF_CONDUCTANCE 1e-9
+// Fonte de tensão declarada sem resistência interna
+#define CIRCUIT_MIN_SOURCE_RESISTANCE 1e-3
+#define CIRCUIT_MAX_DIODE_ITERATIONS 50
+
+#define CIRCUIT_GROUND 0
+
+typedef enum {
+    CIRCUIT_SOLVER_DIRECT = 0,  // Cholesky: denso ou esparso pelo tamanho da ilha
+    CIRCUIT_SOLVER_ITERATIVE    // gradiente conjugado nas ilhas grandes
+} circuit_solver_t;
+
+typedef enum {
+    CIRCUIT_RESISTOR = 0,
+    CIRCUIT_VOLTAGE_SOURCE,     // fonte com resistência série, vira Norton
+    CIRCUIT_CURRENT_SOURCE,
+    CIRCUIT_DIODE,              // linear por partes: Vf + Ron conduzindo
+    CIRCUIT_CAPACITOR           // Euler implícito: condutância C/h + fonte
+} circuit_element_type_t;
+
+typedef struct {
+    circuit_element_type_t type;
+    char* name;
+    int a;                      // terminal + (fontes) ou ânodo (diodo)
+    int b;
+    double value;               // ohms, volts, amperes, farads ou Vf do diodo
+    double resistance;          // série da fonte de tensão ou Ron do diodo
+    bool enabled;               // desligado não entra na matriz
+    bool conducting;            // diodo
+    double history;             // capacitor: tensão no início do passo
+} circuit_element_t;
+
+// Ilha: componente conexo do netlist sem passar pela terra. Nós de ilhas
+// diferentes não dividem nenhuma entrada da matriz, então cada ilha é um
+// sistema independente, fatorado e resolvido por conta própria.
+typedef struct {
+    int* nodes;                 // nós do circuito, na ordem do bloco
+    int size;
+    double* factor;             // Cholesky do bloco (L, linha a linha)
+    sparse_t* sparse;           // no lugar de factor nas ilhas grandes
+    pcg_t* iterative;           // ou este, com CIRCUIT_SOLVER_ITERATIVE
+    double* rhs;
+    bool factored;
+    int result;
+} circuit_island_t;
+
+typedef struct circuit_pool circuit_pool_t;
+
+// Análise nodal de um circuito DC. As fontes de tensão entram como
+// equivalentes de Norton, então a matriz só depende de resistências e do
+// estado dos diodos: mudar o valor de uma fonte só refaz o lado direito e as
+// substituições, sem fatorar de novo. Com timestep 0 (o padrão) a análise é
+// DC e os capacitores ficam abertos; circuit_step avança no tempo.
+typedef struct {
+    char** node_names;          // node_names[0] é a terra
+    int node_count;
+    int node_capacity;
+
+    circuit_element_t* elements;
+    int element_count;
+    int element_capacity;
+
+    // Ilhas, refeitas na primeira solução depois de mudar o netlist
+    circuit_island_t* islands;  // da maior para a menor
+    int island_count;
+    int* node_island;           // por nó, -1 na terra
+    int* node_local;            // posição do nó no bloco da ilha
+    int* element_slots;         // por elemento: posições de aa, bb e ab na matriz esparsa
+    bool partitioned;
+    int thread_count;           // 0 usa os processadores disponíveis, 1 é serial
+    circuit_pool_t* pool;       // workers das ilhas, vivos até circuit_free
+    int pool_size;              // workers pedidos quando o pool foi criado
+    circuit_solver_t solver;
+
+    double* voltages;           // por nó, terra incluída
+    int voltage_count;
+    bool factored;              // false refatora todas as ilhas
+    double timestep;            // passo do último circuit_step, 0 em DC
+
+    unsigned long factor_count;
+    unsigned long solve_count;
+} circuit_t;
+
+int circuit_init(circuit_t* circuit);
+void circuit_free(circuit_t* circuit);
+
+// Nó pelo nome, criado no primeiro uso; "0" e "GND" são a terra
+int circuit_node(circuit_t* circuit, const char* name);
+
+// Retornam o índice do elemento ou -1
+int circuit_add_resistor(circuit_t* circuit, const char* name, int a, int b, double ohms);
+int circuit_add_voltage_source(circuit_t* circuit, const char* name, int positive, int negative,
+                               double volts, double series_ohms);
+int circuit_add_current_source(circuit_t* circuit, const char* name, int positive, int negative, double amperes);
+int circuit_add_diode(circuit_t* circuit, const char* name, int anode, int cathode,
+                      double forward_voltage, double on_resistance);
+int circuit_add_capacitor(circuit_t* circuit, const char* name, int a, int b, double farads);
+int circuit_find_element(const circuit_t* circuit, const char* name);
+
+// Valor de uma fonte: barato, só muda o lado direito
+int circuit_set_source(circuit_t* circuit, int element, double value);
+// Liga ou desliga um elemento: exige nova fatoração
+int circuit_set_enabled(circuit_t* circuit, int element, bool enabled);
+
+// Troca o método das ilhas grandes; vale a partir da próxima solução
+int circuit_set_solver(circuit_t* circuit, circuit_solver_t solver);
+
+// Resolve as tensões dos nós, iterando o estado dos diodos até estabilizar
+int circuit_solve(circuit_t* circuit);
+
+// Avança dt segundos: as tensões atuais são o estado inicial dos
+// capacitores. Mudar dt de um passo para outro exige nova fatoração.
+int circuit_step(circuit_t* circuit, double dt);
+
+// Union-find sobre os nós, com compressão de caminho: agrupa o netlist em
+// ilhas aqui e em partições no multirate
+int circuit_find_root(int* parent, int node);
+void circuit_union(int* parent, int a, int b);
+
+double circuit_voltage(const circuit_t* circuit, int node);
+// Corrente de a para b pelo elemento (nas fontes, saindo do terminal +)
+double circuit_current(const circuit_t* circuit, int element);
+
+#endif // CIRCUIT_H
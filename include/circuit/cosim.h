@@ -0,0 +1,57 @@
+#ifndef COSIM_H
+#define COSIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "circuit/circuit.h"
+#include "config/microcontroller.h"
+
+// Resistência de saída típica de um pino CMOS
+#define COSIM_DEFAULT_DRIVE_RESISTANCE 25.0
+// Ciclos do MCU entre duas verificações dos pinos
+#define COSIM_DEFAULT_QUANTUM 1000
+
+// Pino ligado a um nó. Como saída é uma fonte de tensão (0 ou vdd) com a
+// resistência de saída; como entrada só lê o nó, com histerese.
+typedef struct {
+    int pin_number;
+    int node;
+    int source;                 // elemento da fonte no circuito
+    pin_direction_t direction;  // última vista
+    pin_state_t driven;         // nível na fonte, à parte do lido como entrada
+} cosim_pin_t;
+
+typedef struct {
+    microcontroller_t* mcu;
+    circuit_t* circuit;
+
+    double vdd;
+    double drive_resistance;
+    double threshold_low;       // entrada vai a LOW abaixo disso
+    double threshold_high;      // e a HIGH acima disso
+    uint64_t quantum;
+
+    cosim_pin_t* pins;
+    int pin_count;
+    int pin_capacity;
+
+    bool dirty;                 // algum pino mudou desde a última solução
+    unsigned long solve_count;
+} cosim_t;
+
+// Limiares padrão de 0,3·vdd e 0,6·vdd, como no ATmega328P
+int cosim_init(cosim_t* cosim, microcontroller_t* mcu, circuit_t* circuit, double vdd);
+void cosim_free(cosim_t* cosim);
+
+// Liga o pino físico pin_number ao nó node do circuito
+int cosim_bind_pin(cosim_t* cosim, int pin_number, int node);
+
+// Leva as mudanças dos pinos ao circuito, resolve se houve alguma e atualiza
+// as entradas. Retorna 1 se resolveu, 0 se nada mudou e -1 em erro.
+int cosim_sync(cosim_t* cosim);
+
+// Executa o MCU em fatias de quantum ciclos sincronizando ao fim de cada uma
+int cosim_run(cosim_t* cosim, uint64_t cycles);
+
+#endif // COSIM_H
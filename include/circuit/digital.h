@@ -0,0 +1,154 @@
+#ifndef DIGITAL_H
+#define DIGITAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "circuit/circuit.h"
+
+#define DIGITAL_MAX_INPUTS 8
+// Iterações de tempo zero (delta) num mesmo instante antes de desistir
+#define DIGITAL_MAX_DELTAS 10000
+
+typedef enum {
+    DIGITAL_0 = 0,
+    DIGITAL_1,
+    DIGITAL_X,                  // desconhecido ou conflito
+    DIGITAL_Z                   // ninguém dirige
+} digital_level_t;
+
+typedef enum {
+    DIGITAL_HIGHZ = 0,
+    DIGITAL_WEAK,               // pull-up/pull-down
+    DIGITAL_STRONG,             // saída de porta
+    DIGITAL_SUPPLY              // alimentação
+} digital_strength_t;
+
+typedef struct {
+    digital_level_t level;
+    digital_strength_t strength;
+} digital_drive_t;
+
+typedef enum {
+    DIGITAL_GATE_BUFFER = 0,
+    DIGITAL_GATE_NOT,
+    DIGITAL_GATE_AND,
+    DIGITAL_GATE_OR,
+    DIGITAL_GATE_NAND,
+    DIGITAL_GATE_NOR,
+    DIGITAL_GATE_XOR,
+    DIGITAL_GATE_SWITCH,        // passa inputs[0] para a saída quando fechado
+    DIGITAL_GATE_CONSTANT       // nível fixo: alimentação, pull-up, pull-down
+} digital_gate_type_t;
+
+typedef struct {
+    digital_gate_type_t type;
+    char* name;
+    int inputs[DIGITAL_MAX_INPUTS];
+    int input_count;
+    int driver;                 // driver da porta na net de saída
+    uint64_t delay;
+    digital_strength_t strength;
+    digital_level_t constant;   // DIGITAL_GATE_CONSTANT
+    bool closed;                // DIGITAL_GATE_SWITCH
+    bool pending;               // avaliação já agendada
+    digital_drive_t scheduled;  // última saída agendada
+} digital_gate_t;
+
+typedef struct {
+    int net;
+    int next;                   // próximo driver da mesma net, -1 no fim
+    digital_drive_t drive;
+} digital_driver_t;
+
+typedef struct {
+    char* name;
+    digital_drive_t value;      // resolução dos drivers
+    int first_driver;
+    int external_driver;        // criado por digital_force, -1 se nenhum
+
+    int* fanout;                // portas com esta net na entrada
+    int fanout_count;
+    int fanout_capacity;
+
+    // Fronteira com o circuito analógico (-1 sem ligação)
+    int analog_source;          // a net dirige esta fonte de tensão
+    int analog_node;            // a net lê este nó
+    int sense_driver;
+} digital_net_t;
+
+typedef struct {
+    uint64_t time;
+    uint64_t sequence;
+    int gate;                   // avaliação de porta, ou -1
+    int driver;                 // atualização de driver, ou -1
+    digital_drive_t drive;
+} digital_event_t;
+
+// Simulação dirigida a eventos: só nets que mudam propagam, e o solver
+// analógico só roda quando uma net ligada a ele muda (ou na primeira vez)
+typedef struct {
+    digital_net_t* nets;
+    int net_count;
+    int net_capacity;
+
+    digital_gate_t* gates;
+    int gate_count;
+    int gate_capacity;
+
+    digital_driver_t* drivers;
+    int driver_count;
+    int driver_capacity;
+
+    digital_event_t* events;    // heap por (time, sequence)
+    int event_count;
+    int event_capacity;
+    uint64_t sequence;
+    uint64_t time;
+
+    circuit_t* circuit;         // opcional
+    double vdd;
+    double drive_resistance;
+    double threshold_low;
+    double threshold_high;
+    int* sensed;                // nets que leem nós analógicos
+    int sensed_count;
+    int sensed_capacity;
+    bool analog_dirty;
+
+    unsigned long event_count_total;
+    unsigned long evaluation_count;
+    unsigned long analog_solve_count;
+} digital_sim_t;
+
+// circuit pode ser NULL para um circuito só digital
+int digital_init(digital_sim_t* sim, circuit_t* circuit, double vdd);
+void digital_free(digital_sim_t* sim);
+
+// Net pelo nome, criada no primeiro uso
+int digital_net(digital_sim_t* sim, const char* name);
+
+// Retornam o índice da porta ou -1
+int digital_add_gate(digital_sim_t* sim, digital_gate_type_t type, const char* name,
+                     const int* inputs, int input_count, int output, uint64_t delay);
+int digital_add_constant(digital_sim_t* sim, const char* name, int net,
+                         digital_level_t level, digital_strength_t strength);
+// Chave unidirecional de a para b (modelo simplificado, sem resistência)
+int digital_add_switch(digital_sim_t* sim, const char* name, int a, int b, bool closed);
+int digital_set_switch(digital_sim_t* sim, int gate, bool closed);
+
+// Estímulo externo: dirige a net a partir do instante atual
+int digital_force(digital_sim_t* sim, int net, digital_level_t level, digital_strength_t strength);
+
+// A net dirige o nó como fonte de vdd/0 com a resistência de saída
+int digital_bind_output(digital_sim_t* sim, int net, int node);
+// A net segue a tensão do nó pelos limiares, com histerese
+int digital_bind_input(digital_sim_t* sim, int net, int node);
+
+// Processa os eventos até until (inclusive)
+int digital_run(digital_sim_t* sim, uint64_t until);
+
+digital_level_t digital_level(const digital_sim_t* sim, int net);
+const char* digital_level_to_string(digital_level_t level);
+
+#endif // DIGITAL_H
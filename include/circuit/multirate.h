@@ -0,0 +1,84 @@
+#ifndef MULTIRATE_H
+#define MULTIRATE_H
+
+#include <stdbool.h>
+
+#include "circuit/circuit.h"
+
+// Resistor é acoplamento fraco quando sua condutância não passa desta fração
+// do resto da condutância de cada um dos seus nós
+#define MULTIRATE_WEAK_RATIO 1e-3
+// Maior variação de tensão (V) aceita num passo antes de reduzi-lo
+#define MULTIRATE_MAX_VOLTAGE_STEP 0.05
+
+// Resistor cortado entre duas partições. Do lado de cada uma ele vira uma
+// fonte de tensão com a mesma resistência, no valor que o outro lado tinha
+// no último ponto de sincronização.
+typedef struct {
+    int element;                // resistor no circuito original
+    int partition;
+    int source;                 // fonte no circuito da partição
+    int remote_partition;
+    int remote_node;            // nó local do outro lado
+} multirate_coupling_t;
+
+typedef struct {
+    circuit_t circuit;
+    int* nodes;                 // nó global de cada nó local (0 é a terra)
+    double* previous;           // tensões do início do passo, para rejeitá-lo
+    bool* conducting;           // e o estado dos diodos, por elemento local
+
+    double time;
+    double step;                // passo adaptativo atual
+    double min_step;
+    double max_step;
+    bool dynamic;               // tem capacitor; sem ele basta um passo por janela
+
+    unsigned long step_count;
+    unsigned long reject_count;
+    int result;
+} multirate_partition_t;
+
+typedef struct multirate multirate_t;
+
+// Chamado a cada ponto de sincronização, com todas as partições paradas:
+// é onde se mudam fontes com multirate_set_source
+typedef int (*multirate_sync_t)(multirate_t* multirate, double time, void* context);
+
+// Simulação particionada: componentes conexos do netlist, separados ainda
+// nos resistores de acoplamento fraco, integram cada um com o seu passo e só
+// trocam valores de fronteira nos pontos de sincronização
+struct multirate {
+    multirate_partition_t* partitions;
+    int partition_count;
+
+    int node_count;
+    int* node_partition;        // por nó global, -1 na terra e em nós soltos
+    int* node_local;
+    int element_count;
+    int* element_partition;     // -1 nos resistores cortados
+    int* element_local;
+
+    multirate_coupling_t* couplings;
+    int coupling_count;
+
+    double time;
+    double max_voltage_step;
+    bool threaded;              // uma thread por partição em multirate_run
+};
+
+// Particiona o circuito e parte do seu ponto de operação DC. O circuito
+// original não é usado depois disso.
+int multirate_init(multirate_t* multirate, circuit_t* circuit, double min_step, double max_step);
+void multirate_free(multirate_t* multirate);
+
+// Avança duration segundos, sincronizando a cada sync_interval; sync pode ser NULL
+int multirate_run(multirate_t* multirate, double duration, double sync_interval,
+                  multirate_sync_t sync, void* context);
+
+// Nós e elementos pelos índices do circuito original
+int multirate_partition_of(const multirate_t* multirate, int node);
+double multirate_voltage(const multirate_t* multirate, int node);
+int multirate_set_source(multirate_t* multirate, int element, double value);
+
+#endif // MULTIRATE_H
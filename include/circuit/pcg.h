@@ -0,0 +1,54 @@
+#ifndef PCG_H
+#define PCG_H
+
+#include <stdbool.h>
+
+// Norma do resíduo relativa à do lado direito
+#define PCG_DEFAULT_TOLERANCE 1e-10
+#define PCG_DEFAULT_MAX_ITERATIONS 20000
+
+// Gradiente conjugado com pré-condicionador Cholesky incompleto sem
+// preenchimento, IC(0). Guarda só o triângulo inferior de A e um L com o
+// mesmo padrão: a memória cresce com os elementos, não com o preenchimento
+// de um fator direto. A última solução é o ponto de partida da próxima.
+typedef struct {
+    int n;
+
+    // Triângulo inferior de A por linha, colunas em ordem (diagonal por último)
+    int* row_start;
+    int* cols;
+    double* values;
+    int* diagonal;              // posição de A(i,i)
+    double* factor;             // L do IC(0), nas mesmas posições
+    bool jacobi;                // IC(0) quebrou: factor só tem a diagonal
+
+    double* x;                  // última solução
+    double* r;
+    double* z;
+    double* p;
+    double* q;
+
+    double tolerance;
+    int max_iterations;
+    bool warm_start;            // false parte de zero em toda solução
+
+    int iterations;             // da última solução
+    double residual;            // relativo, da última solução
+    unsigned long iteration_count;
+} pcg_t;
+
+// Padrão como em sparse_init: pares fora da diagonal, a diagonal entra sempre
+int pcg_init(pcg_t* pcg, int n, const int* rows, const int* cols, int count);
+void pcg_free(pcg_t* pcg);
+
+// Posição de A(i, j) em values, ou -1 se não faz parte do padrão
+int pcg_slot(const pcg_t* pcg, int i, int j);
+int pcg_nonzeros(const pcg_t* pcg);
+
+// Monta o pré-condicionador com os valores atuais; se o IC(0) quebrar,
+// usa só a diagonal de A
+int pcg_factor(pcg_t* pcg);
+// Resolve A·x = b no lugar; -1 se não convergiu em max_iterations
+int pcg_solve(pcg_t* pcg, double* b);
+
+#endif // PCG_H
@@ -0,0 +1,75 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include <stdbool.h>
+
+// Subgrafos até este tamanho não são mais divididos
+#define SPARSE_LEAF_SIZE 64
+// Domínio com menos colunas que isso é fatorado na thread que o pegou
+#define SPARSE_MIN_PARALLEL_COLUMNS 4096
+
+// Nó da árvore de dissecção: as colunas [first, separator) são dos dois
+// subdomínios e [separator, end) do separador que os isola. Sem aresta entre
+// left e right, os dois são fatorados ao mesmo tempo; o separador espera.
+typedef struct {
+    int first;
+    int separator;              // == first numa folha
+    int end;
+    int left;                   // -1 se não há
+    int right;
+    int failed;                 // coluna original sem pivô positivo, ou -1
+} sparse_domain_t;
+
+// Cholesky esparso de uma matriz simétrica definida positiva, na ordem de
+// dissecção aninhada. O padrão é fixo depois de sparse_init: os valores são
+// escritos direto em values pelas posições de sparse_slot e fatorados de novo
+// quantas vezes for preciso.
+typedef struct {
+    int n;
+
+    // A permutada, triângulo superior por coluna, linhas em ordem
+    int* columns;
+    int* rows;
+    double* values;
+    int* diagonal;              // posição de A(i,i) em values, por índice original
+
+    int* perm;                  // perm[k] é o índice original da coluna k
+    int* inverse;
+    int* parent;                // árvore de eliminação
+
+    sparse_domain_t* domains;
+    int domain_count;
+    int domain_capacity;
+    int root;
+
+    // L por coluna, diagonal primeiro
+    int* factor_columns;
+    int* factor_rows;
+    double* factor_values;
+    int* next;                  // próxima posição livre de cada coluna
+
+    // Áreas de trabalho: domínios em paralelo só tocam nas próprias colunas
+    double* work;
+    int* stack;
+    bool* mark;
+
+    int thread_count;           // 0 usa os processadores disponíveis
+    int failed;
+    unsigned long factor_count;
+} sparse_t;
+
+// Padrão dado por count pares (rows[p], cols[p]) fora da diagonal, em
+// qualquer triângulo e com repetições; a diagonal entra sempre
+int sparse_init(sparse_t* sparse, int n, const int* rows, const int* cols, int count);
+void sparse_free(sparse_t* sparse);
+
+// Posição de A(i, j) em values, ou -1 se não faz parte do padrão
+int sparse_slot(const sparse_t* sparse, int i, int j);
+int sparse_nonzeros(const sparse_t* sparse);
+
+// Fatora os valores atuais; em erro, failed tem o índice original do pivô
+int sparse_factor(sparse_t* sparse);
+// Resolve A·x = b no lugar, na ordem original
+void sparse_solve(sparse_t* sparse, double* b);
+
+#endif // SPARSE_H
@@ -0,0 +1,121 @@
+#ifndef ARM_CORE_H
+#define ARM_CORE_H
+
+#include <stdint.h>
+
+#include "config/microcontroller.h"
+
+// Índices em mcu->registers.arm (o PC fica em program_counter)
+#define ARM_REG_SP 13
+#define ARM_REG_LR 14
+#define ARM_REG_PC 15
+#define ARM_REG_XPSR 16
+
+// Bits do xPSR; o estado do IT ocupa os bits 26:25 e 15:10
+#define ARM_FLAG_N 0x80000000u
+#define ARM_FLAG_Z 0x40000000u
+#define ARM_FLAG_C 0x20000000u
+#define ARM_FLAG_V 0x10000000u
+#define ARM_FLAG_Q 0x08000000u
+#define ARM_XPSR_T 0x01000000u
+
+// Mapa de memória: código (alias do flash em 0), SRAM e periféricos
+#define ARM_PERIPHERAL_BASE 0x40000000u
+#define ARM_PERIPHERAL_END  0x60000000u
+#define ARM_PPB_BASE        0xE0000000u
+#define ARM_MAX_REGIONS     32
+
+// Flags de uma instrução decodificada
+#define ARM_INSN_BREAKPOINT 0x0001
+#define ARM_INSN_S          0x0002  // atualiza flags
+#define ARM_INSN_S_OUT_IT   0x0004  // atualiza flags só fora de um bloco IT (16 bits)
+#define ARM_INSN_IMM        0x0008  // segundo operando/offset é imediato
+#define ARM_INSN_IMM_C      0x0010  // imediato rotacionado define o carry
+#define ARM_INSN_SIGNED     0x0020
+#define ARM_INSN_PRE        0x0040  // endereço com offset (senão pós-indexado)
+#define ARM_INSN_WBACK      0x0080
+#define ARM_INSN_SUB        0x0100  // offset subtraído da base
+#define ARM_INSN_ALIGN_PC   0x0200  // base é Align(PC, 4)
+#define ARM_INSN_LINK       0x0400  // BLX
+#define ARM_INSN_NONZERO    0x0800  // CBNZ
+#define ARM_INSN_DB         0x1000  // LDM/STM decrementando antes
+
+typedef enum {
+    ARM_I_UNDECODED = 0,
+    ARM_I_UNDEFINED,
+    // Processamento de dados: rd = rn op operando2
+    ARM_I_AND, ARM_I_EOR, ARM_I_ORR, ARM_I_ORN, ARM_I_BIC, ARM_I_MOV, ARM_I_MVN,
+    ARM_I_ADD, ARM_I_ADC, ARM_I_SUB, ARM_I_SBC, ARM_I_RSB,
+    ARM_I_TST, ARM_I_TEQ, ARM_I_CMP, ARM_I_CMN,
+    ARM_I_SHIFT,                    // deslocamento por registrador
+    ARM_I_MUL, ARM_I_MLA, ARM_I_MLS,
+    ARM_I_UMULL, ARM_I_SMULL, ARM_I_UMLAL, ARM_I_SMLAL, ARM_I_UDIV, ARM_I_SDIV,
+    ARM_I_MOVT, ARM_I_EXTEND,
+    ARM_I_REV, ARM_I_REV16, ARM_I_REVSH, ARM_I_RBIT, ARM_I_CLZ,
+    ARM_I_BFI, ARM_I_UBFX, ARM_I_SBFX,
+    // Memória
+    ARM_I_LOAD, ARM_I_STORE, ARM_I_LOADD, ARM_I_STORED, ARM_I_STREX, ARM_I_LDM, ARM_I_STM,
+    // Desvios
+    ARM_I_B, ARM_I_BL, ARM_I_BX, ARM_I_CBZ, ARM_I_TB,
+    // Controle
+    ARM_I_IT, ARM_I_MRS, ARM_I_MSR, ARM_I_NOP, ARM_I_BKPT,
+    ARM_I_COUNT
+} arm_insn_op_t;
+
+// Instrução decodificada; o cache guarda uma por meia-palavra do flash
+typedef struct arm_insn {
+    uint8_t op;         // arm_insn_op_t
+    uint8_t cls;        // arm_op_t, índice da tabela de ciclos
+    uint8_t length;     // 2 ou 4 bytes
+    uint8_t cond;       // 0xE = sempre
+    uint8_t rd, rn, rm, ra;
+    uint8_t shift_type; // 0 LSL, 1 LSR, 2 ASR, 3 ROR, 4 RRX
+    uint8_t shift_n;
+    uint8_t size;       // largura do acesso à memória em bytes
+    uint16_t flags;     // ARM_INSN_*
+    uint32_t imm;
+} arm_insn_t;
+
+// Periférico mapeado; offset é relativo à base da região
+typedef uint32_t (*arm_io_read_t)(microcontroller_t* mcu, uint32_t offset, int size, void* context);
+typedef void (*arm_io_write_t)(microcontroller_t* mcu, uint32_t offset, uint32_t value, int size, void* context);
+
+typedef struct {
+    uint32_t base;
+    uint32_t size;
+    arm_io_read_t read;
+    arm_io_write_t write;
+    void* context;
+} arm_region_t;
+
+typedef struct arm_core {
+    arm_insn_t* code;                       // cache do flash
+    arm_region_t regions[ARM_MAX_REGIONS];  // ordenadas por base
+    int region_count;
+    int last_region;                        // última região acessada
+} arm_core_t;
+
+arm_insn_t arm_decode(uint16_t first, uint16_t second);
+
+int arm_core_init(microcontroller_t* mcu);
+void arm_core_cleanup(microcontroller_t* mcu);
+// SP e PC iniciais vêm da tabela de vetores no início do flash
+void arm_core_reset(microcontroller_t* mcu);
+void arm_core_invalidate(microcontroller_t* mcu);
+void arm_core_mark_breakpoint(microcontroller_t* mcu, uint32_t halfword, bool enabled);
+
+// Periféricos: acessos fora de regiões mapeadas leem zero
+int arm_map_region(microcontroller_t* mcu, uint32_t base, uint32_t size,
+                   arm_io_read_t read, arm_io_write_t write, void* context);
+
+int arm_read(microcontroller_t* mcu, uint32_t address, int size, uint32_t* value);
+int arm_write(microcontroller_t* mcu, uint32_t address, int size, uint32_t value);
+
+// Executa uma instrução e retorna os ciclos gastos (ou -1 em erro)
+int arm_core_step(microcontroller_t* mcu);
+// Executa até cycle_count alcançar stop ou o núcleo sair de RUNNING
+int arm_core_run(microcontroller_t* mcu, uint64_t stop);
+
+extern const mcu_core_ops_t arm_core_ops;
+
+#endif // ARM_CORE_H
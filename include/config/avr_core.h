@@ -0,0 +1,55 @@
+#ifndef AVR_CORE_H
+#define AVR_CORE_H
+
+#include <stdint.h>
+
+#include "config/microcontroller.h"
+
+// Mapa do espaço de dados do ATmega328P
+#define AVR_REGISTER_COUNT 32
+#define AVR_IO_BASE 0x20
+#define AVR_SPL 0x5D
+#define AVR_SPH 0x5E
+#define AVR_SREG 0x5F
+
+// Bits do SREG
+#define AVR_FLAG_C 0x01
+#define AVR_FLAG_Z 0x02
+#define AVR_FLAG_N 0x04
+#define AVR_FLAG_V 0x08
+#define AVR_FLAG_S 0x10
+#define AVR_FLAG_H 0x20
+#define AVR_FLAG_T 0x40
+#define AVR_FLAG_I 0x80
+
+// Flags de uma instrução decodificada
+#define AVR_INSN_BREAKPOINT 0x01
+
+// Instrução decodificada; o cache guarda uma por palavra do flash
+typedef struct avr_insn {
+    uint8_t op;       // avr_op_t
+    uint8_t d;        // registrador destino, endereço de I/O ou bit do SREG
+    uint8_t r;        // registrador fonte ou número do bit
+    uint8_t length;   // tamanho em palavras (1 ou 2)
+    uint32_t k;       // imediato, deslocamento ou endereço
+    uint8_t flags;    // AVR_INSN_*
+} avr_insn_t;
+
+avr_insn_t avr_decode(uint16_t opcode, uint16_t next);
+
+int avr_core_init(microcontroller_t* mcu);
+void avr_core_cleanup(microcontroller_t* mcu);
+void avr_core_reset(microcontroller_t* mcu);
+void avr_core_invalidate(microcontroller_t* mcu);
+// Atualiza a flag de breakpoint de uma palavra já decodificada
+void avr_core_mark_breakpoint(microcontroller_t* mcu, uint32_t word, bool enabled);
+
+// Executa uma instrução e retorna os ciclos gastos (ou -1 em erro)
+int avr_core_step(microcontroller_t* mcu);
+// Executa até cycle_count alcançar stop ou o núcleo sair de RUNNING
+int avr_core_run(microcontroller_t* mcu, uint64_t stop);
+
+// Tabela de operações usada pelo mcu_init
+extern const mcu_core_ops_t avr_core_ops;
+
+#endif // AVR_CORE_H
@@ -0,0 +1,22 @@
+#ifndef AVR_IO_H
+#define AVR_IO_H
+
+#include "config/microcontroller.h"
+
+// Registradores de GPIO do ATmega328P (endereços no espaço de dados)
+#define AVR_PINB  0x23
+#define AVR_DDRB  0x24
+#define AVR_PORTB 0x25
+#define AVR_PINC  0x26
+#define AVR_DDRC  0x27
+#define AVR_PORTC 0x28
+#define AVR_PIND  0x29
+#define AVR_DDRD  0x2A
+#define AVR_PORTD 0x2B
+
+// Mapeia registradores de uso geral e portas B/C/D, nomeando os pinos
+// ("PB5" etc.) na numeração física do encapsulamento DIP-28 (pino 1 = 0)
+int avr_io_init(microcontroller_t* mcu);
+void avr_io_reset(microcontroller_t* mcu);
+
+#endif // AVR_IO_H
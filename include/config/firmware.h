@@ -0,0 +1,44 @@
+#ifndef FIRMWARE_H
+#define FIRMWARE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config/microcontroller.h"
+
+typedef enum {
+    FIRMWARE_RAW = 0,     // binário puro, copiado para o início do flash
+    FIRMWARE_IHEX,        // Intel HEX
+    FIRMWARE_ELF          // ELF32 little-endian (avr-gcc, arm-none-eabi-gcc)
+} firmware_format_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+} firmware_file_t;
+
+// Função da tabela de símbolos do ELF; address no espaço do PC (bit Thumb limpo)
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+    char* name;
+} firmware_symbol_t;
+
+// Mapeia o arquivo inteiro em memória (somente leitura)
+int firmware_map(const char* path, firmware_file_t* file);
+void firmware_unmap(firmware_file_t* file);
+
+firmware_format_t firmware_detect_format(const uint8_t* data, size_t size);
+const char* firmware_format_to_string(firmware_format_t format);
+
+// Posiciona os segmentos no flash e na imagem inicial da RAM do MCU,
+// atualizando firmware_size e entry_point. Com dry_run só valida.
+int firmware_load_image(microcontroller_t* mcu, const uint8_t* data, size_t size, bool dry_run);
+
+// Lê as funções (STT_FUNC) do .symtab, ordenadas por endereço. Símbolos sem
+// tamanho vão até o próximo. Sem .symtab, retorna 0 símbolos.
+int firmware_load_symbols(const uint8_t* data, size_t size, firmware_symbol_t** symbols, int* count);
+void firmware_free_symbols(firmware_symbol_t* symbols, int count);
+
+#endif // FIRMWARE_H
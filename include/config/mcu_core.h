@@ -0,0 +1,36 @@
+#ifndef MCU_CORE_H
+#define MCU_CORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct microcontroller;
+
+// Operações de um núcleo de CPU, escolhidas pelo mcu_init conforme o tipo.
+// O laço de execução chama step/run_block direto pela tabela, sem testar o
+// tipo do microcontrolador a cada instrução.
+typedef struct mcu_core_ops {
+    const char* name;
+    int register_count;     // índices válidos em read_reg/write_reg
+
+    int (*init)(struct microcontroller* mcu);
+    void (*cleanup)(struct microcontroller* mcu);
+    void (*reset)(struct microcontroller* mcu);
+    // Descarta as instruções decodificadas (o flash mudou)
+    void (*invalidate)(struct microcontroller* mcu);
+    // index em meias-palavras a partir de flash_start, como no bitmap de breakpoints
+    void (*mark_breakpoint)(struct microcontroller* mcu, uint32_t index, bool enabled);
+
+    // Uma instrução; retorna os ciclos gastos (ou -1 em erro)
+    int (*step)(struct microcontroller* mcu);
+    // Executa até cycle_count alcançar stop ou o núcleo sair de RUNNING
+    int (*run_block)(struct microcontroller* mcu, uint64_t stop);
+
+    int (*read_reg)(const struct microcontroller* mcu, int index, uint32_t* value);
+    int (*write_reg)(struct microcontroller* mcu, int index, uint32_t value);
+    // Texto da instrução em address; retorna o tamanho dela em bytes (ou -1)
+    int (*disassemble)(const struct microcontroller* mcu, uint32_t address, char* buffer, size_t size);
+} mcu_core_ops_t;
+
+#endif // MCU_CORE_H
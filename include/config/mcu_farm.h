@@ -0,0 +1,52 @@
+#ifndef MCU_FARM_H
+#define MCU_FARM_H
+
+#include <pthread.h>
+
+#include "config/microcontroller.h"
+
+// Uma placa emulada da farm. Tudo que a instância imprime vai para o seu
+// próprio buffer, lido com mcu_farm_output depois da execução.
+typedef struct {
+    microcontroller_t mcu;
+    int index;
+    int result;             // retorno do job nesta instância
+    void* user_data;        // livre para o chamador (parâmetros da matriz etc.)
+
+    FILE* output_stream;
+    char* output;
+    size_t output_size;
+} mcu_farm_instance_t;
+
+// Executado uma vez por instância, em alguma thread da farm; retorna 0 em sucesso
+typedef int (*mcu_farm_job_t)(mcu_farm_instance_t* instance, void* context);
+
+// Fila de uma thread: índices [top, bottom). O dono consome pelo fim e as
+// outras threads roubam pelo início.
+typedef struct {
+    pthread_mutex_t lock;
+    int top;
+    int bottom;
+} mcu_farm_queue_t;
+
+typedef struct {
+    mcu_farm_instance_t* instances;
+    int instance_count;
+    int thread_count;
+    mcu_farm_queue_t* queues;
+} mcu_farm_t;
+
+// thread_count <= 0 usa o número de processadores disponíveis
+int mcu_farm_init(mcu_farm_t* farm, const mcu_config_t* config, int instance_count, int thread_count);
+void mcu_farm_cleanup(mcu_farm_t* farm);
+
+// Carrega o firmware uma vez; as demais instâncias compartilham o flash
+int mcu_farm_load_firmware(mcu_farm_t* farm, const char* firmware_path);
+int mcu_farm_load_firmware_buffer(mcu_farm_t* farm, const uint8_t* data, size_t size);
+
+// Roda job em todas as instâncias; retorna quantas falharam (ou -1 em erro)
+int mcu_farm_run(mcu_farm_t* farm, mcu_farm_job_t job, void* context);
+
+const char* mcu_farm_output(mcu_farm_t* farm, int index, size_t* size);
+
+#endif // MCU_FARM_H
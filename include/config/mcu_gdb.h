@@ -0,0 +1,46 @@
+#ifndef MCU_GDB_H
+#define MCU_GDB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config/microcontroller.h"
+
+#define MCU_GDB_PACKET_SIZE 4096
+// Ciclos executados entre duas verificações do socket enquanto o alvo roda
+#define MCU_GDB_BATCH_CYCLES 100000
+
+// Servidor do protocolo remoto do GDB para um MCU. Endereços seguem o
+// avr-gdb nos núcleos Harvard (flash em 0, dados a partir de 0x800000) e o
+// mapa real no ARM. Breakpoints usam o bitmap do MCU (Z0/Z1) e watchpoints
+// os de dados (Z2 escrita, Z3 leitura, Z4 acesso).
+typedef struct {
+    microcontroller_t* mcu;
+    int listen_fd;
+    int client_fd;
+    uint16_t port;              // porta TCP efetiva (listen com porta 0)
+    char* unix_path;
+
+    bool running;               // 'c' em andamento
+    bool no_ack;
+    uint64_t batch_cycles;
+
+    char input[MCU_GDB_PACKET_SIZE];
+    size_t input_length;
+} mcu_gdb_t;
+
+// Escuta em 127.0.0.1:port (0 escolhe uma porta livre) ou num socket Unix
+int mcu_gdb_listen_tcp(mcu_gdb_t* gdb, microcontroller_t* mcu, uint16_t port);
+int mcu_gdb_listen_unix(mcu_gdb_t* gdb, microcontroller_t* mcu, const char* path);
+void mcu_gdb_close(mcu_gdb_t* gdb);
+
+// Uma rodada do servidor: aceita a conexão, trata os pacotes que chegaram
+// e, com o alvo rodando, executa batch_cycles ciclos. Só espera pelo socket
+// (até timeout_ms, -1 sem limite) quando o alvo está parado. Retorna 1
+// enquanto houver depurador conectado, 0 sem conexão e -1 em erro.
+int mcu_gdb_poll(mcu_gdb_t* gdb, int timeout_ms);
+
+// Atende um depurador até ele desconectar (detach ou kill)
+int mcu_gdb_serve(mcu_gdb_t* gdb);
+
+#endif // MCU_GDB_H
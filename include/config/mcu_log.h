@@ -0,0 +1,56 @@
+#ifndef MCU_LOG_H
+#define MCU_LOG_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define MCU_LOG_TRACE 0
+#define MCU_LOG_DEBUG 1
+#define MCU_LOG_INFO  2
+#define MCU_LOG_WARN  3
+#define MCU_LOG_ERROR 4
+#define MCU_LOG_OFF   5
+
+// Níveis abaixo deste somem na compilação (-DMCU_LOG_COMPILE_LEVEL=...)
+#ifndef MCU_LOG_COMPILE_LEVEL
+#define MCU_LOG_COMPILE_LEVEL MCU_LOG_DEBUG
+#endif
+
+// Mensagens por thread que ainda não foram escritas; além disso são descartadas
+#define MCU_LOG_RING_SIZE 1024
+#define MCU_LOG_MESSAGE_SIZE 120
+
+extern atomic_int mcu_log_runtime_level;
+
+// Escreve em out. Com o logger iniciado a mensagem vai para o anel da thread
+// e é escrita pela thread de escrita; sem ele, é escrita na hora.
+void mcu_log_write(FILE* out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// O nível é constante: o teste contra MCU_LOG_COMPILE_LEVEL é resolvido pelo
+// compilador e o de execução é uma leitura relaxada
+#define MCU_LOG(level, out, ...)                                                     \
+    do {                                                                             \
+        if ((level) >= MCU_LOG_COMPILE_LEVEL &&                                      \
+            (level) >= atomic_load_explicit(&mcu_log_runtime_level, memory_order_relaxed)) { \
+            mcu_log_write((out), __VA_ARGS__);                                       \
+        }                                                                            \
+    } while (0)
+
+void mcu_log_set_level(int level);
+int mcu_log_get_level(void);
+
+// Inicia/para a thread que esvazia os anéis; mcu_log_stop escreve o que restou
+int mcu_log_start(void);
+void mcu_log_stop(void);
+bool mcu_log_running(void);
+
+// Escreve tudo que já foi registrado antes de retornar. Chame antes de fechar
+// um FILE que recebeu mensagens, já que o anel guarda só o ponteiro.
+void mcu_log_flush(void);
+
+// Mensagens descartadas por anel cheio desde o início
+unsigned long mcu_log_dropped(void);
+
+#endif // MCU_LOG_H
@@ -0,0 +1,81 @@
+#ifndef MCU_PROFILE_H
+#define MCU_PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "config/firmware.h"
+#include "config/microcontroller.h"
+
+#define MCU_PROFILE_MAX_DEPTH 64
+
+typedef enum {
+    MCU_PROFILE_OFF = 0,
+    // Evento do scheduler a cada period ciclos registra o PC; o laço da CPU
+    // não muda, só é interrompido com mais frequência
+    MCU_PROFILE_SAMPLING,
+    // mcu_profile_run executa instrução por instrução contando entradas e
+    // ciclos de cada bloco básico e a pilha de chamadas
+    MCU_PROFILE_BLOCKS
+} mcu_profile_mode_t;
+
+// Nó da árvore de chamadas (modo de blocos); symbol < 0 usa address
+typedef struct {
+    int parent;
+    int first_child;
+    int next_sibling;
+    int symbol;
+    uint32_t address;
+    uint64_t cycles;            // ciclos gastos no próprio nó
+} mcu_profile_node_t;
+
+typedef struct {
+    int node;
+    uint32_t return_address;
+} mcu_profile_frame_t;
+
+typedef struct {
+    microcontroller_t* mcu;
+    mcu_profile_mode_t mode;
+    uint64_t period;
+    int event_id;
+
+    // Uma posição por meia-palavra do flash: amostras (amostragem) ou
+    // ciclos do bloco que começa ali (blocos)
+    uint64_t* hits;
+    uint64_t* entries;          // blocos: vezes que o bloco começou
+    uint32_t slot_count;
+    uint64_t outside;           // PC fora do flash
+    uint64_t total;
+
+    firmware_symbol_t* symbols;
+    int symbol_count;
+
+    mcu_profile_node_t* nodes;
+    int node_count;
+    int node_capacity;
+    mcu_profile_frame_t stack[MCU_PROFILE_MAX_DEPTH];
+    int depth;
+    uint32_t block;             // início do bloco atual
+} mcu_profile_t;
+
+// period só é usado na amostragem
+int mcu_profile_start(mcu_profile_t* profile, microcontroller_t* mcu, mcu_profile_mode_t mode, uint64_t period);
+void mcu_profile_stop(mcu_profile_t* profile);
+void mcu_profile_free(mcu_profile_t* profile);
+
+// Símbolos do ELF em path (normalmente mcu->firmware_path), ou uma cópia
+// de uma lista já pronta
+int mcu_profile_load_symbols(mcu_profile_t* profile, const char* path);
+int mcu_profile_set_symbols(mcu_profile_t* profile, const firmware_symbol_t* symbols, int count);
+
+// Modo de blocos: como mcu_run_cycles, mas medindo cada instrução
+int mcu_profile_run(mcu_profile_t* profile, uint64_t cycles);
+
+// Perfil plano: por função com símbolos, por endereço sem eles
+void mcu_profile_report(const mcu_profile_t* profile, FILE* out);
+// Uma linha "f1;f2;f3 contagem" por pilha (formato do flamegraph.pl);
+// na amostragem cada pilha tem só a função amostrada
+void mcu_profile_write_collapsed(const mcu_profile_t* profile, FILE* out);
+
+#endif // MCU_PROFILE_H
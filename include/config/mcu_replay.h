@@ -0,0 +1,76 @@
+#ifndef MCU_REPLAY_H
+#define MCU_REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config/mcu_snapshot.h"
+
+// Gravação de uma execução: só as entradas externas (pinos dirigidos de fora
+// e escritas do host no espaço de dados, como amostras de ADC ou bytes
+// recebidos pela UART) vão para o journal, com o ciclo em que foram
+// aplicadas. O resto da execução é determinístico e é refeito a partir do
+// snapshot mais próximo.
+//
+// Cada entrada do journal: delta de ciclos (varint), tipo (1 byte) e dados
+//   MCU_INPUT_PIN:    pino (varint), estado (1 byte)
+//   MCU_INPUT_MEMORY: endereço (varint), tamanho (varint), bytes
+typedef enum {
+    MCU_INPUT_PIN = 1,
+    MCU_INPUT_MEMORY
+} mcu_input_kind_t;
+
+typedef struct {
+    mcu_snapshot_t snapshot;
+    size_t journal_offset;      // primeira entrada posterior ao snapshot
+    uint64_t journal_cycle;     // base dos deltas nessa posição
+} mcu_checkpoint_t;
+
+typedef struct mcu_recording {
+    uint8_t* journal;
+    size_t journal_size;
+    size_t journal_capacity;
+    uint64_t journal_cycle;     // ciclo da última entrada gravada
+
+    // Snapshots ordenados por ciclo, um a cada snapshot_interval ciclos
+    mcu_checkpoint_t* checkpoints;
+    int checkpoint_count;
+    int checkpoint_capacity;
+    uint64_t snapshot_interval;
+
+    bool replaying;
+    bool applying;              // entrada vinda do journal, não do host
+    size_t cursor;              // próxima entrada a reaplicar
+    uint64_t cursor_cycle;
+} mcu_recording_t;
+
+int mcu_recording_init(mcu_recording_t* recording, uint64_t snapshot_interval);
+void mcu_recording_free(mcu_recording_t* recording);
+
+// Começa a gravar a partir do estado atual (primeiro snapshot)
+int mcu_record_start(microcontroller_t* mcu, mcu_recording_t* recording);
+// Como mcu_run_cycles, tirando snapshots a cada snapshot_interval ciclos
+int mcu_record_run(microcontroller_t* mcu, uint64_t cycles);
+void mcu_record_stop(microcontroller_t* mcu);
+
+// Leva o MCU ao ciclo pedido: segue da posição atual se ela estiver no
+// caminho, senão restaura o snapshot anterior mais próximo, e reexecuta
+// só o trecho restante reaplicando o journal. Entradas do host são
+// ignoradas enquanto o MCU estiver em replay.
+int mcu_replay_seek(microcontroller_t* mcu, mcu_recording_t* recording, uint64_t cycle);
+void mcu_replay_stop(microcontroller_t* mcu);
+
+// O journal é salvo sem os snapshots. Ao carregar, o primeiro snapshot é o
+// estado atual de mcu, que deve ter o mesmo firmware e ter acabado de
+// passar por mcu_run; os demais são tirados durante o replay. recording
+// precisa ter passado por mcu_recording_init, e o que ele tinha é liberado.
+int mcu_recording_save(const mcu_recording_t* recording, const char* path);
+int mcu_recording_load(mcu_recording_t* recording, microcontroller_t* mcu, const char* path);
+
+// Chamados por mcu_set_pin_state/mcu_write_memory quando há gravação
+// associada; retornam false se a entrada deve ser ignorada
+bool mcu_replay_pin_input(microcontroller_t* mcu, int pin_number, pin_state_t state);
+bool mcu_replay_memory_input(microcontroller_t* mcu, uint32_t address, const uint8_t* data, size_t size);
+
+#endif // MCU_REPLAY_H
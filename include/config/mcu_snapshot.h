@@ -0,0 +1,40 @@
+#ifndef MCU_SNAPSHOT_H
+#define MCU_SNAPSHOT_H
+
+#include "config/microcontroller.h"
+
+// Estado completo de um MCU em execução: espaço de dados (RAM e I/O),
+// registradores, PC, ciclos, eventos pendentes e pinos. O flash não faz
+// parte do snapshot; recarregar o firmware invalida a restauração rápida.
+typedef struct {
+    uint32_t id;
+    mcu_type_t type;
+
+    uint8_t* data_memory;
+    uint32_t data_size;
+    mcu_registers_t registers;
+
+    mcu_state_t state;
+    uint32_t program_counter;
+    uint64_t cycle_count;
+    bool skip_breakpoint;
+    mcu_stop_reason_t stop_reason;
+    uint32_t stop_address;
+    mcu_watch_t stop_watch;
+
+    scheduler_t scheduler;
+    pin_t* pins;
+    int pin_count;
+} mcu_snapshot_t;
+
+// Captura o estado atual e passa a rastrear as páginas escritas a partir dele
+int mcu_snapshot_take(microcontroller_t* mcu, mcu_snapshot_t* snapshot);
+
+// Volta ao estado do snapshot. Se ele for o último tirado/restaurado neste
+// MCU, só as páginas sujas são copiadas; caso contrário a cópia é completa.
+// O snapshot pode ser restaurado em qualquer MCU do mesmo tipo.
+int mcu_snapshot_restore(microcontroller_t* mcu, const mcu_snapshot_t* snapshot);
+
+void mcu_snapshot_free(mcu_snapshot_t* snapshot);
+
+#endif // MCU_SNAPSHOT_H
@@ -0,0 +1,179 @@
+#ifndef MCU_TIMING_H
+#define MCU_TIMING_H
+
+#include <stdint.h>
+
+// Os ciclos são sempre contados em períodos do clock do oscilador
+// (mcu_config_t.clock_frequency), então tempo = ciclos / frequência.
+
+// Opcodes do AVR (ATmega328P) produzidos pelo decodificador
+typedef enum {
+    AVR_OP_UNDECODED = 0,
+    AVR_OP_NOP,
+    AVR_OP_MOVW,
+    AVR_OP_MULS,
+    AVR_OP_MULSU,
+    AVR_OP_FMUL,
+    AVR_OP_FMULS,
+    AVR_OP_FMULSU,
+    AVR_OP_CPC,
+    AVR_OP_SBC,
+    AVR_OP_ADD,
+    AVR_OP_CPSE,
+    AVR_OP_CP,
+    AVR_OP_SUB,
+    AVR_OP_ADC,
+    AVR_OP_AND,
+    AVR_OP_EOR,
+    AVR_OP_OR,
+    AVR_OP_MOV,
+    AVR_OP_CPI,
+    AVR_OP_SBCI,
+    AVR_OP_SUBI,
+    AVR_OP_ORI,
+    AVR_OP_ANDI,
+    AVR_OP_LDD_Y,
+    AVR_OP_LDD_Z,
+    AVR_OP_STD_Y,
+    AVR_OP_STD_Z,
+    AVR_OP_LDS,
+    AVR_OP_LD_X,
+    AVR_OP_LD_X_INC,
+    AVR_OP_LD_X_DEC,
+    AVR_OP_LD_Y_INC,
+    AVR_OP_LD_Y_DEC,
+    AVR_OP_LD_Z_INC,
+    AVR_OP_LD_Z_DEC,
+    AVR_OP_LPM_R0,
+    AVR_OP_LPM,
+    AVR_OP_LPM_INC,
+    AVR_OP_POP,
+    AVR_OP_STS,
+    AVR_OP_ST_X,
+    AVR_OP_ST_X_INC,
+    AVR_OP_ST_X_DEC,
+    AVR_OP_ST_Y_INC,
+    AVR_OP_ST_Y_DEC,
+    AVR_OP_ST_Z_INC,
+    AVR_OP_ST_Z_DEC,
+    AVR_OP_PUSH,
+    AVR_OP_COM,
+    AVR_OP_NEG,
+    AVR_OP_SWAP,
+    AVR_OP_INC,
+    AVR_OP_ASR,
+    AVR_OP_LSR,
+    AVR_OP_ROR,
+    AVR_OP_DEC,
+    AVR_OP_BSET,
+    AVR_OP_BCLR,
+    AVR_OP_RET,
+    AVR_OP_RETI,
+    AVR_OP_SLEEP,
+    AVR_OP_BREAK,
+    AVR_OP_WDR,
+    AVR_OP_SPM,
+    AVR_OP_IJMP,
+    AVR_OP_ICALL,
+    AVR_OP_JMP,
+    AVR_OP_CALL,
+    AVR_OP_ADIW,
+    AVR_OP_SBIW,
+    AVR_OP_CBI,
+    AVR_OP_SBIC,
+    AVR_OP_SBI,
+    AVR_OP_SBIS,
+    AVR_OP_MUL,
+    AVR_OP_IN,
+    AVR_OP_OUT,
+    AVR_OP_RJMP,
+    AVR_OP_RCALL,
+    AVR_OP_LDI,
+    AVR_OP_BRBS,
+    AVR_OP_BRBC,
+    AVR_OP_BLD,
+    AVR_OP_BST,
+    AVR_OP_SBRC,
+    AVR_OP_SBRS,
+    AVR_OP_ILLEGAL,
+    AVR_OP_COUNT
+} avr_op_t;
+
+// Desvio condicional tomado custa um ciclo a mais
+#define AVR_BRANCH_TAKEN_CYCLES 1
+// Instruções de skip custam mais 1 ciclo por palavra pulada
+#define AVR_SKIP_CYCLES_PER_WORD 1
+
+// Classes de instrução do Cortex-M3 (ARM Cortex-M3 TRM, "Instruction timing")
+typedef enum {
+    ARM_OP_ALU = 0,        // processamento de dados, MOV, CMP, extensões
+    ARM_OP_MUL,            // MUL
+    ARM_OP_MLA,            // MLA, MLS
+    ARM_OP_MULL,           // UMULL, SMULL, UMLAL, SMLAL
+    ARM_OP_DIV,            // UDIV, SDIV (2 a 12 ciclos, dependente dos dados)
+    ARM_OP_LOAD,           // LDR, LDRB, LDRH, LDRSB, LDRSH
+    ARM_OP_STORE,          // STR, STRB, STRH
+    ARM_OP_LOAD_MULTIPLE,  // LDM, POP (+1 por registrador)
+    ARM_OP_STORE_MULTIPLE, // STM, PUSH (+1 por registrador)
+    ARM_OP_BRANCH,         // B, B<cond>, CBZ, CBNZ, BX, BLX
+    ARM_OP_BRANCH_LINK,    // BL
+    ARM_OP_TABLE_BRANCH,   // TBB, TBH
+    ARM_OP_IT,             // IT
+    ARM_OP_STATUS,         // MRS, MSR, CPS
+    ARM_OP_BARRIER,        // DMB, DSB, ISB
+    ARM_OP_SLEEP,          // WFI, WFE
+    ARM_OP_NOP,
+    ARM_OP_COUNT
+} arm_op_t;
+
+// Recarga do pipeline (P no TRM) quando um desvio é tomado
+#define ARM_PIPELINE_REFILL_CYCLES 2
+
+// Instruções do PIC16 (conjunto de 35 instruções de 14 bits)
+typedef enum {
+    PIC_OP_UNDECODED = 0,
+    PIC_OP_ADDWF,
+    PIC_OP_ANDWF,
+    PIC_OP_CLRF,
+    PIC_OP_CLRW,
+    PIC_OP_COMF,
+    PIC_OP_DECF,
+    PIC_OP_DECFSZ,
+    PIC_OP_INCF,
+    PIC_OP_INCFSZ,
+    PIC_OP_IORWF,
+    PIC_OP_MOVF,
+    PIC_OP_MOVWF,
+    PIC_OP_NOP,
+    PIC_OP_RLF,
+    PIC_OP_RRF,
+    PIC_OP_SUBWF,
+    PIC_OP_SWAPF,
+    PIC_OP_XORWF,
+    PIC_OP_BCF,
+    PIC_OP_BSF,
+    PIC_OP_BTFSC,
+    PIC_OP_BTFSS,
+    PIC_OP_ADDLW,
+    PIC_OP_ANDLW,
+    PIC_OP_CALL,
+    PIC_OP_CLRWDT,
+    PIC_OP_GOTO,
+    PIC_OP_IORLW,
+    PIC_OP_MOVLW,
+    PIC_OP_RETFIE,
+    PIC_OP_RETLW,
+    PIC_OP_RETURN,
+    PIC_OP_SLEEP,
+    PIC_OP_SUBLW,
+    PIC_OP_XORLW,
+    PIC_OP_ILLEGAL,
+    PIC_OP_COUNT
+} pic_op_t;
+
+// No PIC16 um ciclo de instrução são 4 ciclos do oscilador
+#define PIC_CLOCKS_PER_INSTRUCTION 4
+// Skip tomado (ou escrita no PCL) insere um ciclo de instrução vazio
+#define PIC_SKIP_CYCLES PIC_CLOCKS_PER_INSTRUCTION
+
+#endif // MCU_TIMING_H
@@ -0,0 +1,234 @@
+#ifndef MICROCONTROLLER_H
+#define MICROCONTROLLER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "config/pin_manager.h"
+#include "config/mcu_core.h"
+#include "config/mcu_timing.h"
+#include "config/scheduler.h"
+
+typedef enum {
+    MCU_AVR_ATMEGA328P = 0,
+    MCU_ARM_CORTEX_M3,
+    MCU_PIC16F877A
+} mcu_type_t;
+
+typedef enum {
+    MCU_STATE_RESET = 0,
+    MCU_STATE_RUNNING,
+    MCU_STATE_HALTED,
+    MCU_STATE_ERROR
+} mcu_state_t;
+
+typedef enum {
+    MCU_STOP_NONE = 0,
+    MCU_STOP_BREAKPOINT,
+    MCU_STOP_WATCHPOINT
+} mcu_stop_reason_t;
+
+typedef enum {
+    MCU_WATCH_READ = 1,
+    MCU_WATCH_WRITE = 2,
+    MCU_WATCH_ACCESS = MCU_WATCH_READ | MCU_WATCH_WRITE
+} mcu_watch_t;
+
+// Granularidade do rastreamento de escritas no espaço de dados (snapshots)
+#define MCU_PAGE_SHIFT 6
+#define MCU_PAGE_SIZE  (1u << MCU_PAGE_SHIFT)
+
+typedef struct {
+    mcu_type_t type;
+    uint32_t clock_frequency;   // Hz
+    uint32_t memory_size;       // tamanho do flash (memória de programa)
+    uint32_t flash_start;
+    uint32_t ram_start;
+    uint32_t ram_size;
+    int pin_count;
+    const char* name;
+} mcu_config_t;
+
+struct microcontroller;
+
+// Callbacks de registradores de I/O mapeados em memória. O handler de
+// escrita é responsável por guardar o valor em data_memory se quiser.
+typedef uint8_t (*mmio_read_t)(struct microcontroller* mcu, uint32_t offset, void* context);
+typedef void (*mmio_write_t)(struct microcontroller* mcu, uint32_t offset, uint8_t value, void* context);
+
+typedef struct {
+    mmio_read_t read;
+    mmio_write_t write;
+    void* context;
+} mmio_handler_t;
+
+// Registradores de cada núcleo, no layout natural, dentro da instância
+typedef union {
+    uint8_t avr[32];                // R0-R31
+    uint32_t arm[17];               // R0-R15 (o PC fica em program_counter) e xPSR
+    struct {
+        uint8_t w;
+        uint8_t stack_ptr;
+        uint16_t stack[8];          // pilha de hardware de 8 níveis
+    } pic;
+} mcu_registers_t;
+
+typedef struct microcontroller {
+    mcu_config_t config;
+    mcu_state_t state;
+    uint32_t program_counter;   // endereço em bytes
+
+    uint8_t* memory;            // flash
+    uint32_t memory_size;
+    bool flash_shared;          // flash e data_image pertencem a outra instância
+
+    // Espaço de dados: começa em data_base (0 no AVR/PIC, ram_start no ARM)
+    uint8_t* data_memory;
+    uint32_t data_base;
+    uint32_t data_size;
+
+    // Região de I/O: offsets abaixo de mmio_end consultam a tabela de
+    // handlers; o restante é RAM comum, acessada diretamente
+    mmio_handler_t* mmio;
+    uint32_t mmio_end;
+    // Início do acesso direto à RAM; sobe para data_size enquanto houver
+    // watchpoints, forçando todo acesso a passar pelo caminho lento
+    uint32_t direct_start;
+
+    // Páginas de RAM escritas desde o último snapshot/restore (um byte por
+    // página); snapshot_id identifica o snapshot que elas diferenciam
+    uint8_t* dirty_pages;
+    uint32_t page_count;
+    uint32_t snapshot_id;
+
+    const mcu_core_ops_t* core;
+    mcu_registers_t registers;
+    pin_manager_t pin_manager;
+
+    // Mensagens da instância (stdout por padrão)
+    FILE* output;
+
+    bool firmware_loaded;
+    char* firmware_path;
+    uint32_t firmware_size;     // bytes ocupados no flash
+    uint32_t entry_point;       // endereço de início após o reset
+    uint8_t* data_image;        // conteúdo inicial da RAM (.data/.bss), se houver
+
+    // Temporização: ciclos de clock desde o reset
+    uint64_t cycle_count;
+    const uint8_t* cycle_table;
+    size_t cycle_table_size;
+
+    // Eventos de periféricos e sincronização, por ciclo
+    scheduler_t scheduler;
+
+    // Instruções AVR pré-decodificadas, uma por palavra do flash
+    struct avr_insn* avr_code;
+    // Núcleo Thumb-2 (cache de instruções e periféricos mapeados)
+    struct arm_core* arm;
+    // Núcleo PIC16 (cache de instruções e tradução de bancos)
+    struct pic_core* pic;
+
+    // Depuração: bitmaps alocados no primeiro uso
+    uint64_t* breakpoints;      // um bit por meia-palavra do flash
+    uint64_t* watch_read;       // um bit por byte do espaço de dados
+    uint64_t* watch_write;
+    int breakpoint_count;
+    int watchpoint_count;
+    bool skip_breakpoint;       // retoma sem parar no breakpoint atual
+    mcu_stop_reason_t stop_reason;
+    uint32_t stop_address;
+    mcu_watch_t stop_watch;     // tipo do watchpoint que parou a execução
+
+    // Gravação ou replay em andamento (entradas externas passam por ela)
+    struct mcu_recording* recording;
+} microcontroller_t;
+
+// Inicialização e limpeza
+int mcu_init(microcontroller_t* mcu, const mcu_config_t* config);
+int mcu_init_with_output(microcontroller_t* mcu, const mcu_config_t* config, FILE* output);
+int mcu_cleanup(microcontroller_t* mcu);
+int mcu_reset(microcontroller_t* mcu);
+
+// Firmware: binário puro, Intel HEX ou ELF (detectado pelo conteúdo)
+int mcu_load_firmware(microcontroller_t* mcu, const char* firmware_path);
+int mcu_load_firmware_buffer(microcontroller_t* mcu, const uint8_t* data, size_t size);
+int mcu_verify_firmware(microcontroller_t* mcu, const char* firmware_path);
+int mcu_get_firmware_info(microcontroller_t* mcu, uint32_t* size, uint32_t* entry_point);
+
+// Usa o flash já carregado em source (somente leitura) em vez de uma cópia;
+// source precisa continuar vivo enquanto mcu existir
+int mcu_share_firmware(microcontroller_t* mcu, const microcontroller_t* source);
+
+// Execução
+int mcu_step(microcontroller_t* mcu);
+int mcu_run(microcontroller_t* mcu);
+int mcu_stop(microcontroller_t* mcu);
+int mcu_run_until_breakpoint(microcontroller_t* mcu, uint32_t address);
+
+// Execução temporizada
+int mcu_run_cycles(microcontroller_t* mcu, uint64_t cycles);
+int mcu_run_until_time(microcontroller_t* mcu, double seconds);
+uint64_t mcu_get_cycle_count(const microcontroller_t* mcu);
+double mcu_get_time(const microcontroller_t* mcu);
+const uint8_t* mcu_get_cycle_table(mcu_type_t type, size_t* count);
+
+// Eventos: delay em ciclos a partir do ciclo atual; retorna o id do evento
+int mcu_schedule_event(microcontroller_t* mcu, uint64_t delay, sched_event_kind_t kind,
+                       sched_callback_t callback, void* context);
+int mcu_cancel_event(microcontroller_t* mcu, int event_id);
+
+// Espaço de dados com despacho de MMIO (offsets a partir de data_base)
+uint8_t mcu_mmio_read(microcontroller_t* mcu, uint32_t offset);
+void mcu_mmio_write(microcontroller_t* mcu, uint32_t offset, uint8_t value);
+int mcu_map_io(microcontroller_t* mcu, uint32_t offset, mmio_read_t read, mmio_write_t write, void* context);
+int mcu_unmap_io(microcontroller_t* mcu, uint32_t offset);
+
+static inline uint8_t mcu_data_read(microcontroller_t* mcu, uint32_t offset) {
+    if (offset >= mcu->direct_start) {
+        return offset < mcu->data_size ? mcu->data_memory[offset] : 0;
+    }
+    return mcu_mmio_read(mcu, offset);
+}
+
+static inline void mcu_data_write(microcontroller_t* mcu, uint32_t offset, uint8_t value) {
+    if (offset >= mcu->direct_start) {
+        if (offset < mcu->data_size) {
+            mcu->data_memory[offset] = value;
+            mcu->dirty_pages[offset >> MCU_PAGE_SHIFT] = 1;
+        }
+        return;
+    }
+    mcu_mmio_write(mcu, offset, value);
+}
+
+// Memória e registradores
+int mcu_read_memory(microcontroller_t* mcu, uint32_t address, uint8_t* data, size_t size);
+int mcu_write_memory(microcontroller_t* mcu, uint32_t address, const uint8_t* data, size_t size);
+int mcu_read_register(microcontroller_t* mcu, int reg_index, uint32_t* value);
+int mcu_write_register(microcontroller_t* mcu, int reg_index, uint32_t value);
+
+// Pinos
+int mcu_get_pin_state(microcontroller_t* mcu, int pin_number, pin_state_t* state);
+int mcu_set_pin_state(microcontroller_t* mcu, int pin_number, pin_state_t state);
+int mcu_get_pin_by_name(microcontroller_t* mcu, const char* name, pin_t** pin);
+
+// Debug
+int mcu_set_breakpoint(microcontroller_t* mcu, uint32_t address);
+int mcu_remove_breakpoint(microcontroller_t* mcu, uint32_t address);
+bool mcu_has_breakpoint(const microcontroller_t* mcu, uint32_t address);
+int mcu_set_watchpoint(microcontroller_t* mcu, uint32_t address, size_t size, mcu_watch_t kind);
+int mcu_remove_watchpoint(microcontroller_t* mcu, uint32_t address, size_t size, mcu_watch_t kind);
+int mcu_get_debug_info(microcontroller_t* mcu);
+// Desmonta a instrução em address; retorna o tamanho dela em bytes
+int mcu_disassemble(microcontroller_t* mcu, uint32_t address, char* buffer, size_t size);
+
+// Utilitários
+const char* mcu_type_to_string(mcu_type_t type);
+const char* mcu_state_to_string(mcu_state_t state);
+int mcu_get_config_by_type(mcu_type_t type, mcu_config_t* config);
+void mcu_print_status(microcontroller_t* mcu);
+
+#endif // MICROCONTROLLER_H
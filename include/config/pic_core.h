@@ -0,0 +1,81 @@
+#ifndef PIC_CORE_H
+#define PIC_CORE_H
+
+#include <stdint.h>
+
+#include "config/microcontroller.h"
+
+// Índices para mcu_read_register: W, os 8 níveis da pilha e o ponteiro dela
+#define PIC_REG_W 0
+#define PIC_REG_STACK 1
+#define PIC_REG_STACK_PTR 9
+#define PIC_STACK_DEPTH 8
+
+// Endereços "bancados" vão de 0 a 0x1FF (RP1:RP0 + 7 bits do opcode ou
+// IRP + FSR). O espaço de dados físico é compactado: os SFRs dos quatro
+// bancos vêm primeiro (abaixo de ram_start, despachados como MMIO) e os
+// 368 registradores de uso geral depois. Espelhos apontam para a mesma
+// posição física.
+#define PIC_BANK_SIZE 128
+#define PIC_BANKED_SIZE (4 * PIC_BANK_SIZE)
+
+// Posições físicas dos registradores usados pelo núcleo
+#define PIC_INDF 0x00
+#define PIC_TMR0 0x01
+#define PIC_PCL 0x02
+#define PIC_STATUS 0x03
+#define PIC_FSR 0x04
+#define PIC_PORTB 0x06
+#define PIC_PCLATH 0x0A
+#define PIC_INTCON 0x0B
+#define PIC_OPTION_REG 0x21
+#define PIC_TRISA 0x25
+#define PIC_TRISB 0x26
+
+// Bits do STATUS
+#define PIC_FLAG_C 0x01
+#define PIC_FLAG_DC 0x02
+#define PIC_FLAG_Z 0x04
+#define PIC_FLAG_PD 0x08
+#define PIC_FLAG_TO 0x10
+#define PIC_STATUS_RP 0x60
+#define PIC_STATUS_IRP 0x80
+
+// Flags de uma instrução decodificada
+#define PIC_INSN_BREAKPOINT 0x01
+#define PIC_INSN_DEST_F 0x02  // d = 1: resultado volta para o registrador
+
+// Instrução decodificada; o cache guarda uma por palavra do flash
+typedef struct pic_insn {
+    uint8_t op;       // pic_op_t
+    uint8_t f;        // registrador (7 bits do opcode)
+    uint8_t b;        // número do bit
+    uint8_t flags;    // PIC_INSN_*
+    uint16_t k;       // literal ou endereço de desvio
+} pic_insn_t;
+
+typedef struct pic_core {
+    pic_insn_t* code;
+    // Tradução endereço bancado -> posição física, montada no init
+    uint16_t file_map[PIC_BANKED_SIZE];
+} pic_core_t;
+
+pic_insn_t pic_decode(uint16_t opcode);
+
+int pic_core_init(microcontroller_t* mcu);
+void pic_core_cleanup(microcontroller_t* mcu);
+void pic_core_reset(microcontroller_t* mcu);
+void pic_core_invalidate(microcontroller_t* mcu);
+void pic_core_mark_breakpoint(microcontroller_t* mcu, uint32_t word, bool enabled);
+
+// Posição física de um endereço bancado (0 a 0x1FF), para mcu_read_memory
+uint32_t pic_file_address(const microcontroller_t* mcu, uint32_t banked);
+
+// Executa uma instrução e retorna os ciclos gastos (ou -1 em erro)
+int pic_core_step(microcontroller_t* mcu);
+// Executa até cycle_count alcançar stop ou o núcleo sair de RUNNING
+int pic_core_run(microcontroller_t* mcu, uint64_t stop);
+
+extern const mcu_core_ops_t pic_core_ops;
+
+#endif // PIC_CORE_H
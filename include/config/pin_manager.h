@@ -0,0 +1,147 @@
+#ifndef PIN_MANAGER_H
+#define PIN_MANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+    PIN_LOW = 0,
+    PIN_HIGH,
+    PIN_FLOATING,
+    PIN_PULL_UP,
+    PIN_PULL_DOWN
+} pin_state_t;
+
+typedef enum {
+    PIN_INPUT = 0,
+    PIN_OUTPUT,
+    PIN_BIDIRECTIONAL
+} pin_direction_t;
+
+struct pin_queue;
+
+typedef struct {
+    int pin_number;
+    char* name;
+    uint32_t name_hash;         // hash de name, calculado em pin_configure
+    pin_direction_t direction;
+    pin_state_t state;
+    bool is_monitored;
+    uint32_t register_address;  // registrador de I/O que controla o pino
+    int bit_position;           // bit do pino dentro do registrador
+    int register_next;          // próximo pino no mesmo bit, -1 no fim
+    int register_index;         // posição em pin_manager_t.registers, -1 sem mapeamento
+} pin_t;
+
+// Mudança de um pino monitorado, com o ciclo em que aconteceu
+typedef struct {
+    uint64_t cycle;
+    int pin_number;
+    pin_state_t old_state;
+    pin_state_t new_state;
+} pin_change_t;
+
+#define PIN_CHANGE_JOURNAL_SIZE 1024  // potência de 2
+
+// Índice registrador -> bit -> pinos, montado por pin_set_register_mapping,
+// com o estado dos pinos empacotado em palavras (bit n = bit n do
+// registrador) para que uma escrita na porta inteira seja uma operação só
+typedef struct {
+    uint32_t address;
+    uint32_t mask;              // bits com ao menos um pino
+    uint32_t high;              // nível HIGH do primeiro pino de saída do bit
+    uint32_t output;            // algum pino do bit com direção diferente de PIN_INPUT
+    uint32_t monitored;         // algum pino do bit monitorado
+    int pin_count;
+    int pins[32];               // menor pino de cada bit, -1 se nenhum
+} pin_register_t;
+
+// Aplica um nível vindo de fora a um pino de entrada; o MCU instala um que
+// passa pela gravação (mcu_set_pin_state)
+typedef int (*pin_input_hook_t)(void* context, int pin_number, pin_state_t state);
+
+typedef struct {
+    pin_t* pins;
+    int max_pins;
+    int pin_count;
+    bool initialized;
+    FILE* output;       // mensagens do gerenciador (stdout por padrão)
+
+    // Índice nome -> pino (endereçamento aberto, -1 é vazio); com nomes
+    // repetidos guarda o pino de menor número, como a busca linear fazia
+    int* name_slots;
+    uint32_t name_mask;
+
+    pin_register_t* registers;  // ordenados por endereço
+    int register_count;
+    int register_capacity;
+
+    // Diário das mudanças dos pinos monitorados; cheio, as novas mudanças
+    // são descartadas e contadas em changes_dropped
+    pin_change_t* changes;
+    uint64_t changes_head;      // total lido
+    uint64_t changes_tail;      // total escrito
+    uint64_t changes_dropped;
+    const uint64_t* clock;      // contador de ciclos do MCU, se houver
+
+    // Ligação com o circuito em outra thread (config/pin_queue.h): bordas
+    // das saídas vão para edges, cruzamentos de limiar chegam por crossings
+    struct pin_queue* edges;
+    struct pin_queue* crossings;
+    pin_input_hook_t input_hook;    // NULL usa pin_set_state
+    void* input_context;
+} pin_manager_t;
+
+int pin_manager_init(pin_manager_t* manager, int max_pins, FILE* output);
+int pin_manager_cleanup(pin_manager_t* manager);
+
+int pin_configure(pin_manager_t* manager, int pin_number, pin_direction_t direction, const char* name);
+int pin_set_register_mapping(pin_manager_t* manager, int pin_number, uint32_t register_address, int bit_position);
+
+int pin_set_state(pin_manager_t* manager, int pin_number, pin_state_t state);
+int pin_set_direction(pin_manager_t* manager, int pin_number, pin_direction_t direction);
+// Direção de todos os pinos do registrador de uma vez: bit em 1 é saída
+int pin_set_register_directions(pin_manager_t* manager, uint32_t register_address, uint32_t output_mask);
+pin_state_t pin_get_state(pin_manager_t* manager, int pin_number);
+int pin_toggle(pin_manager_t* manager, int pin_number);
+
+int pin_start_monitoring(pin_manager_t* manager, int pin_number);
+int pin_stop_monitoring(pin_manager_t* manager, int pin_number);
+// Retira até max_changes mudanças do diário, da mais antiga para a mais
+// nova; retorna quantas foram copiadas
+int pin_get_monitored_changes(pin_manager_t* manager, pin_change_t* changes, int max_changes);
+// Mudanças descartadas com o diário cheio desde o último pedido; zera o contador
+uint64_t pin_take_dropped_changes(pin_manager_t* manager);
+// Origem do carimbo de ciclo das mudanças (NULL grava 0)
+void pin_manager_set_clock(pin_manager_t* manager, const uint64_t* clock);
+
+// Caminho dos níveis externos aplicados por pin_manager_sync_queues
+void pin_manager_set_input_hook(pin_manager_t* manager, pin_input_hook_t hook, void* context);
+
+// Filas para o solver do circuito; qualquer uma pode ser NULL. O gerenciador
+// é o produtor de edges e o consumidor de crossings.
+void pin_manager_set_queues(pin_manager_t* manager, struct pin_queue* edges, struct pin_queue* crossings);
+// Ponto de sincronização: publica as bordas pendentes e aplica às entradas
+// os cruzamentos já vencidos pelo relógio. Retorna quantos foram aplicados.
+int pin_manager_sync_queues(pin_manager_t* manager);
+
+int pin_get_by_number(pin_manager_t* manager, int pin_number, pin_t** pin);
+int pin_get_by_name(pin_manager_t* manager, const char* name, pin_t** pin);
+int pin_list_all(pin_manager_t* manager);
+
+// Sincroniza todos os pinos de saída do registrador com register_value
+int pin_update_from_register(pin_manager_t* manager, uint32_t register_address, uint32_t register_value);
+// Como pin_update_from_register, mas só visita os bits que mudaram
+int pin_update_register_change(pin_manager_t* manager, uint32_t register_address,
+                               uint32_t old_value, uint32_t new_value);
+int pin_update_to_register(pin_manager_t* manager, uint32_t register_address, uint32_t* register_value);
+
+// Recalcula os bancos empacotados depois de escritas diretas em pin_t
+void pin_manager_resync(pin_manager_t* manager);
+
+const char* pin_state_to_string(pin_state_t state);
+const char* pin_direction_to_string(pin_direction_t direction);
+void pin_print_info(const pin_t* pin);
+
+#endif // PIN_MANAGER_H
@@ -0,0 +1,58 @@
+#ifndef PIN_QUEUE_H
+#define PIN_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config/pin_manager.h"
+
+#define PIN_QUEUE_CACHE_LINE 64
+// Eventos escritos antes de o produtor publicar o novo head
+#define PIN_QUEUE_DEFAULT_BATCH 32
+
+// Borda de um pino: saídas do MCU para o circuito ou cruzamentos de limiar
+// do circuito para as entradas do MCU
+typedef struct {
+    uint64_t cycle;
+    int pin_number;
+    pin_state_t state;
+} pin_event_t;
+
+// Fila lock-free de um produtor e um consumidor. Cada lado tem sua linha de
+// cache: o índice que publica e uma cópia do índice do outro lado, relida só
+// quando a fila parece cheia (produtor) ou vazia (consumidor).
+typedef struct pin_queue {
+    // Produtor
+    _Alignas(PIN_QUEUE_CACHE_LINE) atomic_size_t head;
+    size_t write;               // próximo evento a escrever; > head até publicar
+    size_t tail_cache;
+    uint64_t dropped;
+
+    // Consumidor
+    _Alignas(PIN_QUEUE_CACHE_LINE) atomic_size_t tail;
+    size_t read;                // próximo evento a ler; > tail até liberar
+    size_t head_cache;
+
+    // Só leitura depois do init
+    _Alignas(PIN_QUEUE_CACHE_LINE) pin_event_t* events;
+    size_t mask;
+    size_t batch;
+} pin_queue_t;
+
+// capacity é arredondada para potência de 2; batch 0 usa o padrão
+int pin_queue_init(pin_queue_t* queue, size_t capacity, size_t batch);
+void pin_queue_cleanup(pin_queue_t* queue);
+
+// Produtor. Cheia, a borda é descartada e contada em dropped.
+bool pin_queue_push(pin_queue_t* queue, const pin_event_t* event);
+// Torna visíveis ao consumidor os eventos ainda não publicados
+void pin_queue_publish(pin_queue_t* queue);
+
+// Consumidor. peek devolve o próximo evento sem retirá-lo (NULL se vazia);
+// pop copia até max eventos e libera as posições para o produtor de uma vez.
+const pin_event_t* pin_queue_peek(pin_queue_t* queue);
+size_t pin_queue_pop(pin_queue_t* queue, pin_event_t* events, size_t max);
+
+#endif // PIN_QUEUE_H
@@ -0,0 +1,56 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+struct microcontroller;
+
+typedef enum {
+    SCHED_EVENT_TIMER = 0,       // overflow/comparação de timers
+    SCHED_EVENT_UART,            // fim da transmissão/recepção de um byte
+    SCHED_EVENT_ADC,             // fim de uma conversão
+    SCHED_EVENT_CIRCUIT_SYNC,    // ponto de sincronização com o solver de circuito
+    SCHED_EVENT_PROFILER,        // amostra do profiler
+    SCHED_EVENT_COUNT
+} sched_event_kind_t;
+
+typedef void (*sched_callback_t)(struct microcontroller* mcu, void* context, uint64_t cycle);
+
+typedef struct {
+    uint64_t cycle;       // ciclo em que o evento vence
+    uint64_t sequence;    // desempate: eventos no mesmo ciclo saem em ordem de inserção
+    int id;
+    sched_event_kind_t kind;
+    sched_callback_t callback;
+    void* context;
+} sched_event_t;
+
+// Min-heap de eventos ordenado por (cycle, sequence)
+typedef struct {
+    sched_event_t* events;
+    int count;
+    int capacity;
+    uint64_t next_sequence;
+    int next_id;
+} scheduler_t;
+
+int scheduler_init(scheduler_t* scheduler, int initial_capacity);
+void scheduler_cleanup(scheduler_t* scheduler);
+void scheduler_clear(scheduler_t* scheduler);
+int scheduler_copy(scheduler_t* dest, const scheduler_t* src);
+
+// Retorna o id do evento (>= 0) ou -1 em erro
+int scheduler_add(scheduler_t* scheduler, uint64_t cycle, sched_event_kind_t kind,
+                  sched_callback_t callback, void* context);
+int scheduler_cancel(scheduler_t* scheduler, int id);
+
+// Remove o próximo evento se ele vence até o ciclo now; retorna 1 se removeu
+int scheduler_pop_due(scheduler_t* scheduler, uint64_t now, sched_event_t* event);
+
+static inline uint64_t scheduler_next_cycle(const scheduler_t* scheduler) {
+    return scheduler->count > 0 ? scheduler->events[0].cycle : UINT64_MAX;
+}
+
+const char* sched_event_kind_to_string(sched_event_kind_t kind);
+
+#endif // SCHEDULER_H
@@ -23,7 +23,31 @@ int main(int argc, char **argv)
                  BUILD_FOLDER"circuita",
                  SRC_FOLDER"main.c",
                  SRC_FOLDER"components/resistor.c",
-                 SRC_FOLDER"components/util.c"
+                 SRC_FOLDER"components/util.c",
+                 SRC_FOLDER"circuit/circuit.c",
+                 SRC_FOLDER"circuit/sparse.c",
+                 SRC_FOLDER"circuit/pcg.c",
+                 SRC_FOLDER"circuit/cosim.c",
+                 SRC_FOLDER"circuit/digital.c",
+                 SRC_FOLDER"circuit/multirate.c",
+                 SRC_FOLDER"config/microcontroller.c",
+                 SRC_FOLDER"config/pin_manager.c",
+                 SRC_FOLDER"config/pin_queue.c",
+                 SRC_FOLDER"config/mcu_timing.c",
+                 SRC_FOLDER"config/avr_core.c",
+                 SRC_FOLDER"config/arm_core.c",
+                 SRC_FOLDER"config/pic_core.c",
+                 SRC_FOLDER"config/avr_io.c",
+                 SRC_FOLDER"config/firmware.c",
+                 SRC_FOLDER"config/mcu_snapshot.c",
+                 SRC_FOLDER"config/mcu_farm.c",
+                 SRC_FOLDER"config/mcu_log.c",
+                 SRC_FOLDER"config/mcu_replay.c",
+                 SRC_FOLDER"config/mcu_gdb.c",
+                 SRC_FOLDER"config/mcu_profile.c",
+                 SRC_FOLDER"config/scheduler.c",
+                 "-lm",
+                 "-pthread"
                  );
 
   if(!nob_cmd_run(&cmd)) return 1;
@@ -38,7 +62,8 @@ int main(int argc, char **argv)
                  "-o",
                  BUILD_FOLDER"test_resistor",
                  TEST_FOLDER"test_resistor.c",
-                 SRC_FOLDER"components/resistor.c"
+                 SRC_FOLDER"components/resistor.c",
+                 "-lm"
                  );
   if(!nob_cmd_run(&cmd)) return 1;
 
@@ -52,7 +77,76 @@ int main(int argc, char **argv)
                  "-o",
                  BUILD_FOLDER"test_util",
                  TEST_FOLDER"test_util.c",
-                 SRC_FOLDER"components/util.c"
+                 SRC_FOLDER"components/util.c",
+                 "-lm"
+                 );
+  if(!nob_cmd_run(&cmd)) return 1;
+
+  // test microcontroller
+  nob_cmd_append(&cmd,
+                 "clang",
+                 "-Wall",
+                 "-Wextra",
+                 "-I./include",
+                 "-std=c17",
+                 "-o",
+                 BUILD_FOLDER"test_microcontroller",
+                 TEST_FOLDER"test_microcontroller.c",
+                 SRC_FOLDER"config/microcontroller.c",
+                 SRC_FOLDER"config/pin_manager.c",
+                 SRC_FOLDER"config/pin_queue.c",
+                 SRC_FOLDER"config/mcu_timing.c",
+                 SRC_FOLDER"config/avr_core.c",
+                 SRC_FOLDER"config/arm_core.c",
+                 SRC_FOLDER"config/pic_core.c",
+                 SRC_FOLDER"config/avr_io.c",
+                 SRC_FOLDER"config/firmware.c",
+                 SRC_FOLDER"config/mcu_snapshot.c",
+                 SRC_FOLDER"config/mcu_farm.c",
+                 SRC_FOLDER"config/mcu_log.c",
+                 SRC_FOLDER"config/mcu_replay.c",
+                 SRC_FOLDER"config/mcu_gdb.c",
+                 SRC_FOLDER"config/mcu_profile.c",
+                 SRC_FOLDER"config/scheduler.c",
+                 "-lm",
+                 "-pthread"
+                 );
+  if(!nob_cmd_run(&cmd)) return 1;
+
+  // test circuit
+  nob_cmd_append(&cmd,
+                 "clang",
+                 "-Wall",
+                 "-Wextra",
+                 "-I./include",
+                 "-std=c17",
+                 "-o",
+                 BUILD_FOLDER"test_circuit",
+                 TEST_FOLDER"test_circuit.c",
+                 SRC_FOLDER"circuit/circuit.c",
+                 SRC_FOLDER"circuit/sparse.c",
+                 SRC_FOLDER"circuit/pcg.c",
+                 SRC_FOLDER"circuit/cosim.c",
+                 SRC_FOLDER"circuit/digital.c",
+                 SRC_FOLDER"circuit/multirate.c",
+                 SRC_FOLDER"config/microcontroller.c",
+                 SRC_FOLDER"config/pin_manager.c",
+                 SRC_FOLDER"config/pin_queue.c",
+                 SRC_FOLDER"config/mcu_timing.c",
+                 SRC_FOLDER"config/avr_core.c",
+                 SRC_FOLDER"config/arm_core.c",
+                 SRC_FOLDER"config/pic_core.c",
+                 SRC_FOLDER"config/avr_io.c",
+                 SRC_FOLDER"config/firmware.c",
+                 SRC_FOLDER"config/mcu_snapshot.c",
+                 SRC_FOLDER"config/mcu_farm.c",
+                 SRC_FOLDER"config/mcu_log.c",
+                 SRC_FOLDER"config/mcu_replay.c",
+                 SRC_FOLDER"config/mcu_gdb.c",
+                 SRC_FOLDER"config/mcu_profile.c",
+                 SRC_FOLDER"config/scheduler.c",
+                 "-lm",
+                 "-pthread"
                  );
   if(!nob_cmd_run(&cmd)) return 1;
 
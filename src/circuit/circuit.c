@@ -0,0 +1,1026 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "circuit/circuit.h"
+
+static void circuit_free_islands(circuit_t* circuit) {
+    for (int i = 0; i < circuit->island_count; i++) {
+        free(circuit->islands[i].nodes);
+        free(circuit->islands[i].factor);
+        free(circuit->islands[i].rhs);
+        sparse_free(circuit->islands[i].sparse);
+        free(circuit->islands[i].sparse);
+        pcg_free(circuit->islands[i].iterative);
+        free(circuit->islands[i].iterative);
+    }
+    free(circuit->islands);
+    circuit->islands = NULL;
+    circuit->island_count = 0;
+}
+
+// Ilha do elemento, ou -1 se ele só toca a terra
+static int circuit_element_island(const circuit_t* circuit, const circuit_element_t* element) {
+    int node = element->a != CIRCUIT_GROUND ? element->a : element->b;
+    return node != CIRCUIT_GROUND ? circuit->node_island[node] : -1;
+}
+
+int circuit_init(circuit_t* circuit) {
+    if (!circuit) {
+        return -1;
+    }
+
+    memset(circuit, 0, sizeof(*circuit));
+
+    if (circuit_node(circuit, "0") != CIRCUIT_GROUND) {
+        circuit_free(circuit);
+        return -1;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Threads das ilhas                                                      */
+/* ---------------------------------------------------------------------- */
+
+typedef void (*circuit_island_work_t)(circuit_t* circuit, circuit_island_t* island, bool factor);
+
+// Workers criados na primeira solução paralela e mantidos até circuit_free:
+// a cada rodada a thread que chama publica o trabalho e divide as ilhas com
+// eles, sem criar nem juntar threads por fatoração ou substituição
+struct circuit_pool {
+    pthread_t* threads;
+    int thread_count;           // workers, fora a thread que chama
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    unsigned long generation;
+    int pending;                // workers ainda na rodada
+    bool stop;
+
+    // Rodada atual
+    circuit_t* circuit;
+    circuit_island_work_t work;
+    bool factor;
+    int next;                   // próxima ilha a ser pega
+};
+
+static void circuit_pool_drain(circuit_pool_t* pool) {
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        int index = pool->next < pool->circuit->island_count ? pool->next++ : -1;
+        pthread_mutex_unlock(&pool->lock);
+        if (index < 0) {
+            break;
+        }
+        pool->work(pool->circuit, &pool->circuit->islands[index], pool->factor);
+    }
+}
+
+static void* circuit_pool_worker(void* arg) {
+    circuit_pool_t* pool = arg;
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stop) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        circuit_pool_drain(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->idle);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+static void circuit_pool_free(circuit_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 0; t < pool->thread_count; t++) {
+        pthread_join(pool->threads[t], NULL);
+    }
+
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+// Até workers threads; com menos (ou nenhuma) a thread que chama faz o resto
+static circuit_pool_t* circuit_pool_create(int workers) {
+    circuit_pool_t* pool = calloc(1, sizeof(circuit_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->threads = malloc(workers * sizeof(pthread_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    while (pool->threads && pool->thread_count < workers &&
+           pthread_create(&pool->threads[pool->thread_count], NULL, circuit_pool_worker, pool) == 0) {
+        pool->thread_count++;
+    }
+
+    return pool;
+}
+
+// Uma rodada: todas as ilhas passam por work, divididas entre os workers e
+// a thread que chama, que só retorna quando todos terminaram
+static void circuit_pool_run(circuit_pool_t* pool, circuit_t* circuit, circuit_island_work_t work, bool factor) {
+    pthread_mutex_lock(&pool->lock);
+    pool->circuit = circuit;
+    pool->work = work;
+    pool->factor = factor;
+    pool->next = 0;
+    pool->pending = pool->thread_count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    circuit_pool_drain(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void circuit_free(circuit_t* circuit) {
+    if (!circuit) {
+        return;
+    }
+
+    circuit_pool_free(circuit->pool);
+
+    for (int i = 0; i < circuit->node_count; i++) {
+        free(circuit->node_names[i]);
+    }
+    for (int i = 0; i < circuit->element_count; i++) {
+        free(circuit->elements[i].name);
+    }
+    circuit_free_islands(circuit);
+    free(circuit->node_names);
+    free(circuit->elements);
+    free(circuit->node_island);
+    free(circuit->node_local);
+    free(circuit->element_slots);
+    free(circuit->voltages);
+    memset(circuit, 0, sizeof(*circuit));
+}
+
+/* ---------------------------------------------------------------------- */
+/* Netlist                                                                */
+/* ---------------------------------------------------------------------- */
+
+int circuit_node(circuit_t* circuit, const char* name) {
+    if (!circuit || !name) {
+        return -1;
+    }
+
+    if (strcmp(name, "GND") == 0) {
+        name = "0";
+    }
+
+    for (int i = 0; i < circuit->node_count; i++) {
+        if (strcmp(circuit->node_names[i], name) == 0) {
+            return i;
+        }
+    }
+
+    if (circuit->node_count == circuit->node_capacity) {
+        int capacity = circuit->node_capacity ? circuit->node_capacity * 2 : 8;
+        char** names = realloc(circuit->node_names, capacity * sizeof(char*));
+        if (!names) {
+            fprintf(stderr, "Erro ao alocar nós do circuito\n");
+            return -1;
+        }
+        circuit->node_names = names;
+        circuit->node_capacity = capacity;
+    }
+
+    char* copy = strdup(name);
+    if (!copy) {
+        fprintf(stderr, "Erro ao alocar nome do nó\n");
+        return -1;
+    }
+
+    circuit->node_names[circuit->node_count] = copy;
+    circuit->partitioned = false;
+    return circuit->node_count++;
+}
+
+static int circuit_add_element(circuit_t* circuit, circuit_element_type_t type, const char* name,
+                               int a, int b, double value, double resistance) {
+    if (!circuit || a < 0 || b < 0 || a >= circuit->node_count || b >= circuit->node_count) {
+        fprintf(stderr, "Elemento %s ligado a nó inexistente\n", name ? name : "sem nome");
+        return -1;
+    }
+
+    if (circuit->element_count == circuit->element_capacity) {
+        int capacity = circuit->element_capacity ? circuit->element_capacity * 2 : 16;
+        circuit_element_t* elements = realloc(circuit->elements, capacity * sizeof(circuit_element_t));
+        if (!elements) {
+            fprintf(stderr, "Erro ao alocar elementos do circuito\n");
+            return -1;
+        }
+        circuit->elements = elements;
+        circuit->element_capacity = capacity;
+    }
+
+    circuit_element_t* element = &circuit->elements[circuit->element_count];
+    element->type = type;
+    element->name = name ? strdup(name) : NULL;
+    element->a = a;
+    element->b = b;
+    element->value = value;
+    element->resistance = resistance;
+    element->enabled = true;
+    element->conducting = false;
+    element->history = 0.0;
+
+    if (name && !element->name) {
+        fprintf(stderr, "Erro ao alocar nome do elemento\n");
+        return -1;
+    }
+
+    circuit->partitioned = false;
+    return circuit->element_count++;
+}
+
+int circuit_add_resistor(circuit_t* circuit, const char* name, int a, int b, double ohms) {
+    if (ohms <= 0.0) {
+        fprintf(stderr, "Resistor %s com resistência inválida: %g\n", name ? name : "sem nome", ohms);
+        return -1;
+    }
+    return circuit_add_element(circuit, CIRCUIT_RESISTOR, name, a, b, ohms, ohms);
+}
+
+int circuit_add_voltage_source(circuit_t* circuit, const char* name, int positive, int negative,
+                               double volts, double series_ohms) {
+    if (series_ohms < CIRCUIT_MIN_SOURCE_RESISTANCE) {
+        series_ohms = CIRCUIT_MIN_SOURCE_RESISTANCE;
+    }
+    return circuit_add_element(circuit, CIRCUIT_VOLTAGE_SOURCE, name, positive, negative, volts, series_ohms);
+}
+
+int circuit_add_current_source(circuit_t* circuit, const char* name, int positive, int negative, double amperes) {
+    return circuit_add_element(circuit, CIRCUIT_CURRENT_SOURCE, name, positive, negative, amperes, 0.0);
+}
+
+int circuit_add_diode(circuit_t* circuit, const char* name, int anode, int cathode,
+                      double forward_voltage, double on_resistance) {
+    if (on_resistance <= 0.0) {
+        fprintf(stderr, "Diodo %s com Ron inválida: %g\n", name ? name : "sem nome", on_resistance);
+        return -1;
+    }
+    return circuit_add_element(circuit, CIRCUIT_DIODE, name, anode, cathode, forward_voltage, on_resistance);
+}
+
+int circuit_add_capacitor(circuit_t* circuit, const char* name, int a, int b, double farads) {
+    if (farads <= 0.0) {
+        fprintf(stderr, "Capacitor %s com capacitância inválida: %g\n", name ? name : "sem nome", farads);
+        return -1;
+    }
+    return circuit_add_element(circuit, CIRCUIT_CAPACITOR, name, a, b, farads, 0.0);
+}
+
+int circuit_find_element(const circuit_t* circuit, const char* name) {
+    if (!circuit || !name) {
+        return -1;
+    }
+
+    for (int i = 0; i < circuit->element_count; i++) {
+        if (circuit->elements[i].name && strcmp(circuit->elements[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int circuit_set_source(circuit_t* circuit, int element, double value) {
+    if (!circuit || element < 0 || element >= circuit->element_count) {
+        return -1;
+    }
+
+    circuit_element_t* source = &circuit->elements[element];
+    if (source->type != CIRCUIT_VOLTAGE_SOURCE && source->type != CIRCUIT_CURRENT_SOURCE) {
+        return -1;
+    }
+
+    source->value = value;
+    return 0;
+}
+
+int circuit_set_enabled(circuit_t* circuit, int element, bool enabled) {
+    if (!circuit || element < 0 || element >= circuit->element_count) {
+        return -1;
+    }
+
+    circuit_element_t* target = &circuit->elements[element];
+    if (target->enabled != enabled) {
+        target->enabled = enabled;
+        // Só a ilha do elemento muda
+        int island = circuit->partitioned ? circuit_element_island(circuit, target) : -1;
+        if (island >= 0) {
+            circuit->islands[island].factored = false;
+        }
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Estampas                                                               */
+/* ---------------------------------------------------------------------- */
+
+// Condutância que o elemento coloca entre a e b (0 se só tem fonte)
+static double circuit_conductance(const circuit_t* circuit, const circuit_element_t* element) {
+    if (!element->enabled) {
+        return 0.0;
+    }
+
+    switch (element->type) {
+        case CIRCUIT_RESISTOR:
+        case CIRCUIT_VOLTAGE_SOURCE:
+            return 1.0 / element->resistance;
+        case CIRCUIT_DIODE:
+            return element->conducting ? 1.0 / element->resistance : CIRCUIT_DIODE_OFF_CONDUCTANCE;
+        case CIRCUIT_CAPACITOR:
+            return circuit->timestep > 0.0 ? element->value / circuit->timestep : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+// Corrente injetada no nó a (e retirada de b) pelo equivalente de Norton
+static double circuit_injection(const circuit_t* circuit, const circuit_element_t* element) {
+    if (!element->enabled) {
+        return 0.0;
+    }
+
+    switch (element->type) {
+        case CIRCUIT_VOLTAGE_SOURCE:
+            return element->value / element->resistance;
+        case CIRCUIT_CURRENT_SOURCE:
+            return element->value;
+        case CIRCUIT_DIODE:
+            // I = (Vak - Vf) / Ron: o termo constante vai para o lado direito
+            return element->conducting ? element->value / element->resistance : 0.0;
+        case CIRCUIT_CAPACITOR:
+            // I = C/h·(v - v0): C/h·v0 é a corrente da fonte equivalente
+            return circuit->timestep > 0.0 ? element->value / circuit->timestep * element->history : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Ilhas                                                                  */
+/* ---------------------------------------------------------------------- */
+
+int circuit_find_root(int* parent, int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+void circuit_union(int* parent, int a, int b) {
+    a = circuit_find_root(parent, a);
+    b = circuit_find_root(parent, b);
+    if (a != b) {
+        parent[b] = a;
+    }
+}
+
+static int circuit_compare_islands(const void* a, const void* b) {
+    return ((const circuit_island_t*)b)->size - ((const circuit_island_t*)a)->size;
+}
+
+// Valores da matriz esparsa da ilha (count posições), ou NULL se é densa
+static double* circuit_island_values(const circuit_island_t* island, const int** diagonal, int* count) {
+    if (island->sparse) {
+        *diagonal = island->sparse->diagonal;
+        *count = island->sparse->columns[island->size];
+        return island->sparse->values;
+    }
+    if (island->iterative) {
+        *diagonal = island->iterative->diagonal;
+        *count = pcg_nonzeros(island->iterative);
+        return island->iterative->values;
+    }
+    return NULL;
+}
+
+// Padrão das ilhas grandes e a posição de cada elemento nele. O padrão
+// inclui elementos desligados, para não refazer a ordenação ao ligá-los.
+static int circuit_build_sparse(circuit_t* circuit) {
+    int m = circuit->element_count;
+    int* slots = realloc(circuit->element_slots, (m ? 3 * m : 1) * sizeof(int));
+    int* offsets = calloc(circuit->island_count + 1, sizeof(int));
+    int* rows = malloc((m ? m : 1) * sizeof(int));
+    int* cols = malloc((m ? m : 1) * sizeof(int));
+    int result = -1;
+
+    if (slots) {
+        circuit->element_slots = slots;
+    }
+    if (!slots || !offsets || !rows || !cols) {
+        fprintf(stderr, "Erro ao alocar matriz esparsa do circuito\n");
+        goto out;
+    }
+
+    // Pares agrupados por ilha, na ordem dos elementos
+    for (int e = 0; e < m; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        if (element->type != CIRCUIT_CURRENT_SOURCE && element->a != CIRCUIT_GROUND &&
+            element->b != CIRCUIT_GROUND && element->a != element->b) {
+            offsets[circuit->node_island[element->a] + 1]++;
+        }
+    }
+    for (int k = 0; k < circuit->island_count; k++) {
+        offsets[k + 1] += offsets[k];
+    }
+    for (int e = 0; e < m; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        if (element->type != CIRCUIT_CURRENT_SOURCE && element->a != CIRCUIT_GROUND &&
+            element->b != CIRCUIT_GROUND && element->a != element->b) {
+            int p = offsets[circuit->node_island[element->a]]++;
+            rows[p] = circuit->node_local[element->a];
+            cols[p] = circuit->node_local[element->b];
+        }
+    }
+    for (int k = circuit->island_count; k > 0; k--) {
+        offsets[k] = offsets[k - 1];
+    }
+    offsets[0] = 0;
+
+    for (int k = 0; k < circuit->island_count; k++) {
+        circuit_island_t* island = &circuit->islands[k];
+        if (island->size < CIRCUIT_SPARSE_MIN_NODES) {
+            continue;
+        }
+        int count = offsets[k + 1] - offsets[k];
+        if (circuit->solver == CIRCUIT_SOLVER_ITERATIVE) {
+            island->iterative = malloc(sizeof(pcg_t));
+            if (!island->iterative ||
+                pcg_init(island->iterative, island->size, &rows[offsets[k]], &cols[offsets[k]], count) < 0) {
+                fprintf(stderr, "Erro ao montar matriz esparsa da ilha %d\n", k);
+                free(island->iterative);
+                island->iterative = NULL;
+                goto out;
+            }
+            continue;
+        }
+        island->sparse = malloc(sizeof(sparse_t));
+        if (!island->sparse ||
+            sparse_init(island->sparse, island->size, &rows[offsets[k]], &cols[offsets[k]], count) < 0) {
+            fprintf(stderr, "Erro ao montar matriz esparsa da ilha %d\n", k);
+            free(island->sparse);
+            island->sparse = NULL;
+            goto out;
+        }
+    }
+
+    for (int e = 0; e < m; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        int index = circuit_element_island(circuit, element);
+        const circuit_island_t* island = index >= 0 ? &circuit->islands[index] : NULL;
+        const int* diagonal = NULL;
+        int count;
+        bool sparse = island && circuit_island_values(island, &diagonal, &count);
+        int a = element->a != CIRCUIT_GROUND ? circuit->node_local[element->a] : -1;
+        int b = element->b != CIRCUIT_GROUND ? circuit->node_local[element->b] : -1;
+
+        slots[3 * e] = sparse && a >= 0 ? diagonal[a] : -1;
+        slots[3 * e + 1] = sparse && b >= 0 ? diagonal[b] : -1;
+        slots[3 * e + 2] = -1;
+        if (sparse && a >= 0 && b >= 0 && a != b) {
+            slots[3 * e + 2] = island->sparse ? sparse_slot(island->sparse, a, b) : pcg_slot(island->iterative, a, b);
+        }
+    }
+    result = 0;
+
+out:
+    free(offsets);
+    free(rows);
+    free(cols);
+    return result;
+}
+
+// Union-find sobre os nós. Fonte de corrente não coloca condutância na
+// matriz, então não une ilhas.
+static int circuit_partition(circuit_t* circuit) {
+    int n = circuit->node_count;
+    int* parent = malloc(n * sizeof(int));
+    int* root_island = malloc(n * sizeof(int));
+    int* node_island = realloc(circuit->node_island, n * sizeof(int));
+    int* node_local = node_island ? realloc(circuit->node_local, n * sizeof(int)) : NULL;
+
+    if (node_island) {
+        circuit->node_island = node_island;
+    }
+    if (node_local) {
+        circuit->node_local = node_local;
+    }
+    circuit_free_islands(circuit);
+    if (!parent || !root_island || !node_island || !node_local) {
+        fprintf(stderr, "Erro ao alocar ilhas do circuito\n");
+        free(parent);
+        free(root_island);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        parent[i] = i;
+        root_island[i] = -1;
+    }
+    for (int e = 0; e < circuit->element_count; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        if (element->type == CIRCUIT_CURRENT_SOURCE ||
+            element->a == CIRCUIT_GROUND || element->b == CIRCUIT_GROUND) {
+            continue;
+        }
+        circuit_union(parent, element->a, element->b);
+    }
+
+    // Toda ilha tem ao menos um nó: n - 1 é o máximo
+    circuit->islands = calloc(n > 1 ? n - 1 : 1, sizeof(circuit_island_t));
+    if (!circuit->islands) {
+        fprintf(stderr, "Erro ao alocar ilhas do circuito\n");
+        free(parent);
+        free(root_island);
+        return -1;
+    }
+
+    circuit->node_island[CIRCUIT_GROUND] = -1;
+    for (int i = 1; i < n; i++) {
+        int root = circuit_find_root(parent, i);
+        if (root_island[root] < 0) {
+            root_island[root] = circuit->island_count++;
+        }
+        circuit->node_island[i] = root_island[root];
+        circuit->islands[root_island[root]].size++;
+    }
+
+    int result = 0;
+    for (int k = 0; k < circuit->island_count; k++) {
+        circuit_island_t* island = &circuit->islands[k];
+        bool dense = island->size < CIRCUIT_SPARSE_MIN_NODES;
+        island->nodes = malloc(island->size * sizeof(int));
+        island->factor = dense ? malloc((size_t)island->size * island->size * sizeof(double)) : NULL;
+        island->rhs = malloc(island->size * sizeof(double));
+        if (!island->nodes || (dense && !island->factor) || !island->rhs) {
+            fprintf(stderr, "Erro ao alocar ilhas do circuito\n");
+            result = -1;
+        }
+        island->size = 0;
+    }
+
+    if (result == 0) {
+        for (int i = 1; i < n; i++) {
+            circuit_island_t* island = &circuit->islands[circuit->node_island[i]];
+            island->nodes[island->size++] = i;
+        }
+
+        // As maiores primeiro: as threads pegam as ilhas em ordem e as
+        // pequenas preenchem o fim
+        qsort(circuit->islands, circuit->island_count, sizeof(circuit_island_t), circuit_compare_islands);
+        for (int k = 0; k < circuit->island_count; k++) {
+            for (int j = 0; j < circuit->islands[k].size; j++) {
+                int node = circuit->islands[k].nodes[j];
+                circuit->node_island[node] = k;
+                circuit->node_local[node] = j;
+            }
+        }
+        result = circuit_build_sparse(circuit);
+        circuit->partitioned = result == 0;
+    }
+
+    free(parent);
+    free(root_island);
+    return result;
+}
+
+static int circuit_reserve(circuit_t* circuit) {
+    if (circuit->voltage_count != circuit->node_count) {
+        double* voltages = realloc(circuit->voltages, circuit->node_count * sizeof(double));
+        if (!voltages) {
+            fprintf(stderr, "Erro ao alocar matriz do circuito\n");
+            return -1;
+        }
+        memset(voltages, 0, circuit->node_count * sizeof(double));
+        circuit->voltages = voltages;
+        circuit->voltage_count = circuit->node_count;
+    }
+
+    if (!circuit->partitioned) {
+        circuit->factored = false;
+        return circuit_partition(circuit);
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Solução                                                                */
+/* ---------------------------------------------------------------------- */
+
+// Fatora o bloco G = L·Lᵀ da ilha no lugar (só o triângulo inferior é usado)
+static int circuit_factor_island(const circuit_t* circuit, circuit_island_t* island) {
+    int n = island->size;
+    double* g = island->factor;
+
+    if (island->sparse) {
+        island->sparse->thread_count = circuit->thread_count;
+        if (sparse_factor(island->sparse) < 0) {
+            fprintf(stderr, "Matriz do circuito não é definida positiva (nó %s)\n",
+                    circuit->node_names[island->nodes[island->sparse->failed]]);
+            return -1;
+        }
+        island->factored = true;
+        return 0;
+    }
+
+    if (island->iterative) {
+        if (pcg_factor(island->iterative) < 0) {
+            return -1;
+        }
+        island->factored = true;
+        return 0;
+    }
+
+    for (int j = 0; j < n; j++) {
+        double diagonal = g[j * n + j];
+        for (int k = 0; k < j; k++) {
+            diagonal -= g[j * n + k] * g[j * n + k];
+        }
+        if (diagonal <= 0.0) {
+            fprintf(stderr, "Matriz do circuito não é definida positiva (nó %s)\n",
+                    circuit->node_names[island->nodes[j]]);
+            return -1;
+        }
+        diagonal = sqrt(diagonal);
+        g[j * n + j] = diagonal;
+
+        for (int i = j + 1; i < n; i++) {
+            double sum = g[i * n + j];
+            for (int k = 0; k < j; k++) {
+                sum -= g[i * n + k] * g[j * n + k];
+            }
+            g[i * n + j] = sum / diagonal;
+        }
+    }
+
+    island->factored = true;
+    return 0;
+}
+
+static int circuit_substitute_island(circuit_t* circuit, circuit_island_t* island) {
+    int n = island->size;
+    const double* l = island->factor;
+    double* x = island->rhs;
+
+    if (island->sparse || island->iterative) {
+        if (island->sparse) {
+            sparse_solve(island->sparse, x);
+        } else if (pcg_solve(island->iterative, x) < 0) {
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            circuit->voltages[island->nodes[i]] = x[i];
+        }
+        return 0;
+    }
+
+    // L·y = i
+    for (int i = 0; i < n; i++) {
+        double sum = x[i];
+        for (int k = 0; k < i; k++) {
+            sum -= l[i * n + k] * x[k];
+        }
+        x[i] = sum / l[i * n + i];
+    }
+    // Lᵀ·v = y
+    for (int i = n - 1; i >= 0; i--) {
+        double sum = x[i];
+        for (int k = i + 1; k < n; k++) {
+            sum -= l[k * n + i] * x[k];
+        }
+        x[i] = sum / l[i * n + i];
+    }
+
+    for (int i = 0; i < n; i++) {
+        circuit->voltages[island->nodes[i]] = x[i];
+    }
+    return 0;
+}
+
+// Fatora as ilhas pendentes ou substitui todas
+static void circuit_work_island(circuit_t* circuit, circuit_island_t* island, bool factor) {
+    if (!factor) {
+        island->result = circuit_substitute_island(circuit, island);
+    } else if (!island->factored) {
+        island->result = circuit_factor_island(circuit, island);
+    }
+}
+
+// Passa pelas ilhas, em paralelo quando há trabalho que compense acordar
+// os workers
+static void circuit_run_islands(circuit_t* circuit, bool factor) {
+    double work = 0.0;
+    int busy = 0;
+
+    for (int k = 0; k < circuit->island_count; k++) {
+        const circuit_island_t* island = &circuit->islands[k];
+        double n = island->size;
+        if (factor && island->factored) {
+            continue;
+        }
+        work += factor ? n * n * n / 3.0 : 2.0 * n * n;
+        busy++;
+    }
+
+    int threads = circuit->thread_count;
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+
+    if (threads <= 1 || busy <= 1 || work < CIRCUIT_PARALLEL_MIN_WORK) {
+        for (int k = 0; k < circuit->island_count; k++) {
+            circuit_work_island(circuit, &circuit->islands[k], factor);
+        }
+        return;
+    }
+
+    // O pool segue thread_count; se ele mudou, os workers são refeitos
+    if (circuit->pool && circuit->pool_size != threads - 1) {
+        circuit_pool_free(circuit->pool);
+        circuit->pool = NULL;
+    }
+    if (!circuit->pool) {
+        circuit->pool = circuit_pool_create(threads - 1);
+        circuit->pool_size = threads - 1;
+    }
+    if (!circuit->pool) {
+        for (int k = 0; k < circuit->island_count; k++) {
+            circuit_work_island(circuit, &circuit->islands[k], factor);
+        }
+        return;
+    }
+    circuit_pool_run(circuit->pool, circuit, circuit_work_island, factor);
+}
+
+// Monta os blocos das ilhas pendentes e fatora cada um. Depois de mudar a
+// topologia ou o passo todas estão pendentes; um diodo ou elemento ligado ou
+// desligado só marca a sua.
+static int circuit_factor(circuit_t* circuit) {
+    bool pending = false;
+
+    for (int k = 0; k < circuit->island_count; k++) {
+        circuit_island_t* island = &circuit->islands[k];
+        if (!circuit->factored) {
+            island->factored = false;
+        }
+        if (island->factored) {
+            continue;
+        }
+
+        int n = island->size;
+        const int* diagonal;
+        int count;
+        double* values = circuit_island_values(island, &diagonal, &count);
+        if (values) {
+            memset(values, 0, count * sizeof(double));
+            for (int i = 0; i < n; i++) {
+                values[diagonal[i]] = CIRCUIT_GMIN;
+            }
+        } else {
+            memset(island->factor, 0, (size_t)n * n * sizeof(double));
+            for (int i = 0; i < n; i++) {
+                island->factor[i * n + i] = CIRCUIT_GMIN;
+            }
+        }
+        island->result = 0;
+        pending = true;
+    }
+    circuit->factored = true;
+    if (!pending) {
+        return 0;
+    }
+
+    for (int e = 0; e < circuit->element_count; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        double conductance = circuit_conductance(circuit, element);
+        int index = circuit_element_island(circuit, element);
+
+        if (conductance == 0.0 || index < 0 || circuit->islands[index].factored) {
+            continue;
+        }
+
+        circuit_island_t* island = &circuit->islands[index];
+        const int* diagonal;
+        int count;
+        double* values = circuit_island_values(island, &diagonal, &count);
+        if (values) {
+            const int* slots = &circuit->element_slots[3 * e];
+            for (int k = 0; k < 3; k++) {
+                if (slots[k] >= 0) {
+                    values[slots[k]] += k < 2 ? conductance : -conductance;
+                }
+            }
+            continue;
+        }
+
+        int n = island->size;
+        double* g = island->factor;
+        int a = element->a != CIRCUIT_GROUND ? circuit->node_local[element->a] : -1;
+        int b = element->b != CIRCUIT_GROUND ? circuit->node_local[element->b] : -1;
+
+        if (a >= 0) {
+            g[a * n + a] += conductance;
+        }
+        if (b >= 0) {
+            g[b * n + b] += conductance;
+        }
+        if (a >= 0 && b >= 0 && a != b) {
+            int row = a > b ? a : b;
+            int col = a > b ? b : a;
+            g[row * n + col] -= conductance;
+        }
+    }
+
+    circuit_run_islands(circuit, true);
+    circuit->factor_count++;
+
+    for (int k = 0; k < circuit->island_count; k++) {
+        if (circuit->islands[k].result < 0) {
+            circuit->islands[k].factored = false;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int circuit_substitute(circuit_t* circuit) {
+    for (int k = 0; k < circuit->island_count; k++) {
+        memset(circuit->islands[k].rhs, 0, circuit->islands[k].size * sizeof(double));
+    }
+
+    for (int e = 0; e < circuit->element_count; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        double current = circuit_injection(circuit, element);
+        if (current == 0.0) {
+            continue;
+        }
+        // Fonte de corrente pode ligar duas ilhas: cada lado vai para a sua
+        if (element->a > 0) {
+            circuit->islands[circuit->node_island[element->a]].rhs[circuit->node_local[element->a]] += current;
+        }
+        if (element->b > 0) {
+            circuit->islands[circuit->node_island[element->b]].rhs[circuit->node_local[element->b]] -= current;
+        }
+    }
+
+    circuit_run_islands(circuit, false);
+    circuit->voltages[CIRCUIT_GROUND] = 0.0;
+    circuit->solve_count++;
+
+    for (int k = 0; k < circuit->island_count; k++) {
+        if (circuit->islands[k].result < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int circuit_set_solver(circuit_t* circuit, circuit_solver_t solver) {
+    if (!circuit || (solver != CIRCUIT_SOLVER_DIRECT && solver != CIRCUIT_SOLVER_ITERATIVE)) {
+        return -1;
+    }
+
+    // As ilhas grandes são remontadas com o outro método
+    if (circuit->solver != solver) {
+        circuit->solver = solver;
+        circuit->partitioned = false;
+    }
+    return 0;
+}
+
+int circuit_solve(circuit_t* circuit) {
+    if (!circuit || circuit_reserve(circuit) < 0) {
+        return -1;
+    }
+
+    for (int iteration = 0; iteration < CIRCUIT_MAX_DIODE_ITERATIONS; iteration++) {
+        if (circuit_factor(circuit) < 0 || circuit_substitute(circuit) < 0) {
+            return -1;
+        }
+
+        // Diodo conduz quando a tensão sobre ele passa de Vf
+        bool changed = false;
+        for (int e = 0; e < circuit->element_count; e++) {
+            circuit_element_t* element = &circuit->elements[e];
+            if (element->type != CIRCUIT_DIODE || !element->enabled) {
+                continue;
+            }
+            double vak = circuit->voltages[element->a] - circuit->voltages[element->b];
+            bool conducting = vak > element->value;
+            if (conducting != element->conducting) {
+                int island = circuit_element_island(circuit, element);
+                element->conducting = conducting;
+                if (island >= 0) {
+                    circuit->islands[island].factored = false;
+                }
+                changed = true;
+            }
+        }
+
+        if (!changed) {
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "Estado dos diodos não convergiu\n");
+    return -1;
+}
+
+int circuit_step(circuit_t* circuit, double dt) {
+    if (!circuit || dt <= 0.0 || circuit_reserve(circuit) < 0) {
+        return -1;
+    }
+
+    if (dt != circuit->timestep) {
+        circuit->timestep = dt;
+        circuit->factored = false;
+    }
+
+    for (int e = 0; e < circuit->element_count; e++) {
+        circuit_element_t* element = &circuit->elements[e];
+        if (element->type == CIRCUIT_CAPACITOR) {
+            element->history = circuit->voltages[element->a] - circuit->voltages[element->b];
+        }
+    }
+
+    return circuit_solve(circuit);
+}
+
+double circuit_voltage(const circuit_t* circuit, int node) {
+    if (!circuit || !circuit->voltages || node < 0 || node >= circuit->node_count) {
+        return 0.0;
+    }
+    return circuit->voltages[node];
+}
+
+double circuit_current(const circuit_t* circuit, int element) {
+    if (!circuit || !circuit->voltages || element < 0 || element >= circuit->element_count) {
+        return 0.0;
+    }
+
+    const circuit_element_t* e = &circuit->elements[element];
+    double vab = circuit->voltages[e->a] - circuit->voltages[e->b];
+
+    if (!e->enabled) {
+        return 0.0;
+    }
+
+    switch (e->type) {
+        case CIRCUIT_RESISTOR:
+            return vab / e->resistance;
+        case CIRCUIT_VOLTAGE_SOURCE:
+            return (e->value - vab) / e->resistance;
+        case CIRCUIT_CURRENT_SOURCE:
+            return e->value;
+        case CIRCUIT_DIODE:
+            return e->conducting ? (vab - e->value) / e->resistance : vab * CIRCUIT_DIODE_OFF_CONDUCTANCE;
+        case CIRCUIT_CAPACITOR:
+            return circuit->timestep > 0.0 ? e->value / circuit->timestep * (vab - e->history) : 0.0;
+        default:
+            return 0.0;
+    }
+}
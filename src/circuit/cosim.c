@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "circuit/cosim.h"
+
+int cosim_init(cosim_t* cosim, microcontroller_t* mcu, circuit_t* circuit, double vdd) {
+    if (!cosim || !mcu || !circuit || vdd <= 0.0) {
+        return -1;
+    }
+
+    memset(cosim, 0, sizeof(*cosim));
+    cosim->mcu = mcu;
+    cosim->circuit = circuit;
+    cosim->vdd = vdd;
+    cosim->drive_resistance = COSIM_DEFAULT_DRIVE_RESISTANCE;
+    cosim->threshold_low = 0.3 * vdd;
+    cosim->threshold_high = 0.6 * vdd;
+    cosim->quantum = COSIM_DEFAULT_QUANTUM;
+    cosim->dirty = true;
+
+    return 0;
+}
+
+void cosim_free(cosim_t* cosim) {
+    if (!cosim) {
+        return;
+    }
+
+    free(cosim->pins);
+    cosim->pins = NULL;
+    cosim->pin_count = 0;
+    cosim->pin_capacity = 0;
+}
+
+int cosim_bind_pin(cosim_t* cosim, int pin_number, int node) {
+    pin_t* pin;
+
+    if (!cosim || pin_get_by_number(&cosim->mcu->pin_manager, pin_number, &pin) < 0 ||
+        node <= CIRCUIT_GROUND || node >= cosim->circuit->node_count) {
+        fprintf(stderr, "Pino %d ou nó %d inválido para co-simulação\n", pin_number, node);
+        return -1;
+    }
+
+    if (cosim->pin_count == cosim->pin_capacity) {
+        int capacity = cosim->pin_capacity ? cosim->pin_capacity * 2 : 8;
+        cosim_pin_t* pins = realloc(cosim->pins, capacity * sizeof(cosim_pin_t));
+        if (!pins) {
+            fprintf(stderr, "Erro ao alocar pinos da co-simulação\n");
+            return -1;
+        }
+        cosim->pins = pins;
+        cosim->pin_capacity = capacity;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "pin%d", pin_number);
+    int source = circuit_add_voltage_source(cosim->circuit, name, node, CIRCUIT_GROUND,
+                                            pin->state == PIN_HIGH ? cosim->vdd : 0.0,
+                                            cosim->drive_resistance);
+    if (source < 0) {
+        return -1;
+    }
+    circuit_set_enabled(cosim->circuit, source, pin->direction != PIN_INPUT);
+
+    cosim->pins[cosim->pin_count++] = (cosim_pin_t){
+        .pin_number = pin_number,
+        .node = node,
+        .source = source,
+        .direction = pin->direction,
+        .driven = pin->state,
+    };
+    cosim->dirty = true;
+
+    return 0;
+}
+
+int cosim_sync(cosim_t* cosim) {
+    if (!cosim) {
+        return -1;
+    }
+
+    pin_manager_t* manager = &cosim->mcu->pin_manager;
+
+    // Só os pinos ligados são conferidos; sem mudança não há solução
+    for (int i = 0; i < cosim->pin_count; i++) {
+        cosim_pin_t* binding = &cosim->pins[i];
+        const pin_t* pin = &manager->pins[binding->pin_number];
+
+        bool turned = pin->direction != binding->direction;
+        if (turned) {
+            // Mudar de direção liga ou desliga a fonte: refatora a matriz
+            circuit_set_enabled(cosim->circuit, binding->source, pin->direction != PIN_INPUT);
+            binding->direction = pin->direction;
+            cosim->dirty = true;
+        }
+        // Ao voltar a ser saída a fonte recebe o nível atual, seja qual for o
+        // último lido como entrada
+        if (pin->direction != PIN_INPUT && (turned || pin->state != binding->driven)) {
+            circuit_set_source(cosim->circuit, binding->source, pin->state == PIN_HIGH ? cosim->vdd : 0.0);
+            binding->driven = pin->state;
+            cosim->dirty = true;
+        }
+    }
+
+    if (!cosim->dirty) {
+        return 0;
+    }
+
+    if (circuit_solve(cosim->circuit) < 0) {
+        return -1;
+    }
+    cosim->dirty = false;
+    cosim->solve_count++;
+
+    for (int i = 0; i < cosim->pin_count; i++) {
+        cosim_pin_t* binding = &cosim->pins[i];
+        const pin_t* pin = &manager->pins[binding->pin_number];
+        if (pin->direction != PIN_INPUT) {
+            continue;
+        }
+
+        // Entre os limiares o pino mantém o nível anterior
+        double voltage = circuit_voltage(cosim->circuit, binding->node);
+        pin_state_t state = pin->state;
+        if (voltage >= cosim->threshold_high) {
+            state = PIN_HIGH;
+        } else if (voltage <= cosim->threshold_low) {
+            state = PIN_LOW;
+        }
+        if (state != pin->state &&
+            mcu_set_pin_state(cosim->mcu, binding->pin_number, state) < 0) {
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+int cosim_run(cosim_t* cosim, uint64_t cycles) {
+    if (!cosim) {
+        return -1;
+    }
+
+    if (cosim_sync(cosim) < 0) {
+        return -1;
+    }
+
+    microcontroller_t* mcu = cosim->mcu;
+    uint64_t target = mcu->cycle_count + cycles;
+
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < target) {
+        uint64_t remaining = target - mcu->cycle_count;
+        if (mcu_run_cycles(mcu, remaining < cosim->quantum ? remaining : cosim->quantum) < 0 ||
+            cosim_sync(cosim) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,576 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "circuit/digital.h"
+
+static const digital_drive_t digital_released = { DIGITAL_Z, DIGITAL_HIGHZ };
+
+// Dobra a capacidade de um vetor dinâmico quando ele enche
+static int digital_grow(void** items, int* capacity, int count, size_t item_size, int initial) {
+    if (count < *capacity) {
+        return 0;
+    }
+
+    int new_capacity = *capacity ? *capacity * 2 : initial;
+    void* grown = realloc(*items, (size_t)new_capacity * item_size);
+    if (!grown) {
+        fprintf(stderr, "Erro ao alocar simulação digital\n");
+        return -1;
+    }
+    *items = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static bool digital_same(digital_drive_t a, digital_drive_t b) {
+    return a.level == b.level && a.strength == b.strength;
+}
+
+int digital_init(digital_sim_t* sim, circuit_t* circuit, double vdd) {
+    if (!sim || (circuit && vdd <= 0.0)) {
+        return -1;
+    }
+
+    memset(sim, 0, sizeof(*sim));
+    sim->circuit = circuit;
+    sim->vdd = vdd;
+    sim->drive_resistance = 25.0;
+    sim->threshold_low = 0.3 * vdd;
+    sim->threshold_high = 0.6 * vdd;
+    return 0;
+}
+
+void digital_free(digital_sim_t* sim) {
+    if (!sim) {
+        return;
+    }
+
+    for (int i = 0; i < sim->net_count; i++) {
+        free(sim->nets[i].name);
+        free(sim->nets[i].fanout);
+    }
+    for (int i = 0; i < sim->gate_count; i++) {
+        free(sim->gates[i].name);
+    }
+    free(sim->nets);
+    free(sim->gates);
+    free(sim->drivers);
+    free(sim->events);
+    free(sim->sensed);
+    memset(sim, 0, sizeof(*sim));
+}
+
+/* ---------------------------------------------------------------------- */
+/* Fila de eventos                                                        */
+/* ---------------------------------------------------------------------- */
+
+static bool digital_event_before(const digital_event_t* a, const digital_event_t* b) {
+    return a->time != b->time ? a->time < b->time : a->sequence < b->sequence;
+}
+
+static int digital_push(digital_sim_t* sim, digital_event_t event) {
+    if (digital_grow((void**)&sim->events, &sim->event_capacity, sim->event_count,
+                     sizeof(digital_event_t), 64) < 0) {
+        return -1;
+    }
+
+    event.sequence = sim->sequence++;
+    int i = sim->event_count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!digital_event_before(&event, &sim->events[parent])) {
+            break;
+        }
+        sim->events[i] = sim->events[parent];
+        i = parent;
+    }
+    sim->events[i] = event;
+    return 0;
+}
+
+static digital_event_t digital_pop(digital_sim_t* sim) {
+    digital_event_t top = sim->events[0];
+    digital_event_t last = sim->events[--sim->event_count];
+    int i = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= sim->event_count) {
+            break;
+        }
+        if (child + 1 < sim->event_count && digital_event_before(&sim->events[child + 1], &sim->events[child])) {
+            child++;
+        }
+        if (!digital_event_before(&sim->events[child], &last)) {
+            break;
+        }
+        sim->events[i] = sim->events[child];
+        i = child;
+    }
+    if (sim->event_count > 0) {
+        sim->events[i] = last;
+    }
+    return top;
+}
+
+static int digital_schedule_driver(digital_sim_t* sim, int driver, digital_drive_t drive, uint64_t time) {
+    digital_event_t event = { .time = time, .gate = -1, .driver = driver, .drive = drive };
+    return digital_push(sim, event);
+}
+
+static int digital_schedule_gate(digital_sim_t* sim, int gate) {
+    if (sim->gates[gate].pending) {
+        return 0;
+    }
+
+    sim->gates[gate].pending = true;
+    digital_event_t event = { .time = sim->time, .gate = gate, .driver = -1 };
+    return digital_push(sim, event);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Netlist                                                                */
+/* ---------------------------------------------------------------------- */
+
+int digital_net(digital_sim_t* sim, const char* name) {
+    if (!sim || !name) {
+        return -1;
+    }
+
+    for (int i = 0; i < sim->net_count; i++) {
+        if (strcmp(sim->nets[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    if (digital_grow((void**)&sim->nets, &sim->net_capacity, sim->net_count, sizeof(digital_net_t), 16) < 0) {
+        return -1;
+    }
+
+    digital_net_t* net = &sim->nets[sim->net_count];
+    memset(net, 0, sizeof(*net));
+    net->name = strdup(name);
+    if (!net->name) {
+        fprintf(stderr, "Erro ao alocar nome da net\n");
+        return -1;
+    }
+    net->value = digital_released;
+    net->first_driver = -1;
+    net->external_driver = -1;
+    net->analog_source = -1;
+    net->analog_node = -1;
+    net->sense_driver = -1;
+
+    return sim->net_count++;
+}
+
+static int digital_add_driver(digital_sim_t* sim, int net) {
+    if (digital_grow((void**)&sim->drivers, &sim->driver_capacity, sim->driver_count,
+                     sizeof(digital_driver_t), 16) < 0) {
+        return -1;
+    }
+
+    int index = sim->driver_count++;
+    sim->drivers[index] = (digital_driver_t){
+        .net = net,
+        .next = sim->nets[net].first_driver,
+        .drive = digital_released,
+    };
+    sim->nets[net].first_driver = index;
+    return index;
+}
+
+static int digital_add_fanout(digital_sim_t* sim, int net, int gate) {
+    digital_net_t* n = &sim->nets[net];
+
+    for (int i = 0; i < n->fanout_count; i++) {
+        if (n->fanout[i] == gate) {
+            return 0;
+        }
+    }
+    if (digital_grow((void**)&n->fanout, &n->fanout_capacity, n->fanout_count, sizeof(int), 4) < 0) {
+        return -1;
+    }
+    n->fanout[n->fanout_count++] = gate;
+    return 0;
+}
+
+int digital_add_gate(digital_sim_t* sim, digital_gate_type_t type, const char* name,
+                     const int* inputs, int input_count, int output, uint64_t delay) {
+    if (!sim || input_count < 0 || input_count > DIGITAL_MAX_INPUTS || (input_count > 0 && !inputs) ||
+        output < 0 || output >= sim->net_count) {
+        return -1;
+    }
+    for (int i = 0; i < input_count; i++) {
+        if (inputs[i] < 0 || inputs[i] >= sim->net_count) {
+            fprintf(stderr, "Porta %s ligada a net inexistente\n", name ? name : "sem nome");
+            return -1;
+        }
+    }
+
+    if (digital_grow((void**)&sim->gates, &sim->gate_capacity, sim->gate_count, sizeof(digital_gate_t), 16) < 0) {
+        return -1;
+    }
+
+    int driver = digital_add_driver(sim, output);
+    if (driver < 0) {
+        return -1;
+    }
+
+    int index = sim->gate_count;
+    digital_gate_t* gate = &sim->gates[index];
+    memset(gate, 0, sizeof(*gate));
+    gate->type = type;
+    gate->name = name ? strdup(name) : NULL;
+    gate->input_count = input_count;
+    for (int i = 0; i < input_count; i++) {
+        gate->inputs[i] = inputs[i];
+    }
+    gate->driver = driver;
+    gate->delay = delay;
+    gate->strength = DIGITAL_STRONG;
+    gate->constant = DIGITAL_X;
+    gate->scheduled = digital_released;
+    sim->gate_count++;
+
+    for (int i = 0; i < input_count; i++) {
+        if (digital_add_fanout(sim, inputs[i], index) < 0) {
+            return -1;
+        }
+    }
+
+    // Toda porta nova é avaliada uma vez para a saída partir de um valor real
+    if (digital_schedule_gate(sim, index) < 0) {
+        return -1;
+    }
+    return index;
+}
+
+int digital_add_constant(digital_sim_t* sim, const char* name, int net,
+                         digital_level_t level, digital_strength_t strength) {
+    int gate = digital_add_gate(sim, DIGITAL_GATE_CONSTANT, name, NULL, 0, net, 0);
+    if (gate >= 0) {
+        sim->gates[gate].constant = level;
+        sim->gates[gate].strength = strength;
+    }
+    return gate;
+}
+
+int digital_add_switch(digital_sim_t* sim, const char* name, int a, int b, bool closed) {
+    int gate = digital_add_gate(sim, DIGITAL_GATE_SWITCH, name, &a, 1, b, 0);
+    if (gate >= 0) {
+        sim->gates[gate].closed = closed;
+    }
+    return gate;
+}
+
+int digital_set_switch(digital_sim_t* sim, int gate, bool closed) {
+    if (!sim || gate < 0 || gate >= sim->gate_count || sim->gates[gate].type != DIGITAL_GATE_SWITCH) {
+        return -1;
+    }
+
+    if (sim->gates[gate].closed == closed) {
+        return 0;
+    }
+    sim->gates[gate].closed = closed;
+    return digital_schedule_gate(sim, gate);
+}
+
+int digital_force(digital_sim_t* sim, int net, digital_level_t level, digital_strength_t strength) {
+    if (!sim || net < 0 || net >= sim->net_count) {
+        return -1;
+    }
+
+    digital_net_t* n = &sim->nets[net];
+    if (n->external_driver < 0) {
+        n->external_driver = digital_add_driver(sim, net);
+        if (n->external_driver < 0) {
+            return -1;
+        }
+    }
+
+    digital_drive_t drive = { level, strength };
+    return digital_schedule_driver(sim, n->external_driver, drive, sim->time);
+}
+
+int digital_bind_output(digital_sim_t* sim, int net, int node) {
+    if (!sim || !sim->circuit || net < 0 || net >= sim->net_count ||
+        node <= CIRCUIT_GROUND || node >= sim->circuit->node_count) {
+        return -1;
+    }
+
+    digital_net_t* n = &sim->nets[net];
+    char name[64];
+    snprintf(name, sizeof(name), "net:%s", n->name);
+    n->analog_source = circuit_add_voltage_source(sim->circuit, name, node, CIRCUIT_GROUND, 0.0, sim->drive_resistance);
+    if (n->analog_source < 0) {
+        return -1;
+    }
+
+    // Até a net ter nível definido a fonte fica desligada
+    circuit_set_enabled(sim->circuit, n->analog_source, false);
+    sim->analog_dirty = true;
+    return 0;
+}
+
+int digital_bind_input(digital_sim_t* sim, int net, int node) {
+    if (!sim || !sim->circuit || net < 0 || net >= sim->net_count ||
+        node <= CIRCUIT_GROUND || node >= sim->circuit->node_count) {
+        return -1;
+    }
+
+    if (digital_grow((void**)&sim->sensed, &sim->sensed_capacity, sim->sensed_count, sizeof(int), 4) < 0) {
+        return -1;
+    }
+
+    digital_net_t* n = &sim->nets[net];
+    n->analog_node = node;
+    n->sense_driver = digital_add_driver(sim, net);
+    if (n->sense_driver < 0) {
+        return -1;
+    }
+
+    sim->sensed[sim->sensed_count++] = net;
+    sim->analog_dirty = true;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Avaliação                                                              */
+/* ---------------------------------------------------------------------- */
+
+// O driver mais forte vence; empate entre níveis diferentes vira X
+static digital_drive_t digital_resolve(const digital_sim_t* sim, const digital_net_t* net) {
+    digital_drive_t result = digital_released;
+
+    for (int d = net->first_driver; d >= 0; d = sim->drivers[d].next) {
+        digital_drive_t drive = sim->drivers[d].drive;
+        if (drive.strength == DIGITAL_HIGHZ || drive.level == DIGITAL_Z) {
+            continue;
+        }
+        if (drive.strength > result.strength) {
+            result = drive;
+        } else if (drive.strength == result.strength && drive.level != result.level) {
+            result.level = DIGITAL_X;
+        }
+    }
+    return result;
+}
+
+static digital_level_t digital_input(const digital_sim_t* sim, int net) {
+    digital_level_t level = sim->nets[net].value.level;
+    return level == DIGITAL_Z ? DIGITAL_X : level;
+}
+
+static digital_level_t digital_not(digital_level_t level) {
+    return level == DIGITAL_0 ? DIGITAL_1 : level == DIGITAL_1 ? DIGITAL_0 : DIGITAL_X;
+}
+
+static digital_drive_t digital_evaluate(const digital_sim_t* sim, const digital_gate_t* gate) {
+    digital_drive_t out = { DIGITAL_X, gate->strength };
+
+    switch (gate->type) {
+        case DIGITAL_GATE_CONSTANT:
+            out.level = gate->constant;
+            return out;
+        case DIGITAL_GATE_SWITCH: {
+            if (!gate->closed) {
+                return digital_released;
+            }
+            // Uma chave não reforça o sinal: passa o nível com a força de quem dirige
+            digital_drive_t in = sim->nets[gate->inputs[0]].value;
+            if (in.strength > DIGITAL_STRONG) {
+                in.strength = DIGITAL_STRONG;
+            }
+            return in;
+        }
+        case DIGITAL_GATE_BUFFER:
+        case DIGITAL_GATE_NOT:
+            out.level = gate->input_count > 0 ? digital_input(sim, gate->inputs[0]) : DIGITAL_X;
+            if (gate->type == DIGITAL_GATE_NOT) {
+                out.level = digital_not(out.level);
+            }
+            return out;
+        case DIGITAL_GATE_AND:
+        case DIGITAL_GATE_NAND:
+        case DIGITAL_GATE_OR:
+        case DIGITAL_GATE_NOR: {
+            bool is_and = gate->type == DIGITAL_GATE_AND || gate->type == DIGITAL_GATE_NAND;
+            // Valor dominante: 0 decide o AND, 1 decide o OR
+            digital_level_t dominant = is_and ? DIGITAL_0 : DIGITAL_1;
+            bool unknown = false;
+            out.level = digital_not(dominant);
+            for (int i = 0; i < gate->input_count; i++) {
+                digital_level_t level = digital_input(sim, gate->inputs[i]);
+                if (level == dominant) {
+                    out.level = dominant;
+                    unknown = false;
+                    break;
+                }
+                unknown |= level == DIGITAL_X;
+            }
+            if (unknown) {
+                out.level = DIGITAL_X;
+            }
+            if (gate->type == DIGITAL_GATE_NAND || gate->type == DIGITAL_GATE_NOR) {
+                out.level = digital_not(out.level);
+            }
+            return out;
+        }
+        case DIGITAL_GATE_XOR:
+            out.level = DIGITAL_0;
+            for (int i = 0; i < gate->input_count; i++) {
+                digital_level_t level = digital_input(sim, gate->inputs[i]);
+                if (level == DIGITAL_X) {
+                    out.level = DIGITAL_X;
+                    break;
+                }
+                out.level = level == DIGITAL_1 ? digital_not(out.level) : out.level;
+            }
+            return out;
+        default:
+            return out;
+    }
+}
+
+// Net mudou: entradas das portas são reavaliadas e a fonte analógica muda
+static int digital_net_changed(digital_sim_t* sim, int net) {
+    digital_net_t* n = &sim->nets[net];
+
+    for (int i = 0; i < n->fanout_count; i++) {
+        if (digital_schedule_gate(sim, n->fanout[i]) < 0) {
+            return -1;
+        }
+    }
+
+    if (n->analog_source >= 0) {
+        bool driven = n->value.level == DIGITAL_0 || n->value.level == DIGITAL_1;
+        circuit_set_enabled(sim->circuit, n->analog_source, driven);
+        circuit_set_source(sim->circuit, n->analog_source, n->value.level == DIGITAL_1 ? sim->vdd : 0.0);
+        sim->analog_dirty = true;
+    }
+    return 0;
+}
+
+static int digital_apply(digital_sim_t* sim, const digital_event_t* event) {
+    sim->event_count_total++;
+
+    if (event->gate >= 0) {
+        digital_gate_t* gate = &sim->gates[event->gate];
+        gate->pending = false;
+        sim->evaluation_count++;
+
+        // Atraso de transporte: só agenda quando a saída prevista muda
+        digital_drive_t out = digital_evaluate(sim, gate);
+        if (digital_same(out, gate->scheduled)) {
+            return 0;
+        }
+        gate->scheduled = out;
+        return digital_schedule_driver(sim, gate->driver, out, sim->time + gate->delay);
+    }
+
+    digital_driver_t* driver = &sim->drivers[event->driver];
+    if (digital_same(driver->drive, event->drive)) {
+        return 0;
+    }
+    driver->drive = event->drive;
+
+    digital_net_t* net = &sim->nets[driver->net];
+    digital_drive_t value = digital_resolve(sim, net);
+    if (digital_same(value, net->value)) {
+        return 0;
+    }
+    net->value = value;
+    return digital_net_changed(sim, driver->net);
+}
+
+// Resolve o circuito e leva as tensões das nets de entrada para o digital
+static int digital_solve_analog(digital_sim_t* sim) {
+    sim->analog_dirty = false;
+    if (circuit_solve(sim->circuit) < 0) {
+        return -1;
+    }
+    sim->analog_solve_count++;
+
+    for (int i = 0; i < sim->sensed_count; i++) {
+        digital_net_t* net = &sim->nets[sim->sensed[i]];
+        digital_drive_t drive = sim->drivers[net->sense_driver].drive;
+        double voltage = circuit_voltage(sim->circuit, net->analog_node);
+
+        // Entre os limiares o nível anterior se mantém (X na primeira leitura)
+        digital_drive_t sensed = { drive.strength == DIGITAL_HIGHZ ? DIGITAL_X : drive.level, DIGITAL_STRONG };
+        if (voltage >= sim->threshold_high) {
+            sensed.level = DIGITAL_1;
+        } else if (voltage <= sim->threshold_low) {
+            sensed.level = DIGITAL_0;
+        }
+        if (!digital_same(sensed, drive) &&
+            digital_schedule_driver(sim, net->sense_driver, sensed, sim->time) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int digital_run(digital_sim_t* sim, uint64_t until) {
+    if (!sim) {
+        return -1;
+    }
+
+    uint64_t instant = sim->time;
+    int deltas = 0;
+
+    for (;;) {
+        bool due = sim->event_count > 0 && sim->events[0].time <= until;
+
+        // O analógico é resolvido uma vez por instante, depois que o digital
+        // parou de mudar nele
+        if (sim->analog_dirty && sim->circuit && (!due || sim->events[0].time > sim->time)) {
+            if (digital_solve_analog(sim) < 0) {
+                return -1;
+            }
+            continue;
+        }
+        if (!due) {
+            break;
+        }
+
+        digital_event_t event = digital_pop(sim);
+        sim->time = event.time;
+        if (event.time != instant) {
+            instant = event.time;
+            deltas = 0;
+        } else if (++deltas > DIGITAL_MAX_DELTAS) {
+            fprintf(stderr, "Simulação digital oscilando no instante %llu\n", (unsigned long long)instant);
+            return -1;
+        }
+
+        if (digital_apply(sim, &event) < 0) {
+            return -1;
+        }
+    }
+
+    if (until > sim->time) {
+        sim->time = until;
+    }
+    return 0;
+}
+
+digital_level_t digital_level(const digital_sim_t* sim, int net) {
+    if (!sim || net < 0 || net >= sim->net_count) {
+        return DIGITAL_X;
+    }
+    return sim->nets[net].value.level;
+}
+
+const char* digital_level_to_string(digital_level_t level) {
+    switch (level) {
+        case DIGITAL_0: return "0";
+        case DIGITAL_1: return "1";
+        case DIGITAL_X: return "X";
+        case DIGITAL_Z: return "Z";
+        default: return "?";
+    }
+}
@@ -0,0 +1,554 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "circuit/multirate.h"
+
+// Coordenação das threads durante multirate_run: a cada janela a thread
+// principal publica o fim dela e espera todas as partições chegarem lá
+typedef struct {
+    multirate_t* multirate;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    unsigned long generation;
+    int pending;
+    double window_end;
+    bool stop;
+} multirate_team_t;
+
+typedef struct {
+    multirate_team_t* team;
+    int index;
+    unsigned long seen;
+} multirate_worker_t;
+
+/* ---------------------------------------------------------------------- */
+/* Particionamento                                                        */
+/* ---------------------------------------------------------------------- */
+
+// Condutância DC que o elemento pode colocar entre os seus nós
+static double multirate_conductance(const circuit_element_t* element) {
+    switch (element->type) {
+        case CIRCUIT_RESISTOR:
+        case CIRCUIT_VOLTAGE_SOURCE:
+        case CIRCUIT_DIODE:
+            return element->enabled ? 1.0 / element->resistance : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+static bool multirate_is_weak(const circuit_element_t* element, const double* total) {
+    if (element->type != CIRCUIT_RESISTOR || element->a == CIRCUIT_GROUND ||
+        element->b == CIRCUIT_GROUND || element->a == element->b) {
+        return false;
+    }
+
+    double conductance = multirate_conductance(element);
+    return conductance <= MULTIRATE_WEAK_RATIO * (total[element->a] - conductance) &&
+           conductance <= MULTIRATE_WEAK_RATIO * (total[element->b] - conductance);
+}
+
+// Copia o elemento para o circuito da partição com os nós locais
+static int multirate_copy_element(circuit_t* local, const circuit_element_t* element, int a, int b) {
+    int index;
+
+    switch (element->type) {
+        case CIRCUIT_RESISTOR:
+            index = circuit_add_resistor(local, element->name, a, b, element->value);
+            break;
+        case CIRCUIT_VOLTAGE_SOURCE:
+            index = circuit_add_voltage_source(local, element->name, a, b, element->value, element->resistance);
+            break;
+        case CIRCUIT_CURRENT_SOURCE:
+            index = circuit_add_current_source(local, element->name, a, b, element->value);
+            break;
+        case CIRCUIT_DIODE:
+            index = circuit_add_diode(local, element->name, a, b, element->value, element->resistance);
+            break;
+        case CIRCUIT_CAPACITOR:
+            index = circuit_add_capacitor(local, element->name, a, b, element->value);
+            break;
+        default:
+            return -1;
+    }
+
+    if (index >= 0) {
+        // O diodo começa no estado que convergiu no circuito completo
+        local->elements[index].conducting = element->conducting;
+        circuit_set_enabled(local, index, element->enabled);
+    }
+    return index;
+}
+
+static int multirate_add_coupling(multirate_t* multirate, const circuit_t* circuit, int element,
+                                  int node, int remote) {
+    const circuit_element_t* resistor = &circuit->elements[element];
+    int partition = multirate->node_partition[node];
+    circuit_t* local = &multirate->partitions[partition].circuit;
+
+    int source = circuit_add_voltage_source(local, resistor->name, multirate->node_local[node], CIRCUIT_GROUND,
+                                            circuit->voltages[remote], resistor->value);
+    if (source < 0) {
+        return -1;
+    }
+
+    multirate->couplings[multirate->coupling_count++] = (multirate_coupling_t){
+        .element = element,
+        .partition = partition,
+        .source = source,
+        .remote_partition = multirate->node_partition[remote],
+        .remote_node = multirate->node_local[remote],
+    };
+    return 0;
+}
+
+static int multirate_build(multirate_t* multirate, circuit_t* circuit, double min_step, double max_step) {
+    int n = circuit->node_count;
+    int m = circuit->element_count;
+    int result = -1;
+
+    double* total = calloc(n, sizeof(double));
+    int* parent = malloc(n * sizeof(int));
+    int* root_partition = malloc(n * sizeof(int));
+    bool* touched = calloc(n, sizeof(bool));
+    bool* weak = calloc(m ? m : 1, sizeof(bool));
+    int* node_counts = NULL;
+
+    multirate->node_partition = malloc(n * sizeof(int));
+    multirate->node_local = calloc(n, sizeof(int));
+    multirate->element_partition = malloc((m ? m : 1) * sizeof(int));
+    multirate->element_local = malloc((m ? m : 1) * sizeof(int));
+    multirate->couplings = malloc((m ? 2 * m : 1) * sizeof(multirate_coupling_t));
+    if (!total || !parent || !root_partition || !touched || !weak || !multirate->node_partition ||
+        !multirate->node_local || !multirate->element_partition || !multirate->element_local ||
+        !multirate->couplings) {
+        fprintf(stderr, "Erro ao alocar particionamento do circuito\n");
+        goto out;
+    }
+
+    for (int e = 0; e < m; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        double conductance = multirate_conductance(element);
+        total[element->a] += conductance;
+        total[element->b] += conductance;
+    }
+
+    // Componentes conexos sem passar pela terra nem pelos acoplamentos fracos
+    for (int i = 0; i < n; i++) {
+        parent[i] = i;
+        root_partition[i] = -1;
+        multirate->node_partition[i] = -1;
+    }
+    for (int e = 0; e < m; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        touched[element->a] = true;
+        touched[element->b] = true;
+        weak[e] = multirate_is_weak(element, total);
+        if (!weak[e] && element->a != CIRCUIT_GROUND && element->b != CIRCUIT_GROUND) {
+            circuit_union(parent, element->a, element->b);
+        }
+    }
+
+    for (int i = 1; i < n; i++) {
+        if (!touched[i]) {
+            continue;
+        }
+        int root = circuit_find_root(parent, i);
+        if (root_partition[root] < 0) {
+            root_partition[root] = multirate->partition_count++;
+        }
+        multirate->node_partition[i] = root_partition[root];
+    }
+
+    multirate->partitions = calloc(multirate->partition_count ? multirate->partition_count : 1,
+                                   sizeof(multirate_partition_t));
+    node_counts = calloc(multirate->partition_count ? multirate->partition_count : 1, sizeof(int));
+    if (!multirate->partitions || !node_counts) {
+        fprintf(stderr, "Erro ao alocar partições do circuito\n");
+        goto out;
+    }
+
+    for (int i = 1; i < n; i++) {
+        if (multirate->node_partition[i] >= 0) {
+            node_counts[multirate->node_partition[i]]++;
+        }
+    }
+
+    for (int p = 0; p < multirate->partition_count; p++) {
+        multirate_partition_t* partition = &multirate->partitions[p];
+        partition->nodes = calloc(node_counts[p] + 1, sizeof(int));
+        if (!partition->nodes || circuit_init(&partition->circuit) < 0) {
+            fprintf(stderr, "Erro ao alocar partição %d do circuito\n", p);
+            goto out;
+        }
+        partition->min_step = min_step;
+        partition->max_step = max_step;
+        partition->step = max_step;
+    }
+
+    for (int i = 1; i < n; i++) {
+        int p = multirate->node_partition[i];
+        if (p < 0) {
+            continue;
+        }
+        multirate_partition_t* partition = &multirate->partitions[p];
+        int local = circuit_node(&partition->circuit, circuit->node_names[i]);
+        if (local < 0) {
+            goto out;
+        }
+        partition->nodes[local] = i;
+        multirate->node_local[i] = local;
+    }
+
+    for (int e = 0; e < m; e++) {
+        const circuit_element_t* element = &circuit->elements[e];
+        int a = element->a;
+        int b = element->b;
+
+        multirate->element_partition[e] = -1;
+        multirate->element_local[e] = -1;
+        if (a == CIRCUIT_GROUND && b == CIRCUIT_GROUND) {
+            continue;
+        }
+
+        if (weak[e] && multirate->node_partition[a] != multirate->node_partition[b]) {
+            if (multirate_add_coupling(multirate, circuit, e, a, b) < 0 ||
+                multirate_add_coupling(multirate, circuit, e, b, a) < 0) {
+                goto out;
+            }
+            continue;
+        }
+
+        int p = multirate->node_partition[a != CIRCUIT_GROUND ? a : b];
+        multirate_partition_t* partition = &multirate->partitions[p];
+        int local = multirate_copy_element(&partition->circuit, element, multirate->node_local[a],
+                                           multirate->node_local[b]);
+        if (local < 0) {
+            goto out;
+        }
+        if (element->type == CIRCUIT_CAPACITOR) {
+            partition->dynamic = true;
+        }
+        multirate->element_partition[e] = p;
+        multirate->element_local[e] = local;
+    }
+
+    // Com as fronteiras no valor do circuito completo, cada partição
+    // reproduz o mesmo ponto de operação
+    for (int p = 0; p < multirate->partition_count; p++) {
+        multirate_partition_t* partition = &multirate->partitions[p];
+        if (circuit_solve(&partition->circuit) < 0) {
+            goto out;
+        }
+        partition->previous = malloc(partition->circuit.node_count * sizeof(double));
+        partition->conducting = malloc((partition->circuit.element_count ? partition->circuit.element_count : 1) *
+                                       sizeof(bool));
+        if (!partition->previous || !partition->conducting) {
+            fprintf(stderr, "Erro ao alocar partição %d do circuito\n", p);
+            goto out;
+        }
+    }
+
+    result = 0;
+
+out:
+    free(total);
+    free(parent);
+    free(root_partition);
+    free(touched);
+    free(weak);
+    free(node_counts);
+    return result;
+}
+
+int multirate_init(multirate_t* multirate, circuit_t* circuit, double min_step, double max_step) {
+    if (!multirate || !circuit || min_step <= 0.0 || max_step < min_step) {
+        return -1;
+    }
+
+    memset(multirate, 0, sizeof(*multirate));
+    multirate->max_voltage_step = MULTIRATE_MAX_VOLTAGE_STEP;
+    multirate->threaded = true;
+
+    // Capacitores abertos, mesmo que o circuito já tenha sido avançado
+    circuit->timestep = 0.0;
+    circuit->factored = false;
+    if (circuit_solve(circuit) < 0) {
+        return -1;
+    }
+
+    multirate->node_count = circuit->node_count;
+    multirate->element_count = circuit->element_count;
+    if (multirate_build(multirate, circuit, min_step, max_step) < 0) {
+        multirate_free(multirate);
+        return -1;
+    }
+
+    return 0;
+}
+
+void multirate_free(multirate_t* multirate) {
+    if (!multirate) {
+        return;
+    }
+
+    for (int p = 0; multirate->partitions && p < multirate->partition_count; p++) {
+        circuit_free(&multirate->partitions[p].circuit);
+        free(multirate->partitions[p].nodes);
+        free(multirate->partitions[p].previous);
+        free(multirate->partitions[p].conducting);
+    }
+    free(multirate->partitions);
+    free(multirate->node_partition);
+    free(multirate->node_local);
+    free(multirate->element_partition);
+    free(multirate->element_local);
+    free(multirate->couplings);
+    memset(multirate, 0, sizeof(*multirate));
+}
+
+/* ---------------------------------------------------------------------- */
+/* Integração                                                             */
+/* ---------------------------------------------------------------------- */
+
+// Integra a partição até until. O passo cai à metade quando alguma tensão
+// varia mais que max_voltage_step e dobra quando varia menos de um quarto.
+static int multirate_advance(const multirate_t* multirate, multirate_partition_t* partition, double until) {
+    circuit_t* circuit = &partition->circuit;
+
+    if (!partition->dynamic) {
+        partition->time = until;
+        partition->step_count++;
+        return circuit_solve(circuit);
+    }
+
+    while (partition->time < until) {
+        double step = partition->step;
+        bool last = step >= until - partition->time;
+        if (last) {
+            step = until - partition->time;
+        }
+
+        memcpy(partition->previous, circuit->voltages, circuit->node_count * sizeof(double));
+        for (int e = 0; e < circuit->element_count; e++) {
+            partition->conducting[e] = circuit->elements[e].conducting;
+        }
+        if (circuit_step(circuit, step) < 0) {
+            return -1;
+        }
+
+        double change = 0.0;
+        for (int i = 1; i < circuit->node_count; i++) {
+            double delta = fabs(circuit->voltages[i] - partition->previous[i]);
+            if (delta > change) {
+                change = delta;
+            }
+        }
+
+        if (change > multirate->max_voltage_step && step > partition->min_step) {
+            // Volta ao início do passo, diodos incluídos: outro estado muda a matriz
+            memcpy(circuit->voltages, partition->previous, circuit->node_count * sizeof(double));
+            for (int e = 0; e < circuit->element_count; e++) {
+                if (circuit->elements[e].conducting != partition->conducting[e]) {
+                    circuit->elements[e].conducting = partition->conducting[e];
+                    circuit->factored = false;
+                }
+            }
+            partition->step = fmax(step / 2.0, partition->min_step);
+            partition->reject_count++;
+            continue;
+        }
+
+        partition->time = last ? until : partition->time + step;
+        partition->step_count++;
+        if (change < multirate->max_voltage_step / 4.0) {
+            partition->step = fmin(partition->step * 2.0, partition->max_step);
+        }
+    }
+
+    return 0;
+}
+
+// Ponto de sincronização: todas as partições estão paradas em multirate->time
+static int multirate_exchange(multirate_t* multirate, multirate_sync_t sync, void* context) {
+    if (sync && sync(multirate, multirate->time, context) < 0) {
+        return -1;
+    }
+
+    for (int c = 0; c < multirate->coupling_count; c++) {
+        const multirate_coupling_t* coupling = &multirate->couplings[c];
+        const circuit_t* remote = &multirate->partitions[coupling->remote_partition].circuit;
+        circuit_set_source(&multirate->partitions[coupling->partition].circuit, coupling->source,
+                           circuit_voltage(remote, coupling->remote_node));
+    }
+
+    return 0;
+}
+
+static double multirate_window_end(const multirate_t* multirate, double end, double sync_interval) {
+    double window = multirate->time + sync_interval;
+
+    // Evita uma última janela minúscula por arredondamento
+    return window >= end - sync_interval * 1e-9 ? end : window;
+}
+
+static void* multirate_worker(void* arg) {
+    multirate_worker_t* worker = arg;
+    multirate_team_t* team = worker->team;
+    multirate_partition_t* partition = &team->multirate->partitions[worker->index];
+
+    for (;;) {
+        pthread_mutex_lock(&team->lock);
+        while (team->generation == worker->seen && !team->stop) {
+            pthread_cond_wait(&team->wake, &team->lock);
+        }
+        if (team->stop) {
+            pthread_mutex_unlock(&team->lock);
+            break;
+        }
+        worker->seen = team->generation;
+        double until = team->window_end;
+        pthread_mutex_unlock(&team->lock);
+
+        partition->result = multirate_advance(team->multirate, partition, until);
+
+        pthread_mutex_lock(&team->lock);
+        if (--team->pending == 0) {
+            pthread_cond_signal(&team->idle);
+        }
+        pthread_mutex_unlock(&team->lock);
+    }
+
+    return NULL;
+}
+
+static int multirate_run_threaded(multirate_t* multirate, double end, double sync_interval,
+                                  multirate_sync_t sync, void* context) {
+    int count = multirate->partition_count;
+    multirate_team_t team = {.multirate = multirate};
+    multirate_worker_t* workers = calloc(count, sizeof(multirate_worker_t));
+    pthread_t* threads = calloc(count, sizeof(pthread_t));
+    int started = 0;
+    int result = 0;
+
+    if (!workers || !threads) {
+        fprintf(stderr, "Erro ao alocar threads das partições\n");
+        free(workers);
+        free(threads);
+        return -1;
+    }
+
+    pthread_mutex_init(&team.lock, NULL);
+    pthread_cond_init(&team.wake, NULL);
+    pthread_cond_init(&team.idle, NULL);
+
+    for (; started < count; started++) {
+        workers[started] = (multirate_worker_t){.team = &team, .index = started};
+        if (pthread_create(&threads[started], NULL, multirate_worker, &workers[started]) != 0) {
+            fprintf(stderr, "Erro ao criar thread da partição %d\n", started);
+            result = -1;
+            break;
+        }
+    }
+
+    while (result == 0 && multirate->time < end) {
+        double window = multirate_window_end(multirate, end, sync_interval);
+        if (multirate_exchange(multirate, sync, context) < 0) {
+            result = -1;
+            break;
+        }
+
+        pthread_mutex_lock(&team.lock);
+        team.window_end = window;
+        team.pending = count;
+        team.generation++;
+        pthread_cond_broadcast(&team.wake);
+        while (team.pending > 0) {
+            pthread_cond_wait(&team.idle, &team.lock);
+        }
+        pthread_mutex_unlock(&team.lock);
+
+        for (int p = 0; p < count; p++) {
+            if (multirate->partitions[p].result < 0) {
+                result = -1;
+            }
+        }
+        multirate->time = window;
+    }
+
+    pthread_mutex_lock(&team.lock);
+    team.stop = true;
+    pthread_cond_broadcast(&team.wake);
+    pthread_mutex_unlock(&team.lock);
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    pthread_cond_destroy(&team.idle);
+    pthread_cond_destroy(&team.wake);
+    pthread_mutex_destroy(&team.lock);
+    free(workers);
+    free(threads);
+    return result;
+}
+
+int multirate_run(multirate_t* multirate, double duration, double sync_interval,
+                  multirate_sync_t sync, void* context) {
+    if (!multirate || duration < 0.0 || sync_interval <= 0.0) {
+        return -1;
+    }
+
+    double end = multirate->time + duration;
+
+    if (multirate->threaded && multirate->partition_count > 1) {
+        return multirate_run_threaded(multirate, end, sync_interval, sync, context);
+    }
+
+    while (multirate->time < end) {
+        double window = multirate_window_end(multirate, end, sync_interval);
+        if (multirate_exchange(multirate, sync, context) < 0) {
+            return -1;
+        }
+        for (int p = 0; p < multirate->partition_count; p++) {
+            if (multirate_advance(multirate, &multirate->partitions[p], window) < 0) {
+                return -1;
+            }
+        }
+        multirate->time = window;
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Consultas                                                              */
+/* ---------------------------------------------------------------------- */
+
+int multirate_partition_of(const multirate_t* multirate, int node) {
+    if (!multirate || node < 0 || node >= multirate->node_count) {
+        return -1;
+    }
+    return multirate->node_partition[node];
+}
+
+double multirate_voltage(const multirate_t* multirate, int node) {
+    int partition = multirate_partition_of(multirate, node);
+    if (partition < 0) {
+        return 0.0;
+    }
+    return circuit_voltage(&multirate->partitions[partition].circuit, multirate->node_local[node]);
+}
+
+int multirate_set_source(multirate_t* multirate, int element, double value) {
+    if (!multirate || element < 0 || element >= multirate->element_count ||
+        multirate->element_partition[element] < 0) {
+        return -1;
+    }
+    return circuit_set_source(&multirate->partitions[multirate->element_partition[element]].circuit,
+                              multirate->element_local[element], value);
+}
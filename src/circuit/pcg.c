@@ -0,0 +1,295 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "circuit/pcg.h"
+
+static int pcg_compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int pcg_init(pcg_t* pcg, int n, const int* rows, const int* cols, int count) {
+    if (!pcg || n < 0 || count < 0 || (count > 0 && (!rows || !cols))) {
+        return -1;
+    }
+
+    memset(pcg, 0, sizeof(*pcg));
+    pcg->n = n;
+    pcg->tolerance = PCG_DEFAULT_TOLERANCE;
+    pcg->max_iterations = PCG_DEFAULT_MAX_ITERATIONS;
+    pcg->warm_start = true;
+
+    for (int p = 0; p < count; p++) {
+        if (rows[p] < 0 || rows[p] >= n || cols[p] < 0 || cols[p] >= n) {
+            fprintf(stderr, "Elemento (%d, %d) fora da matriz %d×%d\n", rows[p], cols[p], n, n);
+            return -1;
+        }
+    }
+
+    int* cursor = malloc((n ? n : 1) * sizeof(int));
+    pcg->row_start = calloc(n + 1, sizeof(int));
+    pcg->cols = malloc((count + n ? count + n : 1) * sizeof(int));
+    if (!cursor || !pcg->row_start || !pcg->cols) {
+        fprintf(stderr, "Erro ao alocar padrão do gradiente conjugado\n");
+        free(cursor);
+        pcg_free(pcg);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        pcg->row_start[i + 1]++;
+    }
+    for (int p = 0; p < count; p++) {
+        pcg->row_start[(rows[p] > cols[p] ? rows[p] : cols[p]) + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        pcg->row_start[i + 1] += pcg->row_start[i];
+    }
+
+    memcpy(cursor, pcg->row_start, n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        pcg->cols[cursor[i]++] = i;
+    }
+    for (int p = 0; p < count; p++) {
+        int row = rows[p] > cols[p] ? rows[p] : cols[p];
+        pcg->cols[cursor[row]++] = rows[p] < cols[p] ? rows[p] : cols[p];
+    }
+
+    // Ordena cada linha e tira as repetições, compactando no lugar
+    int write = 0;
+    for (int i = 0; i < n; i++) {
+        int start = pcg->row_start[i];
+        int end = pcg->row_start[i + 1];
+        qsort(&pcg->cols[start], end - start, sizeof(int), pcg_compare_ints);
+        pcg->row_start[i] = write;
+        for (int p = start; p < end; p++) {
+            if (p == start || pcg->cols[p] != pcg->cols[p - 1]) {
+                pcg->cols[write++] = pcg->cols[p];
+            }
+        }
+    }
+    pcg->row_start[n] = write;
+    free(cursor);
+
+    size_t vector = (n ? n : 1) * sizeof(double);
+    pcg->values = calloc(write ? write : 1, sizeof(double));
+    pcg->factor = calloc(write ? write : 1, sizeof(double));
+    pcg->diagonal = malloc((n ? n : 1) * sizeof(int));
+    pcg->x = calloc(1, vector);
+    pcg->r = malloc(vector);
+    pcg->z = malloc(vector);
+    pcg->p = malloc(vector);
+    pcg->q = malloc(vector);
+    if (!pcg->values || !pcg->factor || !pcg->diagonal || !pcg->x || !pcg->r || !pcg->z || !pcg->p ||
+        !pcg->q) {
+        fprintf(stderr, "Erro ao alocar gradiente conjugado\n");
+        pcg_free(pcg);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        pcg->diagonal[i] = pcg->row_start[i + 1] - 1;
+    }
+    return 0;
+}
+
+void pcg_free(pcg_t* pcg) {
+    if (!pcg) {
+        return;
+    }
+
+    free(pcg->row_start);
+    free(pcg->cols);
+    free(pcg->values);
+    free(pcg->diagonal);
+    free(pcg->factor);
+    free(pcg->x);
+    free(pcg->r);
+    free(pcg->z);
+    free(pcg->p);
+    free(pcg->q);
+    memset(pcg, 0, sizeof(*pcg));
+}
+
+int pcg_slot(const pcg_t* pcg, int i, int j) {
+    if (!pcg || i < 0 || j < 0 || i >= pcg->n || j >= pcg->n) {
+        return -1;
+    }
+
+    int row = i > j ? i : j;
+    int col = i < j ? i : j;
+    int* found = bsearch(&col, &pcg->cols[pcg->row_start[row]], pcg->row_start[row + 1] - pcg->row_start[row],
+                         sizeof(int), pcg_compare_ints);
+    return found ? (int)(found - pcg->cols) : -1;
+}
+
+int pcg_nonzeros(const pcg_t* pcg) {
+    return pcg && pcg->row_start ? pcg->row_start[pcg->n] : 0;
+}
+
+// L = raiz da diagonal de A, ou seja, pré-condicionador de Jacobi
+static int pcg_factor_jacobi(pcg_t* pcg) {
+    memset(pcg->factor, 0, pcg->row_start[pcg->n] * sizeof(double));
+    for (int i = 0; i < pcg->n; i++) {
+        double diagonal = pcg->values[pcg->diagonal[i]];
+        if (diagonal <= 0.0) {
+            fprintf(stderr, "Matriz do gradiente conjugado não é definida positiva (linha %d)\n", i);
+            return -1;
+        }
+        pcg->factor[pcg->diagonal[i]] = sqrt(diagonal);
+    }
+
+    pcg->jacobi = true;
+    return 0;
+}
+
+// L(i,k) = (A(i,k) - Σ L(i,m)·L(k,m)) / L(k,k), só nas posições de A
+int pcg_factor(pcg_t* pcg) {
+    if (!pcg) {
+        return -1;
+    }
+
+    pcg->jacobi = false;
+
+    for (int i = 0; i < pcg->n; i++) {
+        for (int p = pcg->row_start[i]; p < pcg->row_start[i + 1]; p++) {
+            int k = pcg->cols[p];
+            double sum = pcg->values[p];
+
+            // Produto das linhas i e k nas colunas m < k comuns às duas
+            int pi = pcg->row_start[i];
+            int pk = pcg->row_start[k];
+            while (pi < p && pk < pcg->diagonal[k]) {
+                if (pcg->cols[pi] == pcg->cols[pk]) {
+                    sum -= pcg->factor[pi++] * pcg->factor[pk++];
+                } else if (pcg->cols[pi] < pcg->cols[pk]) {
+                    pi++;
+                } else {
+                    pk++;
+                }
+            }
+
+            if (k < i) {
+                pcg->factor[p] = sum / pcg->factor[pcg->diagonal[k]];
+                continue;
+            }
+
+            // Matriz de condutâncias é uma M-matriz e o IC(0) não quebra;
+            // se quebrar, o pré-condicionador inteiro passa a ser Jacobi
+            if (sum <= 0.0) {
+                return pcg_factor_jacobi(pcg);
+            }
+            pcg->factor[p] = sqrt(sum);
+        }
+    }
+
+    return 0;
+}
+
+// y = A·x com A simétrica guardada pelo triângulo inferior
+static void pcg_multiply(const pcg_t* pcg, const double* x, double* y) {
+    memset(y, 0, pcg->n * sizeof(double));
+    for (int i = 0; i < pcg->n; i++) {
+        for (int p = pcg->row_start[i]; p < pcg->diagonal[i]; p++) {
+            int j = pcg->cols[p];
+            y[i] += pcg->values[p] * x[j];
+            y[j] += pcg->values[p] * x[i];
+        }
+        y[i] += pcg->values[pcg->diagonal[i]] * x[i];
+    }
+}
+
+// z = (L·Lᵀ)⁻¹·r
+static void pcg_precondition(const pcg_t* pcg, const double* r, double* z) {
+    const double* l = pcg->factor;
+
+    for (int i = 0; i < pcg->n; i++) {
+        double sum = r[i];
+        for (int p = pcg->row_start[i]; p < pcg->diagonal[i]; p++) {
+            sum -= l[p] * z[pcg->cols[p]];
+        }
+        z[i] = sum / l[pcg->diagonal[i]];
+    }
+    for (int i = pcg->n - 1; i >= 0; i--) {
+        z[i] /= l[pcg->diagonal[i]];
+        for (int p = pcg->row_start[i]; p < pcg->diagonal[i]; p++) {
+            z[pcg->cols[p]] -= l[p] * z[i];
+        }
+    }
+}
+
+static double pcg_dot(const double* a, const double* b, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+int pcg_solve(pcg_t* pcg, double* b) {
+    if (!pcg || !b) {
+        return -1;
+    }
+
+    int n = pcg->n;
+    double* x = pcg->x;
+    double* r = pcg->r;
+    double* z = pcg->z;
+    double* p = pcg->p;
+    double* q = pcg->q;
+
+    if (!pcg->warm_start) {
+        memset(x, 0, n * sizeof(double));
+    }
+
+    double norm = sqrt(pcg_dot(b, b, n));
+    pcg->iterations = 0;
+    pcg->residual = 0.0;
+    if (norm == 0.0) {
+        memset(x, 0, n * sizeof(double));
+        return 0;
+    }
+
+    pcg_multiply(pcg, x, r);
+    for (int i = 0; i < n; i++) {
+        r[i] = b[i] - r[i];
+    }
+    pcg_precondition(pcg, r, z);
+    memcpy(p, z, n * sizeof(double));
+    double rz = pcg_dot(r, z, n);
+
+    for (;;) {
+        pcg->residual = sqrt(pcg_dot(r, r, n)) / norm;
+        if (pcg->residual <= pcg->tolerance) {
+            break;
+        }
+        if (pcg->iterations == pcg->max_iterations) {
+            fprintf(stderr, "Gradiente conjugado não convergiu em %d iterações (resíduo %g)\n",
+                    pcg->iterations, pcg->residual);
+            return -1;
+        }
+
+        pcg_multiply(pcg, p, q);
+        double alpha = rz / pcg_dot(p, q, n);
+        for (int i = 0; i < n; i++) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+
+        pcg_precondition(pcg, r, z);
+        double next = pcg_dot(r, z, n);
+        double beta = next / rz;
+        rz = next;
+        for (int i = 0; i < n; i++) {
+            p[i] = z[i] + beta * p[i];
+        }
+
+        pcg->iterations++;
+        pcg->iteration_count++;
+    }
+
+    memcpy(b, x, n * sizeof(double));
+    return 0;
+}
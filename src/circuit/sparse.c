@@ -0,0 +1,640 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "circuit/sparse.h"
+
+typedef struct {
+    sparse_t* sparse;
+    const int* adjacency_start;
+    const int* adjacency;
+    int* owner;                 // marca do subgrafo em que o nó está
+    int* level;
+    int* queue;
+    int* buffer;
+    int stamp;
+} sparse_dissect_t;
+
+typedef struct {
+    sparse_t* sparse;
+    int domain;
+    int depth;
+} sparse_task_t;
+
+static int sparse_compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Dissecção aninhada                                                     */
+/* ---------------------------------------------------------------------- */
+
+static int sparse_add_domain(sparse_t* sparse) {
+    if (sparse->domain_count == sparse->domain_capacity) {
+        int capacity = sparse->domain_capacity ? sparse->domain_capacity * 2 : 16;
+        sparse_domain_t* domains = realloc(sparse->domains, capacity * sizeof(sparse_domain_t));
+        if (!domains) {
+            fprintf(stderr, "Erro ao alocar árvore de dissecção\n");
+            return -1;
+        }
+        sparse->domains = domains;
+        sparse->domain_capacity = capacity;
+    }
+    return sparse->domain_count++;
+}
+
+// Busca em largura dentro do subgrafo marcado; os nós alcançados entram na
+// fila a partir de queue[offset] e o retorno é quantos foram
+static int sparse_bfs(sparse_dissect_t* d, int start, int offset) {
+    int head = offset;
+    int tail = offset;
+
+    d->level[start] = 0;
+    d->queue[tail++] = start;
+    while (head < tail) {
+        int v = d->queue[head++];
+        for (int p = d->adjacency_start[v]; p < d->adjacency_start[v + 1]; p++) {
+            int w = d->adjacency[p];
+            if (d->owner[w] == d->stamp && d->level[w] < 0) {
+                d->level[w] = d->level[v] + 1;
+                d->queue[tail++] = w;
+            }
+        }
+    }
+    return tail - offset;
+}
+
+// Divide nodes em [esquerda | direita | separador]: por componentes se o
+// subgrafo é desconexo, senão pelo nível do meio de uma busca em largura a
+// partir de um nó pseudo-periférico. Retorna 0 se não há divisão útil.
+static int sparse_split(sparse_dissect_t* d, int* nodes, int count, int* left_count, int* right_count) {
+    d->stamp++;
+    for (int k = 0; k < count; k++) {
+        d->owner[nodes[k]] = d->stamp;
+        d->level[nodes[k]] = -1;
+    }
+
+    int reached = sparse_bfs(d, nodes[0], 0);
+    int mid;
+
+    if (reached < count) {
+        // Junta componentes inteiros até metade, sem pegar todos
+        int last_start = 0;
+        int last_size = reached;
+        for (int k = 0; k < count && reached < count / 2; k++) {
+            if (d->level[nodes[k]] < 0) {
+                last_start = reached;
+                last_size = sparse_bfs(d, nodes[k], reached);
+                reached += last_size;
+            }
+        }
+        if (reached == count) {
+            for (int k = last_start; k < last_start + last_size; k++) {
+                d->level[d->queue[k]] = -1;
+            }
+        }
+        mid = -1;
+    } else {
+        int far = d->queue[count - 1];
+        for (int k = 0; k < count; k++) {
+            d->level[nodes[k]] = -1;
+        }
+        sparse_bfs(d, far, 0);
+
+        int depth = d->level[d->queue[count - 1]];
+        if (depth < 2) {
+            return 0;
+        }
+        mid = d->level[d->queue[count / 2]];
+        if (mid < 1) {
+            mid = 1;
+        } else if (mid > depth - 1) {
+            mid = depth - 1;
+        }
+    }
+
+    // Sem separador (mid -1) a esquerda é o que foi alcançado
+    int l = 0;
+    int r = 0;
+    int s = 0;
+    for (int k = 0; k < count; k++) {
+        int level = d->level[nodes[k]];
+        if (mid < 0 ? level >= 0 : level < mid) {
+            l++;
+        } else if (mid < 0 || level > mid) {
+            r++;
+        } else {
+            s++;
+        }
+    }
+
+    int left = 0;
+    int right = l;
+    int separator = l + r;
+    for (int k = 0; k < count; k++) {
+        int level = d->level[nodes[k]];
+        if (mid < 0 ? level >= 0 : level < mid) {
+            d->buffer[left++] = nodes[k];
+        } else if (mid < 0 || level > mid) {
+            d->buffer[right++] = nodes[k];
+        } else {
+            d->buffer[separator++] = nodes[k];
+        }
+    }
+    memcpy(nodes, d->buffer, count * sizeof(int));
+
+    *left_count = l;
+    *right_count = r;
+    return s < count;
+}
+
+// Ordena nodes nas colunas [first, first + count) e retorna o domínio
+static int sparse_dissect(sparse_dissect_t* d, int* nodes, int count, int first) {
+    int left_count = 0;
+    int right_count = 0;
+    int left = -1;
+    int right = -1;
+    int separator = first;
+
+    if (count > SPARSE_LEAF_SIZE && sparse_split(d, nodes, count, &left_count, &right_count)) {
+        if (left_count > 0 && (left = sparse_dissect(d, nodes, left_count, first)) < 0) {
+            return -1;
+        }
+        if (right_count > 0 &&
+            (right = sparse_dissect(d, nodes + left_count, right_count, first + left_count)) < 0) {
+            return -1;
+        }
+        separator = first + left_count + right_count;
+    }
+
+    int index = sparse_add_domain(d->sparse);
+    if (index < 0) {
+        return -1;
+    }
+    d->sparse->domains[index] = (sparse_domain_t){
+        .first = first,
+        .separator = separator,
+        .end = first + count,
+        .left = left,
+        .right = right,
+        .failed = -1,
+    };
+    return index;
+}
+
+static int sparse_order(sparse_t* sparse, const int* rows, const int* cols, int count) {
+    int n = sparse->n;
+    int result = -1;
+    sparse_dissect_t d = {.sparse = sparse};
+    int* degree = calloc(n + 1, sizeof(int));
+    int* adjacency = malloc((count ? 2 * count : 1) * sizeof(int));
+
+    d.owner = calloc(n, sizeof(int));
+    d.level = malloc(n * sizeof(int));
+    d.queue = malloc(n * sizeof(int));
+    d.buffer = malloc(n * sizeof(int));
+    if (!degree || !adjacency || !d.owner || !d.level || !d.queue || !d.buffer) {
+        fprintf(stderr, "Erro ao alocar ordenação da matriz esparsa\n");
+        goto out;
+    }
+
+    for (int p = 0; p < count; p++) {
+        if (rows[p] != cols[p]) {
+            degree[rows[p] + 1]++;
+            degree[cols[p] + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        degree[i + 1] += degree[i];
+    }
+    // degree vira o início das listas; d.buffer serve de cursor
+    memcpy(d.buffer, degree, n * sizeof(int));
+    for (int p = 0; p < count; p++) {
+        if (rows[p] != cols[p]) {
+            adjacency[d.buffer[rows[p]]++] = cols[p];
+            adjacency[d.buffer[cols[p]]++] = rows[p];
+        }
+    }
+    d.adjacency_start = degree;
+    d.adjacency = adjacency;
+
+    for (int i = 0; i < n; i++) {
+        sparse->perm[i] = i;
+    }
+    sparse->root = sparse_dissect(&d, sparse->perm, n, 0);
+    if (sparse->root < 0) {
+        goto out;
+    }
+    for (int k = 0; k < n; k++) {
+        sparse->inverse[sparse->perm[k]] = k;
+    }
+    result = 0;
+
+out:
+    free(degree);
+    free(adjacency);
+    free(d.owner);
+    free(d.level);
+    free(d.queue);
+    free(d.buffer);
+    return result;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Análise simbólica                                                      */
+/* ---------------------------------------------------------------------- */
+
+// Padrão da matriz permutada: só o triângulo superior, diagonal incluída
+static int sparse_pattern(sparse_t* sparse, const int* rows, const int* cols, int count) {
+    int n = sparse->n;
+    int* cursor = malloc(n * sizeof(int));
+
+    sparse->columns = calloc(n + 1, sizeof(int));
+    sparse->rows = malloc((count + n) * sizeof(int));
+    if (!cursor || !sparse->columns || !sparse->rows) {
+        fprintf(stderr, "Erro ao alocar padrão da matriz esparsa\n");
+        free(cursor);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        sparse->columns[i + 1]++;
+    }
+    for (int p = 0; p < count; p++) {
+        int i = sparse->inverse[rows[p]];
+        int j = sparse->inverse[cols[p]];
+        sparse->columns[(i > j ? i : j) + 1]++;
+    }
+    for (int k = 0; k < n; k++) {
+        sparse->columns[k + 1] += sparse->columns[k];
+    }
+
+    memcpy(cursor, sparse->columns, n * sizeof(int));
+    for (int k = 0; k < n; k++) {
+        sparse->rows[cursor[k]++] = k;
+    }
+    for (int p = 0; p < count; p++) {
+        int i = sparse->inverse[rows[p]];
+        int j = sparse->inverse[cols[p]];
+        sparse->rows[cursor[i > j ? i : j]++] = i < j ? i : j;
+    }
+
+    // Ordena cada coluna e tira as repetições, compactando no lugar
+    int write = 0;
+    for (int k = 0; k < n; k++) {
+        int start = sparse->columns[k];
+        int end = sparse->columns[k + 1];
+        qsort(&sparse->rows[start], end - start, sizeof(int), sparse_compare_ints);
+        sparse->columns[k] = write;
+        for (int p = start; p < end; p++) {
+            if (p == start || sparse->rows[p] != sparse->rows[p - 1]) {
+                sparse->rows[write++] = sparse->rows[p];
+            }
+        }
+    }
+    sparse->columns[n] = write;
+    free(cursor);
+
+    sparse->values = calloc(write ? write : 1, sizeof(double));
+    sparse->diagonal = malloc(n * sizeof(int));
+    if (!sparse->values || !sparse->diagonal) {
+        fprintf(stderr, "Erro ao alocar valores da matriz esparsa\n");
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        sparse->diagonal[i] = sparse_slot(sparse, i, i);
+    }
+    return 0;
+}
+
+static void sparse_etree(sparse_t* sparse, int* ancestor) {
+    for (int k = 0; k < sparse->n; k++) {
+        sparse->parent[k] = -1;
+        ancestor[k] = -1;
+        for (int p = sparse->columns[k]; p < sparse->columns[k + 1]; p++) {
+            int next;
+            for (int i = sparse->rows[p]; i != -1 && i < k; i = next) {
+                next = ancestor[i];
+                ancestor[i] = k;
+                if (next == -1) {
+                    sparse->parent[i] = k;
+                }
+            }
+        }
+    }
+}
+
+// Colunas j < k com L(k, j) != 0, em ordem topológica, em stack[top, k).
+// Todas descendem de k, então caem em [base, k) quando base é o início do
+// domínio de k: domínios em paralelo não dividem stack nem mark.
+static int sparse_ereach(sparse_t* sparse, int k, int base) {
+    int* stack = sparse->stack;
+    int top = k;
+
+    sparse->mark[k] = true;
+    for (int p = sparse->columns[k]; p < sparse->columns[k + 1]; p++) {
+        int i = sparse->rows[p];
+        int length = base;
+        for (; !sparse->mark[i]; i = sparse->parent[i]) {
+            stack[length++] = i;
+            sparse->mark[i] = true;
+        }
+        while (length > base) {
+            stack[--top] = stack[--length];
+        }
+    }
+
+    for (int p = top; p < k; p++) {
+        sparse->mark[stack[p]] = false;
+    }
+    sparse->mark[k] = false;
+    return top;
+}
+
+static int sparse_symbolic(sparse_t* sparse) {
+    int n = sparse->n;
+    int* ancestor = malloc(n * sizeof(int));
+
+    sparse->parent = malloc(n * sizeof(int));
+    sparse->factor_columns = calloc(n + 1, sizeof(int));
+    sparse->next = malloc(n * sizeof(int));
+    sparse->work = calloc(n, sizeof(double));
+    sparse->stack = malloc(n * sizeof(int));
+    sparse->mark = calloc(n, sizeof(bool));
+    if (!ancestor || !sparse->parent || !sparse->factor_columns || !sparse->next || !sparse->work ||
+        !sparse->stack || !sparse->mark) {
+        fprintf(stderr, "Erro ao alocar análise da matriz esparsa\n");
+        free(ancestor);
+        return -1;
+    }
+
+    sparse_etree(sparse, ancestor);
+    free(ancestor);
+
+    // Contagem por coluna: a linha k contribui com um elemento em cada
+    // coluna do seu padrão, mais a diagonal
+    for (int k = 0; k < n; k++) {
+        int top = sparse_ereach(sparse, k, 0);
+        for (int p = top; p < k; p++) {
+            sparse->factor_columns[sparse->stack[p] + 1]++;
+        }
+        sparse->factor_columns[k + 1]++;
+    }
+    for (int k = 0; k < n; k++) {
+        sparse->factor_columns[k + 1] += sparse->factor_columns[k];
+    }
+
+    int nonzeros = sparse->factor_columns[n];
+    sparse->factor_rows = malloc((nonzeros ? nonzeros : 1) * sizeof(int));
+    sparse->factor_values = malloc((nonzeros ? nonzeros : 1) * sizeof(double));
+    if (!sparse->factor_rows || !sparse->factor_values) {
+        fprintf(stderr, "Erro ao alocar fator da matriz esparsa\n");
+        return -1;
+    }
+    return 0;
+}
+
+int sparse_init(sparse_t* sparse, int n, const int* rows, const int* cols, int count) {
+    if (!sparse || n < 0 || count < 0 || (count > 0 && (!rows || !cols))) {
+        return -1;
+    }
+
+    memset(sparse, 0, sizeof(*sparse));
+    sparse->n = n;
+    sparse->root = -1;
+    sparse->failed = -1;
+
+    for (int p = 0; p < count; p++) {
+        if (rows[p] < 0 || rows[p] >= n || cols[p] < 0 || cols[p] >= n) {
+            fprintf(stderr, "Elemento (%d, %d) fora da matriz esparsa %d×%d\n", rows[p], cols[p], n, n);
+            return -1;
+        }
+    }
+
+    sparse->perm = malloc((n ? n : 1) * sizeof(int));
+    sparse->inverse = malloc((n ? n : 1) * sizeof(int));
+    if (!sparse->perm || !sparse->inverse) {
+        fprintf(stderr, "Erro ao alocar matriz esparsa\n");
+        sparse_free(sparse);
+        return -1;
+    }
+
+    if ((n > 0 && sparse_order(sparse, rows, cols, count) < 0) ||
+        sparse_pattern(sparse, rows, cols, count) < 0 || sparse_symbolic(sparse) < 0) {
+        sparse_free(sparse);
+        return -1;
+    }
+
+    return 0;
+}
+
+void sparse_free(sparse_t* sparse) {
+    if (!sparse) {
+        return;
+    }
+
+    free(sparse->columns);
+    free(sparse->rows);
+    free(sparse->values);
+    free(sparse->diagonal);
+    free(sparse->perm);
+    free(sparse->inverse);
+    free(sparse->parent);
+    free(sparse->domains);
+    free(sparse->factor_columns);
+    free(sparse->factor_rows);
+    free(sparse->factor_values);
+    free(sparse->next);
+    free(sparse->work);
+    free(sparse->stack);
+    free(sparse->mark);
+    memset(sparse, 0, sizeof(*sparse));
+}
+
+int sparse_slot(const sparse_t* sparse, int i, int j) {
+    if (!sparse || i < 0 || j < 0 || i >= sparse->n || j >= sparse->n) {
+        return -1;
+    }
+
+    int row = sparse->inverse[i];
+    int column = sparse->inverse[j];
+    if (row > column) {
+        int swap = row;
+        row = column;
+        column = swap;
+    }
+
+    int* found = bsearch(&row, &sparse->rows[sparse->columns[column]],
+                         sparse->columns[column + 1] - sparse->columns[column], sizeof(int),
+                         sparse_compare_ints);
+    return found ? (int)(found - sparse->rows) : -1;
+}
+
+int sparse_nonzeros(const sparse_t* sparse) {
+    return sparse && sparse->factor_columns ? sparse->factor_columns[sparse->n] : 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Fatoração numérica                                                     */
+/* ---------------------------------------------------------------------- */
+
+// Cholesky por linhas (up-looking) das linhas [first, end): a linha k só lê
+// e escreve colunas descendentes de k, todas dentro de [base, k]
+static int sparse_factor_rows(sparse_t* sparse, int base, int first, int end) {
+    double* x = sparse->work;
+    const int* lp = sparse->factor_columns;
+    int* li = sparse->factor_rows;
+    double* lx = sparse->factor_values;
+
+    for (int k = first; k < end; k++) {
+        int top = sparse_ereach(sparse, k, base);
+
+        for (int p = sparse->columns[k]; p < sparse->columns[k + 1]; p++) {
+            x[sparse->rows[p]] = sparse->values[p];
+        }
+        double d = x[k];
+        x[k] = 0.0;
+
+        for (int s = top; s < k; s++) {
+            int j = sparse->stack[s];
+            double lkj = x[j] / lx[lp[j]];
+            x[j] = 0.0;
+            for (int p = lp[j] + 1; p < sparse->next[j]; p++) {
+                x[li[p]] -= lx[p] * lkj;
+            }
+            d -= lkj * lkj;
+
+            int p = sparse->next[j]++;
+            li[p] = k;
+            lx[p] = lkj;
+        }
+
+        if (d <= 0.0) {
+            return sparse->perm[k];
+        }
+        int p = sparse->next[k]++;
+        li[p] = k;
+        lx[p] = sqrt(d);
+    }
+
+    return -1;
+}
+
+static int sparse_factor_domain(sparse_t* sparse, int index, int depth);
+
+static void* sparse_task(void* arg) {
+    sparse_task_t* task = arg;
+    sparse_factor_domain(task->sparse, task->domain, task->depth);
+    return NULL;
+}
+
+// Fatora os dois subdomínios, o da esquerda numa thread nova enquanto houver
+// profundidade para isso, e depois as linhas do separador
+static int sparse_factor_domain(sparse_t* sparse, int index, int depth) {
+    sparse_domain_t* domain = &sparse->domains[index];
+    int failed = -1;
+
+    if (domain->left >= 0 && domain->right >= 0 && depth > 0 &&
+        domain->end - domain->first >= SPARSE_MIN_PARALLEL_COLUMNS) {
+        pthread_t thread;
+        sparse_task_t task = {.sparse = sparse, .domain = domain->left, .depth = depth - 1};
+        bool forked = pthread_create(&thread, NULL, sparse_task, &task) == 0;
+
+        if (!forked) {
+            sparse_factor_domain(sparse, domain->left, depth - 1);
+        }
+        sparse_factor_domain(sparse, domain->right, depth - 1);
+        if (forked) {
+            pthread_join(thread, NULL);
+        }
+        failed = sparse->domains[domain->left].failed;
+        if (failed < 0) {
+            failed = sparse->domains[domain->right].failed;
+        }
+    } else {
+        if (domain->left >= 0) {
+            failed = sparse_factor_domain(sparse, domain->left, depth);
+        }
+        if (failed < 0 && domain->right >= 0) {
+            failed = sparse_factor_domain(sparse, domain->right, depth);
+        }
+    }
+
+    if (failed < 0) {
+        failed = sparse_factor_rows(sparse, domain->first, domain->separator, domain->end);
+    }
+    domain->failed = failed;
+    return failed;
+}
+
+int sparse_factor(sparse_t* sparse) {
+    if (!sparse) {
+        return -1;
+    }
+
+    sparse->failed = -1;
+    if (sparse->n == 0) {
+        return 0;
+    }
+
+    memcpy(sparse->next, sparse->factor_columns, sparse->n * sizeof(int));
+
+    int threads = sparse->thread_count;
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    int depth = 0;
+    while ((1 << depth) < threads) {
+        depth++;
+    }
+
+    sparse->failed = sparse_factor_domain(sparse, sparse->root, depth);
+    sparse->factor_count++;
+    if (sparse->failed >= 0) {
+        // O que ficou pela metade não é reaproveitado
+        memset(sparse->work, 0, sparse->n * sizeof(double));
+        return -1;
+    }
+    return 0;
+}
+
+void sparse_solve(sparse_t* sparse, double* b) {
+    if (!sparse || !b) {
+        return;
+    }
+
+    int n = sparse->n;
+    double* y = sparse->work;
+    const int* lp = sparse->factor_columns;
+    const int* li = sparse->factor_rows;
+    const double* lx = sparse->factor_values;
+
+    for (int k = 0; k < n; k++) {
+        y[k] = b[sparse->perm[k]];
+    }
+    // L·z = y
+    for (int j = 0; j < n; j++) {
+        y[j] /= lx[lp[j]];
+        for (int p = lp[j] + 1; p < lp[j + 1]; p++) {
+            y[li[p]] -= lx[p] * y[j];
+        }
+    }
+    // Lᵀ·x = z
+    for (int j = n - 1; j >= 0; j--) {
+        for (int p = lp[j] + 1; p < lp[j + 1]; p++) {
+            y[j] -= lx[p] * y[li[p]];
+        }
+        y[j] /= lx[lp[j]];
+    }
+    for (int k = 0; k < n; k++) {
+        b[sparse->perm[k]] = y[k];
+        y[k] = 0.0;
+    }
+}
@@ -0,0 +1,1603 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/arm_core.h"
+
+#define ARM_COND_ALWAYS 0xE
+
+enum { ARM_SHIFT_LSL = 0, ARM_SHIFT_LSR, ARM_SHIFT_ASR, ARM_SHIFT_ROR, ARM_SHIFT_RRX };
+
+static inline int32_t sign_extend(uint32_t value, int bits) {
+    uint32_t mask = 1u << (bits - 1);
+    return (int32_t)((value ^ mask) - mask);
+}
+
+static inline uint32_t ror32(uint32_t value, int n) {
+    n &= 31;
+    return n ? (value >> n) | (value << (32 - n)) : value;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Decodificação                                                          */
+/* ---------------------------------------------------------------------- */
+
+static arm_insn_t arm_insn(arm_insn_op_t op, arm_op_t cls) {
+    arm_insn_t insn = { .op = op, .cls = cls, .length = 2, .cond = ARM_COND_ALWAYS };
+    return insn;
+}
+
+static arm_insn_t arm_undefined(void) {
+    return arm_insn(ARM_I_UNDEFINED, ARM_OP_NOP);
+}
+
+static arm_insn_t arm_dp_imm(arm_insn_op_t op, int rd, int rn, uint32_t imm, uint16_t flags) {
+    arm_insn_t insn = arm_insn(op, ARM_OP_ALU);
+    insn.rd = rd;
+    insn.rn = rn;
+    insn.imm = imm;
+    insn.flags = ARM_INSN_IMM | flags;
+    return insn;
+}
+
+// DecodeImmShift: LSR/ASR #0 significam 32 e ROR #0 é RRX
+static void arm_imm_shift(arm_insn_t* insn, int type, int imm5) {
+    if (type == ARM_SHIFT_ROR && imm5 == 0) {
+        insn->shift_type = ARM_SHIFT_RRX;
+        insn->shift_n = 1;
+    } else {
+        insn->shift_type = type;
+        insn->shift_n = (imm5 == 0 && type != ARM_SHIFT_LSL) ? 32 : imm5;
+    }
+}
+
+static arm_insn_t arm_dp_reg(arm_insn_op_t op, int rd, int rn, int rm, int type, int imm5, uint16_t flags) {
+    arm_insn_t insn = arm_insn(op, ARM_OP_ALU);
+    insn.rd = rd;
+    insn.rn = rn;
+    insn.rm = rm;
+    insn.flags = flags;
+    arm_imm_shift(&insn, type, imm5);
+    return insn;
+}
+
+static arm_insn_t arm_mem(arm_insn_op_t op, int rt, int rn, int size, uint32_t imm, uint16_t flags) {
+    arm_insn_t insn = arm_insn(op, op == ARM_I_STORE || op == ARM_I_STORED ? ARM_OP_STORE : ARM_OP_LOAD);
+    insn.rd = rt;
+    insn.rn = rn;
+    insn.size = size;
+    insn.imm = imm;
+    insn.flags = flags;
+    if (rn == ARM_REG_PC) {
+        insn.flags |= ARM_INSN_ALIGN_PC;
+    }
+    return insn;
+}
+
+static arm_insn_t arm_multiple(bool load, int rn, uint32_t list, uint16_t flags) {
+    arm_insn_t insn = arm_insn(load ? ARM_I_LDM : ARM_I_STM,
+                               load ? ARM_OP_LOAD_MULTIPLE : ARM_OP_STORE_MULTIPLE);
+    insn.rn = rn;
+    insn.imm = list;
+    insn.flags = flags;
+    return insn;
+}
+
+static arm_insn_t arm_branch(arm_insn_op_t op, int cond, int32_t offset) {
+    arm_insn_t insn = arm_insn(op, op == ARM_I_BL ? ARM_OP_BRANCH_LINK : ARM_OP_BRANCH);
+    insn.cond = cond;
+    insn.imm = (uint32_t)offset;
+    return insn;
+}
+
+static arm_insn_t arm_extend(int rd, int rn, int rm, int size, bool is_signed, int rotation) {
+    arm_insn_t insn = arm_insn(ARM_I_EXTEND, ARM_OP_ALU);
+    insn.rd = rd;
+    insn.rn = rn;
+    insn.rm = rm;
+    insn.size = size;
+    insn.shift_n = rotation;
+    insn.flags = is_signed ? ARM_INSN_SIGNED : 0;
+    return insn;
+}
+
+static arm_insn_t arm_unary(arm_insn_op_t op, int rd, int rm) {
+    arm_insn_t insn = arm_insn(op, ARM_OP_ALU);
+    insn.rd = rd;
+    insn.rm = rm;
+    return insn;
+}
+
+static arm_insn_t arm_hint(int hint) {
+    switch (hint) {
+        case 2:
+        case 3:
+            return arm_insn(ARM_I_NOP, ARM_OP_SLEEP);  // WFE, WFI
+        default:
+            return arm_insn(ARM_I_NOP, ARM_OP_NOP);    // NOP, YIELD, SEV
+    }
+}
+
+// ThumbExpandImm; rotated indica que o carry vem do bit 31 do resultado
+static uint32_t arm_expand_imm(uint32_t imm12, bool* rotated) {
+    uint32_t imm8 = imm12 & 0xFF;
+
+    if ((imm12 >> 10) == 0) {
+        *rotated = false;
+        switch ((imm12 >> 8) & 0x03) {
+            case 0: return imm8;
+            case 1: return imm8 * 0x00010001u;
+            case 2: return imm8 * 0x01000100u;
+            default: return imm8 * 0x01010101u;
+        }
+    }
+
+    *rotated = true;
+    return ror32(0x80 | (imm12 & 0x7F), imm12 >> 7);
+}
+
+static arm_insn_t arm_decode_misc16(uint16_t hw) {
+    int rd = hw & 0x07;
+    int rm = (hw >> 3) & 0x07;
+
+    switch (hw & 0x0F00) {
+        case 0x0000:
+            return arm_dp_imm((hw & 0x0080) ? ARM_I_SUB : ARM_I_ADD, ARM_REG_SP, ARM_REG_SP,
+                              (hw & 0x7F) * 4, 0);
+        case 0x0200: {
+            static const struct { uint8_t size; bool is_signed; } ext[] = {
+                { 2, true }, { 1, true }, { 2, false }, { 1, false }
+            };
+            int sel = (hw >> 6) & 0x03;
+            return arm_extend(rd, ARM_REG_PC, rm, ext[sel].size, ext[sel].is_signed, 0);
+        }
+        case 0x0400:
+        case 0x0500:
+            return arm_multiple(false, ARM_REG_SP, (hw & 0xFF) | ((hw & 0x0100) ? 1u << ARM_REG_LR : 0),
+                                ARM_INSN_DB | ARM_INSN_WBACK);
+        case 0x0600:
+            if ((hw & 0x00E8) == 0x0060) {
+                return arm_insn(ARM_I_NOP, ARM_OP_STATUS);  // CPS
+            }
+            return arm_undefined();
+        case 0x0A00:
+            switch ((hw >> 6) & 0x03) {
+                case 0: return arm_unary(ARM_I_REV, rd, rm);
+                case 1: return arm_unary(ARM_I_REV16, rd, rm);
+                case 3: return arm_unary(ARM_I_REVSH, rd, rm);
+                default: return arm_undefined();
+            }
+        case 0x0C00:
+        case 0x0D00:
+            return arm_multiple(true, ARM_REG_SP, (hw & 0xFF) | ((hw & 0x0100) ? 1u << ARM_REG_PC : 0),
+                                ARM_INSN_WBACK);
+        case 0x0E00: {
+            arm_insn_t insn = arm_insn(ARM_I_BKPT, ARM_OP_NOP);
+            insn.imm = hw & 0xFF;
+            return insn;
+        }
+        case 0x0F00:
+            if (hw & 0x000F) {
+                arm_insn_t insn = arm_insn(ARM_I_IT, ARM_OP_IT);
+                insn.imm = hw & 0xFF;
+                return insn;
+            }
+            return arm_hint((hw >> 4) & 0x0F);
+        default:
+            // CBZ/CBNZ: 1011 o0i1
+            if ((hw & 0x0500) == 0x0100) {
+                arm_insn_t insn = arm_insn(ARM_I_CBZ, ARM_OP_BRANCH);
+                insn.rn = rd;
+                insn.imm = ((hw >> 2) & 0x3E) | ((hw >> 3) & 0x40);
+                insn.flags = (hw & 0x0800) ? ARM_INSN_NONZERO : 0;
+                return insn;
+            }
+            return arm_undefined();
+    }
+}
+
+static arm_insn_t arm_decode16(uint16_t hw) {
+    int rd = hw & 0x07;
+    int rn = (hw >> 3) & 0x07;
+
+    switch (hw >> 11) {
+        case 0x00:
+        case 0x01:
+        case 0x02:
+            // LSL/LSR/ASR imediatos são MOV com deslocamento
+            return arm_dp_reg(ARM_I_MOV, rd, 0, rn, hw >> 11, (hw >> 6) & 0x1F, ARM_INSN_S_OUT_IT);
+        case 0x03: {
+            arm_insn_op_t op = (hw & 0x0200) ? ARM_I_SUB : ARM_I_ADD;
+            if (hw & 0x0400) {
+                return arm_dp_imm(op, rd, rn, (hw >> 6) & 0x07, ARM_INSN_S_OUT_IT);
+            }
+            return arm_dp_reg(op, rd, rn, (hw >> 6) & 0x07, ARM_SHIFT_LSL, 0, ARM_INSN_S_OUT_IT);
+        }
+        case 0x04: return arm_dp_imm(ARM_I_MOV, (hw >> 8) & 0x07, 0, hw & 0xFF, ARM_INSN_S_OUT_IT);
+        case 0x05: return arm_dp_imm(ARM_I_CMP, 0, (hw >> 8) & 0x07, hw & 0xFF, 0);
+        case 0x06: return arm_dp_imm(ARM_I_ADD, (hw >> 8) & 0x07, (hw >> 8) & 0x07, hw & 0xFF, ARM_INSN_S_OUT_IT);
+        case 0x07: return arm_dp_imm(ARM_I_SUB, (hw >> 8) & 0x07, (hw >> 8) & 0x07, hw & 0xFF, ARM_INSN_S_OUT_IT);
+        case 0x08:
+            if ((hw & 0x0400) == 0) {
+                static const arm_insn_op_t ops[] = {
+                    ARM_I_AND, ARM_I_EOR, ARM_I_SHIFT, ARM_I_SHIFT, ARM_I_SHIFT, ARM_I_ADC, ARM_I_SBC, ARM_I_SHIFT,
+                    ARM_I_TST, ARM_I_RSB, ARM_I_CMP, ARM_I_CMN, ARM_I_ORR, ARM_I_MUL, ARM_I_BIC, ARM_I_MVN
+                };
+                static const uint8_t shifts[] = {
+                    [2] = ARM_SHIFT_LSL, [3] = ARM_SHIFT_LSR, [4] = ARM_SHIFT_ASR, [7] = ARM_SHIFT_ROR
+                };
+                int opc = (hw >> 6) & 0x0F;
+                arm_insn_t insn;
+
+                switch (ops[opc]) {
+                    case ARM_I_RSB:
+                        return arm_dp_imm(ARM_I_RSB, rd, rn, 0, ARM_INSN_S_OUT_IT);
+                    case ARM_I_SHIFT:
+                        insn = arm_dp_reg(ARM_I_SHIFT, rd, rd, rn, ARM_SHIFT_LSL, 0, ARM_INSN_S_OUT_IT);
+                        insn.shift_type = shifts[opc];
+                        return insn;
+                    case ARM_I_MUL:
+                        insn = arm_dp_reg(ARM_I_MUL, rd, rn, rd, ARM_SHIFT_LSL, 0, ARM_INSN_S_OUT_IT);
+                        insn.cls = ARM_OP_MUL;
+                        return insn;
+                    default:
+                        return arm_dp_reg(ops[opc], rd, rd, rn, ARM_SHIFT_LSL, 0, ARM_INSN_S_OUT_IT);
+                }
+            } else {
+                // Registradores altos: ADD, CMP, MOV, BX/BLX
+                int rdn = (hw & 0x07) | ((hw >> 4) & 0x08);
+                int rm = (hw >> 3) & 0x0F;
+                arm_insn_t insn;
+
+                switch ((hw >> 8) & 0x03) {
+                    case 0: return arm_dp_reg(ARM_I_ADD, rdn, rdn, rm, ARM_SHIFT_LSL, 0, 0);
+                    case 1: return arm_dp_reg(ARM_I_CMP, 0, rdn, rm, ARM_SHIFT_LSL, 0, 0);
+                    case 2: return arm_dp_reg(ARM_I_MOV, rdn, 0, rm, ARM_SHIFT_LSL, 0, 0);
+                    default:
+                        insn = arm_insn(ARM_I_BX, ARM_OP_BRANCH);
+                        insn.rm = rm;
+                        insn.flags = (hw & 0x0080) ? ARM_INSN_LINK : 0;
+                        return insn;
+                }
+            }
+        case 0x09:
+            return arm_mem(ARM_I_LOAD, (hw >> 8) & 0x07, ARM_REG_PC, 4, (hw & 0xFF) * 4,
+                           ARM_INSN_IMM | ARM_INSN_PRE);
+        case 0x0A:
+        case 0x0B: {
+            static const struct { uint8_t op; uint8_t size; bool is_signed; } forms[] = {
+                { ARM_I_STORE, 4, false }, { ARM_I_STORE, 2, false }, { ARM_I_STORE, 1, false },
+                { ARM_I_LOAD, 1, true }, { ARM_I_LOAD, 4, false }, { ARM_I_LOAD, 2, false },
+                { ARM_I_LOAD, 1, false }, { ARM_I_LOAD, 2, true }
+            };
+            int sel = (hw >> 9) & 0x07;
+            arm_insn_t insn = arm_mem(forms[sel].op, rd, rn, forms[sel].size, 0,
+                                      ARM_INSN_PRE | (forms[sel].is_signed ? ARM_INSN_SIGNED : 0));
+            insn.rm = (hw >> 6) & 0x07;
+            return insn;
+        }
+        case 0x0C: case 0x0D: case 0x0E: case 0x0F: {
+            bool byte = (hw & 0x1000) != 0;
+            arm_insn_op_t op = (hw & 0x0800) ? ARM_I_LOAD : ARM_I_STORE;
+            uint32_t imm5 = (hw >> 6) & 0x1F;
+            return arm_mem(op, rd, rn, byte ? 1 : 4, byte ? imm5 : imm5 * 4, ARM_INSN_IMM | ARM_INSN_PRE);
+        }
+        case 0x10:
+        case 0x11:
+            return arm_mem((hw & 0x0800) ? ARM_I_LOAD : ARM_I_STORE, rd, rn, 2, ((hw >> 6) & 0x1F) * 2,
+                           ARM_INSN_IMM | ARM_INSN_PRE);
+        case 0x12:
+        case 0x13:
+            return arm_mem((hw & 0x0800) ? ARM_I_LOAD : ARM_I_STORE, (hw >> 8) & 0x07, ARM_REG_SP, 4,
+                           (hw & 0xFF) * 4, ARM_INSN_IMM | ARM_INSN_PRE);
+        case 0x14: {
+            // ADR
+            arm_insn_t insn = arm_dp_imm(ARM_I_ADD, (hw >> 8) & 0x07, ARM_REG_PC, (hw & 0xFF) * 4, 0);
+            insn.flags |= ARM_INSN_ALIGN_PC;
+            return insn;
+        }
+        case 0x15:
+            return arm_dp_imm(ARM_I_ADD, (hw >> 8) & 0x07, ARM_REG_SP, (hw & 0xFF) * 4, 0);
+        case 0x16:
+        case 0x17:
+            return arm_decode_misc16(hw);
+        case 0x18:
+        case 0x19: {
+            bool load = (hw & 0x0800) != 0;
+            int base = (hw >> 8) & 0x07;
+            uint32_t list = hw & 0xFF;
+            // LDM com a base na lista não atualiza a base
+            uint16_t flags = (!load || !(list & (1u << base))) ? ARM_INSN_WBACK : 0;
+            return arm_multiple(load, base, list, flags);
+        }
+        case 0x1A:
+        case 0x1B: {
+            int cond = (hw >> 8) & 0x0F;
+            if (cond >= 0xE) {
+                return arm_undefined();  // UDF, SVC: sem modelo de exceções
+            }
+            return arm_branch(ARM_I_B, cond, sign_extend((hw & 0xFF) << 1, 9));
+        }
+        case 0x1C:
+            return arm_branch(ARM_I_B, ARM_COND_ALWAYS, sign_extend((hw & 0x07FF) << 1, 12));
+        default:
+            return arm_undefined();
+    }
+}
+
+// Mapeia o opcode das tabelas de processamento de dados de 32 bits
+static bool arm_dp32(arm_insn_t* insn, int opc, bool s, int rd, int rn) {
+    bool test = s && rd == ARM_REG_PC;
+
+    insn->rd = rd;
+    insn->rn = rn;
+    if (s) {
+        insn->flags |= ARM_INSN_S;
+    }
+
+    switch (opc) {
+        case 0x0: insn->op = test ? ARM_I_TST : ARM_I_AND; break;
+        case 0x1: insn->op = ARM_I_BIC; break;
+        case 0x2: insn->op = rn == ARM_REG_PC ? ARM_I_MOV : ARM_I_ORR; break;
+        case 0x3: insn->op = rn == ARM_REG_PC ? ARM_I_MVN : ARM_I_ORN; break;
+        case 0x4: insn->op = test ? ARM_I_TEQ : ARM_I_EOR; break;
+        case 0x8: insn->op = test ? ARM_I_CMN : ARM_I_ADD; break;
+        case 0xA: insn->op = ARM_I_ADC; break;
+        case 0xB: insn->op = ARM_I_SBC; break;
+        case 0xD: insn->op = test ? ARM_I_CMP : ARM_I_SUB; break;
+        case 0xE: insn->op = ARM_I_RSB; break;
+        default: return false;
+    }
+
+    return true;
+}
+
+static arm_insn_t arm_decode_multiple32(uint16_t hw1, uint16_t hw2) {
+    int rn = hw1 & 0x0F;
+    bool load = (hw1 & 0x0010) != 0;
+    uint16_t flags = (hw1 & 0x0020) ? ARM_INSN_WBACK : 0;
+
+    if ((hw1 & 0x0040) == 0) {
+        switch ((hw1 >> 7) & 0x03) {
+            case 1: return arm_multiple(load, rn, hw2, flags);
+            case 2: return arm_multiple(load, rn, hw2, flags | ARM_INSN_DB);
+            default: return arm_undefined();
+        }
+    }
+
+    // Dual, exclusivo e TBB/TBH
+    int rt = hw2 >> 12;
+    uint32_t imm = (hw2 & 0xFF) * 4;
+
+    if ((hw1 & 0xFFF0) == 0xE8D0 && (hw2 & 0xFFE0) == 0xF000) {
+        arm_insn_t insn = arm_insn(ARM_I_TB, ARM_OP_TABLE_BRANCH);
+        insn.rn = rn;
+        insn.rm = hw2 & 0x0F;
+        insn.size = (hw2 & 0x0010) ? 2 : 1;
+        return insn;
+    }
+    if ((hw1 & 0xFFF0) == 0xE840) {
+        arm_insn_t insn = arm_mem(ARM_I_STREX, rt, rn, 4, imm, ARM_INSN_IMM | ARM_INSN_PRE);
+        insn.cls = ARM_OP_STORE;
+        insn.ra = (hw2 >> 8) & 0x0F;
+        return insn;
+    }
+    if ((hw1 & 0xFFF0) == 0xE850) {
+        return arm_mem(ARM_I_LOAD, rt, rn, 4, imm, ARM_INSN_IMM | ARM_INSN_PRE);
+    }
+    if (hw1 & 0x0120) {
+        uint16_t mode = ARM_INSN_IMM;
+        if (hw1 & 0x0100) mode |= ARM_INSN_PRE;
+        if (hw1 & 0x0020) mode |= ARM_INSN_WBACK;
+        if (!(hw1 & 0x0080)) mode |= ARM_INSN_SUB;
+        arm_insn_t insn = arm_mem(load ? ARM_I_LOADD : ARM_I_STORED, rt, rn, 4, imm, mode);
+        insn.ra = (hw2 >> 8) & 0x0F;
+        return insn;
+    }
+
+    return arm_undefined();
+}
+
+static arm_insn_t arm_decode_plain_imm(uint16_t hw1, uint16_t hw2) {
+    int rn = hw1 & 0x0F;
+    int rd = (hw2 >> 8) & 0x0F;
+    uint32_t imm12 = ((hw1 >> 10) & 0x01) << 11 | ((hw2 >> 12) & 0x07) << 8 | (hw2 & 0xFF);
+    uint32_t imm16 = (uint32_t)(hw1 & 0x0F) << 12 | imm12;
+    int lsb = ((hw2 >> 12) & 0x07) << 2 | ((hw2 >> 6) & 0x03);
+    int bits = hw2 & 0x1F;
+    arm_insn_t insn;
+
+    switch ((hw1 >> 4) & 0x1F) {
+        case 0x00:
+        case 0x0A:
+            // ADDW/SUBW; com rn = PC é ADR
+            insn = arm_dp_imm((hw1 & 0x0080) ? ARM_I_SUB : ARM_I_ADD, rd, rn, imm12, 0);
+            if (rn == ARM_REG_PC) {
+                insn.flags |= ARM_INSN_ALIGN_PC;
+            }
+            return insn;
+        case 0x04:
+            return arm_dp_imm(ARM_I_MOV, rd, 0, imm16, 0);
+        case 0x0C:
+            insn = arm_dp_imm(ARM_I_MOVT, rd, rd, imm16, 0);
+            return insn;
+        case 0x14:
+        case 0x1C:
+            insn = arm_unary((hw1 & 0x0080) ? ARM_I_UBFX : ARM_I_SBFX, rd, rn);
+            insn.shift_n = lsb;
+            insn.imm = bits + 1;
+            return insn;
+        case 0x16:
+            if (bits < lsb) {
+                return arm_undefined();
+            }
+            // BFI; BFC quando rn = PC
+            insn = arm_unary(ARM_I_BFI, rd, rn);
+            insn.shift_n = lsb;
+            insn.imm = bits - lsb + 1;
+            return insn;
+        default:
+            return arm_undefined();  // SSAT, USAT
+    }
+}
+
+static arm_insn_t arm_decode_branch32(uint16_t hw1, uint16_t hw2) {
+    uint32_t s = (hw1 >> 10) & 0x01;
+    uint32_t j1 = (hw2 >> 13) & 0x01;
+    uint32_t j2 = (hw2 >> 11) & 0x01;
+
+    switch (hw2 & 0x5000) {
+        case 0x0000: {
+            int op = (hw1 >> 4) & 0x7F;
+            if ((op & 0x38) != 0x38) {
+                uint32_t imm = s << 20 | j2 << 19 | j1 << 18 | (hw1 & 0x3F) << 12 | (hw2 & 0x07FF) << 1;
+                return arm_branch(ARM_I_B, (hw1 >> 6) & 0x0F, sign_extend(imm, 21));
+            }
+
+            arm_insn_t insn;
+            switch (op) {
+                case 0x38:
+                case 0x39:
+                    insn = arm_insn(ARM_I_MSR, ARM_OP_STATUS);
+                    insn.rn = hw1 & 0x0F;
+                    insn.imm = hw2 & 0xFF;
+                    insn.shift_n = (hw2 >> 10) & 0x03;
+                    return insn;
+                case 0x3A:
+                    if ((hw2 & 0x0700) != 0) {
+                        return arm_insn(ARM_I_NOP, ARM_OP_STATUS);  // CPS.W
+                    }
+                    return arm_hint(hw2 & 0xFF);
+                case 0x3B:
+                    return arm_insn(ARM_I_NOP, ARM_OP_BARRIER);    // DSB, DMB, ISB, CLREX
+                case 0x3E:
+                case 0x3F:
+                    insn = arm_insn(ARM_I_MRS, ARM_OP_STATUS);
+                    insn.rd = (hw2 >> 8) & 0x0F;
+                    insn.imm = hw2 & 0xFF;
+                    return insn;
+                default:
+                    return arm_undefined();
+            }
+        }
+        case 0x1000:
+        case 0x5000: {
+            uint32_t i1 = !(j1 ^ s);
+            uint32_t i2 = !(j2 ^ s);
+            uint32_t imm = s << 24 | i1 << 23 | i2 << 22 | (hw1 & 0x03FF) << 12 | (hw2 & 0x07FF) << 1;
+            return arm_branch((hw2 & 0x4000) ? ARM_I_BL : ARM_I_B, ARM_COND_ALWAYS, sign_extend(imm, 25));
+        }
+        default:
+            return arm_undefined();  // BLX para o modo ARM não existe no M3
+    }
+}
+
+static arm_insn_t arm_decode_load_store32(uint16_t hw1, uint16_t hw2) {
+    bool load = (hw1 & 0x0010) != 0;
+    int size_sel = (hw1 >> 5) & 0x03;
+    int rn = hw1 & 0x0F;
+    int rt = hw2 >> 12;
+    arm_insn_op_t op = load ? ARM_I_LOAD : ARM_I_STORE;
+    uint16_t sign = (load && (hw1 & 0x0100)) ? ARM_INSN_SIGNED : 0;
+
+    if (size_sel == 3 || (!load && (hw1 & 0x0100))) {
+        return arm_undefined();
+    }
+
+    int size = 1 << size_sel;
+    if (load && rt == ARM_REG_PC && size != 4) {
+        return arm_insn(ARM_I_NOP, ARM_OP_NOP);  // PLD, PLI
+    }
+
+    // Literal: U no bit 7
+    if (load && rn == ARM_REG_PC) {
+        return arm_mem(op, rt, rn, size, hw2 & 0x0FFF,
+                       ARM_INSN_IMM | ARM_INSN_PRE | sign | ((hw1 & 0x0080) ? 0 : ARM_INSN_SUB));
+    }
+
+    if (hw1 & 0x0080) {
+        return arm_mem(op, rt, rn, size, hw2 & 0x0FFF, ARM_INSN_IMM | ARM_INSN_PRE | sign);
+    }
+
+    if (hw2 & 0x0800) {
+        // imm8 com P/U/W; PUW = 110 (acesso não privilegiado) vira offset comum
+        uint16_t mode = ARM_INSN_IMM | sign;
+        if (hw2 & 0x0400) mode |= ARM_INSN_PRE;
+        if (!(hw2 & 0x0200)) mode |= ARM_INSN_SUB;
+        if (hw2 & 0x0100) mode |= ARM_INSN_WBACK;
+        if (!(mode & (ARM_INSN_PRE | ARM_INSN_WBACK))) {
+            return arm_undefined();
+        }
+        return arm_mem(op, rt, rn, size, hw2 & 0xFF, mode);
+    }
+
+    if ((hw2 & 0x0FC0) == 0) {
+        arm_insn_t insn = arm_mem(op, rt, rn, size, 0, ARM_INSN_PRE | sign);
+        insn.rm = hw2 & 0x0F;
+        insn.shift_n = (hw2 >> 4) & 0x03;
+        return insn;
+    }
+
+    return arm_undefined();
+}
+
+static arm_insn_t arm_decode_dp_reg32(uint16_t hw1, uint16_t hw2) {
+    int rn = hw1 & 0x0F;
+    int rd = (hw2 >> 8) & 0x0F;
+    int rm = hw2 & 0x0F;
+
+    if (!(hw1 & 0x0080) && (hw2 & 0xF0F0) == 0xF000) {
+        arm_insn_t insn = arm_dp_reg(ARM_I_SHIFT, rd, rn, rm, (hw1 >> 5) & 0x03, 0,
+                                     (hw1 & 0x0010) ? ARM_INSN_S : 0);
+        insn.shift_type = (hw1 >> 5) & 0x03;
+        return insn;
+    }
+
+    if (!(hw1 & 0x0080) && (hw2 & 0xF080) == 0xF080) {
+        int rotation = ((hw2 >> 4) & 0x03) * 8;
+        switch ((hw1 >> 4) & 0x07) {
+            case 0: return arm_extend(rd, rn, rm, 2, true, rotation);
+            case 1: return arm_extend(rd, rn, rm, 2, false, rotation);
+            case 4: return arm_extend(rd, rn, rm, 1, true, rotation);
+            case 5: return arm_extend(rd, rn, rm, 1, false, rotation);
+            default: return arm_undefined();
+        }
+    }
+
+    if ((hw1 & 0xFFF0) == 0xFA90 && (hw2 & 0xF0C0) == 0xF080) {
+        static const arm_insn_op_t ops[] = { ARM_I_REV, ARM_I_REV16, ARM_I_RBIT, ARM_I_REVSH };
+        return arm_unary(ops[(hw2 >> 4) & 0x03], rd, rm);
+    }
+
+    if ((hw1 & 0xFFF0) == 0xFAB0 && (hw2 & 0xF0F0) == 0xF080) {
+        return arm_unary(ARM_I_CLZ, rd, rm);
+    }
+
+    return arm_undefined();
+}
+
+static arm_insn_t arm_decode_multiply32(uint16_t hw1, uint16_t hw2) {
+    arm_insn_t insn = arm_insn(ARM_I_UNDEFINED, ARM_OP_MUL);
+    int op1 = (hw1 >> 4) & 0x07;
+    int op2 = (hw2 >> 4) & 0x0F;
+
+    insn.rn = hw1 & 0x0F;
+    insn.ra = hw2 >> 12;
+    insn.rd = (hw2 >> 8) & 0x0F;
+    insn.rm = hw2 & 0x0F;
+
+    if ((hw1 & 0x0080) == 0) {
+        if (op1 != 0 || op2 > 1) {
+            return arm_undefined();
+        }
+        if (op2 == 1) {
+            insn.op = ARM_I_MLS;
+            insn.cls = ARM_OP_MLA;
+        } else if (insn.ra == ARM_REG_PC) {
+            insn.op = ARM_I_MUL;
+        } else {
+            insn.op = ARM_I_MLA;
+            insn.cls = ARM_OP_MLA;
+        }
+        return insn;
+    }
+
+    // Longos: ra = RdLo, rd = RdHi
+    switch (op1) {
+        case 0: insn.op = ARM_I_SMULL; insn.cls = ARM_OP_MULL; break;
+        case 1: insn.op = ARM_I_SDIV; insn.cls = ARM_OP_DIV; break;
+        case 2: insn.op = ARM_I_UMULL; insn.cls = ARM_OP_MULL; break;
+        case 3: insn.op = ARM_I_UDIV; insn.cls = ARM_OP_DIV; break;
+        case 4: insn.op = ARM_I_SMLAL; insn.cls = ARM_OP_MULL; break;
+        case 6: insn.op = ARM_I_UMLAL; insn.cls = ARM_OP_MULL; break;
+        default: return arm_undefined();
+    }
+    if (op2 != (insn.op == ARM_I_SDIV || insn.op == ARM_I_UDIV ? 0x0F : 0)) {
+        return arm_undefined();
+    }
+
+    return insn;
+}
+
+static arm_insn_t arm_decode32(uint16_t hw1, uint16_t hw2) {
+    arm_insn_t insn;
+
+    switch (hw1 >> 11) {
+        case 0x1D:
+            if ((hw1 & 0x0600) == 0x0000) {
+                insn = arm_decode_multiple32(hw1, hw2);
+            } else if ((hw1 & 0x0600) == 0x0200) {
+                // Processamento de dados com registrador deslocado
+                int imm5 = ((hw2 >> 12) & 0x07) << 2 | ((hw2 >> 6) & 0x03);
+                insn = arm_dp_reg(ARM_I_UNDEFINED, 0, 0, hw2 & 0x0F, (hw2 >> 4) & 0x03, imm5, 0);
+                if (!arm_dp32(&insn, (hw1 >> 5) & 0x0F, hw1 & 0x0010, (hw2 >> 8) & 0x0F, hw1 & 0x0F)) {
+                    insn = arm_undefined();
+                }
+            } else {
+                insn = arm_undefined();  // coprocessador
+            }
+            break;
+        case 0x1E:
+            if (hw2 & 0x8000) {
+                insn = arm_decode_branch32(hw1, hw2);
+            } else if (hw1 & 0x0200) {
+                insn = arm_decode_plain_imm(hw1, hw2);
+            } else {
+                uint32_t imm12 = ((hw1 >> 10) & 0x01) << 11 | ((hw2 >> 12) & 0x07) << 8 | (hw2 & 0xFF);
+                bool rotated;
+                uint32_t imm = arm_expand_imm(imm12, &rotated);
+                insn = arm_dp_imm(ARM_I_UNDEFINED, 0, 0, imm, rotated ? ARM_INSN_IMM_C : 0);
+                if (!arm_dp32(&insn, (hw1 >> 5) & 0x0F, hw1 & 0x0010, (hw2 >> 8) & 0x0F, hw1 & 0x0F)) {
+                    insn = arm_undefined();
+                }
+            }
+            break;
+        default:
+            if ((hw1 & 0xFE00) == 0xF800) {
+                insn = arm_decode_load_store32(hw1, hw2);
+            } else if ((hw1 & 0xFF00) == 0xFA00) {
+                insn = arm_decode_dp_reg32(hw1, hw2);
+            } else if ((hw1 & 0xFF00) == 0xFB00) {
+                insn = arm_decode_multiply32(hw1, hw2);
+            } else {
+                insn = arm_undefined();
+            }
+            break;
+    }
+
+    insn.length = 4;
+    return insn;
+}
+
+arm_insn_t arm_decode(uint16_t first, uint16_t second) {
+    if ((first >> 11) >= 0x1D) {
+        return arm_decode32(first, second);
+    }
+    return arm_decode16(first);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Memória                                                                */
+/* ---------------------------------------------------------------------- */
+
+int arm_core_init(microcontroller_t* mcu) {
+    mcu->arm = calloc(1, sizeof(arm_core_t));
+    if (!mcu->arm) {
+        fprintf(stderr, "Erro ao alocar núcleo ARM\n");
+        return -1;
+    }
+
+    mcu->arm->code = calloc(mcu->memory_size / 2, sizeof(arm_insn_t));
+    if (!mcu->arm->code) {
+        fprintf(stderr, "Erro ao alocar cache de instruções\n");
+        free(mcu->arm);
+        mcu->arm = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+void arm_core_cleanup(microcontroller_t* mcu) {
+    if (mcu->arm) {
+        free(mcu->arm->code);
+        free(mcu->arm);
+        mcu->arm = NULL;
+    }
+}
+
+void arm_core_invalidate(microcontroller_t* mcu) {
+    if (mcu->arm) {
+        memset(mcu->arm->code, 0, (mcu->memory_size / 2) * sizeof(arm_insn_t));
+    }
+}
+
+int arm_map_region(microcontroller_t* mcu, uint32_t base, uint32_t size,
+                   arm_io_read_t read, arm_io_write_t write, void* context) {
+    arm_core_t* core = mcu ? mcu->arm : NULL;
+
+    if (!core || size == 0 || base + (size - 1) < base) {
+        return -1;
+    }
+
+    bool peripheral = (base >= ARM_PERIPHERAL_BASE && base + (size - 1) < ARM_PERIPHERAL_END) ||
+                      base >= ARM_PPB_BASE;
+    if (!peripheral || core->region_count == ARM_MAX_REGIONS) {
+        fprintf(stderr, "Região de periférico inválida em 0x%08x\n", base);
+        return -1;
+    }
+
+    // Inserção ordenada, recusando sobreposição
+    int i = core->region_count;
+    while (i > 0 && core->regions[i - 1].base > base) {
+        i--;
+    }
+    if ((i > 0 && core->regions[i - 1].base + (core->regions[i - 1].size - 1) >= base) ||
+        (i < core->region_count && base + (size - 1) >= core->regions[i].base)) {
+        fprintf(stderr, "Região de periférico 0x%08x sobrepõe outra\n", base);
+        return -1;
+    }
+
+    memmove(&core->regions[i + 1], &core->regions[i], (core->region_count - i) * sizeof(arm_region_t));
+    core->regions[i] = (arm_region_t){ base, size, read, write, context };
+    core->region_count++;
+    core->last_region = i;
+
+    return 0;
+}
+
+static const arm_region_t* arm_find_region(arm_core_t* core, uint32_t address) {
+    const arm_region_t* last = &core->regions[core->last_region];
+
+    // Acessos consecutivos costumam cair no mesmo periférico
+    if (core->region_count > 0 && address - last->base < last->size) {
+        return last;
+    }
+
+    int low = 0;
+    int high = core->region_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const arm_region_t* region = &core->regions[mid];
+        if (address < region->base) {
+            high = mid - 1;
+        } else if (address - region->base >= region->size) {
+            low = mid + 1;
+        } else {
+            core->last_region = mid;
+            return region;
+        }
+    }
+
+    return NULL;
+}
+
+static inline bool arm_is_peripheral(uint32_t address) {
+    return (address >= ARM_PERIPHERAL_BASE && address < ARM_PERIPHERAL_END) || address >= ARM_PPB_BASE;
+}
+
+// Flash no endereço nativo ou no alias a partir de 0
+static inline const uint8_t* arm_flash(const microcontroller_t* mcu, uint32_t address, int size) {
+    uint32_t offset = address - mcu->config.flash_start;
+
+    if (offset >= mcu->memory_size) {
+        offset = address;
+    }
+    if (offset >= mcu->memory_size || (uint32_t)size > mcu->memory_size - offset) {
+        return NULL;
+    }
+
+    return mcu->memory + offset;
+}
+
+static inline uint32_t arm_load_le(const uint8_t* bytes, int size) {
+    switch (size) {
+        case 1: return bytes[0];
+        case 2: return bytes[0] | (uint32_t)bytes[1] << 8;
+        default: return bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    }
+}
+
+static int arm_fault(microcontroller_t* mcu, const char* access, uint32_t address) {
+    fprintf(stderr, "Falha de barramento: %s em 0x%08x (PC 0x%08x)\n",
+            access, address, mcu->program_counter);
+    mcu->state = MCU_STATE_ERROR;
+    return -1;
+}
+
+int arm_read(microcontroller_t* mcu, uint32_t address, int size, uint32_t* value) {
+    uint32_t offset = address - mcu->data_base;
+
+    // SRAM; com watchpoints ativos os bytes passam pelo despacho
+    if (offset < mcu->data_size && (uint32_t)size <= mcu->data_size - offset) {
+        if (offset >= mcu->direct_start) {
+            *value = arm_load_le(mcu->data_memory + offset, size);
+        } else {
+            *value = 0;
+            for (int i = 0; i < size; i++) {
+                *value |= (uint32_t)mcu_mmio_read(mcu, offset + i) << (8 * i);
+            }
+        }
+        return 0;
+    }
+
+    const uint8_t* flash = arm_flash(mcu, address, size);
+    if (flash) {
+        *value = arm_load_le(flash, size);
+        return 0;
+    }
+
+    if (arm_is_peripheral(address)) {
+        const arm_region_t* region = arm_find_region(mcu->arm, address);
+        *value = (region && region->read) ? region->read(mcu, address - region->base, size, region->context) : 0;
+        return 0;
+    }
+
+    return arm_fault(mcu, "leitura", address);
+}
+
+int arm_write(microcontroller_t* mcu, uint32_t address, int size, uint32_t value) {
+    uint32_t offset = address - mcu->data_base;
+
+    if (offset < mcu->data_size && (uint32_t)size <= mcu->data_size - offset) {
+        if (offset >= mcu->direct_start) {
+            for (int i = 0; i < size; i++) {
+                mcu->data_memory[offset + i] = (uint8_t)(value >> (8 * i));
+            }
+            mcu->dirty_pages[offset >> MCU_PAGE_SHIFT] = 1;
+            mcu->dirty_pages[(offset + size - 1) >> MCU_PAGE_SHIFT] = 1;
+        } else {
+            for (int i = 0; i < size; i++) {
+                mcu_mmio_write(mcu, offset + i, (uint8_t)(value >> (8 * i)));
+            }
+        }
+        return 0;
+    }
+
+    if (arm_is_peripheral(address)) {
+        const arm_region_t* region = arm_find_region(mcu->arm, address);
+        if (region && region->write) {
+            region->write(mcu, address - region->base, value, size, region->context);
+        }
+        return 0;
+    }
+
+    return arm_fault(mcu, "escrita", address);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Execução                                                               */
+/* ---------------------------------------------------------------------- */
+
+void arm_core_reset(microcontroller_t* mcu) {
+    uint32_t* r = mcu->registers.arm;
+    const uint8_t* vectors = arm_flash(mcu, mcu->config.flash_start, 8);
+    uint32_t sp = vectors ? arm_load_le(vectors, 4) : 0;
+    uint32_t reset = vectors ? arm_load_le(vectors + 4, 4) : 0;
+
+    // Sem tabela de vetores válida, usa o ponto de entrada do firmware
+    if (sp != 0 && (reset & 1)) {
+        r[ARM_REG_SP] = sp & ~3u;
+        mcu->program_counter = reset & ~1u;
+    } else {
+        r[ARM_REG_SP] = mcu->config.ram_start + mcu->config.ram_size;
+    }
+
+    r[ARM_REG_LR] = 0xFFFFFFFF;
+    r[ARM_REG_XPSR] = ARM_XPSR_T;
+}
+
+void arm_core_mark_breakpoint(microcontroller_t* mcu, uint32_t halfword, bool enabled) {
+    arm_insn_t* insn = &mcu->arm->code[halfword];
+
+    // Meias-palavras ainda não decodificadas recebem a flag ao serem decodificadas
+    if (insn->op == ARM_I_UNDECODED) {
+        return;
+    }
+
+    if (enabled) {
+        insn->flags |= ARM_INSN_BREAKPOINT;
+    } else {
+        insn->flags &= ~ARM_INSN_BREAKPOINT;
+    }
+}
+
+static inline uint16_t arm_flash_halfword(const microcontroller_t* mcu, uint32_t offset) {
+    return offset + 1 < mcu->memory_size ? (uint16_t)arm_load_le(mcu->memory + offset, 2) : 0;
+}
+
+// Código no flash usa o cache; fora dele (SRAM) decodifica a cada execução
+static inline const arm_insn_t* arm_fetch(microcontroller_t* mcu, uint32_t pc, arm_insn_t* scratch) {
+    uint32_t offset = pc - mcu->config.flash_start;
+
+    if (offset >= mcu->memory_size) {
+        offset = pc;
+    }
+
+    if (offset < mcu->memory_size) {
+        arm_insn_t* insn = &mcu->arm->code[offset >> 1];
+        if (insn->op == ARM_I_UNDECODED) {
+            *insn = arm_decode(arm_flash_halfword(mcu, offset), arm_flash_halfword(mcu, offset + 2));
+            if (mcu->breakpoint_count > 0 && mcu_has_breakpoint(mcu, mcu->config.flash_start + offset)) {
+                insn->flags |= ARM_INSN_BREAKPOINT;
+            }
+        }
+        return insn;
+    }
+
+    uint32_t first, second = 0;
+    if (arm_read(mcu, pc, 2, &first) < 0) {
+        return NULL;
+    }
+    if ((first >> 11) >= 0x1D && arm_read(mcu, pc + 2, 2, &second) < 0) {
+        return NULL;
+    }
+    *scratch = arm_decode((uint16_t)first, (uint16_t)second);
+    return scratch;
+}
+
+static inline uint32_t arm_it_state(uint32_t xpsr) {
+    return ((xpsr >> 8) & 0xFC) | ((xpsr >> 25) & 0x03);
+}
+
+static inline uint32_t arm_set_it_state(uint32_t xpsr, uint32_t it) {
+    return (xpsr & ~0x0600FC00u) | ((it & 0xFC) << 8) | ((it & 0x03) << 25);
+}
+
+static inline uint32_t arm_it_advance(uint32_t it) {
+    return (it & 0x07) == 0 ? 0 : (it & 0xE0) | ((it << 1) & 0x1F);
+}
+
+static bool arm_condition(uint32_t xpsr, int cond) {
+    bool n = (xpsr & ARM_FLAG_N) != 0;
+    bool z = (xpsr & ARM_FLAG_Z) != 0;
+    bool c = (xpsr & ARM_FLAG_C) != 0;
+    bool v = (xpsr & ARM_FLAG_V) != 0;
+
+    switch (cond) {
+        case 0x0: return z;
+        case 0x1: return !z;
+        case 0x2: return c;
+        case 0x3: return !c;
+        case 0x4: return n;
+        case 0x5: return !n;
+        case 0x6: return v;
+        case 0x7: return !v;
+        case 0x8: return c && !z;
+        case 0x9: return !c || z;
+        case 0xA: return n == v;
+        case 0xB: return n != v;
+        case 0xC: return !z && n == v;
+        case 0xD: return z || n != v;
+        default: return true;
+    }
+}
+
+// Deslocamento com carry (Shift_C); n = 0 mantém valor e carry
+static uint32_t arm_shift_c(uint32_t value, int type, uint32_t n, uint32_t* carry) {
+    if (n == 0 && type != ARM_SHIFT_RRX) {
+        return value;
+    }
+
+    switch (type) {
+        case ARM_SHIFT_LSL:
+            if (n > 32) { *carry = 0; return 0; }
+            *carry = (uint32_t)(((uint64_t)value << n) >> 32) & 1;
+            return n == 32 ? 0 : value << n;
+        case ARM_SHIFT_LSR:
+            if (n > 32) { *carry = 0; return 0; }
+            *carry = (value >> (n - 1)) & 1;
+            return n == 32 ? 0 : value >> n;
+        case ARM_SHIFT_ASR:
+            if (n >= 32) {
+                *carry = value >> 31;
+                return *carry ? 0xFFFFFFFF : 0;
+            }
+            *carry = (value >> (n - 1)) & 1;
+            return (uint32_t)((int32_t)value >> n);
+        case ARM_SHIFT_ROR: {
+            uint32_t result = ror32(value, n);
+            *carry = result >> 31;
+            return result;
+        }
+        default: {
+            uint32_t result = (*carry << 31) | (value >> 1);
+            *carry = value & 1;
+            return result;
+        }
+    }
+}
+
+static inline uint32_t arm_add(uint32_t x, uint32_t y, uint32_t carry_in, uint32_t* carry, uint32_t* overflow) {
+    uint64_t sum = (uint64_t)x + y + carry_in;
+    uint32_t result = (uint32_t)sum;
+    *carry = (uint32_t)(sum >> 32);
+    *overflow = ((x ^ result) & (y ^ result)) >> 31;
+    return result;
+}
+
+static inline uint32_t arm_get(const microcontroller_t* mcu, const arm_insn_t* insn, int reg, uint32_t pc) {
+    if (reg != ARM_REG_PC) {
+        return mcu->registers.arm[reg];
+    }
+    return (insn->flags & ARM_INSN_ALIGN_PC) ? (pc + 4) & ~3u : pc + 4;
+}
+
+static inline void arm_set_flags(microcontroller_t* mcu, uint32_t mask, uint32_t flags) {
+    uint32_t* xpsr = &mcu->registers.arm[ARM_REG_XPSR];
+    *xpsr = (*xpsr & ~mask) | (flags & mask);
+}
+
+static inline uint32_t arm_nz(uint32_t result) {
+    return (result & ARM_FLAG_N) | (result == 0 ? ARM_FLAG_Z : 0);
+}
+
+static int arm_load_store(microcontroller_t* mcu, const arm_insn_t* insn, uint32_t pc, uint32_t* next, int* cycles) {
+    uint32_t* r = mcu->registers.arm;
+    uint32_t base = arm_get(mcu, insn, insn->rn, pc);
+    uint32_t offset = (insn->flags & ARM_INSN_IMM) ? insn->imm : r[insn->rm] << insn->shift_n;
+    uint32_t offset_address = (insn->flags & ARM_INSN_SUB) ? base - offset : base + offset;
+    uint32_t address = (insn->flags & ARM_INSN_PRE) ? offset_address : base;
+    uint32_t value;
+
+    switch ((arm_insn_op_t)insn->op) {
+        case ARM_I_LOAD:
+            if (arm_read(mcu, address, insn->size, &value) < 0) {
+                return -1;
+            }
+            if (insn->flags & ARM_INSN_SIGNED) {
+                value = (uint32_t)sign_extend(value, insn->size * 8);
+            }
+            if (insn->flags & ARM_INSN_WBACK) {
+                r[insn->rn] = offset_address;
+            }
+            if (insn->rd == ARM_REG_PC) {
+                *next = value & ~1u;
+                *cycles += ARM_PIPELINE_REFILL_CYCLES;
+            } else {
+                r[insn->rd] = value;
+            }
+            return 0;
+        case ARM_I_STORE:
+            if (arm_write(mcu, address, insn->size, arm_get(mcu, insn, insn->rd, pc)) < 0) {
+                return -1;
+            }
+            break;
+        case ARM_I_STREX:
+            if (arm_write(mcu, address, 4, r[insn->rd]) < 0) {
+                return -1;
+            }
+            r[insn->ra] = 0;  // um único núcleo: o exclusivo nunca falha
+            break;
+        case ARM_I_LOADD: {
+            uint32_t high;
+            if (arm_read(mcu, address, 4, &value) < 0 || arm_read(mcu, address + 4, 4, &high) < 0) {
+                return -1;
+            }
+            r[insn->rd] = value;
+            r[insn->ra] = high;
+            *cycles += 1;
+            break;
+        }
+        case ARM_I_STORED:
+            if (arm_write(mcu, address, 4, r[insn->rd]) < 0 ||
+                arm_write(mcu, address + 4, 4, r[insn->ra]) < 0) {
+                return -1;
+            }
+            *cycles += 1;
+            break;
+        default:
+            break;
+    }
+
+    if (insn->flags & ARM_INSN_WBACK) {
+        r[insn->rn] = offset_address;
+    }
+
+    return 0;
+}
+
+static int arm_multiple_transfer(microcontroller_t* mcu, const arm_insn_t* insn, uint32_t* next, int* cycles) {
+    uint32_t* r = mcu->registers.arm;
+    uint32_t list = insn->imm;
+    uint32_t count = (uint32_t)__builtin_popcount(list);
+    uint32_t start = (insn->flags & ARM_INSN_DB) ? r[insn->rn] - 4 * count : r[insn->rn];
+    uint32_t address = start;
+
+    *cycles += count;
+
+    for (int reg = 0; reg < 16; reg++) {
+        if (!(list & (1u << reg))) {
+            continue;
+        }
+
+        if (insn->op == ARM_I_STM) {
+            if (arm_write(mcu, address, 4, r[reg]) < 0) {
+                return -1;
+            }
+        } else {
+            uint32_t value;
+            if (arm_read(mcu, address, 4, &value) < 0) {
+                return -1;
+            }
+            if (reg == ARM_REG_PC) {
+                *next = value & ~1u;
+                *cycles += ARM_PIPELINE_REFILL_CYCLES;
+            } else {
+                r[reg] = value;
+            }
+        }
+        address += 4;
+    }
+
+    if (insn->flags & ARM_INSN_WBACK) {
+        r[insn->rn] = (insn->flags & ARM_INSN_DB) ? start : start + 4 * count;
+    }
+
+    return 0;
+}
+
+static uint32_t arm_special_read(const microcontroller_t* mcu, uint32_t sysm) {
+    switch (sysm) {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+            return mcu->registers.arm[ARM_REG_XPSR] & 0xF8000000u;
+        case 8:
+        case 9:
+            return mcu->registers.arm[ARM_REG_SP];
+        default:
+            return 0;  // PRIMASK, BASEPRI, FAULTMASK, CONTROL
+    }
+}
+
+int arm_core_step(microcontroller_t* mcu) {
+    uint32_t* r = mcu->registers.arm;
+    uint32_t pc = mcu->program_counter;
+    arm_insn_t scratch;
+    const arm_insn_t* insn = arm_fetch(mcu, pc, &scratch);
+
+    if (!insn) {
+        return -1;
+    }
+
+    int cycles = mcu->cycle_table[insn->cls];
+    uint32_t next = pc + insn->length;
+    uint32_t xpsr = r[ARM_REG_XPSR];
+    uint32_t it = arm_it_state(xpsr);
+    bool in_it = (it & 0x0F) != 0;
+    int cond = in_it ? (int)(it >> 4) : insn->cond;
+
+    if (in_it && insn->op != ARM_I_IT) {
+        r[ARM_REG_XPSR] = arm_set_it_state(xpsr, arm_it_advance(it));
+    }
+
+    // Instrução com condição falsa ocupa um ciclo
+    if (cond != ARM_COND_ALWAYS && !arm_condition(xpsr, cond)) {
+        mcu->program_counter = next;
+        mcu->cycle_count += mcu->cycle_table[ARM_OP_NOP];
+        return mcu->cycle_table[ARM_OP_NOP];
+    }
+
+    bool setflags = (insn->flags & ARM_INSN_S) || ((insn->flags & ARM_INSN_S_OUT_IT) && !in_it);
+    uint32_t carry_in = (xpsr >> 29) & 1;
+
+    switch ((arm_insn_op_t)insn->op) {
+        case ARM_I_AND: case ARM_I_EOR: case ARM_I_ORR: case ARM_I_ORN: case ARM_I_BIC:
+        case ARM_I_MOV: case ARM_I_MVN: case ARM_I_TST: case ARM_I_TEQ:
+        case ARM_I_ADD: case ARM_I_ADC: case ARM_I_SUB: case ARM_I_SBC: case ARM_I_RSB:
+        case ARM_I_CMP: case ARM_I_CMN: {
+            uint32_t a = arm_get(mcu, insn, insn->rn, pc);
+            uint32_t carry = carry_in;
+            uint32_t overflow = 0;
+            uint32_t b;
+            bool arithmetic = false;
+            bool write = true;
+            uint32_t result;
+
+            if (insn->flags & ARM_INSN_IMM) {
+                b = insn->imm;
+                if (insn->flags & ARM_INSN_IMM_C) {
+                    carry = b >> 31;
+                }
+            } else {
+                b = arm_shift_c(arm_get(mcu, insn, insn->rm, pc), insn->shift_type, insn->shift_n, &carry);
+            }
+
+            switch ((arm_insn_op_t)insn->op) {
+                case ARM_I_AND: result = a & b; break;
+                case ARM_I_EOR: result = a ^ b; break;
+                case ARM_I_ORR: result = a | b; break;
+                case ARM_I_ORN: result = a | ~b; break;
+                case ARM_I_BIC: result = a & ~b; break;
+                case ARM_I_MOV: result = b; break;
+                case ARM_I_MVN: result = ~b; break;
+                case ARM_I_TST: result = a & b; write = false; setflags = true; break;
+                case ARM_I_TEQ: result = a ^ b; write = false; setflags = true; break;
+                case ARM_I_ADD: result = arm_add(a, b, 0, &carry, &overflow); arithmetic = true; break;
+                case ARM_I_ADC: result = arm_add(a, b, carry_in, &carry, &overflow); arithmetic = true; break;
+                case ARM_I_SUB: result = arm_add(a, ~b, 1, &carry, &overflow); arithmetic = true; break;
+                case ARM_I_SBC: result = arm_add(a, ~b, carry_in, &carry, &overflow); arithmetic = true; break;
+                case ARM_I_RSB: result = arm_add(~a, b, 1, &carry, &overflow); arithmetic = true; break;
+                case ARM_I_CMP:
+                    result = arm_add(a, ~b, 1, &carry, &overflow);
+                    arithmetic = true;
+                    write = false;
+                    setflags = true;
+                    break;
+                default:
+                    result = arm_add(a, b, 0, &carry, &overflow);
+                    arithmetic = true;
+                    write = false;
+                    setflags = true;
+                    break;
+            }
+
+            if (write && insn->rd == ARM_REG_PC) {
+                // ADD/MOV com PC de destino (registradores altos) desviam
+                next = result & ~1u;
+                cycles += ARM_PIPELINE_REFILL_CYCLES;
+                break;
+            }
+            if (write) {
+                r[insn->rd] = result;
+            }
+            if (setflags) {
+                uint32_t flags = arm_nz(result) | (carry ? ARM_FLAG_C : 0) | (overflow ? ARM_FLAG_V : 0);
+                arm_set_flags(mcu, arithmetic ? ARM_FLAG_N | ARM_FLAG_Z | ARM_FLAG_C | ARM_FLAG_V
+                                              : ARM_FLAG_N | ARM_FLAG_Z | ARM_FLAG_C, flags);
+            }
+            break;
+        }
+        case ARM_I_SHIFT: {
+            uint32_t carry = carry_in;
+            uint32_t result = arm_shift_c(r[insn->rn], insn->shift_type, r[insn->rm] & 0xFF, &carry);
+            r[insn->rd] = result;
+            if (setflags) {
+                arm_set_flags(mcu, ARM_FLAG_N | ARM_FLAG_Z | ARM_FLAG_C, arm_nz(result) | (carry ? ARM_FLAG_C : 0));
+            }
+            break;
+        }
+        case ARM_I_MUL: {
+            uint32_t result = r[insn->rn] * r[insn->rm];
+            r[insn->rd] = result;
+            if (setflags) {
+                arm_set_flags(mcu, ARM_FLAG_N | ARM_FLAG_Z, arm_nz(result));
+            }
+            break;
+        }
+        case ARM_I_MLA:
+            r[insn->rd] = r[insn->ra] + r[insn->rn] * r[insn->rm];
+            break;
+        case ARM_I_MLS:
+            r[insn->rd] = r[insn->ra] - r[insn->rn] * r[insn->rm];
+            break;
+        case ARM_I_UMULL:
+        case ARM_I_UMLAL:
+        case ARM_I_SMULL:
+        case ARM_I_SMLAL: {
+            uint64_t accumulator = ((uint64_t)r[insn->rd] << 32) | r[insn->ra];
+            uint64_t product = (insn->op == ARM_I_UMULL || insn->op == ARM_I_UMLAL)
+                ? (uint64_t)r[insn->rn] * r[insn->rm]
+                : (uint64_t)((int64_t)(int32_t)r[insn->rn] * (int32_t)r[insn->rm]);
+            if (insn->op == ARM_I_UMLAL || insn->op == ARM_I_SMLAL) {
+                product += accumulator;
+            }
+            r[insn->ra] = (uint32_t)product;
+            r[insn->rd] = (uint32_t)(product >> 32);
+            break;
+        }
+        case ARM_I_UDIV:
+            // Sem DIV_0_TRP: divisão por zero resulta em zero
+            r[insn->rd] = r[insn->rm] ? r[insn->rn] / r[insn->rm] : 0;
+            break;
+        case ARM_I_SDIV: {
+            int32_t n = (int32_t)r[insn->rn];
+            int32_t m = (int32_t)r[insn->rm];
+            if (m == 0) {
+                r[insn->rd] = 0;
+            } else if (n == INT32_MIN && m == -1) {
+                r[insn->rd] = (uint32_t)n;
+            } else {
+                r[insn->rd] = (uint32_t)(n / m);
+            }
+            break;
+        }
+        case ARM_I_MOVT:
+            r[insn->rd] = (r[insn->rd] & 0xFFFF) | (insn->imm << 16);
+            break;
+        case ARM_I_EXTEND: {
+            uint32_t value = ror32(r[insn->rm], insn->shift_n);
+            uint32_t bits = insn->size * 8;
+            value &= (1u << bits) - 1;
+            if (insn->flags & ARM_INSN_SIGNED) {
+                value = (uint32_t)sign_extend(value, bits);
+            }
+            r[insn->rd] = insn->rn == ARM_REG_PC ? value : r[insn->rn] + value;
+            break;
+        }
+        case ARM_I_REV:
+            r[insn->rd] = __builtin_bswap32(r[insn->rm]);
+            break;
+        case ARM_I_REV16: {
+            uint32_t value = r[insn->rm];
+            r[insn->rd] = ((value & 0x00FF00FFu) << 8) | ((value >> 8) & 0x00FF00FFu);
+            break;
+        }
+        case ARM_I_REVSH:
+            r[insn->rd] = (uint32_t)(int16_t)((r[insn->rm] << 8) | ((r[insn->rm] >> 8) & 0xFF));
+            break;
+        case ARM_I_RBIT: {
+            uint32_t value = r[insn->rm];
+            uint32_t result = 0;
+            for (int i = 0; i < 32; i++) {
+                result = (result << 1) | ((value >> i) & 1);
+            }
+            r[insn->rd] = result;
+            break;
+        }
+        case ARM_I_CLZ:
+            r[insn->rd] = r[insn->rm] ? (uint32_t)__builtin_clz(r[insn->rm]) : 32;
+            break;
+        case ARM_I_BFI: {
+            uint32_t mask = (insn->imm >= 32 ? 0xFFFFFFFFu : (1u << insn->imm) - 1) << insn->shift_n;
+            uint32_t source = insn->rm == ARM_REG_PC ? 0 : r[insn->rm] << insn->shift_n;
+            r[insn->rd] = (r[insn->rd] & ~mask) | (source & mask);
+            break;
+        }
+        case ARM_I_UBFX:
+        case ARM_I_SBFX: {
+            uint32_t width = insn->imm;
+            if (insn->shift_n + width > 32) {
+                goto undefined;
+            }
+            uint32_t value = r[insn->rm] >> insn->shift_n;
+            if (width < 32) {
+                value &= (1u << width) - 1;
+            }
+            r[insn->rd] = insn->op == ARM_I_SBFX ? (uint32_t)sign_extend(value, width) : value;
+            break;
+        }
+        case ARM_I_LOAD:
+        case ARM_I_STORE:
+        case ARM_I_LOADD:
+        case ARM_I_STORED:
+        case ARM_I_STREX:
+            if (arm_load_store(mcu, insn, pc, &next, &cycles) < 0) {
+                return -1;
+            }
+            break;
+        case ARM_I_LDM:
+        case ARM_I_STM:
+            if (arm_multiple_transfer(mcu, insn, &next, &cycles) < 0) {
+                return -1;
+            }
+            break;
+        case ARM_I_B:
+            next = pc + 4 + insn->imm;
+            cycles += ARM_PIPELINE_REFILL_CYCLES;
+            break;
+        case ARM_I_BL:
+            r[ARM_REG_LR] = next | 1;
+            next = pc + 4 + insn->imm;
+            break;
+        case ARM_I_BX: {
+            uint32_t target = arm_get(mcu, insn, insn->rm, pc);
+            if (insn->flags & ARM_INSN_LINK) {
+                r[ARM_REG_LR] = next | 1;
+            }
+            next = target & ~1u;
+            cycles += ARM_PIPELINE_REFILL_CYCLES;
+            break;
+        }
+        case ARM_I_CBZ:
+            if ((r[insn->rn] == 0) != ((insn->flags & ARM_INSN_NONZERO) != 0)) {
+                next = pc + 4 + insn->imm;
+                cycles += ARM_PIPELINE_REFILL_CYCLES;
+            }
+            break;
+        case ARM_I_TB: {
+            uint32_t base = arm_get(mcu, insn, insn->rn, pc);
+            uint32_t index = r[insn->rm];
+            uint32_t halfwords;
+            if (arm_read(mcu, base + index * insn->size, insn->size, &halfwords) < 0) {
+                return -1;
+            }
+            next = pc + 4 + 2 * halfwords;
+            break;
+        }
+        case ARM_I_IT:
+            r[ARM_REG_XPSR] = arm_set_it_state(xpsr, insn->imm);
+            break;
+        case ARM_I_MRS:
+            r[insn->rd] = arm_special_read(mcu, insn->imm);
+            break;
+        case ARM_I_MSR:
+            if (insn->imm <= 3 && (insn->shift_n & 0x02)) {
+                arm_set_flags(mcu, 0xF8000000u, r[insn->rn]);
+            } else if (insn->imm == 8 || insn->imm == 9) {
+                r[ARM_REG_SP] = r[insn->rn] & ~3u;
+            }
+            break;
+        case ARM_I_NOP:
+            break;
+        case ARM_I_BKPT:
+            mcu->state = MCU_STATE_HALTED;
+            break;
+        case ARM_I_UNDECODED:
+        case ARM_I_UNDEFINED:
+        case ARM_I_COUNT:
+        undefined:
+            fprintf(stderr, "Instrução inválida 0x%04x em 0x%08x\n",
+                    insn == &scratch ? 0 : arm_flash_halfword(mcu, pc - mcu->config.flash_start), pc);
+            mcu->state = MCU_STATE_ERROR;
+            return -1;
+    }
+
+    mcu->program_counter = next;
+    mcu->cycle_count += cycles;
+
+    return cycles;
+}
+
+int arm_core_run(microcontroller_t* mcu, uint64_t stop) {
+    // Sem breakpoints o laço não faz nenhuma verificação extra
+    if (mcu->breakpoint_count == 0) {
+        while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < stop) {
+            if (arm_core_step(mcu) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < stop) {
+        arm_insn_t scratch;
+        const arm_insn_t* insn = arm_fetch(mcu, mcu->program_counter, &scratch);
+
+        if (insn && (insn->flags & ARM_INSN_BREAKPOINT)) {
+            if (!mcu->skip_breakpoint || mcu->program_counter != mcu->stop_address) {
+                mcu->state = MCU_STATE_HALTED;
+                mcu->stop_reason = MCU_STOP_BREAKPOINT;
+                mcu->stop_address = mcu->program_counter;
+                mcu->skip_breakpoint = true;
+                break;
+            }
+        }
+        mcu->skip_breakpoint = false;
+
+        if (arm_core_step(mcu) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Interface de núcleo                                                    */
+/* ---------------------------------------------------------------------- */
+
+static int arm_read_reg(const microcontroller_t* mcu, int index, uint32_t* value) {
+    if (index < 0 || index > ARM_REG_XPSR) {
+        return -1;
+    }
+    *value = index == ARM_REG_PC ? mcu->program_counter : mcu->registers.arm[index];
+    return 0;
+}
+
+static int arm_write_reg(microcontroller_t* mcu, int index, uint32_t value) {
+    if (index < 0 || index > ARM_REG_XPSR) {
+        return -1;
+    }
+    if (index == ARM_REG_PC) {
+        mcu->program_counter = value & ~1u;
+    } else {
+        mcu->registers.arm[index] = value;
+    }
+    return 0;
+}
+
+static const char* const arm_mnemonics[ARM_I_COUNT] = {
+    [ARM_I_UNDEFINED] = "udf",
+    [ARM_I_AND] = "and", [ARM_I_EOR] = "eor", [ARM_I_ORR] = "orr", [ARM_I_ORN] = "orn",
+    [ARM_I_BIC] = "bic", [ARM_I_MOV] = "mov", [ARM_I_MVN] = "mvn",
+    [ARM_I_ADD] = "add", [ARM_I_ADC] = "adc", [ARM_I_SUB] = "sub", [ARM_I_SBC] = "sbc", [ARM_I_RSB] = "rsb",
+    [ARM_I_TST] = "tst", [ARM_I_TEQ] = "teq", [ARM_I_CMP] = "cmp", [ARM_I_CMN] = "cmn",
+    [ARM_I_SHIFT] = "shift",
+    [ARM_I_MUL] = "mul", [ARM_I_MLA] = "mla", [ARM_I_MLS] = "mls",
+    [ARM_I_UMULL] = "umull", [ARM_I_SMULL] = "smull", [ARM_I_UMLAL] = "umlal", [ARM_I_SMLAL] = "smlal",
+    [ARM_I_UDIV] = "udiv", [ARM_I_SDIV] = "sdiv",
+    [ARM_I_MOVT] = "movt", [ARM_I_EXTEND] = "xt",
+    [ARM_I_REV] = "rev", [ARM_I_REV16] = "rev16", [ARM_I_REVSH] = "revsh", [ARM_I_RBIT] = "rbit", [ARM_I_CLZ] = "clz",
+    [ARM_I_BFI] = "bfi", [ARM_I_UBFX] = "ubfx", [ARM_I_SBFX] = "sbfx",
+    [ARM_I_LOAD] = "ldr", [ARM_I_STORE] = "str", [ARM_I_LOADD] = "ldrd", [ARM_I_STORED] = "strd",
+    [ARM_I_STREX] = "strex", [ARM_I_LDM] = "ldm", [ARM_I_STM] = "stm",
+    [ARM_I_B] = "b", [ARM_I_BL] = "bl", [ARM_I_BX] = "bx", [ARM_I_CBZ] = "cbz", [ARM_I_TB] = "tb",
+    [ARM_I_IT] = "it", [ARM_I_MRS] = "mrs", [ARM_I_MSR] = "msr", [ARM_I_NOP] = "nop", [ARM_I_BKPT] = "bkpt",
+};
+
+static const char* const arm_conditions[16] = {
+    "eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "", ""
+};
+
+// Só instruções no flash; operandos saem na forma genérica (registradores
+// e imediato decodificados), sem reconstruir a sintaxe exata de cada variante
+static int arm_disassemble(const microcontroller_t* mcu, uint32_t address, char* buffer, size_t size) {
+    uint32_t offset = address - mcu->config.flash_start;
+
+    if (offset >= mcu->memory_size) {
+        offset = address;
+    }
+    if (offset + 1 >= mcu->memory_size) {
+        return -1;
+    }
+
+    arm_insn_t insn = arm_decode(arm_flash_halfword(mcu, offset), arm_flash_halfword(mcu, offset + 2));
+    const char* name = arm_mnemonics[insn.op] ? arm_mnemonics[insn.op] : "udf";
+    const char* suffix = (insn.flags & ARM_INSN_S) ? "s" : "";
+
+    switch ((arm_insn_op_t)insn.op) {
+        case ARM_I_B:
+        case ARM_I_BL:
+            snprintf(buffer, size, "%s%s 0x%08x", name, arm_conditions[insn.cond & 0x0F],
+                     address + 4 + insn.imm);
+            break;
+        case ARM_I_CBZ:
+            snprintf(buffer, size, "%s r%d, 0x%08x", (insn.flags & ARM_INSN_NONZERO) ? "cbnz" : "cbz",
+                     insn.rn, address + 4 + insn.imm);
+            break;
+        case ARM_I_BX:
+            snprintf(buffer, size, "%s r%d", (insn.flags & ARM_INSN_LINK) ? "blx" : "bx", insn.rm);
+            break;
+        case ARM_I_LOAD:
+        case ARM_I_STORE:
+            if (insn.flags & ARM_INSN_IMM) {
+                snprintf(buffer, size, "%s r%d, [r%d, #%s%u]", name, insn.rd, insn.rn,
+                         (insn.flags & ARM_INSN_SUB) ? "-" : "", insn.imm);
+            } else {
+                snprintf(buffer, size, "%s r%d, [r%d, r%d]", name, insn.rd, insn.rn, insn.rm);
+            }
+            break;
+        case ARM_I_LDM:
+        case ARM_I_STM:
+            snprintf(buffer, size, "%s r%d, {0x%04x}", name, insn.rn, insn.imm);
+            break;
+        case ARM_I_IT:
+        case ARM_I_BKPT:
+        case ARM_I_MRS:
+        case ARM_I_MSR:
+            snprintf(buffer, size, "%s 0x%x", name, insn.imm);
+            break;
+        case ARM_I_NOP:
+        case ARM_I_UNDECODED:
+        case ARM_I_UNDEFINED:
+        case ARM_I_COUNT:
+            snprintf(buffer, size, "%s", name);
+            break;
+        default:
+            if (insn.flags & ARM_INSN_IMM) {
+                snprintf(buffer, size, "%s%s r%d, r%d, #%u", name, suffix, insn.rd, insn.rn, insn.imm);
+            } else {
+                snprintf(buffer, size, "%s%s r%d, r%d, r%d", name, suffix, insn.rd, insn.rn, insn.rm);
+            }
+            break;
+    }
+
+    return insn.length;
+}
+
+const mcu_core_ops_t arm_core_ops = {
+    .name = "ARM Cortex-M3",
+    .register_count = ARM_REG_XPSR + 1,
+    .init = arm_core_init,
+    .cleanup = arm_core_cleanup,
+    .reset = arm_core_reset,
+    .invalidate = arm_core_invalidate,
+    .mark_breakpoint = arm_core_mark_breakpoint,
+    .step = arm_core_step,
+    .run_block = arm_core_run,
+    .read_reg = arm_read_reg,
+    .write_reg = arm_write_reg,
+    .disassemble = arm_disassemble,
+};
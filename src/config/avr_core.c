@@ -0,0 +1,892 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/avr_core.h"
+
+// Campos comuns das instruções de 16 bits
+#define AVR_D5(op) (((op) >> 4) & 0x1F)
+#define AVR_R5(op) (((op) & 0x0F) | (((op) >> 5) & 0x10))
+#define AVR_D4(op) (16 + (((op) >> 4) & 0x0F))
+#define AVR_K8(op) (((op) & 0x0F) | (((op) >> 4) & 0xF0))
+
+static inline int32_t sign_extend(uint32_t value, int bits) {
+    uint32_t mask = 1u << (bits - 1);
+    return (int32_t)((value ^ mask) - mask);
+}
+
+static avr_insn_t avr_insn(avr_op_t op, uint8_t d, uint8_t r, uint32_t k) {
+    avr_insn_t insn = { .op = op, .d = d, .r = r, .length = 1, .k = k };
+    return insn;
+}
+
+static avr_insn_t avr_decode_load_store(uint16_t op, uint16_t next) {
+    bool store = (op & 0x0200) != 0;
+    uint8_t reg = AVR_D5(op);
+
+    switch (op & 0x0F) {
+        case 0x0: {
+            avr_insn_t insn = avr_insn(store ? AVR_OP_STS : AVR_OP_LDS, reg, reg, next);
+            insn.length = 2;
+            return insn;
+        }
+        case 0x1: return avr_insn(store ? AVR_OP_ST_Z_INC : AVR_OP_LD_Z_INC, reg, reg, 0);
+        case 0x2: return avr_insn(store ? AVR_OP_ST_Z_DEC : AVR_OP_LD_Z_DEC, reg, reg, 0);
+        case 0x4: return store ? avr_insn(AVR_OP_ILLEGAL, 0, 0, 0) : avr_insn(AVR_OP_LPM, reg, 0, 0);
+        case 0x5: return store ? avr_insn(AVR_OP_ILLEGAL, 0, 0, 0) : avr_insn(AVR_OP_LPM_INC, reg, 0, 0);
+        case 0x9: return avr_insn(store ? AVR_OP_ST_Y_INC : AVR_OP_LD_Y_INC, reg, reg, 0);
+        case 0xA: return avr_insn(store ? AVR_OP_ST_Y_DEC : AVR_OP_LD_Y_DEC, reg, reg, 0);
+        case 0xC: return avr_insn(store ? AVR_OP_ST_X : AVR_OP_LD_X, reg, reg, 0);
+        case 0xD: return avr_insn(store ? AVR_OP_ST_X_INC : AVR_OP_LD_X_INC, reg, reg, 0);
+        case 0xE: return avr_insn(store ? AVR_OP_ST_X_DEC : AVR_OP_LD_X_DEC, reg, reg, 0);
+        case 0xF: return avr_insn(store ? AVR_OP_PUSH : AVR_OP_POP, reg, reg, 0);
+        default: return avr_insn(AVR_OP_ILLEGAL, 0, 0, 0);
+    }
+}
+
+static avr_insn_t avr_decode_one_operand(uint16_t op, uint16_t next) {
+    uint8_t reg = AVR_D5(op);
+
+    switch (op & 0x0F) {
+        case 0x0: return avr_insn(AVR_OP_COM, reg, 0, 0);
+        case 0x1: return avr_insn(AVR_OP_NEG, reg, 0, 0);
+        case 0x2: return avr_insn(AVR_OP_SWAP, reg, 0, 0);
+        case 0x3: return avr_insn(AVR_OP_INC, reg, 0, 0);
+        case 0x5: return avr_insn(AVR_OP_ASR, reg, 0, 0);
+        case 0x6: return avr_insn(AVR_OP_LSR, reg, 0, 0);
+        case 0x7: return avr_insn(AVR_OP_ROR, reg, 0, 0);
+        case 0xA: return avr_insn(AVR_OP_DEC, reg, 0, 0);
+        case 0x8:
+            if ((op & 0x0100) == 0) {
+                uint8_t bit = (op >> 4) & 0x07;
+                return avr_insn((op & 0x0080) ? AVR_OP_BCLR : AVR_OP_BSET, bit, 0, 0);
+            }
+            switch ((op >> 4) & 0x0F) {
+                case 0x0: return avr_insn(AVR_OP_RET, 0, 0, 0);
+                case 0x1: return avr_insn(AVR_OP_RETI, 0, 0, 0);
+                case 0x8: return avr_insn(AVR_OP_SLEEP, 0, 0, 0);
+                case 0x9: return avr_insn(AVR_OP_BREAK, 0, 0, 0);
+                case 0xA: return avr_insn(AVR_OP_WDR, 0, 0, 0);
+                case 0xC: return avr_insn(AVR_OP_LPM_R0, 0, 0, 0);
+                case 0xE: return avr_insn(AVR_OP_SPM, 0, 0, 0);
+                default: return avr_insn(AVR_OP_ILLEGAL, 0, 0, 0);
+            }
+        case 0x9:
+            if (op == 0x9409) return avr_insn(AVR_OP_IJMP, 0, 0, 0);
+            if (op == 0x9509) return avr_insn(AVR_OP_ICALL, 0, 0, 0);
+            return avr_insn(AVR_OP_ILLEGAL, 0, 0, 0);
+        case 0xC:
+        case 0xD:
+        case 0xE:
+        case 0xF: {
+            uint32_t high = ((op >> 3) & 0x3E) | (op & 0x01);
+            avr_insn_t insn = avr_insn((op & 0x02) ? AVR_OP_CALL : AVR_OP_JMP, 0, 0,
+                                       (high << 16) | next);
+            insn.length = 2;
+            return insn;
+        }
+        default:
+            return avr_insn(AVR_OP_ILLEGAL, 0, 0, 0);
+    }
+}
+
+avr_insn_t avr_decode(uint16_t op, uint16_t next) {
+    switch (op >> 12) {
+        case 0x0:
+            switch ((op >> 10) & 0x03) {
+                case 0:
+                    switch ((op >> 8) & 0x03) {
+                        case 0:
+                            return avr_insn(op == 0 ? AVR_OP_NOP : AVR_OP_ILLEGAL, 0, 0, 0);
+                        case 1:
+                            return avr_insn(AVR_OP_MOVW, ((op >> 4) & 0x0F) * 2, (op & 0x0F) * 2, 0);
+                        case 2:
+                            return avr_insn(AVR_OP_MULS, AVR_D4(op), 16 + (op & 0x0F), 0);
+                        default: {
+                            static const avr_op_t ops[] = {
+                                AVR_OP_MULSU, AVR_OP_FMUL, AVR_OP_FMULS, AVR_OP_FMULSU
+                            };
+                            int sel = ((op >> 6) & 0x02) | ((op >> 3) & 0x01);
+                            return avr_insn(ops[sel], 16 + ((op >> 4) & 0x07), 16 + (op & 0x07), 0);
+                        }
+                    }
+                case 1: return avr_insn(AVR_OP_CPC, AVR_D5(op), AVR_R5(op), 0);
+                case 2: return avr_insn(AVR_OP_SBC, AVR_D5(op), AVR_R5(op), 0);
+                default: return avr_insn(AVR_OP_ADD, AVR_D5(op), AVR_R5(op), 0);
+            }
+        case 0x1: {
+            static const avr_op_t ops[] = { AVR_OP_CPSE, AVR_OP_CP, AVR_OP_SUB, AVR_OP_ADC };
+            return avr_insn(ops[(op >> 10) & 0x03], AVR_D5(op), AVR_R5(op), 0);
+        }
+        case 0x2: {
+            static const avr_op_t ops[] = { AVR_OP_AND, AVR_OP_EOR, AVR_OP_OR, AVR_OP_MOV };
+            return avr_insn(ops[(op >> 10) & 0x03], AVR_D5(op), AVR_R5(op), 0);
+        }
+        case 0x3: return avr_insn(AVR_OP_CPI, AVR_D4(op), 0, AVR_K8(op));
+        case 0x4: return avr_insn(AVR_OP_SBCI, AVR_D4(op), 0, AVR_K8(op));
+        case 0x5: return avr_insn(AVR_OP_SUBI, AVR_D4(op), 0, AVR_K8(op));
+        case 0x6: return avr_insn(AVR_OP_ORI, AVR_D4(op), 0, AVR_K8(op));
+        case 0x7: return avr_insn(AVR_OP_ANDI, AVR_D4(op), 0, AVR_K8(op));
+        case 0x8:
+        case 0xA: {
+            uint32_t q = (op & 0x07) | ((op >> 7) & 0x18) | ((op >> 8) & 0x20);
+            bool store = (op & 0x0200) != 0;
+            bool y = (op & 0x0008) != 0;
+            avr_op_t kind = store ? (y ? AVR_OP_STD_Y : AVR_OP_STD_Z)
+                                  : (y ? AVR_OP_LDD_Y : AVR_OP_LDD_Z);
+            return avr_insn(kind, AVR_D5(op), AVR_D5(op), q);
+        }
+        case 0x9:
+            switch ((op >> 8) & 0x0F) {
+                case 0x0:
+                case 0x1:
+                case 0x2:
+                case 0x3:
+                    return avr_decode_load_store(op, next);
+                case 0x4:
+                case 0x5:
+                    return avr_decode_one_operand(op, next);
+                case 0x6:
+                case 0x7: {
+                    uint8_t reg = 24 + ((op >> 4) & 0x03) * 2;
+                    uint32_t k = (op & 0x0F) | ((op >> 2) & 0x30);
+                    return avr_insn((op & 0x0100) ? AVR_OP_SBIW : AVR_OP_ADIW, reg, 0, k);
+                }
+                case 0x8: return avr_insn(AVR_OP_CBI, (op >> 3) & 0x1F, op & 0x07, 0);
+                case 0x9: return avr_insn(AVR_OP_SBIC, (op >> 3) & 0x1F, op & 0x07, 0);
+                case 0xA: return avr_insn(AVR_OP_SBI, (op >> 3) & 0x1F, op & 0x07, 0);
+                case 0xB: return avr_insn(AVR_OP_SBIS, (op >> 3) & 0x1F, op & 0x07, 0);
+                default: return avr_insn(AVR_OP_MUL, AVR_D5(op), AVR_R5(op), 0);
+            }
+        case 0xB: {
+            uint8_t io = (op & 0x0F) | ((op >> 5) & 0x30);
+            return avr_insn((op & 0x0800) ? AVR_OP_OUT : AVR_OP_IN, io, AVR_D5(op), 0);
+        }
+        case 0xC: return avr_insn(AVR_OP_RJMP, 0, 0, (uint32_t)sign_extend(op & 0x0FFF, 12));
+        case 0xD: return avr_insn(AVR_OP_RCALL, 0, 0, (uint32_t)sign_extend(op & 0x0FFF, 12));
+        case 0xE: return avr_insn(AVR_OP_LDI, AVR_D4(op), 0, AVR_K8(op));
+        default:
+            if (op & 0x0800) {
+                static const avr_op_t ops[] = { AVR_OP_BLD, AVR_OP_BST, AVR_OP_SBRC, AVR_OP_SBRS };
+                if (op & 0x0008) {
+                    return avr_insn(AVR_OP_ILLEGAL, 0, 0, 0);
+                }
+                return avr_insn(ops[(op >> 9) & 0x03], AVR_D5(op), op & 0x07, 0);
+            }
+            return avr_insn((op & 0x0400) ? AVR_OP_BRBC : AVR_OP_BRBS, op & 0x07, 0,
+                            (uint32_t)sign_extend((op >> 3) & 0x7F, 7));
+    }
+}
+
+int avr_core_init(microcontroller_t* mcu) {
+    uint32_t words = mcu->memory_size / 2;
+
+    mcu->avr_code = calloc(words, sizeof(avr_insn_t));
+    if (!mcu->avr_code) {
+        fprintf(stderr, "Erro ao alocar cache de instruções\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+void avr_core_cleanup(microcontroller_t* mcu) {
+    free(mcu->avr_code);
+    mcu->avr_code = NULL;
+}
+
+void avr_core_invalidate(microcontroller_t* mcu) {
+    if (mcu->avr_code) {
+        memset(mcu->avr_code, 0, (mcu->memory_size / 2) * sizeof(avr_insn_t));
+    }
+}
+
+static inline uint16_t avr_flash_word(const microcontroller_t* mcu, uint32_t word) {
+    if (word >= mcu->memory_size / 2) {
+        return 0;
+    }
+    return (uint16_t)(mcu->memory[word * 2] | (mcu->memory[word * 2 + 1] << 8));
+}
+
+static inline avr_insn_t* avr_fetch(microcontroller_t* mcu, uint32_t word) {
+    avr_insn_t* insn = &mcu->avr_code[word];
+    if (insn->op == AVR_OP_UNDECODED) {
+        *insn = avr_decode(avr_flash_word(mcu, word), avr_flash_word(mcu, word + 1));
+        if (mcu->breakpoint_count > 0 && mcu_has_breakpoint(mcu, word * 2)) {
+            insn->flags |= AVR_INSN_BREAKPOINT;
+        }
+    }
+    return insn;
+}
+
+void avr_core_mark_breakpoint(microcontroller_t* mcu, uint32_t word, bool enabled) {
+    avr_insn_t* insn = &mcu->avr_code[word];
+
+    // Palavras ainda não decodificadas recebem a flag ao serem decodificadas
+    if (insn->op == AVR_OP_UNDECODED) {
+        return;
+    }
+
+    if (enabled) {
+        insn->flags |= AVR_INSN_BREAKPOINT;
+    } else {
+        insn->flags &= ~AVR_INSN_BREAKPOINT;
+    }
+}
+
+// Acesso ao espaço de dados; registradores e I/O passam pelo despacho de MMIO
+static inline uint8_t avr_read(microcontroller_t* mcu, uint32_t address) {
+    return mcu_data_read(mcu, address);
+}
+
+static inline void avr_write(microcontroller_t* mcu, uint32_t address, uint8_t value) {
+    mcu_data_write(mcu, address, value);
+}
+
+static inline uint16_t avr_get_sp(const microcontroller_t* mcu) {
+    return (uint16_t)(mcu->data_memory[AVR_SPL] | (mcu->data_memory[AVR_SPH] << 8));
+}
+
+static inline void avr_set_sp(microcontroller_t* mcu, uint16_t sp) {
+    mcu->data_memory[AVR_SPL] = sp & 0xFF;
+    mcu->data_memory[AVR_SPH] = sp >> 8;
+}
+
+static inline void avr_push(microcontroller_t* mcu, uint8_t value) {
+    uint16_t sp = avr_get_sp(mcu);
+    avr_write(mcu, sp, value);
+    avr_set_sp(mcu, sp - 1);
+}
+
+static inline uint8_t avr_pop(microcontroller_t* mcu) {
+    uint16_t sp = avr_get_sp(mcu) + 1;
+    avr_set_sp(mcu, sp);
+    return avr_read(mcu, sp);
+}
+
+// Endereço de retorno: byte baixo empilhado primeiro
+static inline void avr_push_pc(microcontroller_t* mcu, uint32_t word) {
+    avr_push(mcu, word & 0xFF);
+    avr_push(mcu, (word >> 8) & 0xFF);
+}
+
+static inline uint32_t avr_pop_pc(microcontroller_t* mcu) {
+    uint32_t high = avr_pop(mcu);
+    return (high << 8) | avr_pop(mcu);
+}
+
+static inline uint16_t avr_pair(const microcontroller_t* mcu, int low) {
+    return (uint16_t)(mcu->registers.avr[low] | (mcu->registers.avr[low + 1] << 8));
+}
+
+static inline void avr_set_pair(microcontroller_t* mcu, int low, uint16_t value) {
+    mcu->registers.avr[low] = value & 0xFF;
+    mcu->registers.avr[low + 1] = value >> 8;
+}
+
+// Atualiza os bits de SREG selecionados em mask
+static inline void avr_flags(microcontroller_t* mcu, uint8_t mask, uint8_t flags) {
+    uint8_t* sreg = &mcu->data_memory[AVR_SREG];
+    *sreg = (*sreg & ~mask) | (flags & mask);
+}
+
+static inline uint8_t avr_nzs(uint8_t result, bool v) {
+    uint8_t flags = 0;
+    bool n = (result & 0x80) != 0;
+    if (result == 0) flags |= AVR_FLAG_Z;
+    if (n) flags |= AVR_FLAG_N;
+    if (v) flags |= AVR_FLAG_V;
+    if (n != v) flags |= AVR_FLAG_S;
+    return flags;
+}
+
+static uint8_t avr_add(microcontroller_t* mcu, uint8_t rd, uint8_t rr, bool carry) {
+    uint8_t result = rd + rr + carry;
+    uint8_t c = (rd & rr) | (rr & ~result) | (~result & rd);
+    bool v = ((rd & rr & ~result) | (~rd & ~rr & result)) & 0x80;
+    uint8_t flags = avr_nzs(result, v);
+    if (c & 0x80) flags |= AVR_FLAG_C;
+    if (c & 0x08) flags |= AVR_FLAG_H;
+    avr_flags(mcu, AVR_FLAG_C | AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S | AVR_FLAG_H, flags);
+    return result;
+}
+
+// Subtração; keep_z implementa o Z encadeado de SBC/SBCI/CPC
+static uint8_t avr_sub(microcontroller_t* mcu, uint8_t rd, uint8_t rr, bool carry, bool keep_z) {
+    uint8_t result = rd - rr - carry;
+    uint8_t c = (~rd & rr) | (rr & result) | (result & ~rd);
+    bool v = ((rd & ~rr & ~result) | (~rd & rr & result)) & 0x80;
+    uint8_t flags = avr_nzs(result, v);
+    if (c & 0x80) flags |= AVR_FLAG_C;
+    if (c & 0x08) flags |= AVR_FLAG_H;
+    if (keep_z && !(mcu->data_memory[AVR_SREG] & AVR_FLAG_Z)) flags &= ~AVR_FLAG_Z;
+    avr_flags(mcu, AVR_FLAG_C | AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S | AVR_FLAG_H, flags);
+    return result;
+}
+
+static inline void avr_logic(microcontroller_t* mcu, uint8_t result) {
+    avr_flags(mcu, AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S, avr_nzs(result, false));
+}
+
+// Deslocamentos para a direita: C recebe o bit 0 e V = N ^ C
+static inline void avr_shift_flags(microcontroller_t* mcu, uint8_t result, bool carry) {
+    bool n = (result & 0x80) != 0;
+    uint8_t flags = avr_nzs(result, n != carry);
+    if (carry) flags |= AVR_FLAG_C;
+    avr_flags(mcu, AVR_FLAG_C | AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S, flags);
+}
+
+static inline void avr_mul_result(microcontroller_t* mcu, uint16_t product, bool carry) {
+    uint8_t flags = product == 0 ? AVR_FLAG_Z : 0;
+    if (carry) flags |= AVR_FLAG_C;
+    avr_flags(mcu, AVR_FLAG_C | AVR_FLAG_Z, flags);
+    avr_set_pair(mcu, 0, product);
+}
+
+// Ciclos extras de um skip: uma palavra a mais por palavra pulada. Depois
+// da última palavra do flash não há instrução: pula uma e o passo seguinte
+// para no fim do flash
+static inline uint32_t avr_skip(microcontroller_t* mcu, uint32_t next, int* cycles) {
+    uint32_t length = next < mcu->memory_size / 2 ? avr_fetch(mcu, next)->length : 1;
+    *cycles += length * AVR_SKIP_CYCLES_PER_WORD;
+    return next + length;
+}
+
+void avr_core_reset(microcontroller_t* mcu) {
+    uint16_t ramend = (uint16_t)(mcu->data_size - 1);
+    avr_set_sp(mcu, ramend);
+    mcu->data_memory[AVR_SREG] = 0;
+}
+
+int avr_core_step(microcontroller_t* mcu) {
+    uint8_t* r = mcu->registers.avr;
+    uint32_t pc = mcu->program_counter >> 1;
+
+    if (pc >= mcu->memory_size / 2) {
+        mcu->state = MCU_STATE_HALTED;
+        return 0;
+    }
+
+    const avr_insn_t* insn = avr_fetch(mcu, pc);
+    int cycles = mcu->cycle_table[insn->op];
+    uint32_t next = pc + insn->length;
+    uint8_t sreg = mcu->data_memory[AVR_SREG];
+    uint8_t d = insn->d;
+    uint8_t s = insn->r;
+
+    switch ((avr_op_t)insn->op) {
+        case AVR_OP_NOP:
+        case AVR_OP_WDR:
+        case AVR_OP_SLEEP:
+        case AVR_OP_SPM:
+            break;
+        case AVR_OP_MOVW:
+            r[d] = r[s];
+            r[d + 1] = r[s + 1];
+            break;
+        case AVR_OP_MUL:
+            avr_mul_result(mcu, (uint16_t)(r[d] * r[s]), ((r[d] * r[s]) & 0x8000) != 0);
+            break;
+        case AVR_OP_MULS: {
+            int16_t product = (int8_t)r[d] * (int8_t)r[s];
+            avr_mul_result(mcu, (uint16_t)product, (product & 0x8000) != 0);
+            break;
+        }
+        case AVR_OP_MULSU: {
+            int16_t product = (int8_t)r[d] * (uint8_t)r[s];
+            avr_mul_result(mcu, (uint16_t)product, (product & 0x8000) != 0);
+            break;
+        }
+        case AVR_OP_FMUL: {
+            uint16_t product = (uint16_t)(r[d] * r[s]);
+            avr_mul_result(mcu, (uint16_t)(product << 1), (product & 0x8000) != 0);
+            break;
+        }
+        case AVR_OP_FMULS: {
+            uint16_t product = (uint16_t)((int8_t)r[d] * (int8_t)r[s]);
+            avr_mul_result(mcu, (uint16_t)(product << 1), (product & 0x8000) != 0);
+            break;
+        }
+        case AVR_OP_FMULSU: {
+            uint16_t product = (uint16_t)((int8_t)r[d] * (uint8_t)r[s]);
+            avr_mul_result(mcu, (uint16_t)(product << 1), (product & 0x8000) != 0);
+            break;
+        }
+        case AVR_OP_ADD:
+            r[d] = avr_add(mcu, r[d], r[s], false);
+            break;
+        case AVR_OP_ADC:
+            r[d] = avr_add(mcu, r[d], r[s], sreg & AVR_FLAG_C);
+            break;
+        case AVR_OP_SUB:
+            r[d] = avr_sub(mcu, r[d], r[s], false, false);
+            break;
+        case AVR_OP_SBC:
+            r[d] = avr_sub(mcu, r[d], r[s], sreg & AVR_FLAG_C, true);
+            break;
+        case AVR_OP_SUBI:
+            r[d] = avr_sub(mcu, r[d], insn->k, false, false);
+            break;
+        case AVR_OP_SBCI:
+            r[d] = avr_sub(mcu, r[d], insn->k, sreg & AVR_FLAG_C, true);
+            break;
+        case AVR_OP_CP:
+            avr_sub(mcu, r[d], r[s], false, false);
+            break;
+        case AVR_OP_CPC:
+            avr_sub(mcu, r[d], r[s], sreg & AVR_FLAG_C, true);
+            break;
+        case AVR_OP_CPI:
+            avr_sub(mcu, r[d], insn->k, false, false);
+            break;
+        case AVR_OP_CPSE:
+            if (r[d] == r[s]) {
+                next = avr_skip(mcu, next, &cycles);
+            }
+            break;
+        case AVR_OP_AND:
+            avr_logic(mcu, r[d] &= r[s]);
+            break;
+        case AVR_OP_ANDI:
+            avr_logic(mcu, r[d] &= insn->k);
+            break;
+        case AVR_OP_OR:
+            avr_logic(mcu, r[d] |= r[s]);
+            break;
+        case AVR_OP_ORI:
+            avr_logic(mcu, r[d] |= insn->k);
+            break;
+        case AVR_OP_EOR:
+            avr_logic(mcu, r[d] ^= r[s]);
+            break;
+        case AVR_OP_MOV:
+            r[d] = r[s];
+            break;
+        case AVR_OP_LDI:
+            r[d] = insn->k;
+            break;
+        case AVR_OP_COM:
+            r[d] = ~r[d] & 0xFF;
+            avr_flags(mcu, AVR_FLAG_C | AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S,
+                      avr_nzs(r[d], false) | AVR_FLAG_C);
+            break;
+        case AVR_OP_NEG: {
+            uint8_t rd = r[d];
+            uint8_t result = -rd;
+            uint8_t flags = avr_nzs(result, result == 0x80);
+            if (result != 0) flags |= AVR_FLAG_C;
+            if ((result | rd) & 0x08) flags |= AVR_FLAG_H;
+            avr_flags(mcu, 0x3F, flags);
+            r[d] = result;
+            break;
+        }
+        case AVR_OP_SWAP:
+            r[d] = ((r[d] << 4) | (r[d] >> 4)) & 0xFF;
+            break;
+        case AVR_OP_INC:
+            r[d] = (r[d] + 1) & 0xFF;
+            avr_flags(mcu, AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S, avr_nzs(r[d], r[d] == 0x80));
+            break;
+        case AVR_OP_DEC:
+            r[d] = (r[d] - 1) & 0xFF;
+            avr_flags(mcu, AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S, avr_nzs(r[d], r[d] == 0x7F));
+            break;
+        case AVR_OP_ASR: {
+            bool carry = r[d] & 0x01;
+            r[d] = (r[d] >> 1) | (r[d] & 0x80);
+            avr_shift_flags(mcu, r[d], carry);
+            break;
+        }
+        case AVR_OP_LSR: {
+            bool carry = r[d] & 0x01;
+            r[d] >>= 1;
+            avr_shift_flags(mcu, r[d], carry);
+            break;
+        }
+        case AVR_OP_ROR: {
+            bool carry = r[d] & 0x01;
+            r[d] = (r[d] >> 1) | ((sreg & AVR_FLAG_C) ? 0x80 : 0);
+            avr_shift_flags(mcu, r[d], carry);
+            break;
+        }
+        case AVR_OP_ADIW:
+        case AVR_OP_SBIW: {
+            uint16_t rd = avr_pair(mcu, d);
+            uint16_t result = insn->op == AVR_OP_ADIW ? rd + insn->k : rd - insn->k;
+            bool rdh7 = rd & 0x8000;
+            bool r15 = result & 0x8000;
+            bool v = insn->op == AVR_OP_ADIW ? (!rdh7 && r15) : (rdh7 && !r15);
+            bool c = insn->op == AVR_OP_ADIW ? (!r15 && rdh7) : (r15 && !rdh7);
+            uint8_t flags = 0;
+            if (result == 0) flags |= AVR_FLAG_Z;
+            if (r15) flags |= AVR_FLAG_N;
+            if (v) flags |= AVR_FLAG_V;
+            if (r15 != v) flags |= AVR_FLAG_S;
+            if (c) flags |= AVR_FLAG_C;
+            avr_flags(mcu, AVR_FLAG_C | AVR_FLAG_Z | AVR_FLAG_N | AVR_FLAG_V | AVR_FLAG_S, flags);
+            avr_set_pair(mcu, d, result);
+            break;
+        }
+        case AVR_OP_BSET:
+            mcu->data_memory[AVR_SREG] |= (1 << d);
+            break;
+        case AVR_OP_BCLR:
+            mcu->data_memory[AVR_SREG] &= ~(1 << d);
+            break;
+        case AVR_OP_BST:
+            avr_flags(mcu, AVR_FLAG_T, (r[d] & (1 << s)) ? AVR_FLAG_T : 0);
+            break;
+        case AVR_OP_BLD:
+            if (sreg & AVR_FLAG_T) {
+                r[d] |= (1 << s);
+            } else {
+                r[d] &= ~(1u << s);
+            }
+            break;
+        case AVR_OP_SBRC:
+            if (!(r[d] & (1 << s))) {
+                next = avr_skip(mcu, next, &cycles);
+            }
+            break;
+        case AVR_OP_SBRS:
+            if (r[d] & (1 << s)) {
+                next = avr_skip(mcu, next, &cycles);
+            }
+            break;
+        case AVR_OP_IN:
+            r[s] = avr_read(mcu, AVR_IO_BASE + d);
+            break;
+        case AVR_OP_OUT:
+            avr_write(mcu, AVR_IO_BASE + d, r[s]);
+            break;
+        case AVR_OP_CBI:
+            avr_write(mcu, AVR_IO_BASE + d, avr_read(mcu, AVR_IO_BASE + d) & ~(1 << s));
+            break;
+        case AVR_OP_SBI:
+            avr_write(mcu, AVR_IO_BASE + d, avr_read(mcu, AVR_IO_BASE + d) | (1 << s));
+            break;
+        case AVR_OP_SBIC:
+            if (!(avr_read(mcu, AVR_IO_BASE + d) & (1 << s))) {
+                next = avr_skip(mcu, next, &cycles);
+            }
+            break;
+        case AVR_OP_SBIS:
+            if (avr_read(mcu, AVR_IO_BASE + d) & (1 << s)) {
+                next = avr_skip(mcu, next, &cycles);
+            }
+            break;
+        case AVR_OP_LDS:
+            r[d] = avr_read(mcu, insn->k);
+            break;
+        case AVR_OP_STS:
+            avr_write(mcu, insn->k, r[d]);
+            break;
+        case AVR_OP_LDD_Y:
+            r[d] = avr_read(mcu, avr_pair(mcu, 28) + insn->k);
+            break;
+        case AVR_OP_LDD_Z:
+            r[d] = avr_read(mcu, avr_pair(mcu, 30) + insn->k);
+            break;
+        case AVR_OP_STD_Y:
+            avr_write(mcu, avr_pair(mcu, 28) + insn->k, r[d]);
+            break;
+        case AVR_OP_STD_Z:
+            avr_write(mcu, avr_pair(mcu, 30) + insn->k, r[d]);
+            break;
+        case AVR_OP_LD_X:
+            r[d] = avr_read(mcu, avr_pair(mcu, 26));
+            break;
+        case AVR_OP_ST_X:
+            avr_write(mcu, avr_pair(mcu, 26), r[d]);
+            break;
+        case AVR_OP_LD_X_INC:
+        case AVR_OP_LD_Y_INC:
+        case AVR_OP_LD_Z_INC: {
+            int ptr = insn->op == AVR_OP_LD_X_INC ? 26 : insn->op == AVR_OP_LD_Y_INC ? 28 : 30;
+            uint16_t address = avr_pair(mcu, ptr);
+            avr_set_pair(mcu, ptr, address + 1);
+            r[d] = avr_read(mcu, address);
+            break;
+        }
+        case AVR_OP_LD_X_DEC:
+        case AVR_OP_LD_Y_DEC:
+        case AVR_OP_LD_Z_DEC: {
+            int ptr = insn->op == AVR_OP_LD_X_DEC ? 26 : insn->op == AVR_OP_LD_Y_DEC ? 28 : 30;
+            uint16_t address = avr_pair(mcu, ptr) - 1;
+            avr_set_pair(mcu, ptr, address);
+            r[d] = avr_read(mcu, address);
+            break;
+        }
+        case AVR_OP_ST_X_INC:
+        case AVR_OP_ST_Y_INC:
+        case AVR_OP_ST_Z_INC: {
+            int ptr = insn->op == AVR_OP_ST_X_INC ? 26 : insn->op == AVR_OP_ST_Y_INC ? 28 : 30;
+            uint16_t address = avr_pair(mcu, ptr);
+            uint8_t value = r[d];
+            avr_set_pair(mcu, ptr, address + 1);
+            avr_write(mcu, address, value);
+            break;
+        }
+        case AVR_OP_ST_X_DEC:
+        case AVR_OP_ST_Y_DEC:
+        case AVR_OP_ST_Z_DEC: {
+            int ptr = insn->op == AVR_OP_ST_X_DEC ? 26 : insn->op == AVR_OP_ST_Y_DEC ? 28 : 30;
+            uint16_t address = avr_pair(mcu, ptr) - 1;
+            uint8_t value = r[d];
+            avr_set_pair(mcu, ptr, address);
+            avr_write(mcu, address, value);
+            break;
+        }
+        case AVR_OP_LPM_R0:
+            r[0] = mcu->memory[avr_pair(mcu, 30) % mcu->memory_size];
+            break;
+        case AVR_OP_LPM:
+            r[d] = mcu->memory[avr_pair(mcu, 30) % mcu->memory_size];
+            break;
+        case AVR_OP_LPM_INC: {
+            uint16_t z = avr_pair(mcu, 30);
+            avr_set_pair(mcu, 30, z + 1);
+            r[d] = mcu->memory[z % mcu->memory_size];
+            break;
+        }
+        case AVR_OP_PUSH:
+            avr_push(mcu, r[d]);
+            break;
+        case AVR_OP_POP:
+            r[d] = avr_pop(mcu);
+            break;
+        case AVR_OP_RJMP:
+            next = pc + 1 + (int32_t)insn->k;
+            break;
+        case AVR_OP_RCALL:
+            avr_push_pc(mcu, next);
+            next = pc + 1 + (int32_t)insn->k;
+            break;
+        case AVR_OP_JMP:
+            next = insn->k;
+            break;
+        case AVR_OP_CALL:
+            avr_push_pc(mcu, next);
+            next = insn->k;
+            break;
+        case AVR_OP_IJMP:
+            next = avr_pair(mcu, 30);
+            break;
+        case AVR_OP_ICALL:
+            avr_push_pc(mcu, next);
+            next = avr_pair(mcu, 30);
+            break;
+        case AVR_OP_RET:
+            next = avr_pop_pc(mcu);
+            break;
+        case AVR_OP_RETI:
+            next = avr_pop_pc(mcu);
+            mcu->data_memory[AVR_SREG] |= AVR_FLAG_I;
+            break;
+        case AVR_OP_BRBS:
+            if (sreg & (1 << d)) {
+                next = pc + 1 + (int32_t)insn->k;
+                cycles += AVR_BRANCH_TAKEN_CYCLES;
+            }
+            break;
+        case AVR_OP_BRBC:
+            if (!(sreg & (1 << d))) {
+                next = pc + 1 + (int32_t)insn->k;
+                cycles += AVR_BRANCH_TAKEN_CYCLES;
+            }
+            break;
+        case AVR_OP_BREAK:
+            mcu->state = MCU_STATE_HALTED;
+            break;
+        case AVR_OP_UNDECODED:
+        case AVR_OP_ILLEGAL:
+        case AVR_OP_COUNT:
+            fprintf(stderr, "Instrução inválida 0x%04x em 0x%08x\n",
+                    avr_flash_word(mcu, pc), mcu->program_counter);
+            mcu->state = MCU_STATE_ERROR;
+            return -1;
+    }
+
+    mcu->program_counter = next << 1;
+    mcu->cycle_count += cycles;
+
+    return cycles;
+}
+
+int avr_core_run(microcontroller_t* mcu, uint64_t stop) {
+    // Sem breakpoints o laço não faz nenhuma verificação extra
+    if (mcu->breakpoint_count == 0) {
+        while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < stop) {
+            if (avr_core_step(mcu) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    uint32_t words = mcu->memory_size / 2;
+
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < stop) {
+        uint32_t pc = mcu->program_counter >> 1;
+
+        if (pc < words && (avr_fetch(mcu, pc)->flags & AVR_INSN_BREAKPOINT)) {
+            if (!mcu->skip_breakpoint || mcu->program_counter != mcu->stop_address) {
+                mcu->state = MCU_STATE_HALTED;
+                mcu->stop_reason = MCU_STOP_BREAKPOINT;
+                mcu->stop_address = mcu->program_counter;
+                mcu->skip_breakpoint = true;
+                break;
+            }
+        }
+        mcu->skip_breakpoint = false;
+
+        if (avr_core_step(mcu) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int avr_read_reg(const microcontroller_t* mcu, int index, uint32_t* value) {
+    if (index < 0 || index >= AVR_REGISTER_COUNT) {
+        return -1;
+    }
+    *value = mcu->registers.avr[index];
+    return 0;
+}
+
+static int avr_write_reg(microcontroller_t* mcu, int index, uint32_t value) {
+    if (index < 0 || index >= AVR_REGISTER_COUNT) {
+        return -1;
+    }
+    mcu->registers.avr[index] = (uint8_t)value;
+    return 0;
+}
+
+static const char* const avr_mnemonics[AVR_OP_COUNT] = {
+    [AVR_OP_NOP] = "nop", [AVR_OP_MOVW] = "movw", [AVR_OP_MULS] = "muls", [AVR_OP_MULSU] = "mulsu",
+    [AVR_OP_FMUL] = "fmul", [AVR_OP_FMULS] = "fmuls", [AVR_OP_FMULSU] = "fmulsu", [AVR_OP_CPC] = "cpc",
+    [AVR_OP_SBC] = "sbc", [AVR_OP_ADD] = "add", [AVR_OP_CPSE] = "cpse", [AVR_OP_CP] = "cp",
+    [AVR_OP_SUB] = "sub", [AVR_OP_ADC] = "adc", [AVR_OP_AND] = "and", [AVR_OP_EOR] = "eor",
+    [AVR_OP_OR] = "or", [AVR_OP_MOV] = "mov", [AVR_OP_CPI] = "cpi", [AVR_OP_SBCI] = "sbci",
+    [AVR_OP_SUBI] = "subi", [AVR_OP_ORI] = "ori", [AVR_OP_ANDI] = "andi", [AVR_OP_LDD_Y] = "ldd",
+    [AVR_OP_LDD_Z] = "ldd", [AVR_OP_STD_Y] = "std", [AVR_OP_STD_Z] = "std", [AVR_OP_LDS] = "lds",
+    [AVR_OP_LD_X] = "ld", [AVR_OP_LD_X_INC] = "ld", [AVR_OP_LD_X_DEC] = "ld", [AVR_OP_LD_Y_INC] = "ld",
+    [AVR_OP_LD_Y_DEC] = "ld", [AVR_OP_LD_Z_INC] = "ld", [AVR_OP_LD_Z_DEC] = "ld", [AVR_OP_LPM_R0] = "lpm",
+    [AVR_OP_LPM] = "lpm", [AVR_OP_LPM_INC] = "lpm", [AVR_OP_POP] = "pop", [AVR_OP_STS] = "sts",
+    [AVR_OP_ST_X] = "st", [AVR_OP_ST_X_INC] = "st", [AVR_OP_ST_X_DEC] = "st", [AVR_OP_ST_Y_INC] = "st",
+    [AVR_OP_ST_Y_DEC] = "st", [AVR_OP_ST_Z_INC] = "st", [AVR_OP_ST_Z_DEC] = "st", [AVR_OP_PUSH] = "push",
+    [AVR_OP_COM] = "com", [AVR_OP_NEG] = "neg", [AVR_OP_SWAP] = "swap", [AVR_OP_INC] = "inc",
+    [AVR_OP_ASR] = "asr", [AVR_OP_LSR] = "lsr", [AVR_OP_ROR] = "ror", [AVR_OP_DEC] = "dec",
+    [AVR_OP_BSET] = "bset", [AVR_OP_BCLR] = "bclr", [AVR_OP_RET] = "ret", [AVR_OP_RETI] = "reti",
+    [AVR_OP_SLEEP] = "sleep", [AVR_OP_BREAK] = "break", [AVR_OP_WDR] = "wdr", [AVR_OP_SPM] = "spm",
+    [AVR_OP_IJMP] = "ijmp", [AVR_OP_ICALL] = "icall", [AVR_OP_JMP] = "jmp", [AVR_OP_CALL] = "call",
+    [AVR_OP_ADIW] = "adiw", [AVR_OP_SBIW] = "sbiw", [AVR_OP_CBI] = "cbi", [AVR_OP_SBIC] = "sbic",
+    [AVR_OP_SBI] = "sbi", [AVR_OP_SBIS] = "sbis", [AVR_OP_MUL] = "mul", [AVR_OP_IN] = "in",
+    [AVR_OP_OUT] = "out", [AVR_OP_RJMP] = "rjmp", [AVR_OP_RCALL] = "rcall", [AVR_OP_LDI] = "ldi",
+    [AVR_OP_BRBS] = "brbs", [AVR_OP_BRBC] = "brbc", [AVR_OP_BLD] = "bld", [AVR_OP_BST] = "bst",
+    [AVR_OP_SBRC] = "sbrc", [AVR_OP_SBRS] = "sbrs",
+};
+
+static int avr_disassemble(const microcontroller_t* mcu, uint32_t address, char* buffer, size_t size) {
+    uint32_t word = address >> 1;
+
+    if (word >= mcu->memory_size / 2) {
+        return -1;
+    }
+
+    uint16_t opcode = avr_flash_word(mcu, word);
+    avr_insn_t insn = avr_decode(opcode, avr_flash_word(mcu, word + 1));
+    const char* name = avr_mnemonics[insn.op];
+    uint32_t target = (word + 1 + (int32_t)insn.k) * 2;
+
+    switch ((avr_op_t)insn.op) {
+        case AVR_OP_MOVW: case AVR_OP_MULS: case AVR_OP_MULSU: case AVR_OP_FMUL:
+        case AVR_OP_FMULS: case AVR_OP_FMULSU: case AVR_OP_CPC: case AVR_OP_SBC:
+        case AVR_OP_ADD: case AVR_OP_CPSE: case AVR_OP_CP: case AVR_OP_SUB:
+        case AVR_OP_ADC: case AVR_OP_AND: case AVR_OP_EOR: case AVR_OP_OR:
+        case AVR_OP_MOV: case AVR_OP_MUL:
+            snprintf(buffer, size, "%s r%u, r%u", name, insn.d, insn.r);
+            break;
+        case AVR_OP_CPI: case AVR_OP_SBCI: case AVR_OP_SUBI: case AVR_OP_ORI:
+        case AVR_OP_ANDI: case AVR_OP_LDI: case AVR_OP_ADIW: case AVR_OP_SBIW:
+            snprintf(buffer, size, "%s r%u, 0x%02x", name, insn.d, insn.k);
+            break;
+        case AVR_OP_COM: case AVR_OP_NEG: case AVR_OP_SWAP: case AVR_OP_INC:
+        case AVR_OP_ASR: case AVR_OP_LSR: case AVR_OP_ROR: case AVR_OP_DEC:
+        case AVR_OP_PUSH: case AVR_OP_POP:
+            snprintf(buffer, size, "%s r%u", name, insn.d);
+            break;
+        case AVR_OP_LDD_Y: snprintf(buffer, size, "ldd r%u, Y+%u", insn.d, insn.k); break;
+        case AVR_OP_LDD_Z: snprintf(buffer, size, "ldd r%u, Z+%u", insn.d, insn.k); break;
+        case AVR_OP_STD_Y: snprintf(buffer, size, "std Y+%u, r%u", insn.k, insn.d); break;
+        case AVR_OP_STD_Z: snprintf(buffer, size, "std Z+%u, r%u", insn.k, insn.d); break;
+        case AVR_OP_LDS: snprintf(buffer, size, "lds r%u, 0x%04x", insn.d, insn.k); break;
+        case AVR_OP_STS: snprintf(buffer, size, "sts 0x%04x, r%u", insn.k, insn.d); break;
+        case AVR_OP_LD_X: snprintf(buffer, size, "ld r%u, X", insn.d); break;
+        case AVR_OP_LD_X_INC: snprintf(buffer, size, "ld r%u, X+", insn.d); break;
+        case AVR_OP_LD_X_DEC: snprintf(buffer, size, "ld r%u, -X", insn.d); break;
+        case AVR_OP_LD_Y_INC: snprintf(buffer, size, "ld r%u, Y+", insn.d); break;
+        case AVR_OP_LD_Y_DEC: snprintf(buffer, size, "ld r%u, -Y", insn.d); break;
+        case AVR_OP_LD_Z_INC: snprintf(buffer, size, "ld r%u, Z+", insn.d); break;
+        case AVR_OP_LD_Z_DEC: snprintf(buffer, size, "ld r%u, -Z", insn.d); break;
+        case AVR_OP_ST_X: snprintf(buffer, size, "st X, r%u", insn.d); break;
+        case AVR_OP_ST_X_INC: snprintf(buffer, size, "st X+, r%u", insn.d); break;
+        case AVR_OP_ST_X_DEC: snprintf(buffer, size, "st -X, r%u", insn.d); break;
+        case AVR_OP_ST_Y_INC: snprintf(buffer, size, "st Y+, r%u", insn.d); break;
+        case AVR_OP_ST_Y_DEC: snprintf(buffer, size, "st -Y, r%u", insn.d); break;
+        case AVR_OP_ST_Z_INC: snprintf(buffer, size, "st Z+, r%u", insn.d); break;
+        case AVR_OP_ST_Z_DEC: snprintf(buffer, size, "st -Z, r%u", insn.d); break;
+        case AVR_OP_LPM: snprintf(buffer, size, "lpm r%u, Z", insn.d); break;
+        case AVR_OP_LPM_INC: snprintf(buffer, size, "lpm r%u, Z+", insn.d); break;
+        case AVR_OP_BSET:
+        case AVR_OP_BCLR:
+            snprintf(buffer, size, "%s %u", name, insn.d);
+            break;
+        case AVR_OP_JMP:
+        case AVR_OP_CALL:
+            snprintf(buffer, size, "%s 0x%04x", name, insn.k * 2);
+            break;
+        case AVR_OP_RJMP:
+        case AVR_OP_RCALL:
+            snprintf(buffer, size, "%s 0x%04x", name, target);
+            break;
+        case AVR_OP_BRBS:
+        case AVR_OP_BRBC:
+            snprintf(buffer, size, "%s %u, 0x%04x", name, insn.d, target);
+            break;
+        case AVR_OP_CBI: case AVR_OP_SBI: case AVR_OP_SBIC: case AVR_OP_SBIS:
+            snprintf(buffer, size, "%s 0x%02x, %u", name, insn.d, insn.r);
+            break;
+        case AVR_OP_IN: snprintf(buffer, size, "in r%u, 0x%02x", insn.r, insn.d); break;
+        case AVR_OP_OUT: snprintf(buffer, size, "out 0x%02x, r%u", insn.d, insn.r); break;
+        case AVR_OP_BLD: case AVR_OP_BST: case AVR_OP_SBRC: case AVR_OP_SBRS:
+            snprintf(buffer, size, "%s r%u, %u", name, insn.d, insn.r);
+            break;
+        case AVR_OP_UNDECODED:
+        case AVR_OP_ILLEGAL:
+        case AVR_OP_COUNT:
+            snprintf(buffer, size, ".word 0x%04x", opcode);
+            break;
+        default:
+            snprintf(buffer, size, "%s", name);
+            break;
+    }
+
+    return insn.length * 2;
+}
+
+const mcu_core_ops_t avr_core_ops = {
+    .name = "AVR",
+    .register_count = AVR_REGISTER_COUNT,
+    .init = avr_core_init,
+    .cleanup = avr_core_cleanup,
+    .reset = avr_core_reset,
+    .invalidate = avr_core_invalidate,
+    .mark_breakpoint = avr_core_mark_breakpoint,
+    .step = avr_core_step,
+    .run_block = avr_core_run,
+    .read_reg = avr_read_reg,
+    .write_reg = avr_write_reg,
+    .disassemble = avr_disassemble,
+};
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include "config/avr_io.h"
+#include "config/avr_core.h"
+
+typedef struct {
+    uint8_t pin_address;     // PINx; DDRx e PORTx vêm logo em seguida
+    char letter;
+    int8_t pins[8];          // pino físico - 1 de cada bit, -1 se não existe
+} avr_port_t;
+
+static const avr_port_t avr_ports[] = {
+    { AVR_PINB, 'B', { 13, 14, 15, 16, 17, 18, 8, 9 } },
+    { AVR_PINC, 'C', { 22, 23, 24, 25, 26, 27, 0, -1 } },
+    { AVR_PIND, 'D', { 1, 2, 3, 4, 5, 10, 11, 12 } },
+};
+
+#define AVR_PORT_COUNT (sizeof(avr_ports) / sizeof(avr_ports[0]))
+
+static uint8_t avr_register_read(microcontroller_t* mcu, uint32_t offset, void* context) {
+    (void)context;
+    return mcu->registers.avr[offset];
+}
+
+static void avr_register_write(microcontroller_t* mcu, uint32_t offset, uint8_t value, void* context) {
+    (void)context;
+    mcu->registers.avr[offset] = value;
+}
+
+// PORTx: os pinos só são atualizados quando o valor do registrador muda
+static void avr_port_write(microcontroller_t* mcu, uint32_t offset, uint8_t value, void* context) {
+    (void)context;
+    uint8_t old = mcu->data_memory[offset];
+    mcu->data_memory[offset] = value;
+
+    if (old != value) {
+        pin_update_register_change(&mcu->pin_manager, offset, old, value);
+    }
+}
+
+static void avr_ddr_write(microcontroller_t* mcu, uint32_t offset, uint8_t value, void* context) {
+    (void)context;
+    uint8_t changed = mcu->data_memory[offset] ^ value;
+    mcu->data_memory[offset] = value;
+
+    // Os pinos da porta são indexados pelo endereço de PORTx
+    pin_set_register_directions(&mcu->pin_manager, offset + 1, value);
+
+    // Um pino que virou saída passa a seguir o bit de PORTx, já que escritas
+    // em PORTx só atualizam os bits que mudam
+    if (changed & value) {
+        pin_update_from_register(&mcu->pin_manager, offset + 1, mcu->data_memory[offset + 1]);
+    }
+}
+
+// PINx lê o nível atual dos pinos
+static uint8_t avr_pin_read(microcontroller_t* mcu, uint32_t offset, void* context) {
+    (void)context;
+    uint32_t value = 0;
+    pin_update_to_register(&mcu->pin_manager, offset + 2, &value);
+    return (uint8_t)value;
+}
+
+// Escrever 1 em PINx alterna o bit correspondente de PORTx
+static void avr_pin_write(microcontroller_t* mcu, uint32_t offset, uint8_t value, void* context) {
+    uint32_t port = offset + 2;
+    avr_port_write(mcu, port, mcu->data_memory[port] ^ value, context);
+}
+
+int avr_io_init(microcontroller_t* mcu) {
+    for (uint32_t i = 0; i < AVR_REGISTER_COUNT; i++) {
+        if (mcu_map_io(mcu, i, avr_register_read, avr_register_write, NULL) < 0) {
+            return -1;
+        }
+    }
+
+    for (size_t p = 0; p < AVR_PORT_COUNT; p++) {
+        const avr_port_t* port = &avr_ports[p];
+        void* context = (void*)port;
+
+        if (mcu_map_io(mcu, port->pin_address, avr_pin_read, avr_pin_write, context) < 0 ||
+            mcu_map_io(mcu, port->pin_address + 1, NULL, avr_ddr_write, context) < 0 ||
+            mcu_map_io(mcu, port->pin_address + 2, NULL, avr_port_write, context) < 0) {
+            return -1;
+        }
+
+        for (int bit = 0; bit < 8; bit++) {
+            char name[12];
+            if (port->pins[bit] < 0) {
+                continue;
+            }
+            snprintf(name, sizeof(name), "P%c%d", port->letter, bit);
+            if (pin_configure(&mcu->pin_manager, port->pins[bit], PIN_INPUT, name) < 0 ||
+                pin_set_register_mapping(&mcu->pin_manager, port->pins[bit],
+                                         port->pin_address + 2, bit) < 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void avr_io_reset(microcontroller_t* mcu) {
+    for (size_t p = 0; p < AVR_PORT_COUNT; p++) {
+        pin_set_register_directions(&mcu->pin_manager, avr_ports[p].pin_address + 2, 0);
+    }
+}
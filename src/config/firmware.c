@@ -0,0 +1,507 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "config/firmware.h"
+
+// O avr-gcc coloca o espaço de dados em 0x800000 nos arquivos ELF;
+// EEPROM, fuses e lock bits ficam a partir de 0x810000 e são ignorados
+#define AVR_ELF_DATA_BASE 0x800000
+#define AVR_ELF_DATA_END  0x810000
+// PIC16: IDs, palavra de configuração e EEPROM a partir da palavra 0x2000
+#define PIC_HEX_CONFIG_BASE 0x4000
+
+#define ELF_MACHINE_ARM 40
+#define ELF_MACHINE_AVR 83
+#define ELF_PT_LOAD 1
+#define ELF_HEADER_SIZE 52
+#define ELF_PHDR_SIZE 32
+#define ELF_SHDR_SIZE 40
+#define ELF_SHT_SYMTAB 2
+#define ELF_SYM_SIZE 16
+#define ELF_STT_FUNC 2
+
+typedef struct {
+    microcontroller_t* mcu;
+    bool dry_run;
+    uint32_t flash_end;      // maior offset do flash ocupado
+    uint32_t entry_point;
+} loader_t;
+
+static inline uint16_t read16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int firmware_map(const char* path, firmware_file_t* file) {
+    if (!path || !file) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Erro ao abrir arquivo de firmware: %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        fprintf(stderr, "Arquivo de firmware vazio ou inválido: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Erro ao mapear arquivo de firmware: %s\n", path);
+        return -1;
+    }
+
+    file->data = data;
+    file->size = (size_t)st.st_size;
+    return 0;
+}
+
+void firmware_unmap(firmware_file_t* file) {
+    if (file && file->data) {
+        munmap((void*)file->data, file->size);
+        file->data = NULL;
+        file->size = 0;
+    }
+}
+
+firmware_format_t firmware_detect_format(const uint8_t* data, size_t size) {
+    if (size >= 4 && memcmp(data, "\x7f" "ELF", 4) == 0) {
+        return FIRMWARE_ELF;
+    }
+    if (size >= 11 && data[0] == ':') {
+        return FIRMWARE_IHEX;
+    }
+    return FIRMWARE_RAW;
+}
+
+const char* firmware_format_to_string(firmware_format_t format) {
+    switch (format) {
+        case FIRMWARE_RAW: return "binário";
+        case FIRMWARE_IHEX: return "Intel HEX";
+        case FIRMWARE_ELF: return "ELF";
+        default: return "desconhecido";
+    }
+}
+
+static bool loader_flash_offset(const microcontroller_t* mcu, uint32_t address, uint32_t size, uint32_t* offset) {
+    if (address < mcu->config.flash_start) {
+        return false;
+    }
+
+    *offset = address - mcu->config.flash_start;
+    return *offset < mcu->config.memory_size && size <= mcu->config.memory_size - *offset;
+}
+
+static bool loader_data_offset(const microcontroller_t* mcu, uint32_t address, uint32_t size, uint32_t* offset) {
+    switch (mcu->config.type) {
+        case MCU_AVR_ATMEGA328P:
+            if (address < AVR_ELF_DATA_BASE || address >= AVR_ELF_DATA_END) {
+                return false;
+            }
+            *offset = address - AVR_ELF_DATA_BASE;
+            break;
+        case MCU_ARM_CORTEX_M3:
+            if (address < mcu->data_base) {
+                return false;
+            }
+            *offset = address - mcu->data_base;
+            break;
+        default:
+            return false;
+    }
+
+    return *offset < mcu->data_size && size <= mcu->data_size - *offset;
+}
+
+static int loader_flash(loader_t* loader, uint32_t offset, const uint8_t* data, uint32_t size) {
+    if (!loader->dry_run) {
+        memcpy(loader->mcu->memory + offset, data, size);
+    }
+
+    if (offset + size > loader->flash_end) {
+        loader->flash_end = offset + size;
+    }
+
+    return 0;
+}
+
+// Inicializa a imagem da RAM: size bytes copiados (.data) e zero_size zerados (.bss)
+static int loader_ram(loader_t* loader, uint32_t offset, const uint8_t* data, uint32_t size, uint32_t zero_size) {
+    microcontroller_t* mcu = loader->mcu;
+
+    if (loader->dry_run) {
+        return 0;
+    }
+
+    if (!mcu->data_image) {
+        mcu->data_image = calloc(mcu->data_size, sizeof(uint8_t));
+        if (!mcu->data_image) {
+            fprintf(stderr, "Erro ao alocar imagem da RAM\n");
+            return -1;
+        }
+    }
+
+    memcpy(mcu->data_image + offset, data, size);
+    memset(mcu->data_image + offset + size, 0, zero_size);
+
+    return 0;
+}
+
+static int loader_place(loader_t* loader, uint32_t address, const uint8_t* data, uint32_t size) {
+    uint32_t offset;
+
+    if (loader_flash_offset(loader->mcu, address, size, &offset)) {
+        return loader_flash(loader, offset, data, size);
+    }
+    if (loader_data_offset(loader->mcu, address, size, &offset)) {
+        return loader_ram(loader, offset, data, size, 0);
+    }
+    // Não emulados; todo .hex gerado para PIC traz a palavra de configuração
+    if (loader->mcu->config.type == MCU_PIC16F877A && address >= PIC_HEX_CONFIG_BASE) {
+        return 0;
+    }
+
+    fprintf(stderr, "Firmware fora da memória: 0x%08x (%u bytes)\n", address, size);
+    return -1;
+}
+
+static int hex_nibble(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static int hex_byte(const uint8_t* p) {
+    int high = hex_nibble(p[0]);
+    int low = hex_nibble(p[1]);
+    return (high < 0 || low < 0) ? -1 : (high << 4) | low;
+}
+
+static int load_ihex(loader_t* loader, const uint8_t* data, size_t size) {
+    uint32_t base = 0;
+    size_t pos = 0;
+    int line = 0;
+
+    while (pos < size) {
+        if (data[pos] == '\r' || data[pos] == '\n' || data[pos] == ' ' || data[pos] == '\t') {
+            pos++;
+            continue;
+        }
+
+        line++;
+        if (data[pos] != ':' || size - pos < 11) {
+            fprintf(stderr, "Intel HEX inválido na linha %d\n", line);
+            return -1;
+        }
+
+        int count = hex_byte(data + pos + 1);
+        if (count < 0 || size - pos < 11 + (size_t)count * 2) {
+            fprintf(stderr, "Intel HEX truncado na linha %d\n", line);
+            return -1;
+        }
+
+        // Decodifica contagem, endereço, tipo, dados e checksum
+        uint8_t record[5 + 255];
+        uint8_t checksum = 0;
+        for (int i = 0; i < count + 5; i++) {
+            int value = hex_byte(data + pos + 1 + i * 2);
+            if (value < 0) {
+                fprintf(stderr, "Intel HEX inválido na linha %d\n", line);
+                return -1;
+            }
+            record[i] = (uint8_t)value;
+            checksum += record[i];
+        }
+
+        if (checksum != 0) {
+            fprintf(stderr, "Checksum inválido no Intel HEX, linha %d\n", line);
+            return -1;
+        }
+
+        uint32_t address = (record[1] << 8) | record[2];
+        const uint8_t* payload = record + 4;
+        pos += 11 + (size_t)count * 2;
+
+        // Registros de endereço têm tamanho fixo: 2 bytes (02, 04) ou 4 (03, 05)
+        int expected = record[3] == 0x02 || record[3] == 0x04 ? 2
+                       : record[3] == 0x03 || record[3] == 0x05 ? 4 : count;
+        if (count != expected) {
+            fprintf(stderr, "Intel HEX inválido na linha %d\n", line);
+            return -1;
+        }
+
+        switch (record[3]) {
+            case 0x00:
+                if (loader_place(loader, base + address, payload, count) < 0) {
+                    return -1;
+                }
+                break;
+            case 0x01:
+                return 0;
+            case 0x02:
+                base = (uint32_t)((payload[0] << 8) | payload[1]) << 4;
+                break;
+            case 0x03:
+                loader->entry_point = (((payload[0] << 8) | payload[1]) << 4) +
+                                      ((payload[2] << 8) | payload[3]);
+                break;
+            case 0x04:
+                base = (uint32_t)((payload[0] << 8) | payload[1]) << 16;
+                break;
+            case 0x05: {
+                // Como no ELF: no Thumb o bit 0 só indica o modo de execução
+                uint32_t entry = ((uint32_t)payload[0] << 24) | (payload[1] << 16) |
+                                 (payload[2] << 8) | payload[3];
+                loader->entry_point = loader->mcu->config.type == MCU_ARM_CORTEX_M3 ? entry & ~1u : entry;
+                break;
+            }
+            default:
+                fprintf(stderr, "Tipo de registro Intel HEX desconhecido: %02x\n", record[3]);
+                return -1;
+        }
+    }
+
+    fprintf(stderr, "Intel HEX sem registro de fim de arquivo\n");
+    return -1;
+}
+
+static int load_elf(loader_t* loader, const uint8_t* data, size_t size) {
+    microcontroller_t* mcu = loader->mcu;
+
+    // Somente ELF32 little-endian
+    if (size < ELF_HEADER_SIZE || data[4] != 1 || data[5] != 1) {
+        fprintf(stderr, "ELF não suportado (esperado ELF32 little-endian)\n");
+        return -1;
+    }
+
+    uint16_t machine = read16(data + 18);
+    uint16_t expected = mcu->config.type == MCU_AVR_ATMEGA328P ? ELF_MACHINE_AVR
+                      : mcu->config.type == MCU_ARM_CORTEX_M3 ? ELF_MACHINE_ARM : 0;
+    if (machine != expected) {
+        fprintf(stderr, "ELF para arquitetura %u não roda em %s\n", machine, mcu->config.name);
+        return -1;
+    }
+
+    uint32_t entry = read32(data + 24);
+    uint32_t phoff = read32(data + 28);
+    uint16_t phentsize = read16(data + 42);
+    uint16_t phnum = read16(data + 44);
+
+    if (phentsize < ELF_PHDR_SIZE || phoff > size || (size_t)phnum * phentsize > size - phoff) {
+        fprintf(stderr, "Tabela de segmentos do ELF inválida\n");
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < phnum; i++) {
+        const uint8_t* ph = data + phoff + (size_t)i * phentsize;
+        if (read32(ph) != ELF_PT_LOAD) {
+            continue;
+        }
+
+        uint32_t offset = read32(ph + 4);
+        uint32_t vaddr = read32(ph + 8);
+        uint32_t paddr = read32(ph + 12);
+        uint32_t filesz = read32(ph + 16);
+        uint32_t memsz = read32(ph + 20);
+        uint32_t flash_offset, data_offset;
+
+        if (offset > size || filesz > size - offset || filesz > memsz) {
+            fprintf(stderr, "Segmento %u do ELF fora do arquivo\n", i);
+            return -1;
+        }
+
+        // Conteúdo inicial vai para o flash no endereço de carga (LMA)
+        bool in_flash = filesz > 0 && loader_flash_offset(mcu, paddr, filesz, &flash_offset);
+        if (in_flash && loader_flash(loader, flash_offset, data + offset, filesz) < 0) {
+            return -1;
+        }
+
+        // .data é copiado e .bss zerado no endereço de execução (VMA) na RAM
+        bool in_ram = loader_data_offset(mcu, vaddr, memsz, &data_offset);
+        if (in_ram && loader_ram(loader, data_offset, data + offset, filesz, memsz - filesz) < 0) {
+            return -1;
+        }
+
+        if (!in_flash && !in_ram) {
+            fprintf(stderr, "Segmento %u do ELF ignorado (0x%08x)\n", i, vaddr);
+        }
+    }
+
+    // No Thumb o bit 0 do endereço de entrada só indica o modo de execução
+    loader->entry_point = mcu->config.type == MCU_ARM_CORTEX_M3 ? entry & ~1u : entry;
+
+    return 0;
+}
+
+int firmware_load_image(microcontroller_t* mcu, const uint8_t* data, size_t size, bool dry_run) {
+    if (!mcu || !data) {
+        return -1;
+    }
+
+    loader_t loader = {
+        .mcu = mcu,
+        .dry_run = dry_run,
+        .flash_end = 0,
+        .entry_point = mcu->config.flash_start,
+    };
+
+    if (!dry_run && mcu->flash_shared) {
+        fprintf(stderr, "Flash compartilhado é somente leitura\n");
+        return -1;
+    }
+
+    if (!dry_run) {
+        memset(mcu->memory, 0, mcu->config.memory_size);
+        if (mcu->data_image) {
+            free(mcu->data_image);
+            mcu->data_image = NULL;
+        }
+    }
+
+    int result;
+    switch (firmware_detect_format(data, size)) {
+        case FIRMWARE_ELF:
+            result = load_elf(&loader, data, size);
+            break;
+        case FIRMWARE_IHEX:
+            result = load_ihex(&loader, data, size);
+            break;
+        default:
+            if (size > mcu->config.memory_size) {
+                fprintf(stderr, "Firmware muito grande: %zu bytes (máximo: %u)\n",
+                        size, mcu->config.memory_size);
+                return -1;
+            }
+            result = loader_flash(&loader, 0, data, (uint32_t)size);
+            break;
+    }
+
+    if (result < 0) {
+        return -1;
+    }
+
+    if (!dry_run) {
+        mcu->firmware_size = loader.flash_end;
+        mcu->entry_point = loader.entry_point;
+    }
+
+    return 0;
+}
+
+static int compare_symbols(const void* a, const void* b) {
+    const firmware_symbol_t* x = a;
+    const firmware_symbol_t* y = b;
+    return x->address < y->address ? -1 : x->address > y->address;
+}
+
+int firmware_load_symbols(const uint8_t* data, size_t size, firmware_symbol_t** symbols, int* count) {
+    if (!data || !symbols || !count) {
+        return -1;
+    }
+
+    *symbols = NULL;
+    *count = 0;
+
+    if (firmware_detect_format(data, size) != FIRMWARE_ELF || size < ELF_HEADER_SIZE ||
+        data[4] != 1 || data[5] != 1) {
+        fprintf(stderr, "Símbolos só podem ser lidos de ELF32 little-endian\n");
+        return -1;
+    }
+
+    uint32_t shoff = read32(data + 32);
+    uint16_t shentsize = read16(data + 46);
+    uint16_t shnum = read16(data + 48);
+    if (shoff == 0 || shnum == 0) {
+        return 0;
+    }
+    if (shentsize < ELF_SHDR_SIZE || shoff > size || (size_t)shnum * shentsize > size - shoff) {
+        fprintf(stderr, "Tabela de seções do ELF inválida\n");
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < shnum; i++) {
+        const uint8_t* sh = data + shoff + (size_t)i * shentsize;
+        if (read32(sh + 4) != ELF_SHT_SYMTAB) {
+            continue;
+        }
+
+        uint32_t offset = read32(sh + 16);
+        uint32_t length = read32(sh + 20);
+        uint32_t link = read32(sh + 24);
+        if (link >= shnum || offset > size || length > size - offset) {
+            fprintf(stderr, "Tabela de símbolos do ELF inválida\n");
+            return -1;
+        }
+
+        const uint8_t* strtab = data + shoff + (size_t)link * shentsize;
+        uint32_t strings = read32(strtab + 16);
+        uint32_t strings_size = read32(strtab + 20);
+        if (strings > size || strings_size > size - strings) {
+            fprintf(stderr, "Tabela de strings do ELF inválida\n");
+            return -1;
+        }
+
+        int capacity = (int)(length / ELF_SYM_SIZE);
+        firmware_symbol_t* list = calloc(capacity > 0 ? capacity : 1, sizeof(firmware_symbol_t));
+        if (!list) {
+            fprintf(stderr, "Erro ao alocar símbolos\n");
+            return -1;
+        }
+
+        int found = 0;
+        for (int j = 0; j < capacity; j++) {
+            const uint8_t* sym = data + offset + (size_t)j * ELF_SYM_SIZE;
+            uint32_t name = read32(sym);
+            if ((sym[12] & 0x0F) != ELF_STT_FUNC || read16(sym + 14) == 0 || name >= strings_size) {
+                continue;
+            }
+
+            const char* text = (const char*)data + strings + name;
+            list[found].address = read32(sym + 4) & ~1u;
+            list[found].size = read32(sym + 8);
+            list[found].name = strndup(text, strings_size - name);
+            if (!list[found].name) {
+                firmware_free_symbols(list, found);
+                return -1;
+            }
+            found++;
+        }
+
+        qsort(list, found, sizeof(firmware_symbol_t), compare_symbols);
+        for (int j = 0; j + 1 < found; j++) {
+            if (list[j].size == 0) {
+                list[j].size = list[j + 1].address - list[j].address;
+            }
+        }
+
+        *symbols = list;
+        *count = found;
+        return 0;
+    }
+
+    return 0;
+}
+
+void firmware_free_symbols(firmware_symbol_t* symbols, int count) {
+    for (int i = 0; i < count; i++) {
+        free(symbols[i].name);
+    }
+    free(symbols);
+}
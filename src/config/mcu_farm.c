@@ -0,0 +1,242 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "config/mcu_farm.h"
+#include "config/mcu_log.h"
+
+typedef struct {
+    mcu_farm_t* farm;
+    int id;
+    mcu_farm_job_t job;
+    void* context;
+    int failures;
+} mcu_farm_worker_t;
+
+static void mcu_farm_cleanup_instance(mcu_farm_instance_t* instance) {
+    mcu_cleanup(&instance->mcu);
+    mcu_log_flush();
+    fclose(instance->output_stream);
+    free(instance->output);
+    instance->output_stream = NULL;
+    instance->output = NULL;
+    instance->output_size = 0;
+}
+
+int mcu_farm_init(mcu_farm_t* farm, const mcu_config_t* config, int instance_count, int thread_count) {
+    if (!farm || !config || instance_count <= 0) {
+        return -1;
+    }
+
+    if (thread_count <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = online > 0 ? (int)online : 1;
+    }
+    if (thread_count > instance_count) {
+        thread_count = instance_count;
+    }
+
+    farm->instances = calloc(instance_count, sizeof(mcu_farm_instance_t));
+    farm->queues = calloc(thread_count, sizeof(mcu_farm_queue_t));
+    if (!farm->instances || !farm->queues) {
+        fprintf(stderr, "Erro ao alocar farm de microcontroladores\n");
+        free(farm->instances);
+        free(farm->queues);
+        return -1;
+    }
+
+    for (int i = 0; i < instance_count; i++) {
+        mcu_farm_instance_t* instance = &farm->instances[i];
+        instance->index = i;
+
+        instance->output_stream = open_memstream(&instance->output, &instance->output_size);
+        if (!instance->output_stream ||
+            mcu_init_with_output(&instance->mcu, config, instance->output_stream) < 0) {
+            fprintf(stderr, "Erro ao inicializar instância %d da farm\n", i);
+            if (instance->output_stream) {
+                fclose(instance->output_stream);
+                free(instance->output);
+            }
+            while (--i >= 0) {
+                mcu_farm_cleanup_instance(&farm->instances[i]);
+            }
+            free(farm->instances);
+            free(farm->queues);
+            return -1;
+        }
+    }
+
+    for (int t = 0; t < thread_count; t++) {
+        pthread_mutex_init(&farm->queues[t].lock, NULL);
+    }
+
+    farm->instance_count = instance_count;
+    farm->thread_count = thread_count;
+
+    return 0;
+}
+
+void mcu_farm_cleanup(mcu_farm_t* farm) {
+    if (!farm || !farm->instances) {
+        return;
+    }
+
+    // A instância 0 é dona do flash compartilhado: é a última a sair
+    for (int i = farm->instance_count - 1; i >= 0; i--) {
+        mcu_farm_cleanup_instance(&farm->instances[i]);
+    }
+
+    for (int t = 0; t < farm->thread_count; t++) {
+        pthread_mutex_destroy(&farm->queues[t].lock);
+    }
+
+    free(farm->instances);
+    free(farm->queues);
+    farm->instances = NULL;
+    farm->queues = NULL;
+    farm->instance_count = 0;
+    farm->thread_count = 0;
+}
+
+static int mcu_farm_share_firmware(mcu_farm_t* farm) {
+    const microcontroller_t* owner = &farm->instances[0].mcu;
+
+    for (int i = 1; i < farm->instance_count; i++) {
+        if (mcu_share_firmware(&farm->instances[i].mcu, owner) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int mcu_farm_load_firmware(mcu_farm_t* farm, const char* firmware_path) {
+    if (!farm || !farm->instances ||
+        mcu_load_firmware(&farm->instances[0].mcu, firmware_path) < 0) {
+        return -1;
+    }
+
+    return mcu_farm_share_firmware(farm);
+}
+
+int mcu_farm_load_firmware_buffer(mcu_farm_t* farm, const uint8_t* data, size_t size) {
+    if (!farm || !farm->instances ||
+        mcu_load_firmware_buffer(&farm->instances[0].mcu, data, size) < 0) {
+        return -1;
+    }
+
+    return mcu_farm_share_firmware(farm);
+}
+
+// Próximo índice da própria fila (pelo fim) ou -1 se ela esvaziou
+static int mcu_farm_pop(mcu_farm_queue_t* queue) {
+    int index = -1;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        index = --queue->bottom;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return index;
+}
+
+static int mcu_farm_steal(mcu_farm_queue_t* queue) {
+    int index = -1;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        index = queue->top++;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return index;
+}
+
+static void* mcu_farm_worker(void* arg) {
+    mcu_farm_worker_t* worker = arg;
+    mcu_farm_t* farm = worker->farm;
+
+    for (;;) {
+        int index = mcu_farm_pop(&farm->queues[worker->id]);
+
+        // Nenhuma instância é adicionada durante a execução: se todas as
+        // filas estão vazias, o trabalho acabou
+        for (int k = 1; index < 0 && k < farm->thread_count; k++) {
+            index = mcu_farm_steal(&farm->queues[(worker->id + k) % farm->thread_count]);
+        }
+        if (index < 0) {
+            break;
+        }
+
+        mcu_farm_instance_t* instance = &farm->instances[index];
+        instance->result = worker->job(instance, worker->context);
+        if (instance->result != 0) {
+            worker->failures++;
+        }
+    }
+
+    return NULL;
+}
+
+int mcu_farm_run(mcu_farm_t* farm, mcu_farm_job_t job, void* context) {
+    if (!farm || !farm->instances || !job) {
+        return -1;
+    }
+
+    mcu_farm_worker_t* workers = calloc(farm->thread_count, sizeof(mcu_farm_worker_t));
+    pthread_t* threads = calloc(farm->thread_count, sizeof(pthread_t));
+    if (!workers || !threads) {
+        fprintf(stderr, "Erro ao alocar threads da farm\n");
+        free(workers);
+        free(threads);
+        return -1;
+    }
+
+    // Cada thread começa com uma faixa contígua de instâncias
+    for (int t = 0; t < farm->thread_count; t++) {
+        farm->queues[t].top = (int)((long)farm->instance_count * t / farm->thread_count);
+        farm->queues[t].bottom = (int)((long)farm->instance_count * (t + 1) / farm->thread_count);
+        workers[t] = (mcu_farm_worker_t){ farm, t, job, context, 0 };
+    }
+
+    // A thread chamadora trabalha como worker 0
+    int started = 1;
+    for (; started < farm->thread_count; started++) {
+        if (pthread_create(&threads[started], NULL, mcu_farm_worker, &workers[started]) != 0) {
+            fprintf(stderr, "Erro ao criar thread %d da farm\n", started);
+            break;
+        }
+    }
+    mcu_farm_worker(&workers[0]);
+
+    int failures = 0;
+    for (int t = 0; t < farm->thread_count; t++) {
+        if (t > 0 && t < started) {
+            pthread_join(threads[t], NULL);
+        }
+        failures += workers[t].failures;
+    }
+
+    free(workers);
+    free(threads);
+    return failures;
+}
+
+const char* mcu_farm_output(mcu_farm_t* farm, int index, size_t* size) {
+    if (!farm || !farm->instances || index < 0 || index >= farm->instance_count) {
+        return NULL;
+    }
+
+    mcu_farm_instance_t* instance = &farm->instances[index];
+    // Mensagens ainda no anel do logger também fazem parte da saída
+    mcu_log_flush();
+    fflush(instance->output_stream);
+    if (size) {
+        *size = instance->output_size;
+    }
+
+    return instance->output;
+}
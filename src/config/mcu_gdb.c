@@ -0,0 +1,696 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "config/avr_core.h"
+#include "config/mcu_gdb.h"
+
+// Espaço de dados no avr-gdb (e aqui também no PIC)
+#define MCU_GDB_DATA_OFFSET 0x800000u
+
+// Registradores do avr-gdb depois de R0-R31
+#define AVR_GDB_SREG 32
+#define AVR_GDB_SP 33
+#define AVR_GDB_PC 34
+
+static const char mcu_gdb_arm_target[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target><architecture>arm</architecture>"
+    "<feature name=\"org.gnu.gdb.arm.m-profile\">"
+    "<reg name=\"r0\" bitsize=\"32\"/><reg name=\"r1\" bitsize=\"32\"/>"
+    "<reg name=\"r2\" bitsize=\"32\"/><reg name=\"r3\" bitsize=\"32\"/>"
+    "<reg name=\"r4\" bitsize=\"32\"/><reg name=\"r5\" bitsize=\"32\"/>"
+    "<reg name=\"r6\" bitsize=\"32\"/><reg name=\"r7\" bitsize=\"32\"/>"
+    "<reg name=\"r8\" bitsize=\"32\"/><reg name=\"r9\" bitsize=\"32\"/>"
+    "<reg name=\"r10\" bitsize=\"32\"/><reg name=\"r11\" bitsize=\"32\"/>"
+    "<reg name=\"r12\" bitsize=\"32\"/>"
+    "<reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"lr\" bitsize=\"32\"/>"
+    "<reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"xpsr\" bitsize=\"32\"/>"
+    "</feature></target>";
+
+static void mcu_gdb_init(mcu_gdb_t* gdb, microcontroller_t* mcu) {
+    memset(gdb, 0, sizeof(*gdb));
+    gdb->mcu = mcu;
+    gdb->listen_fd = -1;
+    gdb->client_fd = -1;
+    gdb->batch_cycles = MCU_GDB_BATCH_CYCLES;
+}
+
+int mcu_gdb_listen_tcp(mcu_gdb_t* gdb, microcontroller_t* mcu, uint16_t port) {
+    if (!gdb || !mcu) {
+        return -1;
+    }
+
+    mcu_gdb_init(gdb, mcu);
+
+    struct sockaddr_in address = {0};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    int reuse = 1;
+
+    gdb->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (gdb->listen_fd < 0 ||
+        setsockopt(gdb->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+        bind(gdb->listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(gdb->listen_fd, 1) < 0 ||
+        getsockname(gdb->listen_fd, (struct sockaddr*)&address, &length) < 0) {
+        fprintf(stderr, "Erro ao escutar na porta %u: %s\n", port, strerror(errno));
+        mcu_gdb_close(gdb);
+        return -1;
+    }
+
+    gdb->port = ntohs(address.sin_port);
+    fprintf(mcu->output, "Servidor GDB em 127.0.0.1:%u\n", gdb->port);
+    return 0;
+}
+
+int mcu_gdb_listen_unix(mcu_gdb_t* gdb, microcontroller_t* mcu, const char* path) {
+    if (!gdb || !mcu || !path) {
+        return -1;
+    }
+
+    mcu_gdb_init(gdb, mcu);
+
+    struct sockaddr_un address = {0};
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Caminho de socket muito longo: %s\n", path);
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    gdb->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (gdb->listen_fd < 0 ||
+        bind(gdb->listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(gdb->listen_fd, 1) < 0) {
+        fprintf(stderr, "Erro ao escutar em %s: %s\n", path, strerror(errno));
+        mcu_gdb_close(gdb);
+        return -1;
+    }
+
+    gdb->unix_path = strdup(path);
+    fprintf(mcu->output, "Servidor GDB em %s\n", path);
+    return 0;
+}
+
+static void mcu_gdb_disconnect(mcu_gdb_t* gdb) {
+    if (gdb->client_fd >= 0) {
+        close(gdb->client_fd);
+    }
+    gdb->client_fd = -1;
+    gdb->running = false;
+    gdb->no_ack = false;
+    gdb->input_length = 0;
+}
+
+void mcu_gdb_close(mcu_gdb_t* gdb) {
+    if (!gdb) {
+        return;
+    }
+
+    mcu_gdb_disconnect(gdb);
+    if (gdb->listen_fd >= 0) {
+        close(gdb->listen_fd);
+        gdb->listen_fd = -1;
+    }
+    if (gdb->unix_path) {
+        unlink(gdb->unix_path);
+        free(gdb->unix_path);
+        gdb->unix_path = NULL;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Pacotes                                                                */
+/* ---------------------------------------------------------------------- */
+
+static const char mcu_gdb_hex[] = "0123456789abcdef";
+
+static int mcu_gdb_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Lê um número hexadecimal e avança text; false se não havia dígitos
+static bool mcu_gdb_parse_hex(const char** text, uint32_t* value) {
+    const char* start = *text;
+    int digit;
+
+    *value = 0;
+    while ((digit = mcu_gdb_nibble(**text)) >= 0) {
+        *value = (*value << 4) | (uint32_t)digit;
+        (*text)++;
+    }
+    return *text != start;
+}
+
+static int mcu_gdb_send(mcu_gdb_t* gdb, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(gdb->client_fd, data, length, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 0;
+}
+
+static int mcu_gdb_reply(mcu_gdb_t* gdb, const char* payload) {
+    char frame[MCU_GDB_PACKET_SIZE + 4];
+    size_t length = strlen(payload);
+    uint8_t checksum = 0;
+
+    if (length > MCU_GDB_PACKET_SIZE) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        checksum += (uint8_t)payload[i];
+    }
+
+    frame[0] = '$';
+    memcpy(frame + 1, payload, length);
+    frame[length + 1] = '#';
+    frame[length + 2] = mcu_gdb_hex[checksum >> 4];
+    frame[length + 3] = mcu_gdb_hex[checksum & 0x0F];
+
+    return mcu_gdb_send(gdb, frame, length + 4);
+}
+
+static void mcu_gdb_put_hex(char* out, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        out[2 * i] = mcu_gdb_hex[data[i] >> 4];
+        out[2 * i + 1] = mcu_gdb_hex[data[i] & 0x0F];
+    }
+    out[2 * size] = '\0';
+}
+
+static bool mcu_gdb_get_hex(const char* text, uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        int high = mcu_gdb_nibble(text[2 * i]);
+        int low = high < 0 ? -1 : mcu_gdb_nibble(text[2 * i + 1]);
+        if (low < 0) {
+            return false;
+        }
+        data[i] = (uint8_t)((high << 4) | low);
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Registradores e memória                                                */
+/* ---------------------------------------------------------------------- */
+
+static bool mcu_gdb_harvard(const microcontroller_t* mcu) {
+    return mcu->config.type != MCU_ARM_CORTEX_M3;
+}
+
+static int mcu_gdb_reg_count(const microcontroller_t* mcu) {
+    return mcu->config.type == MCU_AVR_ATMEGA328P ? AVR_GDB_PC + 1 : mcu->core->register_count;
+}
+
+// Bytes do registrador n no pacote 'g'
+static int mcu_gdb_reg_size(const microcontroller_t* mcu, int n) {
+    if (mcu->config.type != MCU_AVR_ATMEGA328P) {
+        return 4;
+    }
+    return n < AVR_GDB_SREG + 1 ? 1 : n == AVR_GDB_SP ? 2 : 4;
+}
+
+static int mcu_gdb_reg_read(microcontroller_t* mcu, int n, uint32_t* value) {
+    if (n < 0 || n >= mcu_gdb_reg_count(mcu)) {
+        return -1;
+    }
+
+    if (mcu->config.type == MCU_AVR_ATMEGA328P && n >= AVR_GDB_SREG) {
+        switch (n) {
+            case AVR_GDB_SREG: *value = mcu->data_memory[AVR_SREG]; break;
+            case AVR_GDB_SP: *value = mcu->data_memory[AVR_SPL] | (mcu->data_memory[AVR_SPH] << 8); break;
+            default: *value = mcu->program_counter; break;
+        }
+        return 0;
+    }
+
+    return mcu->core->read_reg(mcu, n, value);
+}
+
+static int mcu_gdb_reg_write(microcontroller_t* mcu, int n, uint32_t value) {
+    if (n < 0 || n >= mcu_gdb_reg_count(mcu)) {
+        return -1;
+    }
+
+    if (mcu->config.type == MCU_AVR_ATMEGA328P && n >= AVR_GDB_SREG) {
+        switch (n) {
+            case AVR_GDB_SREG:
+                mcu->data_memory[AVR_SREG] = (uint8_t)value;
+                break;
+            case AVR_GDB_SP:
+                mcu->data_memory[AVR_SPL] = (uint8_t)value;
+                mcu->data_memory[AVR_SPH] = (uint8_t)(value >> 8);
+                break;
+            default:
+                mcu->program_counter = value;
+                break;
+        }
+        return 0;
+    }
+
+    return mcu->core->write_reg(mcu, n, value);
+}
+
+// Offset no flash de um endereço do GDB, ou -1 se não estiver nele
+static int64_t mcu_gdb_flash_offset(const microcontroller_t* mcu, uint32_t address, size_t size) {
+    uint32_t offset = address;
+
+    if (!mcu_gdb_harvard(mcu) && address >= mcu->config.flash_start) {
+        offset = address - mcu->config.flash_start;
+    }
+    if (mcu_gdb_harvard(mcu) && address >= MCU_GDB_DATA_OFFSET) {
+        return -1;
+    }
+    if (offset >= mcu->memory_size || size > mcu->memory_size - offset) {
+        return -1;
+    }
+    return offset;
+}
+
+static uint32_t mcu_gdb_data_address(const microcontroller_t* mcu, uint32_t address) {
+    return mcu_gdb_harvard(mcu) ? address - MCU_GDB_DATA_OFFSET : address;
+}
+
+static int mcu_gdb_read_memory(microcontroller_t* mcu, uint32_t address, uint8_t* data, size_t size) {
+    int64_t offset = mcu_gdb_flash_offset(mcu, address, size);
+
+    if (offset >= 0) {
+        memcpy(data, mcu->memory + offset, size);
+        return 0;
+    }
+    return mcu_read_memory(mcu, mcu_gdb_data_address(mcu, address), data, size);
+}
+
+// Escritas no flash (o comando load do GDB) descartam o cache de decodificação
+static int mcu_gdb_write_memory(microcontroller_t* mcu, uint32_t address, const uint8_t* data, size_t size) {
+    int64_t offset = mcu_gdb_flash_offset(mcu, address, size);
+
+    if (offset >= 0) {
+        if (mcu->flash_shared) {
+            return -1;
+        }
+        memcpy(mcu->memory + offset, data, size);
+        mcu->core->invalidate(mcu);
+        return 0;
+    }
+    return mcu_write_memory(mcu, mcu_gdb_data_address(mcu, address), data, size);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Comandos                                                               */
+/* ---------------------------------------------------------------------- */
+
+static int mcu_gdb_stop_reply(mcu_gdb_t* gdb, int signal) {
+    microcontroller_t* mcu = gdb->mcu;
+    char reply[64];
+
+    gdb->running = false;
+    if (mcu->state == MCU_STATE_ERROR) {
+        return mcu_gdb_reply(gdb, "S04");
+    }
+
+    if (signal == 5 && mcu->stop_reason == MCU_STOP_WATCHPOINT) {
+        // Mesmo tipo do Z2/Z3/Z4 que criou o watchpoint
+        const char* kind = mcu->stop_watch == MCU_WATCH_WRITE ? "watch"
+                           : mcu->stop_watch == MCU_WATCH_READ ? "rwatch" : "awatch";
+        uint32_t address = mcu->stop_address + (mcu_gdb_harvard(mcu) ? MCU_GDB_DATA_OFFSET : 0);
+        snprintf(reply, sizeof(reply), "T05%s:%x;", kind, address);
+        return mcu_gdb_reply(gdb, reply);
+    }
+
+    snprintf(reply, sizeof(reply), "S%02x", signal);
+    return mcu_gdb_reply(gdb, reply);
+}
+
+static int mcu_gdb_read_registers(mcu_gdb_t* gdb) {
+    char reply[MCU_GDB_PACKET_SIZE];
+    char* out = reply;
+
+    for (int n = 0; n < mcu_gdb_reg_count(gdb->mcu); n++) {
+        uint32_t value = 0;
+        uint8_t bytes[4];
+        int size = mcu_gdb_reg_size(gdb->mcu, n);
+
+        mcu_gdb_reg_read(gdb->mcu, n, &value);
+        for (int i = 0; i < size; i++) {
+            bytes[i] = (uint8_t)(value >> (8 * i));
+        }
+        mcu_gdb_put_hex(out, bytes, size);
+        out += 2 * size;
+    }
+
+    return mcu_gdb_reply(gdb, reply);
+}
+
+static int mcu_gdb_write_registers(mcu_gdb_t* gdb, const char* text) {
+    for (int n = 0; n < mcu_gdb_reg_count(gdb->mcu) && *text; n++) {
+        uint8_t bytes[4] = {0};
+        int size = mcu_gdb_reg_size(gdb->mcu, n);
+
+        if (!mcu_gdb_get_hex(text, bytes, size)) {
+            return mcu_gdb_reply(gdb, "E01");
+        }
+        mcu_gdb_reg_write(gdb->mcu, n, bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24));
+        text += 2 * size;
+    }
+
+    return mcu_gdb_reply(gdb, "OK");
+}
+
+static int mcu_gdb_register(mcu_gdb_t* gdb, const char* text, bool write) {
+    uint32_t n, value = 0;
+    uint8_t bytes[4] = {0};
+    char reply[16];
+
+    if (!mcu_gdb_parse_hex(&text, &n) || n >= (uint32_t)mcu_gdb_reg_count(gdb->mcu)) {
+        return mcu_gdb_reply(gdb, "E01");
+    }
+
+    int size = mcu_gdb_reg_size(gdb->mcu, (int)n);
+    if (write) {
+        if (*text++ != '=' || !mcu_gdb_get_hex(text, bytes, size)) {
+            return mcu_gdb_reply(gdb, "E01");
+        }
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        return mcu_gdb_reply(gdb, mcu_gdb_reg_write(gdb->mcu, (int)n, value) < 0 ? "E01" : "OK");
+    }
+
+    mcu_gdb_reg_read(gdb->mcu, (int)n, &value);
+    for (int i = 0; i < size; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+    mcu_gdb_put_hex(reply, bytes, size);
+    return mcu_gdb_reply(gdb, reply);
+}
+
+static int mcu_gdb_memory(mcu_gdb_t* gdb, const char* text, bool write) {
+    uint8_t data[MCU_GDB_PACKET_SIZE / 2];
+    char reply[MCU_GDB_PACKET_SIZE + 1];
+    uint32_t address, size;
+
+    if (!mcu_gdb_parse_hex(&text, &address) || *text++ != ',' ||
+        !mcu_gdb_parse_hex(&text, &size) || size > sizeof(data) - 1) {
+        return mcu_gdb_reply(gdb, "E01");
+    }
+
+    if (write) {
+        if (*text++ != ':' || !mcu_gdb_get_hex(text, data, size) ||
+            mcu_gdb_write_memory(gdb->mcu, address, data, size) < 0) {
+            return mcu_gdb_reply(gdb, "E01");
+        }
+        return mcu_gdb_reply(gdb, "OK");
+    }
+
+    if (mcu_gdb_read_memory(gdb->mcu, address, data, size) < 0) {
+        return mcu_gdb_reply(gdb, "E01");
+    }
+    mcu_gdb_put_hex(reply, data, size);
+    return mcu_gdb_reply(gdb, reply);
+}
+
+// Z/z tipo,endereço,tamanho
+static int mcu_gdb_breakpoint(mcu_gdb_t* gdb, const char* text, bool insert) {
+    static const mcu_watch_t watch_kinds[] = { MCU_WATCH_WRITE, MCU_WATCH_READ, MCU_WATCH_ACCESS };
+    microcontroller_t* mcu = gdb->mcu;
+    uint32_t type, address, size;
+    int result;
+
+    if (!mcu_gdb_parse_hex(&text, &type) || *text++ != ',' ||
+        !mcu_gdb_parse_hex(&text, &address) || *text++ != ',' ||
+        !mcu_gdb_parse_hex(&text, &size)) {
+        return mcu_gdb_reply(gdb, "E01");
+    }
+
+    if (type <= 1) {
+        result = insert ? mcu_set_breakpoint(mcu, address) : mcu_remove_breakpoint(mcu, address);
+    } else if (type <= 4) {
+        uint32_t data = mcu_gdb_data_address(mcu, address);
+        mcu_watch_t kind = watch_kinds[type - 2];
+        result = insert ? mcu_set_watchpoint(mcu, data, size, kind) : mcu_remove_watchpoint(mcu, data, size, kind);
+    } else {
+        return mcu_gdb_reply(gdb, "");
+    }
+
+    return mcu_gdb_reply(gdb, result < 0 ? "E01" : "OK");
+}
+
+static int mcu_gdb_query(mcu_gdb_t* gdb, const char* packet) {
+    if (strncmp(packet, "qSupported", 10) == 0) {
+        char reply[128];
+        snprintf(reply, sizeof(reply), "PacketSize=%x;QStartNoAckMode+%s", MCU_GDB_PACKET_SIZE,
+                 gdb->mcu->config.type == MCU_ARM_CORTEX_M3 ? ";qXfer:features:read+" : "");
+        return mcu_gdb_reply(gdb, reply);
+    }
+    if (strcmp(packet, "qAttached") == 0) {
+        return mcu_gdb_reply(gdb, "1");
+    }
+    if (strcmp(packet, "qC") == 0) {
+        return mcu_gdb_reply(gdb, "QC1");
+    }
+    if (strcmp(packet, "QStartNoAckMode") == 0) {
+        int result = mcu_gdb_reply(gdb, "OK");
+        gdb->no_ack = true;
+        return result;
+    }
+
+    const char* prefix = "qXfer:features:read:target.xml:";
+    if (strncmp(packet, prefix, strlen(prefix)) == 0 && gdb->mcu->config.type == MCU_ARM_CORTEX_M3) {
+        const char* text = packet + strlen(prefix);
+        uint32_t offset, length;
+        char reply[MCU_GDB_PACKET_SIZE + 1];
+        size_t total = sizeof(mcu_gdb_arm_target) - 1;
+
+        if (!mcu_gdb_parse_hex(&text, &offset) || *text++ != ',' || !mcu_gdb_parse_hex(&text, &length)) {
+            return mcu_gdb_reply(gdb, "E01");
+        }
+        if (offset >= total) {
+            return mcu_gdb_reply(gdb, "l");
+        }
+        if (length > MCU_GDB_PACKET_SIZE - 1) {
+            length = MCU_GDB_PACKET_SIZE - 1;
+        }
+        size_t chunk = total - offset < length ? total - offset : length;
+        reply[0] = offset + chunk < total ? 'm' : 'l';
+        memcpy(reply + 1, mcu_gdb_arm_target + offset, chunk);
+        reply[chunk + 1] = '\0';
+        return mcu_gdb_reply(gdb, reply);
+    }
+
+    return mcu_gdb_reply(gdb, "");
+}
+
+static int mcu_gdb_resume(mcu_gdb_t* gdb, bool step) {
+    microcontroller_t* mcu = gdb->mcu;
+
+    if (mcu->state == MCU_STATE_ERROR) {
+        return mcu_gdb_stop_reply(gdb, 4);
+    }
+
+    mcu->state = MCU_STATE_RUNNING;
+    mcu->stop_reason = MCU_STOP_NONE;
+
+    if (!step) {
+        gdb->running = true;
+        return 0;
+    }
+
+    mcu_step(mcu);
+    if (mcu->state == MCU_STATE_RUNNING) {
+        mcu->state = MCU_STATE_HALTED;
+    }
+    return mcu_gdb_stop_reply(gdb, 5);
+}
+
+// Retorna -1 se a conexão deve ser encerrada
+static int mcu_gdb_handle(mcu_gdb_t* gdb, const char* packet) {
+    switch (packet[0]) {
+        case '?':
+            return mcu_gdb_stop_reply(gdb, 5);
+        case 'g':
+            return mcu_gdb_read_registers(gdb);
+        case 'G':
+            return mcu_gdb_write_registers(gdb, packet + 1);
+        case 'p':
+        case 'P':
+            return mcu_gdb_register(gdb, packet + 1, packet[0] == 'P');
+        case 'm':
+        case 'M':
+            return mcu_gdb_memory(gdb, packet + 1, packet[0] == 'M');
+        case 'Z':
+        case 'z':
+            return mcu_gdb_breakpoint(gdb, packet + 1, packet[0] == 'Z');
+        case 'c':
+        case 's':
+            return mcu_gdb_resume(gdb, packet[0] == 's');
+        case 'H':
+            return mcu_gdb_reply(gdb, "OK");
+        case 'q':
+        case 'Q':
+            return mcu_gdb_query(gdb, packet);
+        case 'D':
+            mcu_gdb_reply(gdb, "OK");
+            return -1;
+        case 'k':
+            return -1;
+        default:
+            return mcu_gdb_reply(gdb, "");
+    }
+}
+
+// Consome os pacotes completos do buffer de entrada
+static int mcu_gdb_process(mcu_gdb_t* gdb) {
+    size_t start = 0;
+
+    while (start < gdb->input_length) {
+        char c = gdb->input[start];
+
+        if (c == '\x03') {
+            start++;
+            if (gdb->running) {
+                gdb->mcu->state = MCU_STATE_HALTED;
+                if (mcu_gdb_stop_reply(gdb, 2) < 0) {
+                    return -1;
+                }
+            }
+            continue;
+        }
+        if (c != '$') {
+            start++;    // acks e lixo entre pacotes
+            continue;
+        }
+
+        char* end = memchr(gdb->input + start, '#', gdb->input_length - start);
+        if (!end || (size_t)(end - gdb->input) + 2 >= gdb->input_length) {
+            break;      // pacote incompleto
+        }
+
+        char* payload = gdb->input + start + 1;
+        size_t length = (size_t)(end - payload);
+        uint8_t checksum = 0;
+        for (size_t i = 0; i < length; i++) {
+            checksum += (uint8_t)payload[i];
+        }
+        // Checksum que não é hexadecimal nunca confere: o pacote recebe "-"
+        int high = mcu_gdb_nibble(end[1]);
+        int low = high < 0 ? -1 : mcu_gdb_nibble(end[2]);
+        int expected = low < 0 ? -1 : (high << 4) | low;
+        start = (size_t)(end - gdb->input) + 3;
+
+        if (!gdb->no_ack) {
+            if (mcu_gdb_send(gdb, checksum == expected ? "+" : "-", 1) < 0) {
+                return -1;
+            }
+        }
+        if (checksum != expected) {
+            continue;
+        }
+
+        *end = '\0';
+        if (mcu_gdb_handle(gdb, payload) < 0) {
+            return -1;
+        }
+    }
+
+    memmove(gdb->input, gdb->input + start, gdb->input_length - start);
+    gdb->input_length -= start;
+
+    // Um pacote maior que o buffer nunca vai se completar
+    if (gdb->input_length == sizeof(gdb->input)) {
+        gdb->input_length = 0;
+    }
+    return 0;
+}
+
+int mcu_gdb_poll(mcu_gdb_t* gdb, int timeout_ms) {
+    if (!gdb || gdb->listen_fd < 0) {
+        return -1;
+    }
+
+    struct pollfd fd = {
+        .fd = gdb->client_fd >= 0 ? gdb->client_fd : gdb->listen_fd,
+        .events = POLLIN
+    };
+
+    // Rodando, o socket é só espiado entre lotes
+    int ready = poll(&fd, 1, gdb->running ? 0 : timeout_ms);
+    if (ready < 0) {
+        return errno == EINTR ? (gdb->client_fd >= 0) : -1;
+    }
+
+    if (gdb->client_fd < 0) {
+        if (ready == 0) {
+            return 0;
+        }
+        gdb->client_fd = accept(gdb->listen_fd, NULL, NULL);
+        if (gdb->client_fd < 0) {
+            return -1;
+        }
+        // O alvo fica parado até o primeiro 'c' ou 's'
+        gdb->running = false;
+        fprintf(gdb->mcu->output, "Depurador conectado\n");
+        return 1;
+    }
+
+    if (ready > 0) {
+        ssize_t received = recv(gdb->client_fd, gdb->input + gdb->input_length,
+                                sizeof(gdb->input) - gdb->input_length, 0);
+        if (received > 0) {
+            gdb->input_length += (size_t)received;
+        }
+        if (received <= 0 || mcu_gdb_process(gdb) < 0) {
+            mcu_gdb_disconnect(gdb);
+            fprintf(gdb->mcu->output, "Depurador desconectado\n");
+            return 0;
+        }
+    }
+
+    if (gdb->running) {
+        microcontroller_t* mcu = gdb->mcu;
+        mcu_run_cycles(mcu, gdb->batch_cycles);
+        if (mcu->state != MCU_STATE_RUNNING && mcu_gdb_stop_reply(gdb, 5) < 0) {
+            mcu_gdb_disconnect(gdb);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int mcu_gdb_serve(mcu_gdb_t* gdb) {
+    int result;
+
+    while ((result = mcu_gdb_poll(gdb, -1)) == 0) {
+    }
+    while (result == 1) {
+        result = mcu_gdb_poll(gdb, -1);
+    }
+
+    return result < 0 ? -1 : 0;
+}
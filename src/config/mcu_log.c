@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+#include "config/mcu_log.h"
+
+typedef struct {
+    FILE* out;
+    char text[MCU_LOG_MESSAGE_SIZE];
+} mcu_log_record_t;
+
+// Anel de uma thread: só ela avança head e só quem esvazia avança tail
+typedef struct mcu_log_ring {
+    mcu_log_record_t records[MCU_LOG_RING_SIZE];
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_bool closed;         // a thread dona terminou
+    struct mcu_log_ring* next;
+} mcu_log_ring_t;
+
+atomic_int mcu_log_runtime_level = MCU_LOG_INFO;
+
+// Protege a lista de anéis e serializa quem os esvazia
+static pthread_mutex_t mcu_log_lock = PTHREAD_MUTEX_INITIALIZER;
+static mcu_log_ring_t* mcu_log_rings;
+
+static pthread_once_t mcu_log_once = PTHREAD_ONCE_INIT;
+static pthread_key_t mcu_log_key;
+static _Thread_local mcu_log_ring_t* mcu_log_local;
+
+static atomic_bool mcu_log_active;
+static atomic_bool mcu_log_stopping;
+static pthread_t mcu_log_thread;
+static atomic_ulong mcu_log_drop_count;
+
+// O anel sobrevive à thread até ser esvaziado
+static void mcu_log_thread_exit(void* ring) {
+    atomic_store_explicit(&((mcu_log_ring_t*)ring)->closed, true, memory_order_release);
+}
+
+static void mcu_log_create_key(void) {
+    pthread_key_create(&mcu_log_key, mcu_log_thread_exit);
+}
+
+static mcu_log_ring_t* mcu_log_ring(void) {
+    if (mcu_log_local) {
+        return mcu_log_local;
+    }
+
+    pthread_once(&mcu_log_once, mcu_log_create_key);
+
+    mcu_log_ring_t* ring = calloc(1, sizeof(mcu_log_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+    pthread_setspecific(mcu_log_key, ring);
+
+    pthread_mutex_lock(&mcu_log_lock);
+    ring->next = mcu_log_rings;
+    mcu_log_rings = ring;
+    pthread_mutex_unlock(&mcu_log_lock);
+
+    mcu_log_local = ring;
+    return ring;
+}
+
+void mcu_log_write(FILE* out, const char* format, ...) {
+    va_list args;
+    mcu_log_ring_t* ring;
+
+    if (!out) {
+        return;
+    }
+
+    if (!atomic_load_explicit(&mcu_log_active, memory_order_acquire) || !(ring = mcu_log_ring())) {
+        va_start(args, format);
+        vfprintf(out, format, args);
+        va_end(args);
+        return;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == MCU_LOG_RING_SIZE) {
+        atomic_fetch_add_explicit(&mcu_log_drop_count, 1, memory_order_relaxed);
+        return;
+    }
+
+    mcu_log_record_t* record = &ring->records[head % MCU_LOG_RING_SIZE];
+    record->out = out;
+    va_start(args, format);
+    vsnprintf(record->text, sizeof(record->text), format, args);
+    va_end(args);
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// Chamada com mcu_log_lock; anéis de threads encerradas são liberados
+// depois de esvaziados
+static size_t mcu_log_drain(void) {
+    mcu_log_ring_t** link = &mcu_log_rings;
+    size_t written = 0;
+
+    while (*link) {
+        mcu_log_ring_t* ring = *link;
+        // closed é lido antes de head: nada é escrito depois do fim da thread
+        bool closed = atomic_load_explicit(&ring->closed, memory_order_acquire);
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+        for (; tail != head; tail++) {
+            const mcu_log_record_t* record = &ring->records[tail % MCU_LOG_RING_SIZE];
+            fputs(record->text, record->out);
+            written++;
+        }
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+        if (closed) {
+            *link = ring->next;
+            free(ring);
+        } else {
+            link = &ring->next;
+        }
+    }
+
+    return written;
+}
+
+void mcu_log_flush(void) {
+    pthread_mutex_lock(&mcu_log_lock);
+    if (mcu_log_drain() > 0) {
+        fflush(NULL);
+    }
+    pthread_mutex_unlock(&mcu_log_lock);
+}
+
+static void* mcu_log_main(void* arg) {
+    (void)arg;
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = 1000000 };
+
+    while (!atomic_load_explicit(&mcu_log_stopping, memory_order_acquire)) {
+        mcu_log_flush();
+        nanosleep(&pause, NULL);
+    }
+
+    return NULL;
+}
+
+int mcu_log_start(void) {
+    if (atomic_load(&mcu_log_active)) {
+        return 0;
+    }
+
+    atomic_store(&mcu_log_stopping, false);
+    if (pthread_create(&mcu_log_thread, NULL, mcu_log_main, NULL) != 0) {
+        fprintf(stderr, "Erro ao criar thread de log\n");
+        return -1;
+    }
+
+    atomic_store_explicit(&mcu_log_active, true, memory_order_release);
+    return 0;
+}
+
+void mcu_log_stop(void) {
+    if (!atomic_load(&mcu_log_active)) {
+        return;
+    }
+
+    // Mensagens novas voltam a ser escritas na hora
+    atomic_store_explicit(&mcu_log_active, false, memory_order_release);
+    atomic_store_explicit(&mcu_log_stopping, true, memory_order_release);
+    pthread_join(mcu_log_thread, NULL);
+
+    mcu_log_flush();
+}
+
+bool mcu_log_running(void) {
+    return atomic_load(&mcu_log_active);
+}
+
+void mcu_log_set_level(int level) {
+    atomic_store_explicit(&mcu_log_runtime_level, level, memory_order_relaxed);
+}
+
+int mcu_log_get_level(void) {
+    return atomic_load_explicit(&mcu_log_runtime_level, memory_order_relaxed);
+}
+
+unsigned long mcu_log_dropped(void) {
+    return atomic_load_explicit(&mcu_log_drop_count, memory_order_relaxed);
+}
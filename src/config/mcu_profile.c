@@ -0,0 +1,508 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+#include "config/arm_core.h"
+#include "config/avr_core.h"
+#include "config/mcu_profile.h"
+#include "config/pic_core.h"
+
+#define MCU_PROFILE_NO_RETURN UINT32_MAX
+
+// Posição no histograma de um PC, ou -1 fora do flash
+static int64_t mcu_profile_slot(const mcu_profile_t* profile, uint32_t pc) {
+    const microcontroller_t* mcu = profile->mcu;
+    uint32_t offset = pc - mcu->config.flash_start;
+
+    if (pc < mcu->config.flash_start || offset >= mcu->memory_size) {
+        offset = pc;
+    }
+    return offset < mcu->memory_size ? (int64_t)(offset >> 1) : -1;
+}
+
+static uint32_t mcu_profile_slot_address(const mcu_profile_t* profile, uint32_t slot) {
+    return profile->mcu->config.flash_start + slot * 2;
+}
+
+// Índice da função que contém address, ou -1
+static int mcu_profile_symbol(const mcu_profile_t* profile, uint32_t address) {
+    int low = 0;
+    int high = profile->symbol_count - 1;
+    int found = -1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (profile->symbols[middle].address <= address) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    if (found >= 0 && profile->symbols[found].size != 0 &&
+        address - profile->symbols[found].address >= profile->symbols[found].size) {
+        return -1;
+    }
+    return found;
+}
+
+static const char* mcu_profile_name(const mcu_profile_t* profile, int symbol, uint32_t address,
+                                    char* buffer, size_t size) {
+    if (symbol >= 0) {
+        return profile->symbols[symbol].name;
+    }
+    snprintf(buffer, size, "0x%08x", address);
+    return buffer;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Árvore de chamadas                                                     */
+/* ---------------------------------------------------------------------- */
+
+static int mcu_profile_add_node(mcu_profile_t* profile, int parent, int symbol, uint32_t address) {
+    if (profile->node_count == profile->node_capacity) {
+        int capacity = profile->node_capacity ? profile->node_capacity * 2 : 64;
+        mcu_profile_node_t* nodes = realloc(profile->nodes, capacity * sizeof(mcu_profile_node_t));
+        if (!nodes) {
+            fprintf(stderr, "Erro ao alocar árvore de chamadas\n");
+            return -1;
+        }
+        profile->nodes = nodes;
+        profile->node_capacity = capacity;
+    }
+
+    int index = profile->node_count++;
+    profile->nodes[index] = (mcu_profile_node_t){
+        .parent = parent,
+        .first_child = -1,
+        .next_sibling = -1,
+        .symbol = symbol,
+        .address = address,
+        .cycles = 0,
+    };
+
+    if (parent >= 0) {
+        profile->nodes[index].next_sibling = profile->nodes[parent].first_child;
+        profile->nodes[parent].first_child = index;
+    }
+    return index;
+}
+
+// Filho de parent para a função em address (criado no primeiro uso)
+static int mcu_profile_child(mcu_profile_t* profile, int parent, uint32_t address) {
+    int symbol = mcu_profile_symbol(profile, address);
+
+    for (int child = profile->nodes[parent].first_child; child >= 0; child = profile->nodes[child].next_sibling) {
+        const mcu_profile_node_t* node = &profile->nodes[child];
+        if (node->symbol == symbol && (symbol >= 0 || node->address == address)) {
+            return child;
+        }
+    }
+
+    return mcu_profile_add_node(profile, parent, symbol, address);
+}
+
+// Estado que muda numa chamada: SP no AVR, ponteiro da pilha no PIC
+static uint32_t mcu_profile_link(const microcontroller_t* mcu) {
+    switch (mcu->config.type) {
+        case MCU_AVR_ATMEGA328P:
+            return mcu->data_memory[AVR_SPL] | (mcu->data_memory[AVR_SPH] << 8);
+        case MCU_PIC16F877A:
+            return mcu->registers.pic.stack_ptr;
+        default:
+            return 0;
+    }
+}
+
+// Depois de um desvio em pc: foi uma chamada? Se sim, devolve o endereço de retorno
+static bool mcu_profile_called(const microcontroller_t* mcu, uint32_t pc, uint32_t link, uint32_t* ret) {
+    switch (mcu->config.type) {
+        case MCU_AVR_ATMEGA328P: {
+            uint32_t sp = mcu_profile_link(mcu);
+            if (sp + 2 != link || sp + 2 >= mcu->data_size) {
+                return false;
+            }
+            // avr_push_pc empilha o byte baixo primeiro
+            *ret = ((mcu->data_memory[sp + 1] << 8) | mcu->data_memory[sp + 2]) * 2;
+            return true;
+        }
+        case MCU_PIC16F877A:
+            if (mcu->registers.pic.stack_ptr != ((link + 1) & (PIC_STACK_DEPTH - 1))) {
+                return false;
+            }
+            *ret = mcu->registers.pic.stack[link] * 2u;
+            return true;
+        default: {
+            // BL/BLX gravam em LR o endereço seguinte com o bit Thumb
+            uint32_t lr = mcu->registers.arm[ARM_REG_LR] & ~1u;
+            if (lr != pc + 2 && lr != pc + 4) {
+                return false;
+            }
+            *ret = lr;
+            return true;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Amostragem                                                             */
+/* ---------------------------------------------------------------------- */
+
+static void mcu_profile_sample(microcontroller_t* mcu, void* context, uint64_t cycle) {
+    mcu_profile_t* profile = context;
+    int64_t slot = mcu_profile_slot(profile, mcu->program_counter);
+
+    if (slot < 0) {
+        profile->outside++;
+    } else {
+        profile->hits[slot]++;
+    }
+    profile->total++;
+
+    // Próxima amostra alinhada ao período, não ao fim da instrução; se a
+    // instrução atravessou mais de um período, a amostra atrasada sai já
+    uint64_t due = cycle + profile->period;
+    uint64_t delay = due > mcu->cycle_count ? due - mcu->cycle_count : 0;
+    profile->event_id = mcu_schedule_event(mcu, delay, SCHED_EVENT_PROFILER, mcu_profile_sample, profile);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Controle                                                               */
+/* ---------------------------------------------------------------------- */
+
+int mcu_profile_start(mcu_profile_t* profile, microcontroller_t* mcu, mcu_profile_mode_t mode, uint64_t period) {
+    if (!profile || !mcu || mode == MCU_PROFILE_OFF || (mode == MCU_PROFILE_SAMPLING && period == 0)) {
+        return -1;
+    }
+
+    memset(profile, 0, sizeof(*profile));
+    profile->mcu = mcu;
+    profile->mode = mode;
+    profile->period = period;
+    profile->event_id = -1;
+    profile->slot_count = mcu->memory_size / 2;
+
+    profile->hits = calloc(profile->slot_count, sizeof(uint64_t));
+    profile->entries = mode == MCU_PROFILE_BLOCKS ? calloc(profile->slot_count, sizeof(uint64_t)) : NULL;
+    if (!profile->hits || (mode == MCU_PROFILE_BLOCKS && !profile->entries)) {
+        fprintf(stderr, "Erro ao alocar histograma do profiler\n");
+        mcu_profile_free(profile);
+        return -1;
+    }
+
+    if (mode == MCU_PROFILE_SAMPLING) {
+        profile->event_id = mcu_schedule_event(mcu, period, SCHED_EVENT_PROFILER, mcu_profile_sample, profile);
+        if (profile->event_id < 0) {
+            mcu_profile_free(profile);
+            return -1;
+        }
+        return 0;
+    }
+
+    // Nó 0 é a raiz sintética; a função atual é a base da pilha
+    int root = mcu_profile_add_node(profile, -1, -1, 0);
+    if (root < 0) {
+        mcu_profile_free(profile);
+        return -1;
+    }
+    profile->block = mcu->program_counter;
+    profile->stack[0].node = -1;
+    profile->stack[0].return_address = MCU_PROFILE_NO_RETURN;
+    profile->depth = 1;
+
+    return 0;
+}
+
+void mcu_profile_stop(mcu_profile_t* profile) {
+    if (!profile || !profile->mcu) {
+        return;
+    }
+
+    if (profile->event_id >= 0) {
+        mcu_cancel_event(profile->mcu, profile->event_id);
+        profile->event_id = -1;
+    }
+}
+
+void mcu_profile_free(mcu_profile_t* profile) {
+    if (!profile) {
+        return;
+    }
+
+    mcu_profile_stop(profile);
+    free(profile->hits);
+    free(profile->entries);
+    free(profile->nodes);
+    firmware_free_symbols(profile->symbols, profile->symbol_count);
+    memset(profile, 0, sizeof(*profile));
+    profile->event_id = -1;
+}
+
+int mcu_profile_load_symbols(mcu_profile_t* profile, const char* path) {
+    if (!profile || !path) {
+        return -1;
+    }
+
+    firmware_file_t file;
+    if (firmware_map(path, &file) < 0) {
+        return -1;
+    }
+
+    firmware_symbol_t* symbols;
+    int count;
+    int result = firmware_load_symbols(file.data, file.size, &symbols, &count);
+    firmware_unmap(&file);
+    if (result < 0) {
+        return -1;
+    }
+
+    firmware_free_symbols(profile->symbols, profile->symbol_count);
+    profile->symbols = symbols;
+    profile->symbol_count = count;
+    return 0;
+}
+
+int mcu_profile_set_symbols(mcu_profile_t* profile, const firmware_symbol_t* symbols, int count) {
+    if (!profile || (count > 0 && !symbols)) {
+        return -1;
+    }
+
+    firmware_symbol_t* copy = calloc(count > 0 ? count : 1, sizeof(firmware_symbol_t));
+    if (!copy) {
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        copy[i] = symbols[i];
+        copy[i].name = strdup(symbols[i].name);
+        if (!copy[i].name) {
+            firmware_free_symbols(copy, i);
+            return -1;
+        }
+    }
+
+    firmware_free_symbols(profile->symbols, profile->symbol_count);
+    profile->symbols = copy;
+    profile->symbol_count = count;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Modo de blocos                                                         */
+/* ---------------------------------------------------------------------- */
+
+int mcu_profile_run(mcu_profile_t* profile, uint64_t cycles) {
+    if (!profile || profile->mode != MCU_PROFILE_BLOCKS) {
+        return -1;
+    }
+
+    microcontroller_t* mcu = profile->mcu;
+    uint64_t target = mcu->cycle_count + cycles;
+
+    // Símbolos podem ter sido carregados depois do start
+    if (profile->stack[0].node < 0) {
+        int node = mcu_profile_child(profile, 0, profile->block);
+        if (node < 0) {
+            return -1;
+        }
+        profile->stack[0].node = node;
+        int64_t slot = mcu_profile_slot(profile, profile->block);
+        if (slot >= 0) {
+            profile->entries[slot]++;
+        }
+    }
+
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < target) {
+        uint32_t pc = mcu->program_counter;
+        uint32_t link = mcu_profile_link(mcu);
+        uint64_t before = mcu->cycle_count;
+
+        if (mcu_step(mcu) < 0) {
+            return -1;
+        }
+
+        uint64_t spent = mcu->cycle_count - before;
+        int64_t block = mcu_profile_slot(profile, profile->block);
+        if (block >= 0) {
+            profile->hits[block] += spent;
+        } else {
+            profile->outside += spent;
+        }
+        profile->nodes[profile->stack[profile->depth - 1].node].cycles += spent;
+        profile->total += spent;
+
+        // Blocos terminam em qualquer mudança não sequencial do PC
+        uint32_t next = mcu->program_counter;
+        if (next == pc + 2 || next == pc + 4) {
+            continue;
+        }
+
+        profile->block = next;
+        int64_t slot = mcu_profile_slot(profile, next);
+        if (slot >= 0) {
+            profile->entries[slot]++;
+        }
+
+        uint32_t ret;
+        if (mcu_profile_called(mcu, pc, link, &ret)) {
+            if (profile->depth < MCU_PROFILE_MAX_DEPTH) {
+                int node = mcu_profile_child(profile, profile->stack[profile->depth - 1].node, next);
+                if (node < 0) {
+                    return -1;
+                }
+                profile->stack[profile->depth].node = node;
+                profile->stack[profile->depth].return_address = ret;
+                profile->depth++;
+            }
+            continue;
+        }
+
+        // Retorno: desempilha até o quadro que esperava este endereço
+        for (int i = profile->depth - 1; i > 0; i--) {
+            if (profile->stack[i].return_address == next) {
+                profile->depth = i;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Relatórios                                                             */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    uint64_t value;
+    uint32_t key;
+} mcu_profile_row_t;
+
+static int mcu_profile_compare_rows(const void* a, const void* b) {
+    const mcu_profile_row_t* x = a;
+    const mcu_profile_row_t* y = b;
+    if (x->value != y->value) {
+        return x->value < y->value ? 1 : -1;
+    }
+    return x->key < y->key ? -1 : x->key > y->key;
+}
+
+// Totais por função (a última linha são os PCs sem símbolo) ou por
+// endereço; retorna o número de linhas não nulas, ordenadas
+static int mcu_profile_rows(const mcu_profile_t* profile, mcu_profile_row_t** rows) {
+    bool by_symbol = profile->symbol_count > 0;
+    uint32_t count = by_symbol ? (uint32_t)profile->symbol_count + 1 : profile->slot_count;
+    mcu_profile_row_t* list = calloc(count, sizeof(mcu_profile_row_t));
+
+    if (!list) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        list[i].key = i;
+    }
+
+    for (uint32_t slot = 0; slot < profile->slot_count; slot++) {
+        if (!profile->hits[slot]) {
+            continue;
+        }
+        if (by_symbol) {
+            int symbol = mcu_profile_symbol(profile, mcu_profile_slot_address(profile, slot));
+            list[symbol >= 0 ? (uint32_t)symbol : count - 1].value += profile->hits[slot];
+        } else {
+            list[slot].value += profile->hits[slot];
+        }
+    }
+
+    qsort(list, count, sizeof(mcu_profile_row_t), mcu_profile_compare_rows);
+
+    int used = 0;
+    while ((uint32_t)used < count && list[used].value > 0) {
+        used++;
+    }
+
+    *rows = list;
+    return used;
+}
+
+static const char* mcu_profile_row_name(const mcu_profile_t* profile, const mcu_profile_row_t* row,
+                                        char* buffer, size_t size) {
+    if (profile->symbol_count > 0) {
+        return row->key < (uint32_t)profile->symbol_count ? profile->symbols[row->key].name : "[sem símbolo]";
+    }
+    return mcu_profile_name(profile, -1, mcu_profile_slot_address(profile, row->key), buffer, size);
+}
+
+void mcu_profile_report(const mcu_profile_t* profile, FILE* out) {
+    mcu_profile_row_t* rows;
+    char buffer[16];
+
+    if (!profile || !out || !profile->hits) {
+        return;
+    }
+
+    int count = mcu_profile_rows(profile, &rows);
+    if (count < 0) {
+        return;
+    }
+
+    const char* unit = profile->mode == MCU_PROFILE_SAMPLING ? "amostras" : "ciclos";
+    double total = profile->total ? (double)profile->total : 1.0;
+
+    fprintf(out, "Perfil plano: %llu %s\n", (unsigned long long)profile->total, unit);
+    fprintf(out, "     %%  %12s  %s\n", unit, profile->symbol_count > 0 ? "função" : "endereço");
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "%6.2f  %12llu  %s", 100.0 * rows[i].value / total,
+                (unsigned long long)rows[i].value, mcu_profile_row_name(profile, &rows[i], buffer, sizeof(buffer)));
+        if (profile->entries && profile->symbol_count == 0) {
+            fprintf(out, " (%llu entradas)", (unsigned long long)profile->entries[rows[i].key]);
+        }
+        fputc('\n', out);
+    }
+    if (profile->outside) {
+        fprintf(out, "%6.2f  %12llu  [fora do flash]\n", 100.0 * profile->outside / total,
+                (unsigned long long)profile->outside);
+    }
+
+    free(rows);
+}
+
+void mcu_profile_write_collapsed(const mcu_profile_t* profile, FILE* out) {
+    char buffer[16];
+
+    if (!profile || !out || !profile->hits) {
+        return;
+    }
+
+    if (profile->mode == MCU_PROFILE_SAMPLING) {
+        mcu_profile_row_t* rows;
+        int count = mcu_profile_rows(profile, &rows);
+        for (int i = 0; i < count; i++) {
+            fprintf(out, "%s %llu\n", mcu_profile_row_name(profile, &rows[i], buffer, sizeof(buffer)),
+                    (unsigned long long)rows[i].value);
+        }
+        if (count >= 0) {
+            free(rows);
+        }
+        return;
+    }
+
+    int path[MCU_PROFILE_MAX_DEPTH + 1];
+    for (int i = 1; i < profile->node_count; i++) {
+        if (profile->nodes[i].cycles == 0) {
+            continue;
+        }
+
+        int depth = 0;
+        for (int node = i; node > 0 && depth <= MCU_PROFILE_MAX_DEPTH; node = profile->nodes[node].parent) {
+            path[depth++] = node;
+        }
+
+        while (depth-- > 0) {
+            const mcu_profile_node_t* node = &profile->nodes[path[depth]];
+            fputs(mcu_profile_name(profile, node->symbol, node->address, buffer, sizeof(buffer)), out);
+            fputc(depth > 0 ? ';' : ' ', out);
+        }
+        fprintf(out, "%llu\n", (unsigned long long)profile->nodes[i].cycles);
+    }
+}
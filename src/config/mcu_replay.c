@@ -0,0 +1,469 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/mcu_replay.h"
+
+#define MCU_REPLAY_MAGIC "CRPL"
+// Maior varint de 64 bits
+#define MCU_VARINT_MAX 10
+
+int mcu_recording_init(mcu_recording_t* recording, uint64_t snapshot_interval) {
+    if (!recording) {
+        return -1;
+    }
+
+    memset(recording, 0, sizeof(*recording));
+    recording->snapshot_interval = snapshot_interval;
+    return 0;
+}
+
+void mcu_recording_free(mcu_recording_t* recording) {
+    if (!recording) {
+        return;
+    }
+
+    for (int i = 0; i < recording->checkpoint_count; i++) {
+        mcu_snapshot_free(&recording->checkpoints[i].snapshot);
+    }
+    free(recording->checkpoints);
+    free(recording->journal);
+    memset(recording, 0, sizeof(*recording));
+}
+
+/* ---------------------------------------------------------------------- */
+/* Journal                                                                */
+/* ---------------------------------------------------------------------- */
+
+static int mcu_journal_reserve(mcu_recording_t* recording, size_t extra) {
+    if (recording->journal_size + extra <= recording->journal_capacity) {
+        return 0;
+    }
+
+    size_t capacity = recording->journal_capacity ? recording->journal_capacity * 2 : 4096;
+    while (capacity < recording->journal_size + extra) {
+        capacity *= 2;
+    }
+
+    uint8_t* journal = realloc(recording->journal, capacity);
+    if (!journal) {
+        fprintf(stderr, "Erro ao alocar journal de gravação\n");
+        return -1;
+    }
+
+    recording->journal = journal;
+    recording->journal_capacity = capacity;
+    return 0;
+}
+
+static void mcu_journal_put_varint(mcu_recording_t* recording, uint64_t value) {
+    while (value >= 0x80) {
+        recording->journal[recording->journal_size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    recording->journal[recording->journal_size++] = (uint8_t)value;
+}
+
+static bool mcu_journal_get_varint(const mcu_recording_t* recording, size_t* position, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && *position < recording->journal_size; shift += 7) {
+        uint8_t byte = recording->journal[(*position)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reserva espaço e escreve o cabeçalho da entrada; payload é o máximo que
+// os dados vão ocupar
+static int mcu_journal_begin(microcontroller_t* mcu, mcu_input_kind_t kind, size_t payload) {
+    mcu_recording_t* recording = mcu->recording;
+
+    if (mcu_journal_reserve(recording, MCU_VARINT_MAX + 1 + payload) < 0) {
+        return -1;
+    }
+
+    mcu_journal_put_varint(recording, mcu->cycle_count - recording->journal_cycle);
+    recording->journal[recording->journal_size++] = (uint8_t)kind;
+    recording->journal_cycle = mcu->cycle_count;
+    return 0;
+}
+
+bool mcu_replay_pin_input(microcontroller_t* mcu, int pin_number, pin_state_t state) {
+    mcu_recording_t* recording = mcu->recording;
+
+    if (recording->replaying) {
+        return recording->applying;
+    }
+
+    if (pin_number >= 0 && mcu_journal_begin(mcu, MCU_INPUT_PIN, MCU_VARINT_MAX + 1) == 0) {
+        mcu_journal_put_varint(recording, (uint64_t)pin_number);
+        recording->journal[recording->journal_size++] = (uint8_t)state;
+    }
+    return true;
+}
+
+bool mcu_replay_memory_input(microcontroller_t* mcu, uint32_t address, const uint8_t* data, size_t size) {
+    mcu_recording_t* recording = mcu->recording;
+
+    if (recording->replaying) {
+        return recording->applying;
+    }
+
+    if (mcu_journal_begin(mcu, MCU_INPUT_MEMORY, 2 * MCU_VARINT_MAX + size) == 0) {
+        mcu_journal_put_varint(recording, address);
+        mcu_journal_put_varint(recording, size);
+        memcpy(recording->journal + recording->journal_size, data, size);
+        recording->journal_size += size;
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Snapshots                                                              */
+/* ---------------------------------------------------------------------- */
+
+static int mcu_checkpoint_add(microcontroller_t* mcu, mcu_recording_t* recording,
+                              size_t journal_offset, uint64_t journal_cycle) {
+    if (recording->checkpoint_count == recording->checkpoint_capacity) {
+        int capacity = recording->checkpoint_capacity ? recording->checkpoint_capacity * 2 : 16;
+        mcu_checkpoint_t* checkpoints = realloc(recording->checkpoints, capacity * sizeof(mcu_checkpoint_t));
+        if (!checkpoints) {
+            fprintf(stderr, "Erro ao alocar snapshots da gravação\n");
+            return -1;
+        }
+        recording->checkpoints = checkpoints;
+        recording->checkpoint_capacity = capacity;
+    }
+
+    mcu_checkpoint_t* checkpoint = &recording->checkpoints[recording->checkpoint_count];
+    if (mcu_snapshot_take(mcu, &checkpoint->snapshot) < 0) {
+        return -1;
+    }
+    checkpoint->journal_offset = journal_offset;
+    checkpoint->journal_cycle = journal_cycle;
+    recording->checkpoint_count++;
+
+    return 0;
+}
+
+static uint64_t mcu_checkpoint_last_cycle(const mcu_recording_t* recording) {
+    return recording->checkpoints[recording->checkpoint_count - 1].snapshot.cycle_count;
+}
+
+// Ciclo a partir do qual o próximo snapshot deve ser tirado
+static uint64_t mcu_checkpoint_next_cycle(const mcu_recording_t* recording) {
+    if (recording->snapshot_interval == 0) {
+        return UINT64_MAX;
+    }
+    return mcu_checkpoint_last_cycle(recording) + recording->snapshot_interval;
+}
+
+// Último snapshot com ciclo <= cycle, ou -1
+static int mcu_checkpoint_find(const mcu_recording_t* recording, uint64_t cycle) {
+    int low = 0;
+    int high = recording->checkpoint_count - 1;
+    int found = -1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (recording->checkpoints[middle].snapshot.cycle_count <= cycle) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return found;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Gravação                                                               */
+/* ---------------------------------------------------------------------- */
+
+int mcu_record_start(microcontroller_t* mcu, mcu_recording_t* recording) {
+    if (!mcu || !recording || mcu->recording) {
+        return -1;
+    }
+
+    if (recording->checkpoint_count > 0) {
+        fprintf(stderr, "Gravação já iniciada\n");
+        return -1;
+    }
+
+    recording->journal_cycle = mcu->cycle_count;
+    recording->replaying = false;
+    if (mcu_checkpoint_add(mcu, recording, 0, mcu->cycle_count) < 0) {
+        return -1;
+    }
+
+    mcu->recording = recording;
+    return 0;
+}
+
+int mcu_record_run(microcontroller_t* mcu, uint64_t cycles) {
+    if (!mcu || !mcu->recording || mcu->recording->replaying) {
+        return -1;
+    }
+
+    mcu_recording_t* recording = mcu->recording;
+    uint64_t target = mcu->cycle_count + cycles;
+
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < target) {
+        uint64_t next = mcu_checkpoint_next_cycle(recording);
+        uint64_t stop = next < target ? next : target;
+
+        if (mcu_run_cycles(mcu, stop - mcu->cycle_count) < 0) {
+            return -1;
+        }
+
+        if (mcu->cycle_count >= next &&
+            mcu_checkpoint_add(mcu, recording, recording->journal_size, recording->journal_cycle) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void mcu_record_stop(microcontroller_t* mcu) {
+    if (mcu && mcu->recording && !mcu->recording->replaying) {
+        mcu->recording = NULL;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Replay                                                                 */
+/* ---------------------------------------------------------------------- */
+
+// Ciclo da próxima entrada do journal, sem consumi-la
+static bool mcu_replay_peek(const mcu_recording_t* recording, uint64_t* cycle) {
+    size_t position = recording->cursor;
+    uint64_t delta;
+
+    if (!mcu_journal_get_varint(recording, &position, &delta)) {
+        return false;
+    }
+
+    *cycle = recording->cursor_cycle + delta;
+    return true;
+}
+
+static int mcu_replay_apply(microcontroller_t* mcu, mcu_recording_t* recording) {
+    size_t position = recording->cursor;
+    uint64_t delta, first, second;
+    int result = -1;
+
+    if (!mcu_journal_get_varint(recording, &position, &delta) || position >= recording->journal_size) {
+        return -1;
+    }
+
+    uint8_t kind = recording->journal[position++];
+    if (!mcu_journal_get_varint(recording, &position, &first)) {
+        return -1;
+    }
+
+    recording->applying = true;
+    if (kind == MCU_INPUT_PIN && position < recording->journal_size) {
+        result = mcu_set_pin_state(mcu, (int)first, (pin_state_t)recording->journal[position++]);
+    } else if (kind == MCU_INPUT_MEMORY && mcu_journal_get_varint(recording, &position, &second) &&
+               second <= recording->journal_size - position) {
+        result = mcu_write_memory(mcu, (uint32_t)first, recording->journal + position, second);
+        position += second;
+    }
+    recording->applying = false;
+
+    if (result < 0) {
+        fprintf(stderr, "Entrada inválida no journal (posição %zu)\n", recording->cursor);
+        return -1;
+    }
+
+    recording->cursor = position;
+    recording->cursor_cycle += delta;
+    return 0;
+}
+
+int mcu_replay_seek(microcontroller_t* mcu, mcu_recording_t* recording, uint64_t cycle) {
+    if (!mcu || !recording || recording->checkpoint_count == 0 ||
+        (mcu->recording && mcu->recording != recording)) {
+        return -1;
+    }
+
+    int index = mcu_checkpoint_find(recording, cycle);
+    if (index < 0) {
+        fprintf(stderr, "Ciclo %llu anterior ao início da gravação\n", (unsigned long long)cycle);
+        return -1;
+    }
+
+    // Seguir em frente é mais barato que restaurar se a posição atual já
+    // passou do snapshot escolhido
+    const mcu_checkpoint_t* checkpoint = &recording->checkpoints[index];
+    bool resume = mcu->recording == recording && recording->replaying &&
+                  mcu->cycle_count >= checkpoint->snapshot.cycle_count && mcu->cycle_count <= cycle;
+
+    if (!resume) {
+        if (mcu_snapshot_restore(mcu, &checkpoint->snapshot) < 0) {
+            return -1;
+        }
+        recording->cursor = checkpoint->journal_offset;
+        recording->cursor_cycle = checkpoint->journal_cycle;
+    }
+
+    mcu->recording = recording;
+    recording->replaying = true;
+
+    for (;;) {
+        uint64_t input = UINT64_MAX;
+        bool pending;
+
+        // O estado no ciclo C inclui as entradas aplicadas em C
+        while ((pending = mcu_replay_peek(recording, &input)) && input <= mcu->cycle_count) {
+            if (mcu_replay_apply(mcu, recording) < 0) {
+                return -1;
+            }
+        }
+
+        if (mcu->cycle_count >= cycle || mcu->state != MCU_STATE_RUNNING) {
+            break;
+        }
+
+        uint64_t stop = pending && input < cycle ? input : cycle;
+
+        // Journal carregado de arquivo: os snapshots que faltam são tirados
+        // pelo caminho
+        bool extend = mcu->cycle_count >= mcu_checkpoint_last_cycle(recording);
+        uint64_t next = mcu_checkpoint_next_cycle(recording);
+        if (extend && next < stop) {
+            stop = next;
+        }
+
+        if (mcu_run_cycles(mcu, stop - mcu->cycle_count) < 0) {
+            return -1;
+        }
+
+        if (extend && mcu->cycle_count >= next &&
+            mcu_checkpoint_add(mcu, recording, recording->cursor, recording->cursor_cycle) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void mcu_replay_stop(microcontroller_t* mcu) {
+    if (mcu && mcu->recording && mcu->recording->replaying) {
+        mcu->recording->replaying = false;
+        mcu->recording = NULL;
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Arquivo                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void mcu_put_u64(uint8_t* bytes, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t mcu_get_u64(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)bytes[i] << (8 * i);
+    }
+    return value;
+}
+
+// Cabeçalho: magic, ciclo inicial, intervalo entre snapshots, tamanho do journal
+#define MCU_REPLAY_HEADER_SIZE (4 + 3 * 8)
+
+int mcu_recording_save(const mcu_recording_t* recording, const char* path) {
+    if (!recording || !path || recording->checkpoint_count == 0) {
+        return -1;
+    }
+
+    uint8_t header[MCU_REPLAY_HEADER_SIZE];
+    memcpy(header, MCU_REPLAY_MAGIC, 4);
+    mcu_put_u64(header + 4, recording->checkpoints[0].journal_cycle);
+    mcu_put_u64(header + 12, recording->snapshot_interval);
+    mcu_put_u64(header + 20, recording->journal_size);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Erro ao criar arquivo de gravação: %s\n", path);
+        return -1;
+    }
+
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              fwrite(recording->journal, 1, recording->journal_size, file) == recording->journal_size;
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Erro ao escrever arquivo de gravação: %s\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int mcu_recording_load(mcu_recording_t* recording, microcontroller_t* mcu, const char* path) {
+    if (!recording || !mcu || !path) {
+        return -1;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Erro ao abrir arquivo de gravação: %s\n", path);
+        return -1;
+    }
+
+    uint8_t header[MCU_REPLAY_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, MCU_REPLAY_MAGIC, 4) != 0) {
+        fprintf(stderr, "Arquivo de gravação inválido: %s\n", path);
+        fclose(file);
+        return -1;
+    }
+
+    // O tamanho do journal no cabeçalho tem que bater com o resto do arquivo
+    uint64_t start_cycle = mcu_get_u64(header + 4);
+    uint64_t journal_size = mcu_get_u64(header + 20);
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if (length < MCU_REPLAY_HEADER_SIZE || journal_size != (uint64_t)(length - MCU_REPLAY_HEADER_SIZE) ||
+        fseek(file, MCU_REPLAY_HEADER_SIZE, SEEK_SET) != 0) {
+        fprintf(stderr, "Arquivo de gravação truncado: %s\n", path);
+        fclose(file);
+        return -1;
+    }
+    if (start_cycle != mcu->cycle_count) {
+        fprintf(stderr, "Gravação começa no ciclo %llu, MCU está no ciclo %llu\n",
+                (unsigned long long)start_cycle, (unsigned long long)mcu->cycle_count);
+        fclose(file);
+        return -1;
+    }
+
+    // Uma gravação já usada é descartada antes de receber a do arquivo
+    mcu_recording_free(recording);
+    mcu_recording_init(recording, mcu_get_u64(header + 12));
+    if (mcu_journal_reserve(recording, journal_size) < 0 ||
+        fread(recording->journal, 1, journal_size, file) != journal_size) {
+        fprintf(stderr, "Arquivo de gravação truncado: %s\n", path);
+        fclose(file);
+        mcu_recording_free(recording);
+        return -1;
+    }
+    fclose(file);
+
+    recording->journal_size = journal_size;
+    recording->journal_cycle = start_cycle;
+    if (mcu_checkpoint_add(mcu, recording, 0, start_cycle) < 0) {
+        mcu_recording_free(recording);
+        return -1;
+    }
+
+    return 0;
+}
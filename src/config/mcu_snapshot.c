@@ -0,0 +1,118 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/mcu_snapshot.h"
+
+// Ids únicos entre todos os MCUs, para que um snapshot compartilhado nunca
+// seja confundido com outro ao decidir se a restauração pode ser parcial
+static atomic_uint next_snapshot_id = 1;
+
+int mcu_snapshot_take(microcontroller_t* mcu, mcu_snapshot_t* snapshot) {
+    if (!mcu || !snapshot) {
+        return -1;
+    }
+
+    snapshot->scheduler.events = NULL;
+    snapshot->data_memory = malloc(mcu->data_size);
+    snapshot->pins = malloc(mcu->pin_manager.max_pins * sizeof(pin_t));
+    if (!snapshot->data_memory || !snapshot->pins ||
+        scheduler_init(&snapshot->scheduler, mcu->scheduler.count) < 0 ||
+        scheduler_copy(&snapshot->scheduler, &mcu->scheduler) < 0) {
+        fprintf(stderr, "Erro ao alocar snapshot\n");
+        free(snapshot->data_memory);
+        free(snapshot->pins);
+        scheduler_cleanup(&snapshot->scheduler);
+        return -1;
+    }
+
+    snapshot->id = atomic_fetch_add(&next_snapshot_id, 1);
+    snapshot->type = mcu->config.type;
+    snapshot->data_size = mcu->data_size;
+    memcpy(snapshot->data_memory, mcu->data_memory, mcu->data_size);
+    snapshot->registers = mcu->registers;
+
+    snapshot->state = mcu->state;
+    snapshot->program_counter = mcu->program_counter;
+    snapshot->cycle_count = mcu->cycle_count;
+    snapshot->skip_breakpoint = mcu->skip_breakpoint;
+    snapshot->stop_reason = mcu->stop_reason;
+    snapshot->stop_address = mcu->stop_address;
+    snapshot->stop_watch = mcu->stop_watch;
+
+    // Os nomes continuam pertencendo ao pin_manager; só o estado é restaurado
+    snapshot->pin_count = mcu->pin_manager.max_pins;
+    memcpy(snapshot->pins, mcu->pin_manager.pins, snapshot->pin_count * sizeof(pin_t));
+
+    memset(mcu->dirty_pages, 0, mcu->page_count);
+    mcu->snapshot_id = snapshot->id;
+
+    return 0;
+}
+
+int mcu_snapshot_restore(microcontroller_t* mcu, const mcu_snapshot_t* snapshot) {
+    if (!mcu || !snapshot || !snapshot->data_memory) {
+        return -1;
+    }
+
+    if (snapshot->type != mcu->config.type || snapshot->data_size != mcu->data_size ||
+        snapshot->pin_count != mcu->pin_manager.max_pins) {
+        fprintf(stderr, "Snapshot incompatível com %s\n", mcu->config.name);
+        return -1;
+    }
+
+    if (scheduler_copy(&mcu->scheduler, &snapshot->scheduler) < 0) {
+        return -1;
+    }
+
+    if (mcu->snapshot_id == snapshot->id) {
+        // Registradores de I/O são escritos direto pelo núcleo (SREG, SP) e
+        // não marcam páginas: essa região pequena é sempre copiada
+        uint32_t fixed = (mcu->mmio_end + MCU_PAGE_SIZE - 1) >> MCU_PAGE_SHIFT;
+
+        for (uint32_t page = 0; page < mcu->page_count; page++) {
+            if (page >= fixed && !mcu->dirty_pages[page]) {
+                continue;
+            }
+
+            uint32_t offset = page << MCU_PAGE_SHIFT;
+            uint32_t size = mcu->data_size - offset < MCU_PAGE_SIZE ? mcu->data_size - offset : MCU_PAGE_SIZE;
+            memcpy(mcu->data_memory + offset, snapshot->data_memory + offset, size);
+        }
+    } else {
+        memcpy(mcu->data_memory, snapshot->data_memory, mcu->data_size);
+        mcu->snapshot_id = snapshot->id;
+    }
+    memset(mcu->dirty_pages, 0, mcu->page_count);
+
+    mcu->registers = snapshot->registers;
+    mcu->state = snapshot->state;
+    mcu->program_counter = snapshot->program_counter;
+    mcu->cycle_count = snapshot->cycle_count;
+    mcu->skip_breakpoint = snapshot->skip_breakpoint;
+    mcu->stop_reason = snapshot->stop_reason;
+    mcu->stop_address = snapshot->stop_address;
+    mcu->stop_watch = snapshot->stop_watch;
+
+    for (int i = 0; i < snapshot->pin_count; i++) {
+        pin_t* pin = &mcu->pin_manager.pins[i];
+        pin->direction = snapshot->pins[i].direction;
+        pin->state = snapshot->pins[i].state;
+        pin->is_monitored = snapshot->pins[i].is_monitored;
+    }
+    pin_manager_resync(&mcu->pin_manager);
+
+    return 0;
+}
+
+void mcu_snapshot_free(mcu_snapshot_t* snapshot) {
+    if (!snapshot) {
+        return;
+    }
+
+    free(snapshot->data_memory);
+    free(snapshot->pins);
+    snapshot->data_memory = NULL;
+    snapshot->pins = NULL;
+    scheduler_cleanup(&snapshot->scheduler);
+}
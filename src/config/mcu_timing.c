@@ -0,0 +1,185 @@
+#include "config/microcontroller.h"
+
+// Ciclos base por opcode do ATmega328P (datasheet, "Instruction Set Summary").
+// Penalidades de desvio tomado e skip são somadas pelo núcleo na execução.
+static const uint8_t avr_cycles[AVR_OP_COUNT] = {
+    [AVR_OP_UNDECODED] = 1,
+    [AVR_OP_NOP] = 1,
+    [AVR_OP_MOVW] = 1,
+    [AVR_OP_MULS] = 2,
+    [AVR_OP_MULSU] = 2,
+    [AVR_OP_FMUL] = 2,
+    [AVR_OP_FMULS] = 2,
+    [AVR_OP_FMULSU] = 2,
+    [AVR_OP_CPC] = 1,
+    [AVR_OP_SBC] = 1,
+    [AVR_OP_ADD] = 1,
+    [AVR_OP_CPSE] = 1,
+    [AVR_OP_CP] = 1,
+    [AVR_OP_SUB] = 1,
+    [AVR_OP_ADC] = 1,
+    [AVR_OP_AND] = 1,
+    [AVR_OP_EOR] = 1,
+    [AVR_OP_OR] = 1,
+    [AVR_OP_MOV] = 1,
+    [AVR_OP_CPI] = 1,
+    [AVR_OP_SBCI] = 1,
+    [AVR_OP_SUBI] = 1,
+    [AVR_OP_ORI] = 1,
+    [AVR_OP_ANDI] = 1,
+    [AVR_OP_LDD_Y] = 2,
+    [AVR_OP_LDD_Z] = 2,
+    [AVR_OP_STD_Y] = 2,
+    [AVR_OP_STD_Z] = 2,
+    [AVR_OP_LDS] = 2,
+    [AVR_OP_LD_X] = 2,
+    [AVR_OP_LD_X_INC] = 2,
+    [AVR_OP_LD_X_DEC] = 2,
+    [AVR_OP_LD_Y_INC] = 2,
+    [AVR_OP_LD_Y_DEC] = 2,
+    [AVR_OP_LD_Z_INC] = 2,
+    [AVR_OP_LD_Z_DEC] = 2,
+    [AVR_OP_LPM_R0] = 3,
+    [AVR_OP_LPM] = 3,
+    [AVR_OP_LPM_INC] = 3,
+    [AVR_OP_POP] = 2,
+    [AVR_OP_STS] = 2,
+    [AVR_OP_ST_X] = 2,
+    [AVR_OP_ST_X_INC] = 2,
+    [AVR_OP_ST_X_DEC] = 2,
+    [AVR_OP_ST_Y_INC] = 2,
+    [AVR_OP_ST_Y_DEC] = 2,
+    [AVR_OP_ST_Z_INC] = 2,
+    [AVR_OP_ST_Z_DEC] = 2,
+    [AVR_OP_PUSH] = 2,
+    [AVR_OP_COM] = 1,
+    [AVR_OP_NEG] = 1,
+    [AVR_OP_SWAP] = 1,
+    [AVR_OP_INC] = 1,
+    [AVR_OP_ASR] = 1,
+    [AVR_OP_LSR] = 1,
+    [AVR_OP_ROR] = 1,
+    [AVR_OP_DEC] = 1,
+    [AVR_OP_BSET] = 1,
+    [AVR_OP_BCLR] = 1,
+    [AVR_OP_RET] = 4,
+    [AVR_OP_RETI] = 4,
+    [AVR_OP_SLEEP] = 1,
+    [AVR_OP_BREAK] = 1,
+    [AVR_OP_WDR] = 1,
+    [AVR_OP_SPM] = 1,
+    [AVR_OP_IJMP] = 2,
+    [AVR_OP_ICALL] = 3,
+    [AVR_OP_JMP] = 3,
+    [AVR_OP_CALL] = 4,
+    [AVR_OP_ADIW] = 2,
+    [AVR_OP_SBIW] = 2,
+    [AVR_OP_CBI] = 2,
+    [AVR_OP_SBIC] = 1,
+    [AVR_OP_SBI] = 2,
+    [AVR_OP_SBIS] = 1,
+    [AVR_OP_MUL] = 2,
+    [AVR_OP_IN] = 1,
+    [AVR_OP_OUT] = 1,
+    [AVR_OP_RJMP] = 2,
+    [AVR_OP_RCALL] = 3,
+    [AVR_OP_LDI] = 1,
+    [AVR_OP_BRBS] = 1,
+    [AVR_OP_BRBC] = 1,
+    [AVR_OP_BLD] = 1,
+    [AVR_OP_BST] = 1,
+    [AVR_OP_SBRC] = 1,
+    [AVR_OP_SBRS] = 1,
+    [AVR_OP_ILLEGAL] = 1,
+};
+
+// Ciclos base por classe do Cortex-M3, sem wait states do flash.
+// Desvios tomados somam ARM_PIPELINE_REFILL_CYCLES; LDM/STM somam 1 por registrador.
+static const uint8_t arm_cycles[ARM_OP_COUNT] = {
+    [ARM_OP_ALU] = 1,
+    [ARM_OP_MUL] = 1,
+    [ARM_OP_MLA] = 2,
+    [ARM_OP_MULL] = 4,
+    [ARM_OP_DIV] = 2,
+    [ARM_OP_LOAD] = 2,
+    [ARM_OP_STORE] = 2,
+    [ARM_OP_LOAD_MULTIPLE] = 1,
+    [ARM_OP_STORE_MULTIPLE] = 1,
+    [ARM_OP_BRANCH] = 1,
+    [ARM_OP_BRANCH_LINK] = 1 + ARM_PIPELINE_REFILL_CYCLES,
+    [ARM_OP_TABLE_BRANCH] = 2 + ARM_PIPELINE_REFILL_CYCLES,
+    [ARM_OP_IT] = 1,
+    [ARM_OP_STATUS] = 2,
+    [ARM_OP_BARRIER] = 3,
+    [ARM_OP_SLEEP] = 1,
+    [ARM_OP_NOP] = 1,
+};
+
+// Ciclos do oscilador por instrução do PIC16F877A
+static const uint8_t pic_cycles[PIC_OP_COUNT] = {
+    [PIC_OP_UNDECODED] = 4,
+    [PIC_OP_ADDWF] = 4,
+    [PIC_OP_ANDWF] = 4,
+    [PIC_OP_CLRF] = 4,
+    [PIC_OP_CLRW] = 4,
+    [PIC_OP_COMF] = 4,
+    [PIC_OP_DECF] = 4,
+    [PIC_OP_DECFSZ] = 4,
+    [PIC_OP_INCF] = 4,
+    [PIC_OP_INCFSZ] = 4,
+    [PIC_OP_IORWF] = 4,
+    [PIC_OP_MOVF] = 4,
+    [PIC_OP_MOVWF] = 4,
+    [PIC_OP_NOP] = 4,
+    [PIC_OP_RLF] = 4,
+    [PIC_OP_RRF] = 4,
+    [PIC_OP_SUBWF] = 4,
+    [PIC_OP_SWAPF] = 4,
+    [PIC_OP_XORWF] = 4,
+    [PIC_OP_BCF] = 4,
+    [PIC_OP_BSF] = 4,
+    [PIC_OP_BTFSC] = 4,
+    [PIC_OP_BTFSS] = 4,
+    [PIC_OP_ADDLW] = 4,
+    [PIC_OP_ANDLW] = 4,
+    [PIC_OP_CALL] = 8,
+    [PIC_OP_CLRWDT] = 4,
+    [PIC_OP_GOTO] = 8,
+    [PIC_OP_IORLW] = 4,
+    [PIC_OP_MOVLW] = 4,
+    [PIC_OP_RETFIE] = 8,
+    [PIC_OP_RETLW] = 8,
+    [PIC_OP_RETURN] = 8,
+    [PIC_OP_SLEEP] = 4,
+    [PIC_OP_SUBLW] = 4,
+    [PIC_OP_XORLW] = 4,
+    [PIC_OP_ILLEGAL] = 4,
+};
+
+const uint8_t* mcu_get_cycle_table(mcu_type_t type, size_t* count) {
+    const uint8_t* table = NULL;
+    size_t size = 0;
+
+    switch (type) {
+        case MCU_AVR_ATMEGA328P:
+            table = avr_cycles;
+            size = AVR_OP_COUNT;
+            break;
+        case MCU_ARM_CORTEX_M3:
+            table = arm_cycles;
+            size = ARM_OP_COUNT;
+            break;
+        case MCU_PIC16F877A:
+            table = pic_cycles;
+            size = PIC_OP_COUNT;
+            break;
+        default:
+            break;
+    }
+
+    if (count) {
+        *count = size;
+    }
+
+    return table;
+}
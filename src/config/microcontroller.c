@@ -1,7 +1,17 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "microcontroller.h"
+#include <math.h>
+#include "config/microcontroller.h"
+#include "config/arm_core.h"
+#include "config/avr_core.h"
+#include "config/avr_io.h"
+#include "config/firmware.h"
+#include "config/mcu_log.h"
+#include "config/mcu_replay.h"
+#include "config/pic_core.h"
 
 // Configurações padrão para diferentes tipos de microcontrolador
 static const mcu_config_t mcu_configs[] = {
@@ -11,6 +21,7 @@ static const mcu_config_t mcu_configs[] = {
         .memory_size = 32768,         // 32 KB
         .flash_start = 0x0000,
         .ram_start = 0x0100,
+        .ram_size = 2048,             // 2 KB de SRAM
         .pin_count = 28,
         .name = "ATmega328P"
     },
@@ -20,32 +31,78 @@ static const mcu_config_t mcu_configs[] = {
         .memory_size = 65536,         // 64 KB
         .flash_start = 0x08000000,
         .ram_start = 0x20000000,
+        .ram_size = 20480,            // 20 KB de SRAM
         .pin_count = 48,
         .name = "ARM Cortex-M3"
     },
     {
         .type = MCU_PIC16F877A,
         .clock_frequency = 20000000,  // 20 MHz
-        .memory_size = 8192,          // 8 KB
+        .memory_size = 16384,         // 8K palavras de 14 bits
         .flash_start = 0x0000,
-        .ram_start = 0x0020,
+        .ram_start = 0x0060,          // após os SFRs dos 4 bancos (ver pic_core.h)
+        .ram_size = 368,              // registradores de uso geral
         .pin_count = 40,
         .name = "PIC16F877A"
     }
 };
 
+// Escolhida uma vez no mcu_init; daí em diante tudo passa por mcu->core
+static const mcu_core_ops_t* mcu_core_for_type(mcu_type_t type) {
+    switch (type) {
+        case MCU_ARM_CORTEX_M3: return &arm_core_ops;
+        case MCU_PIC16F877A: return &pic_core_ops;
+        default: return &avr_core_ops;
+    }
+}
+
+static int mcu_pin_input_hook(void* context, int pin_number, pin_state_t state) {
+    return mcu_set_pin_state(context, pin_number, state);
+}
+
 int mcu_init(microcontroller_t* mcu, const mcu_config_t* config) {
+    return mcu_init_with_output(mcu, config, stdout);
+}
+
+int mcu_init_with_output(microcontroller_t* mcu, const mcu_config_t* config, FILE* output) {
     if (!mcu || !config) {
         return -1;
     }
 
     // Copia a configuração
     mcu->config = *config;
+    mcu->output = output ? output : stdout;
     mcu->state = MCU_STATE_RESET;
     mcu->program_counter = config->flash_start;
     mcu->memory_size = config->memory_size;
+    mcu->flash_shared = false;
     mcu->firmware_loaded = false;
     mcu->firmware_path = NULL;
+    mcu->firmware_size = 0;
+    mcu->entry_point = config->flash_start;
+    mcu->data_image = NULL;
+    mcu->cycle_count = 0;
+    mcu->avr_code = NULL;
+    mcu->arm = NULL;
+    mcu->pic = NULL;
+    mcu->mmio = NULL;
+    mcu->mmio_end = 0;
+    mcu->breakpoints = NULL;
+    mcu->watch_read = NULL;
+    mcu->watch_write = NULL;
+    mcu->breakpoint_count = 0;
+    mcu->watchpoint_count = 0;
+    mcu->skip_breakpoint = false;
+    mcu->stop_reason = MCU_STOP_NONE;
+    mcu->stop_address = 0;
+    mcu->stop_watch = MCU_WATCH_ACCESS;
+    mcu->recording = NULL;
+
+    mcu->cycle_table = mcu_get_cycle_table(config->type, &mcu->cycle_table_size);
+    if (!mcu->cycle_table) {
+        fprintf(stderr, "Tipo de microcontrolador sem tabela de ciclos\n");
+        return -1;
+    }
 
     // Aloca memória
     mcu->memory = calloc(config->memory_size, sizeof(uint8_t));
@@ -54,26 +111,88 @@ int mcu_init(microcontroller_t* mcu, const mcu_config_t* config) {
         return -1;
     }
 
-    // Aloca registradores (assumindo 32 registradores de 32 bits)
-    mcu->registers = calloc(32, sizeof(uint32_t));
-    if (!mcu->registers) {
-        fprintf(stderr, "Erro ao alocar registradores\n");
+    // No AVR e no PIC o espaço de dados inclui registradores e I/O abaixo da RAM
+    mcu->data_base = (config->type == MCU_ARM_CORTEX_M3) ? config->ram_start : 0;
+    mcu->data_size = config->ram_start + config->ram_size - mcu->data_base;
+    mcu->data_memory = calloc(mcu->data_size, sizeof(uint8_t));
+    if (!mcu->data_memory) {
+        fprintf(stderr, "Erro ao alocar memória de dados\n");
+        free(mcu->memory);
+        return -1;
+    }
+
+    mcu->page_count = (mcu->data_size + MCU_PAGE_SIZE - 1) >> MCU_PAGE_SHIFT;
+    mcu->dirty_pages = calloc(mcu->page_count, sizeof(uint8_t));
+    mcu->snapshot_id = 0;
+    if (!mcu->dirty_pages) {
+        fprintf(stderr, "Erro ao alocar memória de dados\n");
+        free(mcu->data_memory);
+        free(mcu->memory);
+        return -1;
+    }
+
+    // AVR: registradores e I/O ficam abaixo de ram_start; PIC: os SFRs
+    if (config->type == MCU_AVR_ATMEGA328P || config->type == MCU_PIC16F877A) {
+        mcu->mmio_end = config->ram_start;
+        mcu->mmio = calloc(mcu->mmio_end, sizeof(mmio_handler_t));
+        if (!mcu->mmio) {
+            fprintf(stderr, "Erro ao alocar tabela de I/O\n");
+            free(mcu->dirty_pages);
+            free(mcu->data_memory);
+            free(mcu->memory);
+            return -1;
+        }
+    }
+    mcu->direct_start = mcu->mmio_end;
+
+    mcu->core = mcu_core_for_type(config->type);
+    memset(&mcu->registers, 0, sizeof(mcu->registers));
+    if (mcu->core->init(mcu) < 0) {
+        free(mcu->mmio);
+        free(mcu->dirty_pages);
+        free(mcu->data_memory);
+        free(mcu->memory);
+        return -1;
+    }
+
+    if (scheduler_init(&mcu->scheduler, 16) < 0) {
+        mcu->core->cleanup(mcu);
+        free(mcu->mmio);
+        free(mcu->dirty_pages);
+        free(mcu->data_memory);
         free(mcu->memory);
         return -1;
     }
 
     // Inicializa o gerenciador de pinos
-    if (pin_manager_init(&mcu->pin_manager, config->pin_count) < 0) {
+    if (pin_manager_init(&mcu->pin_manager, config->pin_count, mcu->output) < 0) {
         fprintf(stderr, "Erro ao inicializar gerenciador de pinos\n");
-        free(mcu->registers);
+        scheduler_cleanup(&mcu->scheduler);
+        mcu->core->cleanup(mcu);
+        free(mcu->mmio);
+        free(mcu->dirty_pages);
+        free(mcu->data_memory);
         free(mcu->memory);
         return -1;
     }
+    // Mudanças dos pinos monitorados saem carimbadas com o ciclo do MCU, e
+    // entradas vindas das filas entram na gravação como as demais
+    pin_manager_set_clock(&mcu->pin_manager, &mcu->cycle_count);
+    pin_manager_set_input_hook(&mcu->pin_manager, mcu_pin_input_hook, mcu);
 
-    printf("Microcontrolador %s inicializado\n", config->name);
-    printf("  Frequência: %u Hz\n", config->clock_frequency);
-    printf("  Memória: %u bytes\n", config->memory_size);
-    printf("  Pinos: %d\n", config->pin_count);
+    if (config->type == MCU_AVR_ATMEGA328P) {
+        if (avr_io_init(mcu) < 0) {
+            fprintf(stderr, "Erro ao mapear I/O do microcontrolador\n");
+            mcu_cleanup(mcu);
+            return -1;
+        }
+    }
+    mcu->core->reset(mcu);
+
+    fprintf(mcu->output, "Microcontrolador %s inicializado\n", config->name);
+    fprintf(mcu->output, "  Frequência: %u Hz\n", config->clock_frequency);
+    fprintf(mcu->output, "  Memória: %u bytes\n", config->memory_size);
+    fprintf(mcu->output, "  Pinos: %d\n", config->pin_count);
 
     return 0;
 }
@@ -86,23 +205,52 @@ int mcu_cleanup(microcontroller_t* mcu) {
     // Limpa o gerenciador de pinos
     pin_manager_cleanup(&mcu->pin_manager);
 
-    // Libera memória
-    if (mcu->memory) {
+    // Libera memória (o flash compartilhado pertence a outra instância)
+    if (mcu->memory && !mcu->flash_shared) {
         free(mcu->memory);
-        mcu->memory = NULL;
     }
+    mcu->memory = NULL;
+
+    if (mcu->data_memory) {
+        free(mcu->data_memory);
+        mcu->data_memory = NULL;
+    }
+
+    free(mcu->dirty_pages);
+    mcu->dirty_pages = NULL;
+    mcu->snapshot_id = 0;
+
+    if (mcu->mmio) {
+        free(mcu->mmio);
+        mcu->mmio = NULL;
+    }
+    mcu->mmio_end = 0;
+    mcu->direct_start = 0;
 
-    if (mcu->registers) {
-        free(mcu->registers);
-        mcu->registers = NULL;
+    free(mcu->breakpoints);
+    free(mcu->watch_read);
+    free(mcu->watch_write);
+    mcu->breakpoints = mcu->watch_read = mcu->watch_write = NULL;
+    mcu->breakpoint_count = mcu->watchpoint_count = 0;
+
+    if (mcu->core) {
+        mcu->core->cleanup(mcu);
     }
+    scheduler_cleanup(&mcu->scheduler);
 
     if (mcu->firmware_path) {
         free(mcu->firmware_path);
         mcu->firmware_path = NULL;
     }
 
-    printf("Microcontrolador finalizado\n");
+    if (mcu->data_image && !mcu->flash_shared) {
+        free(mcu->data_image);
+    }
+    mcu->data_image = NULL;
+    mcu->flash_shared = false;
+    mcu->recording = NULL;
+
+    fprintf(mcu->output, "Microcontrolador finalizado\n");
     return 0;
 }
 
@@ -113,15 +261,29 @@ int mcu_reset(microcontroller_t* mcu) {
 
     // Reseta o estado
     mcu->state = MCU_STATE_RESET;
-    mcu->program_counter = mcu->config.flash_start;
+    mcu->program_counter = mcu->entry_point;
+    mcu->cycle_count = 0;
+
+    // Eventos pendentes referem-se à linha do tempo anterior ao reset
+    scheduler_clear(&mcu->scheduler);
+
+    // A RAM inteira é reescrita: o próximo restore precisa ser completo
+    mcu->snapshot_id = 0;
 
     // Limpa registradores
-    memset(mcu->registers, 0, 32 * sizeof(uint32_t));
+    memset(&mcu->registers, 0, sizeof(mcu->registers));
+
+    // Restaura o espaço de dados (o flash é mantido se firmware foi carregado);
+    // .data/.bss do ELF voltam aos valores iniciais
+    if (mcu->data_image) {
+        memcpy(mcu->data_memory, mcu->data_image, mcu->data_size);
+    } else if (mcu->data_memory) {
+        memset(mcu->data_memory, 0, mcu->data_size);
+    }
 
-    // Limpa memória RAM (mantém flash se firmware foi carregado)
-    if (mcu->memory) {
-        memset(mcu->memory + mcu->config.ram_start, 0,
-               mcu->config.memory_size - mcu->config.ram_start);
+    mcu->core->reset(mcu);
+    if (mcu->config.type == MCU_AVR_ATMEGA328P) {
+        avr_io_reset(mcu);
     }
 
     // Reseta pinos
@@ -129,50 +291,108 @@ int mcu_reset(microcontroller_t* mcu) {
         pin_set_state(&mcu->pin_manager, i, PIN_LOW);
     }
 
-    printf("Microcontrolador resetado\n");
+    fprintf(mcu->output, "Microcontrolador resetado\n");
     return 0;
 }
 
+// Coloca o MCU no estado inicial definido pelo firmware
+static void mcu_apply_firmware(microcontroller_t* mcu) {
+    mcu->snapshot_id = 0;
+    if (mcu->data_image) {
+        memcpy(mcu->data_memory, mcu->data_image, mcu->data_size);
+    }
+    mcu->program_counter = mcu->entry_point;
+
+    mcu->core->invalidate(mcu);
+    mcu->core->reset(mcu);
+
+    mcu->firmware_loaded = true;
+}
+
 int mcu_load_firmware(microcontroller_t* mcu, const char* firmware_path) {
     if (!mcu || !firmware_path) {
         return -1;
     }
 
-    FILE* file = fopen(firmware_path, "rb");
-    if (!file) {
-        fprintf(stderr, "Erro ao abrir arquivo de firmware: %s\n", firmware_path);
+    firmware_file_t file;
+    if (firmware_map(firmware_path, &file) < 0) {
+        return -1;
+    }
+
+    // Valida antes de tocar no flash, para não deixar um firmware pela metade
+    if (firmware_load_image(mcu, file.data, file.size, true) < 0 ||
+        firmware_load_image(mcu, file.data, file.size, false) < 0) {
+        firmware_unmap(&file);
+        mcu->firmware_loaded = false;
         return -1;
     }
 
-    // Obtém tamanho do arquivo
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    firmware_format_t format = firmware_detect_format(file.data, file.size);
+    firmware_unmap(&file);
+
+    // Salva o caminho do firmware
+    if (mcu->firmware_path) {
+        free(mcu->firmware_path);
+    }
+    mcu->firmware_path = strdup(firmware_path);
+
+    mcu_apply_firmware(mcu);
+    fprintf(mcu->output, "Firmware carregado: %s (%s, %u bytes, entrada 0x%08x)\n",
+           firmware_path, firmware_format_to_string(format), mcu->firmware_size, mcu->entry_point);
+
+    return 0;
+}
+
+int mcu_load_firmware_buffer(microcontroller_t* mcu, const uint8_t* data, size_t size) {
+    if (!mcu || !data) {
+        return -1;
+    }
 
-    if (file_size > mcu->config.memory_size) {
-        fprintf(stderr, "Firmware muito grande: %ld bytes (máximo: %u)\n",
-                file_size, mcu->config.memory_size);
-        fclose(file);
+    if (firmware_load_image(mcu, data, size, true) < 0 ||
+        firmware_load_image(mcu, data, size, false) < 0) {
+        mcu->firmware_loaded = false;
         return -1;
     }
 
-    // Lê o firmware para a memória flash
-    size_t bytes_read = fread(mcu->memory + mcu->config.flash_start, 1, file_size, file);
-    fclose(file);
+    if (mcu->firmware_path) {
+        free(mcu->firmware_path);
+        mcu->firmware_path = NULL;
+    }
+
+    mcu_apply_firmware(mcu);
 
-    if (bytes_read != (size_t)file_size) {
-        fprintf(stderr, "Erro ao ler firmware: %zu bytes lidos de %ld\n", bytes_read, file_size);
+    return 0;
+}
+
+int mcu_share_firmware(microcontroller_t* mcu, const microcontroller_t* source) {
+    if (!mcu || !source || mcu == source || !source->firmware_loaded) {
         return -1;
     }
 
-    // Salva o caminho do firmware
+    if (mcu->config.type != source->config.type || mcu->data_size != source->data_size) {
+        fprintf(stderr, "Firmware de %s não pode ser compartilhado com %s\n",
+                source->config.name, mcu->config.name);
+        return -1;
+    }
+
+    if (!mcu->flash_shared) {
+        free(mcu->memory);
+        free(mcu->data_image);
+    }
+
+    // O núcleo só lê o flash; o cache de decodificação continua por instância
+    mcu->memory = source->memory;
+    mcu->data_image = source->data_image;
+    mcu->flash_shared = true;
+    mcu->firmware_size = source->firmware_size;
+    mcu->entry_point = source->entry_point;
+
     if (mcu->firmware_path) {
         free(mcu->firmware_path);
     }
-    mcu->firmware_path = strdup(firmware_path);
+    mcu->firmware_path = source->firmware_path ? strdup(source->firmware_path) : NULL;
 
-    mcu->firmware_loaded = true;
-    printf("Firmware carregado: %s (%zu bytes)\n", firmware_path, bytes_read);
+    mcu_apply_firmware(mcu);
 
     return 0;
 }
@@ -182,69 +402,144 @@ int mcu_verify_firmware(microcontroller_t* mcu, const char* firmware_path) {
         return -1;
     }
 
-    FILE* file = fopen(firmware_path, "rb");
-    if (!file) {
+    firmware_file_t file;
+    if (firmware_map(firmware_path, &file) < 0) {
         return -1;
     }
 
-    // Verifica se o arquivo pode ser aberto e tem tamanho válido
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fclose(file);
+    int result = firmware_load_image(mcu, file.data, file.size, true);
+    firmware_unmap(&file);
+
+    return result;
+}
 
-    if (file_size <= 0 || file_size > mcu->config.memory_size) {
+int mcu_get_firmware_info(microcontroller_t* mcu, uint32_t* size, uint32_t* entry_point) {
+    if (!mcu || !size || !entry_point) {
         return -1;
     }
 
+    if (!mcu->firmware_loaded) {
+        return -1;
+    }
+
+    // Ambos são registrados pelo carregador
+    *entry_point = mcu->entry_point;
+    *size = mcu->firmware_size;
+
     return 0;
 }
 
-int mcu_get_firmware_info(microcontroller_t* mcu, uint32_t* size, uint32_t* entry_point) {
-    if (!mcu || !size || !entry_point) {
+// Executa uma instrução sem imprimir nada; retorna os ciclos gastos
+static int mcu_execute(microcontroller_t* mcu) {
+    return mcu->core->step(mcu);
+}
+
+// Executa até o ciclo stop sem verificar eventos
+static int mcu_execute_until(microcontroller_t* mcu, uint64_t stop) {
+    return mcu->core->run_block(mcu, stop);
+}
+
+// Dispara todos os eventos vencidos até o ciclo atual
+static void mcu_dispatch_events(microcontroller_t* mcu) {
+    sched_event_t event;
+
+    while (scheduler_pop_due(&mcu->scheduler, mcu->cycle_count, &event)) {
+        event.callback(mcu, event.context, event.cycle);
+    }
+}
+
+int mcu_step(microcontroller_t* mcu) {
+    if (!mcu || mcu->state != MCU_STATE_RUNNING) {
         return -1;
     }
 
-    if (!mcu->firmware_loaded) {
+    MCU_LOG(MCU_LOG_TRACE, mcu->output, "Executando instrução em 0x%08x\n", mcu->program_counter);
+
+    if (mcu_execute(mcu) < 0) {
         return -1;
     }
 
-    // Por enquanto, assume que o entry point é o início da flash
-    *entry_point = mcu->config.flash_start;
+    mcu_dispatch_events(mcu);
 
-    // Calcula o tamanho baseado no primeiro byte não-zero
-    *size = 0;
-    for (uint32_t i = 0; i < mcu->config.memory_size; i++) {
-        if (mcu->memory[i] != 0) {
-            *size = i + 1;
-        }
+    // Verifica se chegou ao fim da memória
+    if (mcu->state == MCU_STATE_HALTED) {
+        MCU_LOG(MCU_LOG_INFO, mcu->output, "Execução finalizada - fim da memória\n");
     }
 
     return 0;
 }
 
-int mcu_step(microcontroller_t* mcu) {
+int mcu_run_cycles(microcontroller_t* mcu, uint64_t cycles) {
     if (!mcu || mcu->state != MCU_STATE_RUNNING) {
         return -1;
     }
 
-    // Simula um ciclo de instrução
-    // Em uma implementação real, aqui seria feita a decodificação e execução
-    // da instrução no endereço do program counter
+    // A última instrução pode ultrapassar o alvo em alguns ciclos,
+    // já que instruções não são interrompidas no meio
+    uint64_t target = mcu->cycle_count + cycles;
 
-    printf("Executando instrução em 0x%08x\n", mcu->program_counter);
+    // O laço da CPU só é interrompido quando o próximo evento vence
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < target) {
+        uint64_t next_event = scheduler_next_cycle(&mcu->scheduler);
+        uint64_t stop = next_event < target ? next_event : target;
 
-    // Incrementa o program counter (assumindo instruções de 2 bytes)
-    mcu->program_counter += 2;
+        if (mcu_execute_until(mcu, stop) < 0) {
+            return -1;
+        }
 
-    // Verifica se chegou ao fim da memória
-    if (mcu->program_counter >= mcu->config.memory_size) {
-        mcu->state = MCU_STATE_HALTED;
-        printf("Execução finalizada - fim da memória\n");
+        mcu_dispatch_events(mcu);
+    }
+
+    // Cada chamada é um quantum da co-simulação com o circuito
+    if (mcu->pin_manager.edges || mcu->pin_manager.crossings) {
+        pin_manager_sync_queues(&mcu->pin_manager);
     }
 
     return 0;
 }
 
+int mcu_run_until_time(microcontroller_t* mcu, double seconds) {
+    if (!mcu || seconds < 0.0) {
+        return -1;
+    }
+
+    uint64_t target = (uint64_t)ceil(seconds * mcu->config.clock_frequency);
+    if (target <= mcu->cycle_count) {
+        return 0;
+    }
+
+    return mcu_run_cycles(mcu, target - mcu->cycle_count);
+}
+
+int mcu_schedule_event(microcontroller_t* mcu, uint64_t delay, sched_event_kind_t kind,
+                       sched_callback_t callback, void* context) {
+    if (!mcu) {
+        return -1;
+    }
+
+    return scheduler_add(&mcu->scheduler, mcu->cycle_count + delay, kind, callback, context);
+}
+
+int mcu_cancel_event(microcontroller_t* mcu, int event_id) {
+    if (!mcu) {
+        return -1;
+    }
+
+    return scheduler_cancel(&mcu->scheduler, event_id);
+}
+
+uint64_t mcu_get_cycle_count(const microcontroller_t* mcu) {
+    return mcu ? mcu->cycle_count : 0;
+}
+
+double mcu_get_time(const microcontroller_t* mcu) {
+    if (!mcu || mcu->config.clock_frequency == 0) {
+        return 0.0;
+    }
+
+    return (double)mcu->cycle_count / mcu->config.clock_frequency;
+}
+
 int mcu_run(microcontroller_t* mcu) {
     if (!mcu) {
         return -1;
@@ -256,7 +551,8 @@ int mcu_run(microcontroller_t* mcu) {
     }
 
     mcu->state = MCU_STATE_RUNNING;
-    printf("Iniciando execução do firmware\n");
+    mcu->stop_reason = MCU_STOP_NONE;
+    fprintf(mcu->output, "Iniciando execução do firmware\n");
 
     return 0;
 }
@@ -267,7 +563,7 @@ int mcu_stop(microcontroller_t* mcu) {
     }
 
     mcu->state = MCU_STATE_HALTED;
-    printf("Execução parada\n");
+    fprintf(mcu->output, "Execução parada\n");
 
     return 0;
 }
@@ -277,62 +573,190 @@ int mcu_run_until_breakpoint(microcontroller_t* mcu, uint32_t address) {
         return -1;
     }
 
-    printf("Executando até breakpoint em 0x%08x\n", address);
+    fprintf(mcu->output, "Executando até breakpoint em 0x%08x\n", address);
+
+    // Breakpoint temporário, além dos que já estiverem definidos
+    bool temporary = !mcu_has_breakpoint(mcu, address);
+    if (temporary && mcu_set_breakpoint(mcu, address) < 0) {
+        return -1;
+    }
 
     mcu->state = MCU_STATE_RUNNING;
+    mcu->stop_reason = MCU_STOP_NONE;
+
+    while (mcu->state == MCU_STATE_RUNNING) {
+        if (mcu_run_cycles(mcu, UINT32_MAX) < 0) {
+            break;
+        }
+    }
+
+    if (temporary) {
+        mcu_remove_breakpoint(mcu, address);
+    }
+
+    if (mcu->stop_reason == MCU_STOP_BREAKPOINT) {
+        fprintf(mcu->output, "Breakpoint atingido em 0x%08x\n", mcu->stop_address);
+    }
+
+    return 0;
+}
 
-    while (mcu->state == MCU_STATE_RUNNING && mcu->program_counter != address) {
-        mcu_step(mcu);
+static inline bool bitmap_test(const uint64_t* bitmap, uint32_t bit) {
+    return (bitmap[bit >> 6] >> (bit & 63)) & 1;
+}
+
+static inline void bitmap_set(uint64_t* bitmap, uint32_t bit, bool value) {
+    if (value) {
+        bitmap[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    } else {
+        bitmap[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+    }
+}
+
+static uint64_t* bitmap_alloc(uint32_t bits) {
+    return calloc((bits + 63) / 64, sizeof(uint64_t));
+}
+
+static uint8_t mmio_dispatch_read(microcontroller_t* mcu, uint32_t offset) {
+    if (offset < mcu->mmio_end && mcu->mmio[offset].read) {
+        return mcu->mmio[offset].read(mcu, offset, mcu->mmio[offset].context);
     }
 
-    if (mcu->program_counter == address) {
+    return offset < mcu->data_size ? mcu->data_memory[offset] : 0;
+}
+
+static void mmio_dispatch_write(microcontroller_t* mcu, uint32_t offset, uint8_t value) {
+    if (offset < mcu->mmio_end && mcu->mmio[offset].write) {
+        mcu->mmio[offset].write(mcu, offset, value, mcu->mmio[offset].context);
+    } else if (offset < mcu->data_size) {
+        mcu->data_memory[offset] = value;
+        mcu->dirty_pages[offset >> MCU_PAGE_SHIFT] = 1;
+    }
+}
+
+// O acesso termina normalmente; a execução para ao fim da instrução. Um
+// byte marcado nos dois mapas é de um watchpoint de acesso
+static void mcu_check_watchpoint(microcontroller_t* mcu, mcu_watch_t access, uint32_t offset) {
+    const uint64_t* bitmap = access == MCU_WATCH_READ ? mcu->watch_read : mcu->watch_write;
+    const uint64_t* other = access == MCU_WATCH_READ ? mcu->watch_write : mcu->watch_read;
+
+    if (bitmap && offset < mcu->data_size && bitmap_test(bitmap, offset)) {
         mcu->state = MCU_STATE_HALTED;
-        printf("Breakpoint atingido em 0x%08x\n", address);
+        mcu->stop_reason = MCU_STOP_WATCHPOINT;
+        mcu->stop_address = mcu->data_base + offset;
+        mcu->stop_watch = other && bitmap_test(other, offset) ? MCU_WATCH_ACCESS : access;
+    }
+}
+
+uint8_t mcu_mmio_read(microcontroller_t* mcu, uint32_t offset) {
+    uint8_t value = mmio_dispatch_read(mcu, offset);
+
+    if (mcu->watchpoint_count > 0) {
+        mcu_check_watchpoint(mcu, MCU_WATCH_READ, offset);
+    }
+
+    return value;
+}
+
+void mcu_mmio_write(microcontroller_t* mcu, uint32_t offset, uint8_t value) {
+    mmio_dispatch_write(mcu, offset, value);
+
+    if (mcu->watchpoint_count > 0) {
+        mcu_check_watchpoint(mcu, MCU_WATCH_WRITE, offset);
     }
+}
+
+int mcu_map_io(microcontroller_t* mcu, uint32_t offset, mmio_read_t read, mmio_write_t write, void* context) {
+    if (!mcu || offset >= mcu->mmio_end) {
+        return -1;
+    }
+
+    mcu->mmio[offset].read = read;
+    mcu->mmio[offset].write = write;
+    mcu->mmio[offset].context = context;
 
     return 0;
 }
 
+int mcu_unmap_io(microcontroller_t* mcu, uint32_t offset) {
+    return mcu_map_io(mcu, offset, NULL, NULL, NULL);
+}
+
+// Endereços são do espaço de dados (a partir de data_base)
 int mcu_read_memory(microcontroller_t* mcu, uint32_t address, uint8_t* data, size_t size) {
-    if (!mcu || !data || address + size > mcu->config.memory_size) {
+    if (!mcu || !data || address < mcu->data_base ||
+        address - mcu->data_base + size > mcu->data_size) {
         return -1;
     }
 
-    memcpy(data, mcu->memory + address, size);
+    uint32_t offset = address - mcu->data_base;
+
+    // Só a parte que cai na região de I/O passa pelos handlers
+    while (size > 0 && offset < mcu->mmio_end) {
+        *data++ = mmio_dispatch_read(mcu, offset++);
+        size--;
+    }
+
+    memcpy(data, mcu->data_memory + offset, size);
     return 0;
 }
 
 int mcu_write_memory(microcontroller_t* mcu, uint32_t address, const uint8_t* data, size_t size) {
-    if (!mcu || !data || address + size > mcu->config.memory_size) {
+    if (!mcu || !data) {
         return -1;
     }
 
     // Só permite escrita na RAM
-    if (address < mcu->config.ram_start) {
+    if (address < mcu->data_base) {
         fprintf(stderr, "Tentativa de escrita na memória flash\n");
         return -1;
     }
 
-    memcpy(mcu->memory + address, data, size);
+    if (address - mcu->data_base + size > mcu->data_size) {
+        return -1;
+    }
+
+    if (mcu->recording && !mcu_replay_memory_input(mcu, address, data, size)) {
+        return 0;
+    }
+
+    uint32_t offset = address - mcu->data_base;
+
+    while (size > 0 && offset < mcu->mmio_end) {
+        mmio_dispatch_write(mcu, offset++, *data++);
+        size--;
+    }
+
+    memcpy(mcu->data_memory + offset, data, size);
+    if (size > 0) {
+        memset(mcu->dirty_pages + (offset >> MCU_PAGE_SHIFT), 1,
+               ((offset + size - 1) >> MCU_PAGE_SHIFT) - (offset >> MCU_PAGE_SHIFT) + 1);
+    }
     return 0;
 }
 
 int mcu_read_register(microcontroller_t* mcu, int reg_index, uint32_t* value) {
-    if (!mcu || !value || reg_index < 0 || reg_index >= 32) {
+    if (!mcu || !value) {
         return -1;
     }
 
-    *value = mcu->registers[reg_index];
-    return 0;
+    return mcu->core->read_reg(mcu, reg_index, value);
 }
 
 int mcu_write_register(microcontroller_t* mcu, int reg_index, uint32_t value) {
-    if (!mcu || reg_index < 0 || reg_index >= 32) {
+    if (!mcu) {
         return -1;
     }
 
-    mcu->registers[reg_index] = value;
-    return 0;
+    return mcu->core->write_reg(mcu, reg_index, value);
+}
+
+int mcu_disassemble(microcontroller_t* mcu, uint32_t address, char* buffer, size_t size) {
+    if (!mcu || !buffer || size == 0) {
+        return -1;
+    }
+
+    return mcu->core->disassemble(mcu, address, buffer, size);
 }
 
 int mcu_get_pin_state(microcontroller_t* mcu, int pin_number, pin_state_t* state) {
@@ -349,6 +773,10 @@ int mcu_set_pin_state(microcontroller_t* mcu, int pin_number, pin_state_t state)
         return -1;
     }
 
+    if (mcu->recording && !mcu_replay_pin_input(mcu, pin_number, state)) {
+        return 0;
+    }
+
     return pin_set_state(&mcu->pin_manager, pin_number, state);
 }
 
@@ -360,41 +788,135 @@ int mcu_get_pin_by_name(microcontroller_t* mcu, const char* name, pin_t** pin) {
     return pin_get_by_name(&mcu->pin_manager, name, pin);
 }
 
+// Breakpoints são indexados por meia-palavra do flash
+static int mcu_breakpoint_index(const microcontroller_t* mcu, uint32_t address, uint32_t* index) {
+    if (address < mcu->config.flash_start ||
+        address - mcu->config.flash_start >= mcu->config.memory_size) {
+        return -1;
+    }
+
+    *index = (address - mcu->config.flash_start) >> 1;
+    return 0;
+}
+
+bool mcu_has_breakpoint(const microcontroller_t* mcu, uint32_t address) {
+    uint32_t index;
+
+    if (!mcu || !mcu->breakpoints || mcu_breakpoint_index(mcu, address, &index) < 0) {
+        return false;
+    }
+
+    return bitmap_test(mcu->breakpoints, index);
+}
+
 int mcu_set_breakpoint(microcontroller_t* mcu, uint32_t address) {
-    if (!mcu || address >= mcu->config.memory_size) {
+    uint32_t index;
+
+    if (!mcu || mcu_breakpoint_index(mcu, address, &index) < 0) {
         return -1;
     }
 
-    printf("Breakpoint definido em 0x%08x\n", address);
+    if (!mcu->breakpoints) {
+        mcu->breakpoints = bitmap_alloc(mcu->config.memory_size / 2);
+        if (!mcu->breakpoints) {
+            fprintf(stderr, "Erro ao alocar mapa de breakpoints\n");
+            return -1;
+        }
+    }
+
+    if (!bitmap_test(mcu->breakpoints, index)) {
+        bitmap_set(mcu->breakpoints, index, true);
+        mcu->breakpoint_count++;
+        mcu->core->mark_breakpoint(mcu, index, true);
+    }
+
+    fprintf(mcu->output, "Breakpoint definido em 0x%08x\n", address);
     return 0;
 }
 
 int mcu_remove_breakpoint(microcontroller_t* mcu, uint32_t address) {
-    if (!mcu) {
+    uint32_t index;
+
+    if (!mcu || mcu_breakpoint_index(mcu, address, &index) < 0) {
         return -1;
     }
 
-    printf("Breakpoint removido em 0x%08x\n", address);
+    if (mcu->breakpoints && bitmap_test(mcu->breakpoints, index)) {
+        bitmap_set(mcu->breakpoints, index, false);
+        mcu->breakpoint_count--;
+        mcu->core->mark_breakpoint(mcu, index, false);
+    }
+
+    fprintf(mcu->output, "Breakpoint removido em 0x%08x\n", address);
     return 0;
 }
 
+static int mcu_update_watchpoint(microcontroller_t* mcu, uint32_t address, size_t size,
+                                 mcu_watch_t kind, bool enabled) {
+    if (!mcu || !(kind & MCU_WATCH_ACCESS) || size == 0 || address < mcu->data_base ||
+        address - mcu->data_base + size > mcu->data_size) {
+        return -1;
+    }
+
+    uint64_t** bitmaps[] = { &mcu->watch_read, &mcu->watch_write };
+    mcu_watch_t kinds[] = { MCU_WATCH_READ, MCU_WATCH_WRITE };
+    uint32_t offset = address - mcu->data_base;
+
+    for (int k = 0; k < 2; k++) {
+        if (!(kind & kinds[k])) {
+            continue;
+        }
+        if (!*bitmaps[k]) {
+            if (!enabled) {
+                continue;
+            }
+            *bitmaps[k] = bitmap_alloc(mcu->data_size);
+            if (!*bitmaps[k]) {
+                fprintf(stderr, "Erro ao alocar mapa de watchpoints\n");
+                return -1;
+            }
+        }
+        for (size_t i = 0; i < size; i++) {
+            if (bitmap_test(*bitmaps[k], offset + i) != enabled) {
+                bitmap_set(*bitmaps[k], offset + i, enabled);
+                mcu->watchpoint_count += enabled ? 1 : -1;
+            }
+        }
+    }
+
+    // Com watchpoints ativos a RAM também passa pelo caminho verificado
+    mcu->direct_start = mcu->watchpoint_count > 0 ? mcu->data_size : mcu->mmio_end;
+
+    return 0;
+}
+
+int mcu_set_watchpoint(microcontroller_t* mcu, uint32_t address, size_t size, mcu_watch_t kind) {
+    return mcu_update_watchpoint(mcu, address, size, kind, true);
+}
+
+int mcu_remove_watchpoint(microcontroller_t* mcu, uint32_t address, size_t size, mcu_watch_t kind) {
+    return mcu_update_watchpoint(mcu, address, size, kind, false);
+}
+
 int mcu_get_debug_info(microcontroller_t* mcu) {
     if (!mcu) {
         return -1;
     }
 
-    printf("=== Informações de Debug ===\n");
-    printf("Estado: %s\n", mcu_state_to_string(mcu->state));
-    printf("Program Counter: 0x%08x\n", mcu->program_counter);
-    printf("Firmware carregado: %s\n", mcu->firmware_loaded ? "Sim" : "Não");
+    fprintf(mcu->output, "=== Informações de Debug ===\n");
+    fprintf(mcu->output, "Estado: %s\n", mcu_state_to_string(mcu->state));
+    fprintf(mcu->output, "Program Counter: 0x%08x\n", mcu->program_counter);
+    fprintf(mcu->output, "Firmware carregado: %s\n", mcu->firmware_loaded ? "Sim" : "Não");
     if (mcu->firmware_path) {
-        printf("Caminho do firmware: %s\n", mcu->firmware_path);
+        fprintf(mcu->output, "Caminho do firmware: %s\n", mcu->firmware_path);
     }
 
     // Mostra alguns registradores
-    printf("Registradores principais:\n");
-    for (int i = 0; i < 8; i++) {
-        printf("  R%d: 0x%08x\n", i, mcu->registers[i]);
+    fprintf(mcu->output, "Registradores principais:\n");
+    for (int i = 0; i < 8 && i < mcu->core->register_count; i++) {
+        uint32_t value = 0;
+        mcu->core->read_reg(mcu, i, &value);
+        fprintf(mcu->output, "  R%d: 0x%08x\n", i, value);
     }
 
     return 0;
@@ -439,11 +961,11 @@ void mcu_print_status(microcontroller_t* mcu) {
         return;
     }
 
-    printf("=== Status do Microcontrolador ===\n");
-    printf("Tipo: %s\n", mcu->config.name);
-    printf("Estado: %s\n", mcu_state_to_string(mcu->state));
-    printf("Program Counter: 0x%08x\n", mcu->program_counter);
-    printf("Firmware: %s\n", mcu->firmware_loaded ? "Carregado" : "Não carregado");
+    fprintf(mcu->output, "=== Status do Microcontrolador ===\n");
+    fprintf(mcu->output, "Tipo: %s\n", mcu->config.name);
+    fprintf(mcu->output, "Estado: %s\n", mcu_state_to_string(mcu->state));
+    fprintf(mcu->output, "Program Counter: 0x%08x\n", mcu->program_counter);
+    fprintf(mcu->output, "Firmware: %s\n", mcu->firmware_loaded ? "Carregado" : "Não carregado");
 
     // Lista pinos configurados
     pin_list_all(&mcu->pin_manager);
@@ -0,0 +1,582 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/pic_core.h"
+
+// Início dos registradores de uso geral no espaço físico (= ram_start)
+#define PIC_GPR_BASE 0x60
+// Contador de programa de 13 bits (8K palavras)
+#define PIC_PC_MASK 0x1FFF
+// Marca instruções cujo resultado vai para W ou, com DEST_F, para o registrador
+#define PIC_INSN_RESULT 0x04
+
+static pic_insn_t pic_insn(pic_op_t op, uint8_t f, uint8_t b, uint8_t flags, uint16_t k) {
+    pic_insn_t insn = { .op = op, .f = f, .b = b, .flags = flags, .k = k };
+    return insn;
+}
+
+pic_insn_t pic_decode(uint16_t op) {
+    uint8_t f = op & 0x7F;
+    uint8_t dest = (op & 0x0080) ? PIC_INSN_DEST_F : 0;
+
+    op &= 0x3FFF;
+    switch (op >> 12) {
+        case 0x0: {
+            static const pic_op_t byte_ops[] = {
+                PIC_OP_ILLEGAL, PIC_OP_CLRF, PIC_OP_SUBWF, PIC_OP_DECF,
+                PIC_OP_IORWF, PIC_OP_ANDWF, PIC_OP_XORWF, PIC_OP_ADDWF,
+                PIC_OP_MOVF, PIC_OP_COMF, PIC_OP_INCF, PIC_OP_DECFSZ,
+                PIC_OP_RRF, PIC_OP_RLF, PIC_OP_SWAPF, PIC_OP_INCFSZ
+            };
+            int sel = (op >> 8) & 0x0F;
+
+            if (sel == 0) {
+                if (dest) {
+                    return pic_insn(PIC_OP_MOVWF, f, 0, PIC_INSN_DEST_F | PIC_INSN_RESULT, 0);
+                }
+                switch (op) {
+                    case 0x0000:
+                    case 0x0020:
+                    case 0x0040:
+                    case 0x0060: return pic_insn(PIC_OP_NOP, 0, 0, 0, 0);
+                    case 0x0008: return pic_insn(PIC_OP_RETURN, 0, 0, 0, 0);
+                    case 0x0009: return pic_insn(PIC_OP_RETFIE, 0, 0, 0, 0);
+                    case 0x0063: return pic_insn(PIC_OP_SLEEP, 0, 0, 0, 0);
+                    case 0x0064: return pic_insn(PIC_OP_CLRWDT, 0, 0, 0, 0);
+                    default: return pic_insn(PIC_OP_ILLEGAL, 0, 0, 0, 0);
+                }
+            }
+            if (sel == 1 && !dest) {
+                return pic_insn(PIC_OP_CLRW, 0, 0, PIC_INSN_RESULT, 0);
+            }
+            return pic_insn(byte_ops[sel], f, 0, dest | PIC_INSN_RESULT, 0);
+        }
+        case 0x1: {
+            static const pic_op_t bit_ops[] = { PIC_OP_BCF, PIC_OP_BSF, PIC_OP_BTFSC, PIC_OP_BTFSS };
+            return pic_insn(bit_ops[(op >> 10) & 0x03], f, (op >> 7) & 0x07, 0, 0);
+        }
+        case 0x2:
+            return pic_insn((op & 0x0800) ? PIC_OP_GOTO : PIC_OP_CALL, 0, 0, 0, op & 0x07FF);
+        default: {
+            static const pic_op_t literal_ops[] = {
+                PIC_OP_MOVLW, PIC_OP_MOVLW, PIC_OP_MOVLW, PIC_OP_MOVLW,
+                PIC_OP_RETLW, PIC_OP_RETLW, PIC_OP_RETLW, PIC_OP_RETLW,
+                PIC_OP_IORLW, PIC_OP_ANDLW, PIC_OP_XORLW, PIC_OP_ILLEGAL,
+                PIC_OP_SUBLW, PIC_OP_SUBLW, PIC_OP_ADDLW, PIC_OP_ADDLW
+            };
+            pic_op_t kind = literal_ops[(op >> 8) & 0x0F];
+            uint8_t flags = (kind == PIC_OP_RETLW || kind == PIC_OP_ILLEGAL) ? 0 : PIC_INSN_RESULT;
+            return pic_insn(kind, 0, 0, flags, op & 0xFF);
+        }
+    }
+}
+
+// Posição física de (banco, registrador). INDF, PCL, STATUS, FSR, PCLATH e
+// INTCON aparecem em todos os bancos, os 16 últimos bytes de cada banco são
+// a RAM comum do banco 0 e TMR0/PORTB e OPTION_REG/TRISB se repetem nos
+// bancos 2 e 3.
+static uint16_t pic_physical(int bank, int f) {
+    switch (f) {
+        case PIC_INDF:
+        case PIC_PCL:
+        case PIC_STATUS:
+        case PIC_FSR:
+        case PIC_PCLATH:
+        case PIC_INTCON:
+            return f;
+        default:
+            break;
+    }
+
+    if (f >= 0x70) {
+        return PIC_GPR_BASE + 0x50 + (f - 0x70);
+    }
+
+    switch (bank) {
+        case 0:
+            return f < 0x20 ? f : PIC_GPR_BASE + (f - 0x20);
+        case 1:
+            return f < 0x20 ? 0x20 + f : PIC_GPR_BASE + 0x60 + (f - 0x20);
+        case 2:
+            if (f == 0x01 || f == 0x06) {
+                return f;
+            }
+            return f < 0x10 ? 0x40 + f : PIC_GPR_BASE + 0xB0 + (f - 0x10);
+        default:
+            if (f == 0x01 || f == 0x06) {
+                return 0x20 + f;
+            }
+            return f < 0x10 ? 0x50 + f : PIC_GPR_BASE + 0x110 + (f - 0x10);
+    }
+}
+
+int pic_core_init(microcontroller_t* mcu) {
+    mcu->pic = calloc(1, sizeof(pic_core_t));
+    if (!mcu->pic) {
+        fprintf(stderr, "Erro ao alocar núcleo PIC\n");
+        return -1;
+    }
+
+    mcu->pic->code = calloc(mcu->memory_size / 2, sizeof(pic_insn_t));
+    if (!mcu->pic->code) {
+        fprintf(stderr, "Erro ao alocar cache de instruções\n");
+        free(mcu->pic);
+        mcu->pic = NULL;
+        return -1;
+    }
+
+    for (int address = 0; address < PIC_BANKED_SIZE; address++) {
+        mcu->pic->file_map[address] = pic_physical(address / PIC_BANK_SIZE, address % PIC_BANK_SIZE);
+    }
+
+    return 0;
+}
+
+void pic_core_cleanup(microcontroller_t* mcu) {
+    if (mcu->pic) {
+        free(mcu->pic->code);
+        free(mcu->pic);
+        mcu->pic = NULL;
+    }
+}
+
+void pic_core_invalidate(microcontroller_t* mcu) {
+    if (mcu->pic) {
+        memset(mcu->pic->code, 0, (mcu->memory_size / 2) * sizeof(pic_insn_t));
+    }
+}
+
+uint32_t pic_file_address(const microcontroller_t* mcu, uint32_t banked) {
+    return mcu->pic->file_map[banked % PIC_BANKED_SIZE];
+}
+
+void pic_core_reset(microcontroller_t* mcu) {
+    uint8_t* data = mcu->data_memory;
+
+    data[PIC_STATUS] = PIC_FLAG_TO | PIC_FLAG_PD;
+    data[PIC_PCLATH] = 0;
+    data[PIC_INTCON] &= 0x01;
+    data[PIC_OPTION_REG] = 0xFF;
+    // TRISA a TRISE: todos os pinos começam como entrada
+    memset(data + PIC_TRISA, 0xFF, 5);
+
+    mcu->registers.pic.stack_ptr = 0;
+}
+
+static inline uint16_t pic_flash_word(const microcontroller_t* mcu, uint32_t word) {
+    if (word >= mcu->memory_size / 2) {
+        return 0;
+    }
+    return (uint16_t)(mcu->memory[word * 2] | (mcu->memory[word * 2 + 1] << 8));
+}
+
+static inline pic_insn_t* pic_fetch(microcontroller_t* mcu, uint32_t word) {
+    pic_insn_t* insn = &mcu->pic->code[word];
+    if (insn->op == PIC_OP_UNDECODED) {
+        *insn = pic_decode(pic_flash_word(mcu, word));
+        if (mcu->breakpoint_count > 0 && mcu_has_breakpoint(mcu, word * 2)) {
+            insn->flags |= PIC_INSN_BREAKPOINT;
+        }
+    }
+    return insn;
+}
+
+void pic_core_mark_breakpoint(microcontroller_t* mcu, uint32_t word, bool enabled) {
+    pic_insn_t* insn = &mcu->pic->code[word];
+
+    // Palavras ainda não decodificadas recebem a flag ao serem decodificadas
+    if (insn->op == PIC_OP_UNDECODED) {
+        return;
+    }
+
+    if (enabled) {
+        insn->flags |= PIC_INSN_BREAKPOINT;
+    } else {
+        insn->flags &= ~PIC_INSN_BREAKPOINT;
+    }
+}
+
+// O banco vem de RP1:RP0 (ou IRP no acesso indireto) como índice da
+// tabela, sem desvios; só INDF exige uma segunda consulta
+static inline uint32_t pic_file(const microcontroller_t* mcu, uint8_t status, uint8_t f) {
+    const uint16_t* map = mcu->pic->file_map;
+    uint32_t file = map[((status & PIC_STATUS_RP) << 2) | f];
+
+    if (file == PIC_INDF) {
+        file = map[((status & PIC_STATUS_IRP) << 1) | mcu->data_memory[PIC_FSR]];
+    }
+    return file;
+}
+
+// INDF acessado através do próprio FSR lê zero e ignora escritas
+static inline uint8_t pic_read(microcontroller_t* mcu, uint32_t file) {
+    return file == PIC_INDF ? 0 : mcu_data_read(mcu, file);
+}
+
+static inline void pic_write(microcontroller_t* mcu, uint32_t file, uint8_t value) {
+    if (file != PIC_INDF) {
+        mcu_data_write(mcu, file, value);
+    }
+}
+
+// Pilha circular: o nono CALL sobrescreve o primeiro endereço
+static inline void pic_push(microcontroller_t* mcu, uint32_t address) {
+    mcu->registers.pic.stack[mcu->registers.pic.stack_ptr] = (uint16_t)address;
+    mcu->registers.pic.stack_ptr = (mcu->registers.pic.stack_ptr + 1) & (PIC_STACK_DEPTH - 1);
+}
+
+static inline uint32_t pic_pop(microcontroller_t* mcu) {
+    mcu->registers.pic.stack_ptr = (mcu->registers.pic.stack_ptr - 1) & (PIC_STACK_DEPTH - 1);
+    return mcu->registers.pic.stack[mcu->registers.pic.stack_ptr];
+}
+
+static inline uint8_t pic_add(uint8_t a, uint8_t b, uint8_t* flags) {
+    unsigned sum = (unsigned)a + b;
+    *flags = (sum > 0xFF ? PIC_FLAG_C : 0) |
+             (((a & 0x0F) + (b & 0x0F)) > 0x0F ? PIC_FLAG_DC : 0) |
+             ((sum & 0xFF) == 0 ? PIC_FLAG_Z : 0);
+    return (uint8_t)sum;
+}
+
+// a - b; C e DC indicam ausência de empréstimo
+static inline uint8_t pic_sub(uint8_t a, uint8_t b, uint8_t* flags) {
+    uint8_t result = (uint8_t)(a - b);
+    *flags = (a >= b ? PIC_FLAG_C : 0) |
+             ((a & 0x0F) >= (b & 0x0F) ? PIC_FLAG_DC : 0) |
+             (result == 0 ? PIC_FLAG_Z : 0);
+    return result;
+}
+
+static inline uint8_t pic_zero(uint8_t value) {
+    return value == 0 ? PIC_FLAG_Z : 0;
+}
+
+int pic_core_step(microcontroller_t* mcu) {
+    uint8_t* data = mcu->data_memory;
+    uint32_t pc = mcu->program_counter >> 1;
+
+    if (pc >= mcu->memory_size / 2) {
+        mcu->state = MCU_STATE_HALTED;
+        return 0;
+    }
+
+    const pic_insn_t* insn = pic_fetch(mcu, pc);
+    int cycles = mcu->cycle_table[insn->op];
+    uint32_t next = (pc + 1) & PIC_PC_MASK;
+    uint8_t status = data[PIC_STATUS];
+    uint8_t w = mcu->registers.pic.w;
+    uint32_t file = pic_file(mcu, status, insn->f);
+    uint8_t carry = status & PIC_FLAG_C;
+    uint8_t result = 0;
+    uint8_t mask = 0;
+    uint8_t flags = 0;
+    uint8_t value;
+
+    // PCL lido por uma instrução já aponta para a próxima
+    data[PIC_PCL] = next & 0xFF;
+
+    switch ((pic_op_t)insn->op) {
+        case PIC_OP_NOP:
+            break;
+        case PIC_OP_MOVWF:
+            result = w;
+            break;
+        case PIC_OP_CLRF:
+        case PIC_OP_CLRW:
+            result = 0;
+            mask = PIC_FLAG_Z;
+            flags = PIC_FLAG_Z;
+            break;
+        case PIC_OP_ADDWF:
+            result = pic_add(pic_read(mcu, file), w, &flags);
+            mask = PIC_FLAG_C | PIC_FLAG_DC | PIC_FLAG_Z;
+            break;
+        case PIC_OP_SUBWF:
+            result = pic_sub(pic_read(mcu, file), w, &flags);
+            mask = PIC_FLAG_C | PIC_FLAG_DC | PIC_FLAG_Z;
+            break;
+        case PIC_OP_ANDWF:
+            result = pic_read(mcu, file) & w;
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_IORWF:
+            result = pic_read(mcu, file) | w;
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_XORWF:
+            result = pic_read(mcu, file) ^ w;
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_COMF:
+            result = (uint8_t)~pic_read(mcu, file);
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_MOVF:
+            result = pic_read(mcu, file);
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_INCF:
+        case PIC_OP_DECF:
+            result = pic_read(mcu, file) + (insn->op == PIC_OP_INCF ? 1 : -1);
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_INCFSZ:
+        case PIC_OP_DECFSZ:
+            result = pic_read(mcu, file) + (insn->op == PIC_OP_INCFSZ ? 1 : -1);
+            if (result == 0) {
+                next = (next + 1) & PIC_PC_MASK;
+                cycles += PIC_SKIP_CYCLES;
+            }
+            break;
+        case PIC_OP_RLF:
+            value = pic_read(mcu, file);
+            result = (uint8_t)(value << 1) | carry;
+            mask = PIC_FLAG_C;
+            flags = value >> 7;
+            break;
+        case PIC_OP_RRF:
+            value = pic_read(mcu, file);
+            result = (value >> 1) | (uint8_t)(carry << 7);
+            mask = PIC_FLAG_C;
+            flags = value & PIC_FLAG_C;
+            break;
+        case PIC_OP_SWAPF:
+            value = pic_read(mcu, file);
+            result = (uint8_t)(value << 4) | (value >> 4);
+            break;
+        case PIC_OP_BCF:
+            pic_write(mcu, file, pic_read(mcu, file) & ~(1u << insn->b));
+            break;
+        case PIC_OP_BSF:
+            pic_write(mcu, file, pic_read(mcu, file) | (1u << insn->b));
+            break;
+        case PIC_OP_BTFSC:
+        case PIC_OP_BTFSS: {
+            bool set = (pic_read(mcu, file) >> insn->b) & 1;
+            if (set == (insn->op == PIC_OP_BTFSS)) {
+                next = (next + 1) & PIC_PC_MASK;
+                cycles += PIC_SKIP_CYCLES;
+            }
+            break;
+        }
+        case PIC_OP_MOVLW:
+            result = (uint8_t)insn->k;
+            break;
+        case PIC_OP_ADDLW:
+            result = pic_add((uint8_t)insn->k, w, &flags);
+            mask = PIC_FLAG_C | PIC_FLAG_DC | PIC_FLAG_Z;
+            break;
+        case PIC_OP_SUBLW:
+            result = pic_sub((uint8_t)insn->k, w, &flags);
+            mask = PIC_FLAG_C | PIC_FLAG_DC | PIC_FLAG_Z;
+            break;
+        case PIC_OP_ANDLW:
+            result = w & insn->k;
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_IORLW:
+            result = w | insn->k;
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_XORLW:
+            result = w ^ insn->k;
+            mask = PIC_FLAG_Z;
+            flags = pic_zero(result);
+            break;
+        case PIC_OP_CALL:
+            pic_push(mcu, next);
+            next = ((data[PIC_PCLATH] & 0x18u) << 8) | insn->k;
+            break;
+        case PIC_OP_GOTO:
+            next = ((data[PIC_PCLATH] & 0x18u) << 8) | insn->k;
+            break;
+        case PIC_OP_RETURN:
+            next = pic_pop(mcu);
+            break;
+        case PIC_OP_RETFIE:
+            next = pic_pop(mcu);
+            data[PIC_INTCON] |= 0x80;  // GIE
+            break;
+        case PIC_OP_RETLW:
+            mcu->registers.pic.w = (uint8_t)insn->k;
+            next = pic_pop(mcu);
+            break;
+        case PIC_OP_CLRWDT:
+            mask = PIC_FLAG_TO | PIC_FLAG_PD;
+            flags = PIC_FLAG_TO | PIC_FLAG_PD;
+            break;
+        case PIC_OP_SLEEP:
+            // Sem interrupções nem watchdog nada acorda o núcleo
+            mask = PIC_FLAG_TO | PIC_FLAG_PD;
+            flags = PIC_FLAG_TO;
+            mcu->state = MCU_STATE_HALTED;
+            break;
+        case PIC_OP_UNDECODED:
+        case PIC_OP_ILLEGAL:
+        case PIC_OP_COUNT:
+            fprintf(stderr, "Instrução inválida 0x%04x em 0x%08x\n",
+                    pic_flash_word(mcu, pc), mcu->program_counter);
+            mcu->state = MCU_STATE_ERROR;
+            return -1;
+    }
+
+    if (insn->flags & PIC_INSN_RESULT) {
+        if (!(insn->flags & PIC_INSN_DEST_F)) {
+            mcu->registers.pic.w = result;
+        } else if (file == PIC_PCL) {
+            // Escrita no PCL desvia para PCLATH<4:0>:resultado
+            next = ((data[PIC_PCLATH] & 0x1Fu) << 8) | result;
+            cycles += PIC_SKIP_CYCLES;
+        } else {
+            pic_write(mcu, file, result);
+        }
+    }
+    // Flags depois do resultado: com STATUS como destino, elas prevalecem
+    data[PIC_STATUS] = (data[PIC_STATUS] & ~mask) | flags;
+
+    mcu->program_counter = next << 1;
+    mcu->cycle_count += cycles;
+
+    return cycles;
+}
+
+int pic_core_run(microcontroller_t* mcu, uint64_t stop) {
+    // Sem breakpoints o laço não faz nenhuma verificação extra
+    if (mcu->breakpoint_count == 0) {
+        while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < stop) {
+            if (pic_core_step(mcu) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    uint32_t words = mcu->memory_size / 2;
+
+    while (mcu->state == MCU_STATE_RUNNING && mcu->cycle_count < stop) {
+        uint32_t pc = mcu->program_counter >> 1;
+
+        if (pc < words && (pic_fetch(mcu, pc)->flags & PIC_INSN_BREAKPOINT)) {
+            if (!mcu->skip_breakpoint || mcu->program_counter != mcu->stop_address) {
+                mcu->state = MCU_STATE_HALTED;
+                mcu->stop_reason = MCU_STOP_BREAKPOINT;
+                mcu->stop_address = mcu->program_counter;
+                mcu->skip_breakpoint = true;
+                break;
+            }
+        }
+        mcu->skip_breakpoint = false;
+
+        if (pic_core_step(mcu) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int pic_read_reg(const microcontroller_t* mcu, int index, uint32_t* value) {
+    if (index == PIC_REG_W) {
+        *value = mcu->registers.pic.w;
+    } else if (index >= PIC_REG_STACK && index < PIC_REG_STACK + PIC_STACK_DEPTH) {
+        *value = mcu->registers.pic.stack[index - PIC_REG_STACK];
+    } else if (index == PIC_REG_STACK_PTR) {
+        *value = mcu->registers.pic.stack_ptr;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int pic_write_reg(microcontroller_t* mcu, int index, uint32_t value) {
+    if (index == PIC_REG_W) {
+        mcu->registers.pic.w = (uint8_t)value;
+    } else if (index >= PIC_REG_STACK && index < PIC_REG_STACK + PIC_STACK_DEPTH) {
+        mcu->registers.pic.stack[index - PIC_REG_STACK] = value & PIC_PC_MASK;
+    } else if (index == PIC_REG_STACK_PTR) {
+        mcu->registers.pic.stack_ptr = value & (PIC_STACK_DEPTH - 1);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static const char* const pic_mnemonics[PIC_OP_COUNT] = {
+    [PIC_OP_ADDWF] = "addwf", [PIC_OP_ANDWF] = "andwf", [PIC_OP_CLRF] = "clrf", [PIC_OP_CLRW] = "clrw",
+    [PIC_OP_COMF] = "comf", [PIC_OP_DECF] = "decf", [PIC_OP_DECFSZ] = "decfsz", [PIC_OP_INCF] = "incf",
+    [PIC_OP_INCFSZ] = "incfsz", [PIC_OP_IORWF] = "iorwf", [PIC_OP_MOVF] = "movf", [PIC_OP_MOVWF] = "movwf",
+    [PIC_OP_NOP] = "nop", [PIC_OP_RLF] = "rlf", [PIC_OP_RRF] = "rrf", [PIC_OP_SUBWF] = "subwf",
+    [PIC_OP_SWAPF] = "swapf", [PIC_OP_XORWF] = "xorwf", [PIC_OP_BCF] = "bcf", [PIC_OP_BSF] = "bsf",
+    [PIC_OP_BTFSC] = "btfsc", [PIC_OP_BTFSS] = "btfss", [PIC_OP_ADDLW] = "addlw", [PIC_OP_ANDLW] = "andlw",
+    [PIC_OP_CALL] = "call", [PIC_OP_CLRWDT] = "clrwdt", [PIC_OP_GOTO] = "goto", [PIC_OP_IORLW] = "iorlw",
+    [PIC_OP_MOVLW] = "movlw", [PIC_OP_RETFIE] = "retfie", [PIC_OP_RETLW] = "retlw", [PIC_OP_RETURN] = "return",
+    [PIC_OP_SLEEP] = "sleep", [PIC_OP_SUBLW] = "sublw", [PIC_OP_XORLW] = "xorlw",
+};
+
+static int pic_disassemble(const microcontroller_t* mcu, uint32_t address, char* buffer, size_t size) {
+    uint32_t word = address >> 1;
+
+    if (word >= mcu->memory_size / 2) {
+        return -1;
+    }
+
+    uint16_t opcode = pic_flash_word(mcu, word);
+    pic_insn_t insn = pic_decode(opcode);
+    const char* name = pic_mnemonics[insn.op];
+
+    switch ((pic_op_t)insn.op) {
+        case PIC_OP_CLRF:
+        case PIC_OP_MOVWF:
+            snprintf(buffer, size, "%s 0x%02x", name, insn.f);
+            break;
+        case PIC_OP_BCF: case PIC_OP_BSF: case PIC_OP_BTFSC: case PIC_OP_BTFSS:
+            snprintf(buffer, size, "%s 0x%02x, %u", name, insn.f, insn.b);
+            break;
+        case PIC_OP_CALL:
+        case PIC_OP_GOTO:
+            snprintf(buffer, size, "%s 0x%03x", name, insn.k);
+            break;
+        case PIC_OP_ADDLW: case PIC_OP_ANDLW: case PIC_OP_IORLW: case PIC_OP_MOVLW:
+        case PIC_OP_RETLW: case PIC_OP_SUBLW: case PIC_OP_XORLW:
+            snprintf(buffer, size, "%s 0x%02x", name, insn.k);
+            break;
+        case PIC_OP_UNDECODED:
+        case PIC_OP_ILLEGAL:
+        case PIC_OP_COUNT:
+            snprintf(buffer, size, "dw 0x%04x", opcode);
+            break;
+        default:
+            if (insn.flags & PIC_INSN_RESULT) {
+                snprintf(buffer, size, "%s 0x%02x, %c", name, insn.f,
+                         (insn.flags & PIC_INSN_DEST_F) ? 'f' : 'w');
+            } else {
+                snprintf(buffer, size, "%s", name);
+            }
+            break;
+    }
+
+    return 2;
+}
+
+const mcu_core_ops_t pic_core_ops = {
+    .name = "PIC16",
+    .register_count = PIC_REG_STACK_PTR + 1,
+    .init = pic_core_init,
+    .cleanup = pic_core_cleanup,
+    .reset = pic_core_reset,
+    .invalidate = pic_core_invalidate,
+    .mark_breakpoint = pic_core_mark_breakpoint,
+    .step = pic_core_step,
+    .run_block = pic_core_run,
+    .read_reg = pic_read_reg,
+    .write_reg = pic_write_reg,
+    .disassemble = pic_disassemble,
+};
@@ -1,13 +1,310 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "pin_manager.h"
+#include "config/mcu_log.h"
+#include "config/pin_manager.h"
+#include "config/pin_queue.h"
+
+/* ---------------------------------------------------------------------- */
+/* Índice de nomes                                                        */
+/* ---------------------------------------------------------------------- */
+
+// FNV-1a de 32 bits
+static uint32_t pin_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Posição no índice do pino com esse nome, ou -1
+static int pin_index_find(const pin_manager_t* manager, const char* name, uint32_t hash) {
+    for (uint32_t slot = hash & manager->name_mask;; slot = (slot + 1) & manager->name_mask) {
+        int index = manager->name_slots[slot];
+        if (index < 0) {
+            return -1;
+        }
+        const pin_t* pin = &manager->pins[index];
+        if (pin->name_hash == hash && strcmp(pin->name, name) == 0) {
+            return (int)slot;
+        }
+    }
+}
+
+static void pin_index_insert(pin_manager_t* manager, int pin_number) {
+    const pin_t* pin = &manager->pins[pin_number];
+    uint32_t slot = pin->name_hash & manager->name_mask;
+
+    // A tabela tem pelo menos o dobro de posições que pinos, então sempre
+    // há uma vaga
+    while (manager->name_slots[slot] >= 0) {
+        const pin_t* other = &manager->pins[manager->name_slots[slot]];
+        if (other->name_hash == pin->name_hash && strcmp(other->name, pin->name) == 0) {
+            if (pin_number < manager->name_slots[slot]) {
+                manager->name_slots[slot] = pin_number;
+            }
+            return;
+        }
+        slot = (slot + 1) & manager->name_mask;
+    }
+    manager->name_slots[slot] = pin_number;
+}
+
+static void pin_index_remove(pin_manager_t* manager, int pin_number) {
+    const pin_t* pin = &manager->pins[pin_number];
+    int found = pin_index_find(manager, pin->name, pin->name_hash);
+
+    // Um nome repetido em outro pino de número menor fica no índice
+    if (found < 0 || manager->name_slots[found] != pin_number) {
+        return;
+    }
+
+    // Remoção sem lápides: puxa para trás as entradas seguintes da mesma
+    // sequência que ficariam inalcançáveis
+    uint32_t hole = (uint32_t)found;
+    for (uint32_t next = (hole + 1) & manager->name_mask; manager->name_slots[next] >= 0;
+         next = (next + 1) & manager->name_mask) {
+        uint32_t home = manager->pins[manager->name_slots[next]].name_hash & manager->name_mask;
+        if (((next - home) & manager->name_mask) >= ((next - hole) & manager->name_mask)) {
+            manager->name_slots[hole] = manager->name_slots[next];
+            hole = next;
+        }
+    }
+    manager->name_slots[hole] = -1;
+
+    // Outro pino com o mesmo nome passa a responder por ele
+    for (int i = 0; i < manager->max_pins; i++) {
+        const pin_t* other = &manager->pins[i];
+        if (i != pin_number && other->name && other->name_hash == pin->name_hash &&
+            strcmp(other->name, pin->name) == 0) {
+            pin_index_insert(manager, i);
+            break;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Diário de mudanças                                                     */
+/* ---------------------------------------------------------------------- */
+
+static void pin_report_change(pin_manager_t* manager, int pin_number, pin_state_t old_state, pin_state_t new_state) {
+    MCU_LOG(MCU_LOG_INFO, manager->output, "[MONITOR] Pino %d mudou de %s para %s\n",
+            pin_number, pin_state_to_string(old_state), pin_state_to_string(new_state));
+
+    if (manager->changes_tail - manager->changes_head == PIN_CHANGE_JOURNAL_SIZE) {
+        manager->changes_dropped++;
+        return;
+    }
+
+    pin_change_t* change = &manager->changes[manager->changes_tail & (PIN_CHANGE_JOURNAL_SIZE - 1)];
+    change->cycle = manager->clock ? *manager->clock : 0;
+    change->pin_number = pin_number;
+    change->old_state = old_state;
+    change->new_state = new_state;
+    manager->changes_tail++;
+}
+
+// Saídas mudam pelo MCU e vão para o circuito; entradas vêm dele
+static void pin_publish_edge(pin_manager_t* manager, const pin_t* pin) {
+    if (!manager->edges || pin->direction == PIN_INPUT) {
+        return;
+    }
+
+    pin_event_t event = {
+        .cycle = manager->clock ? *manager->clock : 0,
+        .pin_number = pin->pin_number,
+        .state = pin->state,
+    };
+    pin_queue_push(manager->edges, &event);
+}
+
+/* ---------------------------------------------------------------------- */
+/* Índice de registradores                                                */
+/* ---------------------------------------------------------------------- */
+
+// Posição de address em registers, ou onde ele deveria ser inserido
+static int pin_register_search(const pin_manager_t* manager, uint32_t address, bool* found) {
+    int low = 0;
+    int high = manager->register_count;
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (manager->registers[middle].address < address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    *found = low < manager->register_count && manager->registers[low].address == address;
+    return low;
+}
+
+static pin_register_t* pin_register_find(const pin_manager_t* manager, uint32_t address) {
+    bool found;
+    int index = pin_register_search(manager, address, &found);
+    return found ? &manager->registers[index] : NULL;
+}
+
+static int pin_register_get(pin_manager_t* manager, uint32_t address) {
+    bool found;
+    int index = pin_register_search(manager, address, &found);
+
+    if (found) {
+        return index;
+    }
+
+    if (manager->register_count == manager->register_capacity) {
+        int capacity = manager->register_capacity ? manager->register_capacity * 2 : 4;
+        pin_register_t* registers = realloc(manager->registers, capacity * sizeof(pin_register_t));
+        if (!registers) {
+            fprintf(stderr, "Erro ao alocar índice de registradores dos pinos\n");
+            return -1;
+        }
+        manager->registers = registers;
+        manager->register_capacity = capacity;
+    }
+
+    memmove(&manager->registers[index + 1], &manager->registers[index],
+            (manager->register_count - index) * sizeof(pin_register_t));
+    manager->register_count++;
+
+    // Mapeamentos só acontecem na configuração; aqui pode percorrer tudo
+    for (int i = 0; i < manager->max_pins; i++) {
+        if (manager->pins[i].register_index >= index) {
+            manager->pins[i].register_index++;
+        }
+    }
+
+    pin_register_t* reg = &manager->registers[index];
+    memset(reg, 0, sizeof(*reg));
+    reg->address = address;
+    for (int bit = 0; bit < 32; bit++) {
+        reg->pins[bit] = -1;
+    }
+    return index;
+}
+
+static pin_register_t* pin_register_of(const pin_manager_t* manager, const pin_t* pin) {
+    return pin->register_index >= 0 ? &manager->registers[pin->register_index] : NULL;
+}
 
-int pin_manager_init(pin_manager_t* manager, int max_pins) {
+// Refaz os bancos do bit do pino a partir de todos os pinos do bit: saída e
+// monitorado se algum for; o nível é o do primeiro pino de saída da lista,
+// ou do primeiro pino se nenhum for saída. A lista está em ordem de número,
+// então o resultado não depende de quem mudou por último.
+static void pin_register_store(pin_manager_t* manager, const pin_t* pin) {
+    pin_register_t* reg = pin_register_of(manager, pin);
+    if (!reg) {
+        return;
+    }
+
+    const pin_t* owner = NULL;
+    bool output = false;
+    bool monitored = false;
+    for (int i = reg->pins[pin->bit_position]; i >= 0; i = manager->pins[i].register_next) {
+        const pin_t* other = &manager->pins[i];
+        if (other->direction != PIN_INPUT && !output) {
+            owner = other;
+            output = true;
+        } else if (!owner) {
+            owner = other;
+        }
+        monitored |= other->is_monitored;
+    }
+
+    uint32_t bit = 1u << pin->bit_position;
+    reg->high = owner->state == PIN_HIGH ? reg->high | bit : reg->high & ~bit;
+    reg->output = output ? reg->output | bit : reg->output & ~bit;
+    reg->monitored = monitored ? reg->monitored | bit : reg->monitored & ~bit;
+}
+
+// Tira o pino da lista do seu bit, se ele estiver mapeado
+static void pin_register_unlink(pin_manager_t* manager, int pin_number) {
+    pin_t* pin = &manager->pins[pin_number];
+    pin_register_t* reg = pin_register_of(manager, pin);
+
+    if (!reg) {
+        return;
+    }
+
+    for (int* link = &reg->pins[pin->bit_position]; *link >= 0; link = &manager->pins[*link].register_next) {
+        if (*link == pin_number) {
+            *link = pin->register_next;
+            break;
+        }
+    }
+    pin->register_next = -1;
+    pin->register_index = -1;
+    reg->pin_count--;
+
+    uint32_t bit = 1u << pin->bit_position;
+    if (reg->pins[pin->bit_position] < 0) {
+        reg->mask &= ~bit;
+        reg->high &= ~bit;
+        reg->output &= ~bit;
+        reg->monitored &= ~bit;
+    } else {
+        pin_register_store(manager, &manager->pins[reg->pins[pin->bit_position]]);
+    }
+}
+
+// Leva value para os pinos de saída dos bits em mask. A mudança sai de um
+// XOR com o banco; com force, todo pino de saída é conferido, mesmo que o
+// banco diga que o bit não mudou
+static int pin_register_apply(pin_manager_t* manager, pin_register_t* reg, uint32_t mask, uint32_t value, bool force) {
+    uint32_t driven = mask & reg->mask & reg->output;
+    uint32_t changed = (reg->high ^ value) & driven;
+    int updated_count = 0;
+
+    reg->high ^= changed;
+
+    // pin_t continua sendo a visão completa; só os bits alterados são copiados
+    for (uint32_t visit = force ? driven : changed; visit; visit &= visit - 1) {
+        int bit = __builtin_ctz(visit);
+        pin_state_t new_state = (value >> bit) & 1 ? PIN_HIGH : PIN_LOW;
+
+        for (int i = reg->pins[bit]; i >= 0; i = manager->pins[i].register_next) {
+            pin_t* pin = &manager->pins[i];
+
+            // Pinos de entrada são dirigidos externamente, não pelo registrador
+            if (pin->direction == PIN_INPUT || pin->state == new_state) {
+                continue;
+            }
+
+            if (pin->is_monitored) {
+                pin_report_change(manager, i, pin->state, new_state);
+            }
+            pin->state = new_state;
+            pin_publish_edge(manager, pin);
+            updated_count++;
+        }
+    }
+
+    if (updated_count > 0) {
+        MCU_LOG(MCU_LOG_DEBUG, manager->output, "Atualizados %d pinos do registrador 0x%08x\n",
+                updated_count, reg->address);
+    }
+
+    return updated_count;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Gerenciador                                                            */
+/* ---------------------------------------------------------------------- */
+
+int pin_manager_init(pin_manager_t* manager, int max_pins, FILE* output) {
     if (!manager || max_pins <= 0) {
         return -1;
     }
 
+    manager->output = output ? output : stdout;
+
     // Aloca memória para os pinos
     manager->pins = calloc(max_pins, sizeof(pin_t));
     if (!manager->pins) {
@@ -15,6 +312,41 @@ int pin_manager_init(pin_manager_t* manager, int max_pins) {
         return -1;
     }
 
+    uint32_t capacity = 8;
+    while (capacity < (uint32_t)max_pins * 2) {
+        capacity <<= 1;
+    }
+    manager->name_slots = malloc(capacity * sizeof(int));
+    if (!manager->name_slots) {
+        fprintf(stderr, "Erro ao alocar índice de nomes dos pinos\n");
+        free(manager->pins);
+        manager->pins = NULL;
+        return -1;
+    }
+    memset(manager->name_slots, 0xff, capacity * sizeof(int));
+    manager->name_mask = capacity - 1;
+
+    manager->registers = NULL;
+    manager->register_count = 0;
+    manager->register_capacity = 0;
+
+    manager->changes = malloc(PIN_CHANGE_JOURNAL_SIZE * sizeof(pin_change_t));
+    if (!manager->changes) {
+        fprintf(stderr, "Erro ao alocar diário de mudanças dos pinos\n");
+        free(manager->name_slots);
+        free(manager->pins);
+        manager->pins = NULL;
+        return -1;
+    }
+    manager->changes_head = 0;
+    manager->changes_tail = 0;
+    manager->changes_dropped = 0;
+    manager->clock = NULL;
+    manager->edges = NULL;
+    manager->crossings = NULL;
+    manager->input_hook = NULL;
+    manager->input_context = NULL;
+
     manager->max_pins = max_pins;
     manager->pin_count = 0;
     manager->initialized = true;
@@ -26,11 +358,14 @@ int pin_manager_init(pin_manager_t* manager, int max_pins) {
         manager->pins[i].direction = PIN_INPUT;
         manager->pins[i].is_monitored = false;
         manager->pins[i].name = NULL;
+        manager->pins[i].name_hash = 0;
         manager->pins[i].register_address = 0;
         manager->pins[i].bit_position = 0;
+        manager->pins[i].register_next = -1;
+        manager->pins[i].register_index = -1;
     }
 
-    printf("Gerenciador de pinos inicializado com %d pinos\n", max_pins);
+    fprintf(manager->output, "Gerenciador de pinos inicializado com %d pinos\n", max_pins);
     return 0;
 }
 
@@ -52,11 +387,23 @@ int pin_manager_cleanup(pin_manager_t* manager) {
         manager->pins = NULL;
     }
 
+    free(manager->name_slots);
+    manager->name_slots = NULL;
+    manager->name_mask = 0;
+
+    free(manager->registers);
+    manager->registers = NULL;
+    manager->register_count = 0;
+    manager->register_capacity = 0;
+
+    free(manager->changes);
+    manager->changes = NULL;
+
     manager->max_pins = 0;
     manager->pin_count = 0;
     manager->initialized = false;
 
-    printf("Gerenciador de pinos finalizado\n");
+    fprintf(manager->output, "Gerenciador de pinos finalizado\n");
     return 0;
 }
 
@@ -67,11 +414,13 @@ int pin_configure(pin_manager_t* manager, int pin_number, pin_direction_t direct
 
     pin_t* pin = &manager->pins[pin_number];
 
-    // Define a direção do pino
+    // Define a direção do pino, mantendo o banco do registrador em dia
     pin->direction = direction;
+    pin_register_store(manager, pin);
 
-    // Define o nome do pino
+    // Define o nome do pino, mantendo o índice de nomes em dia
     if (pin->name) {
+        pin_index_remove(manager, pin_number);
         free(pin->name);
     }
 
@@ -81,8 +430,11 @@ int pin_configure(pin_manager_t* manager, int pin_number, pin_direction_t direct
             fprintf(stderr, "Erro ao alocar memória para nome do pino\n");
             return -1;
         }
+        pin->name_hash = pin_name_hash(name);
+        pin_index_insert(manager, pin_number);
     } else {
         pin->name = NULL;
+        pin->name_hash = 0;
     }
 
     // Se for o primeiro pino configurado, incrementa o contador
@@ -90,7 +442,7 @@ int pin_configure(pin_manager_t* manager, int pin_number, pin_direction_t direct
         manager->pin_count = pin_number + 1;
     }
 
-    printf("Pino %d configurado: %s (%s)\n",
+    fprintf(manager->output, "Pino %d configurado: %s (%s)\n",
            pin_number,
            name ? name : "sem nome",
            pin_direction_to_string(direction));
@@ -99,15 +451,36 @@ int pin_configure(pin_manager_t* manager, int pin_number, pin_direction_t direct
 }
 
 int pin_set_register_mapping(pin_manager_t* manager, int pin_number, uint32_t register_address, int bit_position) {
-    if (!manager || !manager->initialized || pin_number < 0 || pin_number >= manager->max_pins) {
+    if (!manager || !manager->initialized || pin_number < 0 || pin_number >= manager->max_pins ||
+        bit_position < 0 || bit_position >= 32) {
         return -1;
     }
 
+    pin_register_unlink(manager, pin_number);
+
+    int index = pin_register_get(manager, register_address);
+    if (index < 0) {
+        return -1;
+    }
+
+    pin_register_t* reg = &manager->registers[index];
     pin_t* pin = &manager->pins[pin_number];
     pin->register_address = register_address;
     pin->bit_position = bit_position;
+    pin->register_index = index;
 
-    printf("Pino %d mapeado para registrador 0x%08x, bit %d\n",
+    // Lista do bit em ordem de número: o primeiro define o nível do banco
+    int* link = &reg->pins[bit_position];
+    while (*link >= 0 && *link < pin_number) {
+        link = &manager->pins[*link].register_next;
+    }
+    pin->register_next = *link;
+    *link = pin_number;
+    reg->mask |= 1u << bit_position;
+    reg->pin_count++;
+    pin_register_store(manager, pin);
+
+    fprintf(manager->output, "Pino %d mapeado para registrador 0x%08x, bit %d\n",
            pin_number, register_address, bit_position);
 
     return 0;
@@ -121,18 +494,56 @@ int pin_set_state(pin_manager_t* manager, int pin_number, pin_state_t state) {
     pin_t* pin = &manager->pins[pin_number];
     pin_state_t old_state = pin->state;
     pin->state = state;
+    pin_register_store(manager, pin);
 
     // Se o pino está sendo monitorado, reporta a mudança
-    if (pin->is_monitored && old_state != state) {
-        printf("[MONITOR] Pino %d mudou de %s para %s\n",
-               pin_number,
-               pin_state_to_string(old_state),
-               pin_state_to_string(state));
+    if (old_state != state) {
+        if (pin->is_monitored) {
+            pin_report_change(manager, pin_number, old_state, state);
+        }
+        pin_publish_edge(manager, pin);
     }
 
     return 0;
 }
 
+int pin_set_direction(pin_manager_t* manager, int pin_number, pin_direction_t direction) {
+    if (!manager || !manager->initialized || pin_number < 0 || pin_number >= manager->max_pins) {
+        return -1;
+    }
+
+    pin_t* pin = &manager->pins[pin_number];
+    pin->direction = direction;
+    pin_register_store(manager, pin);
+
+    return 0;
+}
+
+int pin_set_register_directions(pin_manager_t* manager, uint32_t register_address, uint32_t output_mask) {
+    if (!manager || !manager->initialized) {
+        return -1;
+    }
+
+    pin_register_t* reg = pin_register_find(manager, register_address);
+    if (!reg) {
+        return 0;
+    }
+
+    uint32_t changed = (reg->output ^ output_mask) & reg->mask;
+
+    for (uint32_t visit = changed; visit; visit &= visit - 1) {
+        int bit = __builtin_ctz(visit);
+        pin_direction_t direction = (output_mask >> bit) & 1 ? PIN_OUTPUT : PIN_INPUT;
+
+        for (int i = reg->pins[bit]; i >= 0; i = manager->pins[i].register_next) {
+            manager->pins[i].direction = direction;
+        }
+        pin_register_store(manager, &manager->pins[reg->pins[bit]]);
+    }
+
+    return __builtin_popcount(changed);
+}
+
 pin_state_t pin_get_state(pin_manager_t* manager, int pin_number) {
     if (!manager || !manager->initialized || pin_number < 0 || pin_number >= manager->max_pins) {
         return PIN_FLOATING;
@@ -159,8 +570,9 @@ int pin_start_monitoring(pin_manager_t* manager, int pin_number) {
 
     pin_t* pin = &manager->pins[pin_number];
     pin->is_monitored = true;
+    pin_register_store(manager, pin);
 
-    printf("Monitoramento iniciado para pino %d\n", pin_number);
+    fprintf(manager->output, "Monitoramento iniciado para pino %d\n", pin_number);
     return 0;
 }
 
@@ -171,41 +583,90 @@ int pin_stop_monitoring(pin_manager_t* manager, int pin_number) {
 
     pin_t* pin = &manager->pins[pin_number];
     pin->is_monitored = false;
+    pin_register_store(manager, pin);
 
-    printf("Monitoramento parado para pino %d\n", pin_number);
+    fprintf(manager->output, "Monitoramento parado para pino %d\n", pin_number);
     return 0;
 }
 
-int pin_get_monitored_changes(pin_manager_t* manager, pin_t** changed_pins, int* change_count) {
-    if (!manager || !manager->initialized || !changed_pins || !change_count) {
+int pin_get_monitored_changes(pin_manager_t* manager, pin_change_t* changes, int max_changes) {
+    if (!manager || !manager->initialized || !changes || max_changes < 0) {
         return -1;
     }
 
-    // Por simplicidade, retorna todos os pinos monitorados
-    // Em uma implementação real, seria necessário rastrear mudanças
-    *change_count = 0;
+    int count = 0;
+    while (count < max_changes && manager->changes_head != manager->changes_tail) {
+        changes[count++] = manager->changes[manager->changes_head & (PIN_CHANGE_JOURNAL_SIZE - 1)];
+        manager->changes_head++;
+    }
 
-    for (int i = 0; i < manager->pin_count; i++) {
-        if (manager->pins[i].is_monitored) {
-            (*change_count)++;
-        }
+    return count;
+}
+
+uint64_t pin_take_dropped_changes(pin_manager_t* manager) {
+    if (!manager) {
+        return 0;
     }
 
-    if (*change_count > 0) {
-        *changed_pins = malloc(*change_count * sizeof(pin_t));
-        if (!*changed_pins) {
-            return -1;
-        }
+    uint64_t dropped = manager->changes_dropped;
+    manager->changes_dropped = 0;
+    return dropped;
+}
 
-        int idx = 0;
-        for (int i = 0; i < manager->pin_count && idx < *change_count; i++) {
-            if (manager->pins[i].is_monitored) {
-                (*changed_pins)[idx++] = manager->pins[i];
+void pin_manager_set_clock(pin_manager_t* manager, const uint64_t* clock) {
+    if (manager) {
+        manager->clock = clock;
+    }
+}
+
+void pin_manager_set_input_hook(pin_manager_t* manager, pin_input_hook_t hook, void* context) {
+    if (manager) {
+        manager->input_hook = hook;
+        manager->input_context = context;
+    }
+}
+
+void pin_manager_set_queues(pin_manager_t* manager, struct pin_queue* edges, struct pin_queue* crossings) {
+    if (manager) {
+        manager->edges = edges;
+        manager->crossings = crossings;
+    }
+}
+
+int pin_manager_sync_queues(pin_manager_t* manager) {
+    if (!manager || !manager->initialized) {
+        return -1;
+    }
+
+    if (manager->edges) {
+        pin_queue_publish(manager->edges);
+    }
+
+    if (!manager->crossings) {
+        return 0;
+    }
+
+    uint64_t now = manager->clock ? *manager->clock : UINT64_MAX;
+    const pin_event_t* event;
+    int applied = 0;
+
+    // Cruzamentos chegam em ordem de tempo; os futuros ficam na fila
+    while ((event = pin_queue_peek(manager->crossings)) && event->cycle <= now) {
+        pin_event_t crossing;
+        pin_queue_pop(manager->crossings, &crossing, 1);
+
+        if (crossing.pin_number >= 0 && crossing.pin_number < manager->max_pins &&
+            manager->pins[crossing.pin_number].direction == PIN_INPUT) {
+            if (manager->input_hook) {
+                manager->input_hook(manager->input_context, crossing.pin_number, crossing.state);
+            } else {
+                pin_set_state(manager, crossing.pin_number, crossing.state);
             }
+            applied++;
         }
     }
 
-    return 0;
+    return applied;
 }
 
 int pin_get_by_number(pin_manager_t* manager, int pin_number, pin_t** pin) {
@@ -222,14 +683,13 @@ int pin_get_by_name(pin_manager_t* manager, const char* name, pin_t** pin) {
         return -1;
     }
 
-    for (int i = 0; i < manager->pin_count; i++) {
-        if (manager->pins[i].name && strcmp(manager->pins[i].name, name) == 0) {
-            *pin = &manager->pins[i];
-            return 0;
-        }
+    int slot = pin_index_find(manager, name, pin_name_hash(name));
+    if (slot < 0) {
+        return -1; // Pino não encontrado
     }
 
-    return -1; // Pino não encontrado
+    *pin = &manager->pins[manager->name_slots[slot]];
+    return 0;
 }
 
 int pin_list_all(pin_manager_t* manager) {
@@ -237,13 +697,13 @@ int pin_list_all(pin_manager_t* manager) {
         return -1;
     }
 
-    printf("Lista de pinos (%d configurados):\n", manager->pin_count);
-    printf("Num | Nome      | Direção   | Estado    | Registrador | Bit\n");
-    printf("----|-----------|-----------|-----------|-------------|-----\n");
+    fprintf(manager->output, "Lista de pinos (%d configurados):\n", manager->pin_count);
+    fprintf(manager->output, "Num | Nome      | Direção   | Estado    | Registrador | Bit\n");
+    fprintf(manager->output, "----|-----------|-----------|-----------|-------------|-----\n");
 
     for (int i = 0; i < manager->pin_count; i++) {
         pin_t* pin = &manager->pins[i];
-        printf("%3d | %-9s | %-9s | %-9s | 0x%08x | %d\n",
+        fprintf(manager->output, "%3d | %-9s | %-9s | %-9s | 0x%08x | %d\n",
                pin->pin_number,
                pin->name ? pin->name : "N/A",
                pin_direction_to_string(pin->direction),
@@ -260,28 +720,18 @@ int pin_update_from_register(pin_manager_t* manager, uint32_t register_address,
         return -1;
     }
 
-    int updated_count = 0;
-
-    for (int i = 0; i < manager->pin_count; i++) {
-        pin_t* pin = &manager->pins[i];
-
-        if (pin->register_address == register_address) {
-            // Extrai o bit do registrador
-            uint32_t bit_value = (register_value >> pin->bit_position) & 1;
-            pin_state_t new_state = bit_value ? PIN_HIGH : PIN_LOW;
-
-            if (pin->state != new_state) {
-                pin_set_state(manager, i, new_state);
-                updated_count++;
-            }
-        }
-    }
+    pin_register_t* reg = pin_register_find(manager, register_address);
+    return reg ? pin_register_apply(manager, reg, UINT32_MAX, register_value, true) : 0;
+}
 
-    if (updated_count > 0) {
-        printf("Atualizados %d pinos do registrador 0x%08x\n", updated_count, register_address);
+int pin_update_register_change(pin_manager_t* manager, uint32_t register_address,
+                               uint32_t old_value, uint32_t new_value) {
+    if (!manager || !manager->initialized) {
+        return -1;
     }
 
-    return updated_count;
+    pin_register_t* reg = pin_register_find(manager, register_address);
+    return reg ? pin_register_apply(manager, reg, old_value ^ new_value, new_value, false) : 0;
 }
 
 int pin_update_to_register(pin_manager_t* manager, uint32_t register_address, uint32_t* register_value) {
@@ -289,23 +739,30 @@ int pin_update_to_register(pin_manager_t* manager, uint32_t register_address, ui
         return -1;
     }
 
-    int updated_count = 0;
+    const pin_register_t* reg = pin_register_find(manager, register_address);
+    if (!reg) {
+        return 0;
+    }
 
-    for (int i = 0; i < manager->pin_count; i++) {
-        pin_t* pin = &manager->pins[i];
+    // Atualiza os bits mapeados do registrador de uma vez
+    *register_value = (*register_value & ~reg->mask) | (reg->high & reg->mask);
+    return reg->pin_count;
+}
 
-        if (pin->register_address == register_address) {
-            // Atualiza o bit no registrador
-            if (pin->state == PIN_HIGH) {
-                *register_value |= (1 << pin->bit_position);
-            } else {
-                *register_value &= ~(1 << pin->bit_position);
-            }
-            updated_count++;
-        }
+void pin_manager_resync(pin_manager_t* manager) {
+    if (!manager || !manager->initialized) {
+        return;
     }
 
-    return updated_count;
+    for (int r = 0; r < manager->register_count; r++) {
+        pin_register_t* reg = &manager->registers[r];
+        reg->high = reg->output = reg->monitored = 0;
+    }
+
+    // Cada pino refaz o seu bit inteiro, então a ordem não importa
+    for (int i = 0; i < manager->max_pins; i++) {
+        pin_register_store(manager, &manager->pins[i]);
+    }
 }
 
 const char* pin_state_to_string(pin_state_t state) {
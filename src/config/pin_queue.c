@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/pin_queue.h"
+
+int pin_queue_init(pin_queue_t* queue, size_t capacity, size_t batch) {
+    if (!queue || capacity == 0) {
+        return -1;
+    }
+
+    size_t size = 16;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    // Linha de cache própria também para o vetor de eventos
+    queue->events = aligned_alloc(PIN_QUEUE_CACHE_LINE, size * sizeof(pin_event_t));
+    if (!queue->events) {
+        fprintf(stderr, "Erro ao alocar fila de eventos de pinos\n");
+        return -1;
+    }
+
+    queue->mask = size - 1;
+    queue->batch = batch ? batch : PIN_QUEUE_DEFAULT_BATCH;
+    if (queue->batch > size) {
+        queue->batch = size;
+    }
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+
+    return 0;
+}
+
+void pin_queue_cleanup(pin_queue_t* queue) {
+    if (!queue) {
+        return;
+    }
+
+    free(queue->events);
+    queue->events = NULL;
+}
+
+bool pin_queue_push(pin_queue_t* queue, const pin_event_t* event) {
+    if (queue->write - queue->tail_cache > queue->mask) {
+        queue->tail_cache = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (queue->write - queue->tail_cache > queue->mask) {
+            // O consumidor pode estar esperando pelo que já foi escrito
+            pin_queue_publish(queue);
+            queue->dropped++;
+            return false;
+        }
+    }
+
+    queue->events[queue->write & queue->mask] = *event;
+    queue->write++;
+
+    if (queue->write - atomic_load_explicit(&queue->head, memory_order_relaxed) >= queue->batch) {
+        pin_queue_publish(queue);
+    }
+    return true;
+}
+
+void pin_queue_publish(pin_queue_t* queue) {
+    atomic_store_explicit(&queue->head, queue->write, memory_order_release);
+}
+
+const pin_event_t* pin_queue_peek(pin_queue_t* queue) {
+    if (queue->read == queue->head_cache) {
+        queue->head_cache = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (queue->read == queue->head_cache) {
+            return NULL;
+        }
+    }
+
+    return &queue->events[queue->read & queue->mask];
+}
+
+size_t pin_queue_pop(pin_queue_t* queue, pin_event_t* events, size_t max) {
+    size_t count = 0;
+
+    while (count < max) {
+        if (queue->read == queue->head_cache) {
+            queue->head_cache = atomic_load_explicit(&queue->head, memory_order_acquire);
+            if (queue->read == queue->head_cache) {
+                break;
+            }
+        }
+        events[count++] = queue->events[queue->read & queue->mask];
+        queue->read++;
+    }
+
+    if (count > 0) {
+        atomic_store_explicit(&queue->tail, queue->read, memory_order_release);
+    }
+    return count;
+}
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config/scheduler.h"
+
+static inline int sched_before(const sched_event_t* a, const sched_event_t* b) {
+    if (a->cycle != b->cycle) {
+        return a->cycle < b->cycle;
+    }
+    return a->sequence < b->sequence;
+}
+
+static void sched_sift_up(scheduler_t* scheduler, int index) {
+    sched_event_t event = scheduler->events[index];
+
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!sched_before(&event, &scheduler->events[parent])) {
+            break;
+        }
+        scheduler->events[index] = scheduler->events[parent];
+        index = parent;
+    }
+
+    scheduler->events[index] = event;
+}
+
+static void sched_sift_down(scheduler_t* scheduler, int index) {
+    sched_event_t event = scheduler->events[index];
+
+    for (;;) {
+        int child = index * 2 + 1;
+        if (child >= scheduler->count) {
+            break;
+        }
+        if (child + 1 < scheduler->count &&
+            sched_before(&scheduler->events[child + 1], &scheduler->events[child])) {
+            child++;
+        }
+        if (!sched_before(&scheduler->events[child], &event)) {
+            break;
+        }
+        scheduler->events[index] = scheduler->events[child];
+        index = child;
+    }
+
+    scheduler->events[index] = event;
+}
+
+static void sched_remove_at(scheduler_t* scheduler, int index) {
+    scheduler->count--;
+    if (index == scheduler->count) {
+        return;
+    }
+
+    scheduler->events[index] = scheduler->events[scheduler->count];
+    sched_sift_down(scheduler, index);
+    sched_sift_up(scheduler, index);
+}
+
+int scheduler_init(scheduler_t* scheduler, int initial_capacity) {
+    if (!scheduler) {
+        return -1;
+    }
+
+    scheduler->capacity = initial_capacity > 0 ? initial_capacity : 1;
+    scheduler->events = malloc(scheduler->capacity * sizeof(sched_event_t));
+    if (!scheduler->events) {
+        fprintf(stderr, "Erro ao alocar fila de eventos\n");
+        return -1;
+    }
+
+    scheduler->count = 0;
+    scheduler->next_sequence = 0;
+    scheduler->next_id = 0;
+
+    return 0;
+}
+
+void scheduler_cleanup(scheduler_t* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    free(scheduler->events);
+    scheduler->events = NULL;
+    scheduler->count = scheduler->capacity = 0;
+}
+
+void scheduler_clear(scheduler_t* scheduler) {
+    if (scheduler) {
+        scheduler->count = 0;
+    }
+}
+
+// Copia a fila inteira (usado por snapshots); a ordem do heap é preservada
+int scheduler_copy(scheduler_t* dest, const scheduler_t* src) {
+    if (!dest || !src) {
+        return -1;
+    }
+
+    if (dest->capacity < src->count) {
+        sched_event_t* tmp = realloc(dest->events, src->count * sizeof(*tmp));
+        if (!tmp) {
+            fprintf(stderr, "Erro ao aumentar fila de eventos\n");
+            return -1;
+        }
+        dest->events = tmp;
+        dest->capacity = src->count;
+    }
+
+    if (src->count > 0) {
+        memcpy(dest->events, src->events, src->count * sizeof(sched_event_t));
+    }
+    dest->count = src->count;
+    dest->next_sequence = src->next_sequence;
+    dest->next_id = src->next_id;
+
+    return 0;
+}
+
+int scheduler_add(scheduler_t* scheduler, uint64_t cycle, sched_event_kind_t kind,
+                  sched_callback_t callback, void* context) {
+    if (!scheduler || !callback || kind < 0 || kind >= SCHED_EVENT_COUNT) {
+        return -1;
+    }
+
+    if (scheduler->count == scheduler->capacity) {
+        int newcap = scheduler->capacity * 2;
+        sched_event_t* tmp = realloc(scheduler->events, newcap * sizeof(*tmp));
+        if (!tmp) {
+            fprintf(stderr, "Erro ao aumentar fila de eventos\n");
+            return -1;
+        }
+        scheduler->events = tmp;
+        scheduler->capacity = newcap;
+    }
+
+    sched_event_t* event = &scheduler->events[scheduler->count];
+    event->cycle = cycle;
+    event->sequence = scheduler->next_sequence++;
+    event->id = scheduler->next_id++;
+    event->kind = kind;
+    event->callback = callback;
+    event->context = context;
+
+    int id = event->id;
+    sched_sift_up(scheduler, scheduler->count++);
+
+    return id;
+}
+
+int scheduler_cancel(scheduler_t* scheduler, int id) {
+    if (!scheduler) {
+        return -1;
+    }
+
+    // Cancelamentos são raros (reprogramação de periférico): busca linear
+    for (int i = 0; i < scheduler->count; i++) {
+        if (scheduler->events[i].id == id) {
+            sched_remove_at(scheduler, i);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int scheduler_pop_due(scheduler_t* scheduler, uint64_t now, sched_event_t* event) {
+    if (!scheduler || scheduler->count == 0 || scheduler->events[0].cycle > now) {
+        return 0;
+    }
+
+    if (event) {
+        *event = scheduler->events[0];
+    }
+    sched_remove_at(scheduler, 0);
+
+    return 1;
+}
+
+const char* sched_event_kind_to_string(sched_event_kind_t kind) {
+    switch (kind) {
+        case SCHED_EVENT_TIMER: return "TIMER";
+        case SCHED_EVENT_UART: return "UART";
+        case SCHED_EVENT_ADC: return "ADC";
+        case SCHED_EVENT_CIRCUIT_SYNC: return "CIRCUIT_SYNC";
+        case SCHED_EVENT_PROFILER: return "PROFILER";
+        default: return "UNKNOWN";
+    }
+}
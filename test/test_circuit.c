@@ -0,0 +1,674 @@
+#include "circuit/circuit.h"
+#include "circuit/cosim.h"
+#include "circuit/digital.h"
+#include "circuit/multirate.h"
+#include "config/microcontroller.h"
+#include <math.h>
+#include <stdio.h>
+
+static int is_close(double x, double y, double tolerance) {
+  return fabs(x - y) <= tolerance;
+}
+
+int test_should_solve_voltage_divider() {
+  circuit_t circuit;
+  circuit_init(&circuit);
+
+  int vcc = circuit_node(&circuit, "VCC");
+  int mid = circuit_node(&circuit, "MID");
+  int v1 = circuit_add_voltage_source(&circuit, "V1", vcc, CIRCUIT_GROUND, 9.0, 0.0);
+  circuit_add_resistor(&circuit, "R1", vcc, mid, 1000.0);
+  int r2 = circuit_add_resistor(&circuit, "R2", mid, CIRCUIT_GROUND, 2000.0);
+
+  if (circuit_solve(&circuit) < 0 ||
+      !is_close(circuit_voltage(&circuit, mid), 6.0, 1e-3) ||
+      !is_close(circuit_current(&circuit, r2), 3e-3, 1e-6)) {
+    fprintf(stderr, "%s FAILED: mid[%f]\n", __func__,
+            circuit_voltage(&circuit, mid));
+    circuit_free(&circuit);
+    return 0;
+  }
+
+  // Mudar a fonte não refatora a matriz
+  unsigned long factors = circuit.factor_count;
+  circuit_set_source(&circuit, v1, 3.0);
+  if (circuit_solve(&circuit) < 0 || circuit.factor_count != factors ||
+      !is_close(circuit_voltage(&circuit, mid), 2.0, 1e-3)) {
+    fprintf(stderr, "%s FAILED: mid[%f], factors[%lu]\n", __func__,
+            circuit_voltage(&circuit, mid), circuit.factor_count);
+    circuit_free(&circuit);
+    return 0;
+  }
+
+  circuit_free(&circuit);
+  return 1;
+}
+
+int test_should_light_led_through_resistor() {
+  circuit_t circuit;
+  circuit_init(&circuit);
+
+  int vcc = circuit_node(&circuit, "VCC");
+  int anode = circuit_node(&circuit, "A");
+  int v1 = circuit_add_voltage_source(&circuit, "V1", vcc, CIRCUIT_GROUND, 5.0, 0.0);
+  circuit_add_resistor(&circuit, "R1", vcc, anode, 220.0);
+  int led = circuit_add_diode(&circuit, "LED1", anode, CIRCUIT_GROUND, 2.0, 10.0);
+
+  if (circuit_solve(&circuit) < 0 ||
+      !is_close(circuit_current(&circuit, led), 3.0 / 230.0, 1e-5)) {
+    fprintf(stderr, "%s FAILED: led[%f]\n", __func__,
+            circuit_current(&circuit, led));
+    circuit_free(&circuit);
+    return 0;
+  }
+
+  // Abaixo de Vf o LED corta
+  circuit_set_source(&circuit, v1, 1.5);
+  if (circuit_solve(&circuit) < 0 ||
+      circuit_current(&circuit, led) > 1e-6 ||
+      circuit.elements[led].conducting) {
+    fprintf(stderr, "%s FAILED: led[%f] off\n", __func__,
+            circuit_current(&circuit, led));
+    circuit_free(&circuit);
+    return 0;
+  }
+
+  circuit_free(&circuit);
+  return 1;
+}
+
+int test_should_drive_led_from_mcu_pin() {
+  // sbi DDRB, 5; sbi PORTB, 5; ldi r16, 200; loop: dec r16; brne loop;
+  // cbi PORTB, 5; break
+  const uint16_t program[] = {0x9A25, 0x9A2D, 0xEC08, 0x950A,
+                              0xF7F1, 0x982D, 0x9598};
+  microcontroller_t mcu = {0};
+  mcu_config_t config;
+  circuit_t circuit;
+  cosim_t cosim = {0};
+  int result = 0;
+
+  circuit_init(&circuit);
+  if (mcu_get_config_by_type(MCU_AVR_ATMEGA328P, &config) < 0 ||
+      mcu_init(&mcu, &config) < 0 ||
+      mcu_load_firmware_buffer(&mcu, (const uint8_t *)program,
+                               sizeof(program)) < 0 ||
+      mcu_run(&mcu) < 0) {
+    fprintf(stderr, "%s FAILED: mcu setup\n", __func__);
+    goto out;
+  }
+
+  // PB5 -> 220R -> LED -> GND; PB0 lê um pull-up de 10k
+  int pb5 = circuit_node(&circuit, "PB5");
+  int anode = circuit_node(&circuit, "A");
+  int pb0 = circuit_node(&circuit, "PB0");
+  int vcc = circuit_node(&circuit, "VCC");
+  circuit_add_resistor(&circuit, "R1", pb5, anode, 220.0);
+  int led = circuit_add_diode(&circuit, "LED1", anode, CIRCUIT_GROUND, 2.0, 10.0);
+  circuit_add_voltage_source(&circuit, "VCC", vcc, CIRCUIT_GROUND, 5.0, 0.0);
+  circuit_add_resistor(&circuit, "R2", vcc, pb0, 10000.0);
+
+  cosim_init(&cosim, &mcu, &circuit, 5.0);
+  cosim.quantum = 100;
+  if (cosim_bind_pin(&cosim, 18, pb5) < 0 ||
+      cosim_bind_pin(&cosim, 13, pb0) < 0 || cosim_run(&cosim, 300) < 0) {
+    fprintf(stderr, "%s FAILED: cosim setup\n", __func__);
+    goto out;
+  }
+
+  double lit = circuit_current(&circuit, led);
+  pin_state_t input = mcu.pin_manager.pins[13].state;
+  cosim_run(&cosim, 1000);
+  double dark = circuit_current(&circuit, led);
+
+  // Sete fatias de 100 ciclos, mas só três soluções: início, acende, apaga
+  result = is_close(lit, 3.0 / 255.0, 1e-5) && dark < 1e-6 &&
+           input == PIN_HIGH && cosim.solve_count == 3;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: lit[%f], dark[%f], input[%s], solves[%lu]\n",
+            __func__, lit, dark, pin_state_to_string(input), cosim.solve_count);
+  }
+
+out:
+  cosim_free(&cosim);
+  circuit_free(&circuit);
+  mcu_cleanup(&mcu);
+  return result;
+}
+
+int test_should_drive_current_level_after_direction_flip() {
+  microcontroller_t mcu = {0};
+  mcu_config_t config;
+  circuit_t circuit;
+  cosim_t cosim = {0};
+  int result = 0;
+
+  // PB5 -> 220R -> LED -> GND, com 10k levando PB5 a GND como entrada
+  circuit_init(&circuit);
+  int pb5 = circuit_node(&circuit, "PB5");
+  int anode = circuit_node(&circuit, "A");
+  circuit_add_resistor(&circuit, "R1", pb5, anode, 220.0);
+  int led = circuit_add_diode(&circuit, "LED1", anode, CIRCUIT_GROUND, 2.0, 10.0);
+  circuit_add_resistor(&circuit, "R2", pb5, CIRCUIT_GROUND, 10000.0);
+
+  if (mcu_get_config_by_type(MCU_AVR_ATMEGA328P, &config) < 0 ||
+      mcu_init(&mcu, &config) < 0 ||
+      cosim_init(&cosim, &mcu, &circuit, 5.0) < 0 ||
+      cosim_bind_pin(&cosim, 18, pb5) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    goto out;
+  }
+
+  // Saída em HIGH acende o LED
+  pin_set_direction(&mcu.pin_manager, 18, PIN_OUTPUT);
+  pin_set_state(&mcu.pin_manager, 18, PIN_HIGH);
+  cosim_sync(&cosim);
+  double lit = circuit_current(&circuit, led);
+
+  // Como entrada o pino lê LOW pelo resistor de 10k
+  pin_set_direction(&mcu.pin_manager, 18, PIN_INPUT);
+  cosim_sync(&cosim);
+  pin_state_t sampled = mcu.pin_manager.pins[18].state;
+
+  // De volta a saída com o nível lido (LOW): a fonte não pode seguir em 5 V
+  pin_set_direction(&mcu.pin_manager, 18, PIN_OUTPUT);
+  cosim_sync(&cosim);
+  double dark = circuit_current(&circuit, led);
+
+  result = lit > 0.01 && sampled == PIN_LOW && dark < 1e-6;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: lit[%f], sampled[%s], dark[%f]\n", __func__,
+            lit, pin_state_to_string(sampled), dark);
+  }
+
+out:
+  cosim_free(&cosim);
+  circuit_free(&circuit);
+  mcu_cleanup(&mcu);
+  return result;
+}
+
+int test_should_propagate_digital_changes_only() {
+  digital_sim_t sim;
+  char name[16];
+  int nets[101];
+
+  digital_init(&sim, NULL, 0.0);
+  for (int i = 0; i <= 100; i++) {
+    snprintf(name, sizeof(name), "N%d", i);
+    nets[i] = digital_net(&sim, name);
+  }
+  // Cadeia de 100 inversores com 1 tick cada
+  for (int i = 0; i < 100; i++) {
+    digital_add_gate(&sim, DIGITAL_GATE_NOT, NULL, &nets[i], 1, nets[i + 1], 1);
+  }
+  digital_force(&sim, nets[0], DIGITAL_1, DIGITAL_STRONG);
+  digital_run(&sim, 1000);
+
+  unsigned long evaluations = sim.evaluation_count;
+  digital_force(&sim, nets[0], DIGITAL_0, DIGITAL_STRONG);
+  digital_run(&sim, 1050);
+  digital_level_t middle = digital_level(&sim, nets[50]);
+  digital_run(&sim, 2000);
+  unsigned long toggled = sim.evaluation_count - evaluations;
+
+  // Sem estímulo nada é avaliado
+  evaluations = sim.evaluation_count;
+  digital_run(&sim, 5000);
+
+  int result = digital_level(&sim, nets[100]) == DIGITAL_0 &&
+               middle == DIGITAL_0 && toggled == 100 &&
+               sim.evaluation_count == evaluations;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: out[%s], middle[%s], toggled[%lu]\n", __func__,
+            digital_level_to_string(digital_level(&sim, nets[100])),
+            digital_level_to_string(middle), toggled);
+  }
+  digital_free(&sim);
+  return result;
+}
+
+int test_should_resolve_drive_strengths() {
+  digital_sim_t sim;
+  digital_init(&sim, NULL, 0.0);
+
+  // Pull-up fraco e chave para a terra
+  int gnd = digital_net(&sim, "GND");
+  int line = digital_net(&sim, "LINE");
+  int bus = digital_net(&sim, "BUS");
+  digital_add_constant(&sim, "GND", gnd, DIGITAL_0, DIGITAL_SUPPLY);
+  digital_add_constant(&sim, "PULL", line, DIGITAL_1, DIGITAL_WEAK);
+  int sw = digital_add_switch(&sim, "SW1", gnd, line, false);
+  digital_run(&sim, 10);
+  digital_level_t open = digital_level(&sim, line);
+
+  digital_set_switch(&sim, sw, true);
+  digital_run(&sim, 20);
+  digital_level_t closed = digital_level(&sim, line);
+
+  // Duas saídas fortes em conflito
+  digital_add_constant(&sim, "A", bus, DIGITAL_1, DIGITAL_STRONG);
+  digital_add_constant(&sim, "B", bus, DIGITAL_0, DIGITAL_STRONG);
+  digital_run(&sim, 30);
+
+  int result = open == DIGITAL_1 && closed == DIGITAL_0 &&
+               digital_level(&sim, bus) == DIGITAL_X &&
+               digital_level(&sim, digital_net(&sim, "FLOAT")) == DIGITAL_Z;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: open[%s], closed[%s], bus[%s]\n", __func__,
+            digital_level_to_string(open), digital_level_to_string(closed),
+            digital_level_to_string(digital_level(&sim, bus)));
+  }
+  digital_free(&sim);
+  return result;
+}
+
+int test_should_solve_analog_only_at_boundaries() {
+  circuit_t circuit;
+  digital_sim_t sim;
+
+  // Net LED -> 220R -> LED -> GND; divisor analógico lido pela net SENSE
+  circuit_init(&circuit);
+  int out = circuit_node(&circuit, "OUT");
+  int anode = circuit_node(&circuit, "A");
+  int vcc = circuit_node(&circuit, "VCC");
+  int div = circuit_node(&circuit, "DIV");
+  circuit_add_resistor(&circuit, "R1", out, anode, 220.0);
+  int led = circuit_add_diode(&circuit, "LED1", anode, CIRCUIT_GROUND, 2.0, 10.0);
+  circuit_add_voltage_source(&circuit, "VCC", vcc, CIRCUIT_GROUND, 5.0, 0.0);
+  circuit_add_resistor(&circuit, "R2", vcc, div, 1000.0);
+  circuit_add_resistor(&circuit, "R3", div, CIRCUIT_GROUND, 3000.0);
+
+  digital_init(&sim, &circuit, 5.0);
+  int led_net = digital_net(&sim, "LED");
+  int clock = digital_net(&sim, "CLK");
+  int clock_n = digital_net(&sim, "CLK_N");
+  int sense = digital_net(&sim, "SENSE");
+  digital_bind_output(&sim, led_net, out);
+  digital_bind_input(&sim, sense, div);
+  digital_add_gate(&sim, DIGITAL_GATE_NOT, "INV", &clock, 1, clock_n, 1);
+
+  digital_force(&sim, led_net, DIGITAL_1, DIGITAL_STRONG);
+  digital_run(&sim, 10);
+  double lit = circuit_current(&circuit, led);
+  unsigned long solves = sim.analog_solve_count;
+
+  // Atividade só digital não toca no solver
+  for (int t = 0; t < 50; t++) {
+    digital_force(&sim, clock, t & 1 ? DIGITAL_1 : DIGITAL_0, DIGITAL_STRONG);
+    digital_run(&sim, 20 + 10 * t);
+  }
+  unsigned long digital_only = sim.analog_solve_count - solves;
+
+  digital_force(&sim, led_net, DIGITAL_0, DIGITAL_STRONG);
+  digital_run(&sim, 1000);
+
+  int result = is_close(lit, 3.0 / 255.0, 1e-5) && digital_only == 0 &&
+               circuit_current(&circuit, led) < 1e-6 &&
+               digital_level(&sim, sense) == DIGITAL_1 &&
+               sim.analog_solve_count == solves + 1;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: lit[%f], digital_only[%lu], sense[%s], solves[%lu]\n",
+            __func__, lit, digital_only,
+            digital_level_to_string(digital_level(&sim, sense)),
+            sim.analog_solve_count);
+  }
+  digital_free(&sim);
+  circuit_free(&circuit);
+  return result;
+}
+
+typedef struct {
+  int slow_source;
+  int fast_source;
+  int toggles;
+} square_wave_t;
+
+// Fonte rápida alterna 0/5 V a cada ponto de sincronização; a lenta liga em t = 0
+static int toggle_fast_source(multirate_t* multirate, double time, void* context) {
+  square_wave_t* wave = context;
+  if (time == 0.0) {
+    multirate_set_source(multirate, wave->slow_source, 5.0);
+  }
+  multirate_set_source(multirate, wave->fast_source, wave->toggles++ & 1 ? 0.0 : 5.0);
+  return 0;
+}
+
+static int build_sensor_and_regulator(circuit_t* circuit, int* slow, int* fast, int* divider) {
+  circuit_init(circuit);
+  *slow = circuit_node(circuit, "SENSOR");
+  *fast = circuit_node(circuit, "SW");
+  *divider = circuit_node(circuit, "REF");
+
+  // RC lento (tau = 1 s), RC rápido (tau = 10 us), ligados por 100 MOhm
+  circuit_add_voltage_source(circuit, "VS", *slow, CIRCUIT_GROUND, 0.0, 10e3);
+  circuit_add_capacitor(circuit, "CS", *slow, CIRCUIT_GROUND, 100e-6);
+  int fast_source = circuit_add_voltage_source(circuit, "VF", *fast, CIRCUIT_GROUND, 0.0, 100.0);
+  circuit_add_capacitor(circuit, "CF", *fast, CIRCUIT_GROUND, 100e-9);
+  circuit_add_resistor(circuit, "RLEAK", *slow, *fast, 100e6);
+
+  // Divisor isolado: componente conexo próprio
+  circuit_add_voltage_source(circuit, "VR", *divider, CIRCUIT_GROUND, 3.3, 1000.0);
+  circuit_add_resistor(circuit, "RR", *divider, CIRCUIT_GROUND, 1000.0);
+  return fast_source;
+}
+
+int test_should_step_partitions_at_their_own_rates() {
+  multirate_t threaded;
+  multirate_t serial;
+  int slow, fast, divider;
+  circuit_t circuit;
+
+  int fast_source = build_sensor_and_regulator(&circuit, &slow, &fast, &divider);
+  int slow_source = circuit_find_element(&circuit, "VS");
+  multirate_init(&threaded, &circuit, 1e-9, 50e-6);
+  circuit_free(&circuit);
+  build_sensor_and_regulator(&circuit, &slow, &fast, &divider);
+  multirate_init(&serial, &circuit, 1e-9, 50e-6);
+  circuit_free(&circuit);
+  serial.threaded = false;
+
+  square_wave_t wave = {.slow_source = slow_source, .fast_source = fast_source};
+  multirate_run(&threaded, 0.02, 50e-6, toggle_fast_source, &wave);
+  wave.toggles = 0;
+  multirate_run(&serial, 0.02, 50e-6, toggle_fast_source, &wave);
+
+  const multirate_partition_t* slow_part = &threaded.partitions[multirate_partition_of(&threaded, slow)];
+  const multirate_partition_t* fast_part = &threaded.partitions[multirate_partition_of(&threaded, fast)];
+  double expected = 5.0 * (1.0 - exp(-0.02));
+  double sensor = multirate_voltage(&threaded, slow);
+
+  int result = threaded.partition_count == 3 && threaded.coupling_count == 2 &&
+               multirate_partition_of(&threaded, slow) != multirate_partition_of(&threaded, fast) &&
+               is_close(sensor, expected, expected * 0.01) &&
+               is_close(multirate_voltage(&threaded, divider), 1.65, 1e-6) &&
+               slow_part->step_count <= 400 && fast_part->step_count > 10 * slow_part->step_count &&
+               multirate_voltage(&threaded, fast) == multirate_voltage(&serial, fast) &&
+               sensor == multirate_voltage(&serial, slow);
+  if (!result) {
+    fprintf(stderr, "%s FAILED: partitions[%d], couplings[%d], sensor[%f/%f], ref[%f], steps[%lu/%lu]\n",
+            __func__, threaded.partition_count, threaded.coupling_count, sensor, expected,
+            multirate_voltage(&threaded, divider), slow_part->step_count, fast_part->step_count);
+  }
+  multirate_free(&threaded);
+  multirate_free(&serial);
+  return result;
+}
+
+// Escada de resistores iguais: o nó k de n fica em V·(n - k)/n
+static void build_ladder(circuit_t* circuit, int island, int length, double volts) {
+  char name[32];
+  int previous = CIRCUIT_GROUND;
+
+  for (int k = 0; k < length; k++) {
+    snprintf(name, sizeof(name), "I%dN%d", island, k);
+    int node = circuit_node(circuit, name);
+    if (k == 0) {
+      circuit_add_voltage_source(circuit, NULL, node, CIRCUIT_GROUND, volts, 0.0);
+    } else {
+      circuit_add_resistor(circuit, NULL, previous, node, 100.0);
+    }
+    previous = node;
+  }
+  circuit_add_resistor(circuit, NULL, previous, CIRCUIT_GROUND, 100.0);
+}
+
+int test_should_solve_disconnected_islands_in_parallel() {
+  circuit_t parallel;
+  circuit_t serial;
+
+  circuit_init(&parallel);
+  circuit_init(&serial);
+  for (int i = 0; i < 8; i++) {
+    build_ladder(&parallel, i, 120, 1.0 + i);
+    build_ladder(&serial, i, 120, 1.0 + i);
+  }
+  // Fonte de corrente entre ilhas não as une
+  circuit_add_current_source(&parallel, NULL, circuit_node(&parallel, "I0N5"), circuit_node(&parallel, "I1N5"), 0.0);
+  circuit_add_current_source(&serial, NULL, circuit_node(&serial, "I0N5"), circuit_node(&serial, "I1N5"), 0.0);
+  parallel.thread_count = 4;
+  serial.thread_count = 1;
+
+  circuit_solve(&parallel);
+  circuit_solve(&serial);
+  const circuit_pool_t *pool = parallel.pool;
+
+  int same = 1;
+  for (int node = 0; node < parallel.node_count; node++) {
+    if (circuit_voltage(&parallel, node) != circuit_voltage(&serial, node)) {
+      same = 0;
+    }
+  }
+
+  // Desligar o resistor para a terra da última escada só refatora a ilha
+  // dela, que passa a flutuar no valor da fonte
+  int tail = circuit_node(&parallel, "I7N119");
+  circuit_set_enabled(&parallel, parallel.element_count - 2, false);
+  int refactored = 0;
+  for (int k = 0; k < parallel.island_count; k++) {
+    refactored += !parallel.islands[k].factored;
+  }
+  circuit_solve(&parallel);
+
+  // Refatorar tudo de novo reaproveita os workers da primeira solução
+  parallel.factored = false;
+  circuit_solve(&parallel);
+
+  int result = parallel.island_count == 8 && same && pool && parallel.pool == pool &&
+               is_close(circuit_voltage(&serial, circuit_node(&serial, "I3N60")), 4.0 * 60.0 / 120.0, 1e-6) &&
+               refactored == 1 && is_close(circuit_voltage(&parallel, tail), 8.0, 1e-3);
+  if (!result) {
+    fprintf(stderr, "%s FAILED: islands[%d], same[%d], pool[%d], refactored[%d], mid[%f]\n",
+            __func__, parallel.island_count, same, pool && parallel.pool == pool, refactored,
+            circuit_voltage(&serial, circuit_node(&serial, "I3N60")));
+  }
+  circuit_free(&parallel);
+  circuit_free(&serial);
+  return result;
+}
+
+// Malha de alimentação size×size: 1 Ohm entre vizinhos, fonte de 1 V em cada
+// canto e 100 uA puxados de cada nó
+static void build_power_grid(circuit_t* circuit, int size) {
+  char name[32];
+
+  circuit_init(circuit);
+  for (int r = 0; r < size; r++) {
+    for (int c = 0; c < size; c++) {
+      snprintf(name, sizeof(name), "G%d_%d", r, c);
+      int node = circuit_node(circuit, name);
+      if (c > 0) {
+        circuit_add_resistor(circuit, NULL, node - 1, node, 1.0);
+      }
+      if (r > 0) {
+        circuit_add_resistor(circuit, NULL, node - size, node, 1.0);
+      }
+      circuit_add_current_source(circuit, NULL, CIRCUIT_GROUND, node, 100e-6);
+    }
+  }
+  int corners[] = {1, size, size * (size - 1) + 1, size * size};
+  for (int k = 0; k < 4; k++) {
+    circuit_add_voltage_source(circuit, NULL, corners[k], CIRCUIT_GROUND, 1.0, 0.01);
+  }
+}
+
+int test_should_factor_large_mesh_with_nested_dissection() {
+  const int size = 120;
+  circuit_t parallel;
+  circuit_t serial;
+
+  build_power_grid(&parallel, size);
+  build_power_grid(&serial, size);
+  parallel.thread_count = 4;
+  serial.thread_count = 1;
+  circuit_solve(&parallel);
+  circuit_solve(&serial);
+
+  // Lei dos nós: o que sai de cada nó pelos elementos tem que somar zero
+  double residual = 0.0;
+  static double outflow[120 * 120 + 1];
+  for (int e = 0; e < parallel.element_count; e++) {
+    const circuit_element_t* element = &parallel.elements[e];
+    double current = circuit_current(&parallel, e);
+    if (element->type != CIRCUIT_RESISTOR) {
+      current = -current;
+    }
+    outflow[element->a] += current;
+    outflow[element->b] -= current;
+  }
+  int same = 1;
+  for (int node = 1; node < parallel.node_count; node++) {
+    residual = fmax(residual, fabs(outflow[node]));
+    if (circuit_voltage(&parallel, node) != circuit_voltage(&serial, node)) {
+      same = 0;
+    }
+  }
+
+  // Dissecção aninhada numa malha de n nós preenche O(n·log n); a ordem
+  // natural, em banda, ficaria com n·size (1,7M aqui) e não passa
+  const sparse_t* sparse = parallel.islands[0].sparse;
+  double center = circuit_voltage(&parallel, (size / 2) * size + size / 2 + 1);
+  double n = size * size;
+  int result = sparse && same && residual < 1e-9 && center > 0.0 && center < 1.0 &&
+               sparse_nonzeros(sparse) < 3.0 * n * log2(n);
+  if (!result) {
+    fprintf(stderr, "%s FAILED: sparse[%d], same[%d], residual[%g], center[%f], nonzeros[%d]\n",
+            __func__, sparse != NULL, same, residual, center, sparse_nonzeros(sparse));
+  }
+  circuit_free(&parallel);
+  circuit_free(&serial);
+  return result;
+}
+
+int test_should_solve_resistive_grid_iteratively() {
+  const int size = 120;
+  circuit_t direct;
+  circuit_t iterative;
+
+  build_power_grid(&direct, size);
+  build_power_grid(&iterative, size);
+  circuit_set_solver(&iterative, CIRCUIT_SOLVER_ITERATIVE);
+  circuit_solve(&direct);
+  circuit_solve(&iterative);
+
+  const pcg_t* pcg = iterative.islands[0].iterative;
+  int cold = pcg ? pcg->iterations : -1;
+  double error = 0.0;
+  for (int node = 1; node < direct.node_count; node++) {
+    error = fmax(error, fabs(circuit_voltage(&direct, node) - circuit_voltage(&iterative, node)));
+  }
+
+  // Varredura: um passo pequeno na carga parte da solução anterior
+  int load = circuit_node(&iterative, "G60_60");
+  for (int e = 0; e < iterative.element_count; e++) {
+    if (iterative.elements[e].type == CIRCUIT_CURRENT_SOURCE && iterative.elements[e].b == load) {
+      circuit_set_source(&iterative, e, 200e-6);
+    }
+  }
+  unsigned long factors = iterative.factor_count;
+  circuit_solve(&iterative);
+  int warm = pcg ? pcg->iterations : -1;
+
+  int result = pcg && error < 1e-7 && warm < cold && iterative.factor_count == factors &&
+               pcg_nonzeros(pcg) < sparse_nonzeros(direct.islands[0].sparse) / 4;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: pcg[%d], error[%g], iterations[%d/%d], nonzeros[%d/%d]\n",
+            __func__, pcg != NULL, error, cold, warm, pcg_nonzeros(pcg),
+            sparse_nonzeros(direct.islands[0].sparse));
+  }
+  circuit_free(&direct);
+  circuit_free(&iterative);
+  return result;
+}
+
+int test_should_fall_back_to_jacobi_when_ic0_breaks() {
+  // Definida positiva, mas sem ser M-matriz: o IC(0) do anel quebra na linha 3
+  const int rows[] = {1, 2, 3, 3};
+  const int cols[] = {0, 1, 2, 0};
+  const double off[] = {5.0, 5.0, 5.0, -8.0};
+  double b[] = {-12.0, 40.0, 60.0, 47.0};
+  pcg_t pcg;
+
+  if (pcg_init(&pcg, 4, rows, cols, 4) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+  for (int i = 0; i < 4; i++) {
+    pcg.values[pcg_slot(&pcg, i, i)] = 10.0;
+    pcg.values[pcg_slot(&pcg, rows[i], cols[i])] = off[i];
+  }
+
+  // Jacobi vale para a matriz toda: nenhuma linha fica com o IC(0) parcial
+  int factored = pcg_factor(&pcg);
+  int diagonal = 1;
+  for (int i = 0; i < 4; i++) {
+    for (int p = pcg.row_start[i]; p < pcg.diagonal[i]; p++) {
+      diagonal &= pcg.factor[p] == 0.0;
+    }
+  }
+  int solved = factored == 0 && pcg_solve(&pcg, b) == 0;
+
+  int result = solved && pcg.jacobi && diagonal && is_close(b[0], 1.0, 1e-8) &&
+               is_close(b[1], 2.0, 1e-8) && is_close(b[2], 3.0, 1e-8) &&
+               is_close(b[3], 4.0, 1e-8);
+  if (!result) {
+    fprintf(stderr, "%s FAILED: solved[%d], jacobi[%d], diagonal[%d], x[%f %f %f %f]\n",
+            __func__, solved, pcg.jacobi, diagonal, b[0], b[1], b[2], b[3]);
+  }
+  pcg_free(&pcg);
+  return result;
+}
+
+int main(void) {
+  if (!test_should_solve_voltage_divider()) {
+    return 1;
+  }
+
+  if (!test_should_light_led_through_resistor()) {
+    return 1;
+  }
+
+  if (!test_should_drive_led_from_mcu_pin()) {
+    return 1;
+  }
+
+  if (!test_should_drive_current_level_after_direction_flip()) {
+    return 1;
+  }
+
+  if (!test_should_propagate_digital_changes_only()) {
+    return 1;
+  }
+
+  if (!test_should_resolve_drive_strengths()) {
+    return 1;
+  }
+
+  if (!test_should_solve_analog_only_at_boundaries()) {
+    return 1;
+  }
+
+  if (!test_should_step_partitions_at_their_own_rates()) {
+    return 1;
+  }
+
+  if (!test_should_solve_disconnected_islands_in_parallel()) {
+    return 1;
+  }
+
+  if (!test_should_factor_large_mesh_with_nested_dissection()) {
+    return 1;
+  }
+
+  if (!test_should_solve_resistive_grid_iteratively()) {
+    return 1;
+  }
+
+  if (!test_should_fall_back_to_jacobi_when_ic0_breaks()) {
+    return 1;
+  }
+
+  printf("==== [test_circuit] TESTS PASSED ====\n");
+
+  return 0;
+}
@@ -0,0 +1,1580 @@
+#include "config/arm_core.h"
+#include "config/microcontroller.h"
+#include "config/mcu_farm.h"
+#include "config/mcu_gdb.h"
+#include "config/mcu_log.h"
+#include "config/mcu_profile.h"
+#include "config/mcu_replay.h"
+#include "config/mcu_snapshot.h"
+#include "config/pic_core.h"
+#include "config/pin_queue.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static int setup_avr(microcontroller_t *mcu, const uint16_t *program, size_t words) {
+  mcu_config_t config;
+  if (mcu_get_config_by_type(MCU_AVR_ATMEGA328P, &config) < 0 ||
+      mcu_init(mcu, &config) < 0) {
+    return 0;
+  }
+  if (mcu_load_firmware_buffer(mcu, (const uint8_t *)program,
+                               words * sizeof(uint16_t)) < 0) {
+    return 0;
+  }
+  return mcu_run(mcu) == 0;
+}
+
+// Imagem com tabela de vetores: SP inicial 0x20005000, reset em 0x08000008
+static int setup_arm(microcontroller_t *mcu, const uint16_t *code, size_t halfwords) {
+  uint16_t image[64] = {0x5000, 0x2000, 0x0009, 0x0800};
+  mcu_config_t config;
+
+  memcpy(image + 4, code, halfwords * sizeof(uint16_t));
+  if (mcu_get_config_by_type(MCU_ARM_CORTEX_M3, &config) < 0 ||
+      mcu_init(mcu, &config) < 0) {
+    return 0;
+  }
+  if (mcu_load_firmware_buffer(mcu, (const uint8_t *)image,
+                               (halfwords + 4) * sizeof(uint16_t)) < 0) {
+    return 0;
+  }
+  return mcu_run(mcu) == 0;
+}
+
+static int setup_pic(microcontroller_t *mcu, const uint16_t *program, size_t words) {
+  mcu_config_t config;
+  if (mcu_get_config_by_type(MCU_PIC16F877A, &config) < 0 ||
+      mcu_init(mcu, &config) < 0) {
+    return 0;
+  }
+  if (mcu_load_firmware_buffer(mcu, (const uint8_t *)program,
+                               words * sizeof(uint16_t)) < 0) {
+    return 0;
+  }
+  return mcu_run(mcu) == 0;
+}
+
+int test_should_count_cycles_of_countdown_loop() {
+  // ldi r16, 10; loop: dec r16; brne loop; break
+  const uint16_t program[] = {0xE00A, 0x950A, 0xF7F1, 0x9598};
+  uint64_t expected_cycles = 1 + 10 * 1 + 9 * 2 + 1 + 1;
+  microcontroller_t mcu;
+  uint32_t r16 = 0xFF;
+
+  if (!setup_avr(&mcu, program, 4)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, 16, &r16);
+
+  if (mcu.state != MCU_STATE_HALTED || r16 != 0 ||
+      mcu_get_cycle_count(&mcu) != expected_cycles) {
+    fprintf(stderr,
+            "%s FAILED: state[%s], r16[%u], cycles[%llu], "
+            "expected.cycles[%llu]\n",
+            __func__, mcu_state_to_string(mcu.state), r16,
+            (unsigned long long)mcu_get_cycle_count(&mcu),
+            (unsigned long long)expected_cycles);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_call_subroutine_and_set_carry() {
+  // ldi r24, 0xF0; ldi r25, 0x20; rcall add; break; add: add r24, r25; ret
+  const uint16_t program[] = {0xEF80, 0xE290, 0xD001, 0x9598, 0x0F89, 0x9508};
+  uint64_t expected_cycles = 1 + 1 + 3 + 1 + 4 + 1;
+  microcontroller_t mcu;
+  uint32_t r24 = 0;
+  uint8_t sreg = 0;
+
+  if (!setup_avr(&mcu, program, 6)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, 24, &r24);
+  mcu_read_memory(&mcu, 0x5F, &sreg, 1);
+
+  if (r24 != 0x10 || !(sreg & 0x01) ||
+      mcu_get_cycle_count(&mcu) != expected_cycles) {
+    fprintf(stderr,
+            "%s FAILED: r24[0x%02x], sreg[0x%02x], cycles[%llu], "
+            "expected.cycles[%llu]\n",
+            __func__, r24, sreg, (unsigned long long)mcu_get_cycle_count(&mcu),
+            (unsigned long long)expected_cycles);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_skip_past_last_flash_word() {
+  // jmp 0x3FFF; ... 0x3FFF: cpse r0, r0 (pula uma palavra além do flash)
+  static uint16_t program[0x4000];
+  microcontroller_t mcu;
+
+  program[0] = 0x940C;
+  program[1] = 0x3FFF;
+  program[0x3FFF] = 0x1000;
+  if (!setup_avr(&mcu, program, 0x4000)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+
+  int result = mcu.state == MCU_STATE_HALTED && mcu.program_counter == 0x8002 &&
+               mcu_get_cycle_count(&mcu) == 3 + 2;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: state[%s], pc[0x%08x], cycles[%llu]\n", __func__,
+            mcu_state_to_string(mcu.state), mcu.program_counter,
+            (unsigned long long)mcu_get_cycle_count(&mcu));
+  }
+
+  mcu_cleanup(&mcu);
+  return result;
+}
+
+int test_should_run_until_emulated_time() {
+  // loop: rjmp loop
+  const uint16_t program[] = {0xCFFF};
+  microcontroller_t mcu;
+  double expected_time = 0.000010; // 10 us = 160 ciclos a 16 MHz
+
+  if (!setup_avr(&mcu, program, 1)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_until_time(&mcu, expected_time);
+
+  if (mcu_get_cycle_count(&mcu) != 160 || mcu_get_time(&mcu) < expected_time) {
+    fprintf(stderr, "%s FAILED: cycles[%llu], time[%.9f], expected.time[%.9f]\n",
+            __func__, (unsigned long long)mcu_get_cycle_count(&mcu),
+            mcu_get_time(&mcu), expected_time);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+typedef struct {
+  int fired;
+  uint64_t due[4];
+  uint64_t now[4];
+} event_log_t;
+
+static void record_event(struct microcontroller *mcu, void *context, uint64_t cycle) {
+  event_log_t *log = context;
+  if (log->fired < 4) {
+    log->due[log->fired] = cycle;
+    log->now[log->fired] = mcu_get_cycle_count(mcu);
+    log->fired++;
+  }
+}
+
+int test_should_dispatch_events_in_cycle_order() {
+  // loop: rjmp loop (2 ciclos por volta)
+  const uint16_t program[] = {0xCFFF};
+  microcontroller_t mcu;
+  event_log_t log = {0};
+
+  if (!setup_avr(&mcu, program, 1)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_schedule_event(&mcu, 51, SCHED_EVENT_TIMER, record_event, &log);
+  mcu_schedule_event(&mcu, 20, SCHED_EVENT_UART, record_event, &log);
+  int cancelled = mcu_schedule_event(&mcu, 30, SCHED_EVENT_ADC, record_event, &log);
+  mcu_cancel_event(&mcu, cancelled);
+
+  mcu_run_cycles(&mcu, 100);
+
+  if (log.fired != 2 || log.due[0] != 20 || log.due[1] != 51 ||
+      log.now[0] != 20 ||
+      log.now[1] != 52 || mcu_get_cycle_count(&mcu) != 100) {
+    fprintf(stderr,
+            "%s FAILED: fired[%d], due[%llu, %llu], now[%llu, %llu], "
+            "cycles[%llu]\n",
+            __func__, log.fired, (unsigned long long)log.due[0],
+            (unsigned long long)log.due[1], (unsigned long long)log.now[0],
+            (unsigned long long)log.now[1],
+            (unsigned long long)mcu_get_cycle_count(&mcu));
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_drive_pins_through_io_registers() {
+  // sbi DDRB, 5; sbi PORTB, 5; in r16, PINB; break
+  const uint16_t program[] = {0x9A25, 0x9A2D, 0xB103, 0x9598};
+  microcontroller_t mcu;
+  pin_t *led = NULL;
+  uint32_t r16 = 0;
+  uint8_t portb = 0;
+
+  if (!setup_avr(&mcu, program, 4) ||
+      mcu_get_pin_by_name(&mcu, "PB5", &led) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_set_pin_state(&mcu, 13, PIN_HIGH); // PB0 como entrada externa
+  mcu_run_cycles(&mcu, 100);
+  mcu_read_register(&mcu, 16, &r16);
+  mcu_read_memory(&mcu, 0x25, &portb, 1);
+
+  if (led->state != PIN_HIGH || led->direction != PIN_OUTPUT ||
+      portb != 0x20 || r16 != 0x21) {
+    fprintf(stderr,
+            "%s FAILED: led.state[%s], led.direction[%s], portb[0x%02x], "
+            "r16[0x%02x]\n",
+            __func__, pin_state_to_string(led->state),
+            pin_direction_to_string(led->direction), portb, r16);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  portb = 0;
+  mcu_write_memory(&mcu, 0x25, &portb, 1);
+
+  if (led->state != PIN_LOW) {
+    fprintf(stderr, "%s FAILED: led.state[%s] after PORTB write\n", __func__,
+            pin_state_to_string(led->state));
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_stop_at_breakpoints_and_watchpoints() {
+  // ldi r16, 10; loop: dec r16; brne loop; sbi PORTB, 5; break
+  const uint16_t program[] = {0xE00A, 0x950A, 0xF7F1, 0x9A2D, 0x9598};
+  microcontroller_t mcu;
+  uint32_t r16 = 0;
+
+  if (!setup_avr(&mcu, program, 5) || mcu_set_breakpoint(&mcu, 2) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_run(&mcu);
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, 16, &r16);
+
+  if (mcu.stop_reason != MCU_STOP_BREAKPOINT || mcu.program_counter != 2 ||
+      r16 != 9) {
+    fprintf(stderr, "%s FAILED: stop_reason[%d], pc[0x%08x], r16[%u]\n",
+            __func__, mcu.stop_reason, mcu.program_counter, r16);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_remove_breakpoint(&mcu, 2);
+  mcu_set_watchpoint(&mcu, 0x25, 1, MCU_WATCH_WRITE);
+  mcu_run(&mcu);
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, 16, &r16);
+
+  if (mcu.stop_reason != MCU_STOP_WATCHPOINT || mcu.stop_address != 0x25 ||
+      mcu.program_counter != 8 || r16 != 0) {
+    fprintf(stderr,
+            "%s FAILED: stop_reason[%d], stop_address[0x%08x], pc[0x%08x], "
+            "r16[%u]\n",
+            __func__, mcu.stop_reason, mcu.stop_address, mcu.program_counter,
+            r16);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_load_intel_hex_file() {
+  // Mesmo laço do teste de ciclos, em Intel HEX
+  const char *hex = ":080000000AE00A95F1F798955A\n"
+                    ":00000001FF\n";
+  const char *path = "build/test_firmware.hex";
+  microcontroller_t mcu;
+  mcu_config_t config;
+  uint32_t size = 0, entry = 0, r16 = 0xFF;
+
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    fprintf(stderr, "%s FAILED: could not write %s\n", __func__, path);
+    return 0;
+  }
+  fputs(hex, file);
+  fclose(file);
+
+  if (mcu_get_config_by_type(MCU_AVR_ATMEGA328P, &config) < 0 ||
+      mcu_init(&mcu, &config) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    remove(path);
+    return 0;
+  }
+
+  int loaded = mcu_verify_firmware(&mcu, path) == 0 &&
+               mcu_load_firmware(&mcu, path) == 0 &&
+               mcu_get_firmware_info(&mcu, &size, &entry) == 0;
+  remove(path);
+
+  if (loaded && mcu_run(&mcu) == 0) {
+    mcu_run_cycles(&mcu, 1000);
+    mcu_read_register(&mcu, 16, &r16);
+  }
+
+  if (!loaded || size != 8 || entry != 0 || mcu.state != MCU_STATE_HALTED ||
+      r16 != 0) {
+    fprintf(stderr,
+            "%s FAILED: loaded[%d], size[%u], entry[%u], state[%s], r16[%u]\n",
+            __func__, loaded, size, entry, mcu_state_to_string(mcu.state), r16);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+  mcu_cleanup(&mcu);
+
+  // No ARM o registro 05 traz o endereço com o bit Thumb, que sai da entrada
+  const char *arm_hex = ":020000040800F2\n"
+                        ":08000000005000200900000877\n"
+                        ":0400000508000009E6\n"
+                        ":00000001FF\n";
+  if (mcu_get_config_by_type(MCU_ARM_CORTEX_M3, &config) < 0 ||
+      mcu_init(&mcu, &config) < 0) {
+    fprintf(stderr, "%s FAILED: arm setup\n", __func__);
+    return 0;
+  }
+  loaded = mcu_load_firmware_buffer(&mcu, (const uint8_t *)arm_hex,
+                                    strlen(arm_hex)) == 0 &&
+           mcu_get_firmware_info(&mcu, &size, &entry) == 0;
+  mcu_cleanup(&mcu);
+  if (!loaded || entry != 0x08000008) {
+    fprintf(stderr, "%s FAILED: arm loaded[%d], entry[0x%08x]\n", __func__,
+            loaded, entry);
+    return 0;
+  }
+
+  // Registro 05 com só dois bytes de endereço é recusado
+  const char *short_hex = ":020000050800F1\n"
+                          ":00000001FF\n";
+  if (mcu_get_config_by_type(MCU_ARM_CORTEX_M3, &config) < 0 ||
+      mcu_init(&mcu, &config) < 0) {
+    fprintf(stderr, "%s FAILED: arm setup\n", __func__);
+    return 0;
+  }
+  int rejected = mcu_load_firmware_buffer(&mcu, (const uint8_t *)short_hex,
+                                          strlen(short_hex)) < 0;
+  mcu_cleanup(&mcu);
+  if (!rejected) {
+    fprintf(stderr, "%s FAILED: short start address record accepted\n", __func__);
+    return 0;
+  }
+
+  return 1;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  put16(p, v & 0xFFFF);
+  put16(p + 2, v >> 16);
+}
+
+int test_should_place_elf_segments() {
+  // .text: lds r16, 0x0100; break  |  .data: 0x5A 0xA5 em 0x800100 + 2 bytes de .bss
+  uint8_t elf[52 + 2 * 32 + 8] = {0x7F, 'E', 'L', 'F', 1, 1, 1};
+  const uint8_t text[] = {0x00, 0x91, 0x00, 0x01, 0x98, 0x95};
+  const uint8_t data[] = {0x5A, 0xA5};
+  uint8_t *ph = elf + 52;
+  microcontroller_t mcu;
+  mcu_config_t config;
+  const uint8_t dirty[] = {0x00, 0xA5, 0xEE};
+  uint8_t ram[3] = {0};
+  uint32_t r16 = 0;
+
+  put16(elf + 16, 2);  // ET_EXEC
+  put16(elf + 18, 83); // EM_AVR
+  put32(elf + 20, 1);
+  put32(elf + 24, 0);  // entrada
+  put32(elf + 28, 52); // tabela de segmentos
+  put16(elf + 40, 52);
+  put16(elf + 42, 32);
+  put16(elf + 44, 2);
+
+  put32(ph, 1); // PT_LOAD .text
+  put32(ph + 4, 116);
+  put32(ph + 16, sizeof(text));
+  put32(ph + 20, sizeof(text));
+  memcpy(elf + 116, text, sizeof(text));
+
+  ph += 32; // PT_LOAD .data/.bss: VMA na RAM, LMA logo após o .text
+  put32(ph, 1);
+  put32(ph + 4, 122);
+  put32(ph + 8, 0x800100);
+  put32(ph + 12, sizeof(text));
+  put32(ph + 16, sizeof(data));
+  put32(ph + 20, sizeof(data) + 2);
+  memcpy(elf + 122, data, sizeof(data));
+
+  if (mcu_get_config_by_type(MCU_AVR_ATMEGA328P, &config) < 0 ||
+      mcu_init(&mcu, &config) < 0 ||
+      mcu_load_firmware_buffer(&mcu, elf, sizeof(elf)) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  // Sujar a RAM: o reset deve restaurar .data e zerar .bss
+  mcu_write_memory(&mcu, 0x0100, dirty, sizeof(dirty));
+  mcu_reset(&mcu);
+  mcu_run(&mcu);
+  mcu_run_cycles(&mcu, 100);
+
+  mcu_read_register(&mcu, 16, &r16);
+  mcu_read_memory(&mcu, 0x0100, ram, sizeof(ram));
+
+  if (mcu.state != MCU_STATE_HALTED || r16 != 0x5A || ram[1] != 0xA5 ||
+      ram[2] != 0 || mcu.firmware_size != sizeof(text) + sizeof(data) ||
+      mcu.memory[sizeof(text)] != 0x5A) {
+    fprintf(stderr,
+            "%s FAILED: state[%s], r16[%02x], data[%02x], bss[%02x], "
+            "size[%u]\n",
+            __func__, mcu_state_to_string(mcu.state), r16, ram[1], ram[2],
+            mcu.firmware_size);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+static void count_event(struct microcontroller *mcu, void *context, uint64_t cycle) {
+  (void)mcu;
+  (void)cycle;
+  (*(int *)context)++;
+}
+
+int test_should_restore_snapshot_of_running_mcu() {
+  // ldi r16, 0x42; sts 0x0200, r16; ldi r17, 1; sts 0x0300, r17; break
+  const uint16_t program[] = {0xE402, 0x9300, 0x0200, 0xE011,
+                              0x9310, 0x0300, 0x9598};
+  const uint8_t junk[] = {0xEE, 0xEE};
+  microcontroller_t mcu;
+  mcu_snapshot_t snapshot;
+  uint8_t ram[2] = {0};
+  uint32_t r17 = 0;
+  int fired = 0;
+
+  if (!setup_avr(&mcu, program, 7)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  // Depois do primeiro sts, com um evento ainda pendente
+  mcu_run_cycles(&mcu, 3);
+  mcu_schedule_event(&mcu, 2, SCHED_EVENT_TIMER, count_event, &fired);
+  if (mcu_snapshot_take(&mcu, &snapshot) < 0) {
+    fprintf(stderr, "%s FAILED: snapshot\n", __func__);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  for (int round = 0; round < 3; round++) {
+    mcu_run_cycles(&mcu, 1000);
+    mcu_write_memory(&mcu, 0x0700, junk, sizeof(junk));
+    mcu_read_memory(&mcu, 0x0300, ram, 1);
+
+    if (mcu.state != MCU_STATE_HALTED || ram[0] != 1 || fired != round + 1) {
+      fprintf(stderr, "%s FAILED: round[%d], state[%s], ram[%02x], fired[%d]\n",
+              __func__, round, mcu_state_to_string(mcu.state), ram[0], fired);
+      mcu_snapshot_free(&snapshot);
+      mcu_cleanup(&mcu);
+      return 0;
+    }
+
+    mcu_snapshot_restore(&mcu, &snapshot);
+    mcu_read_memory(&mcu, 0x0300, ram, 1);
+    mcu_read_memory(&mcu, 0x0700, ram + 1, 1);
+    mcu_read_register(&mcu, 17, &r17);
+
+    if (mcu.state != MCU_STATE_RUNNING || mcu_get_cycle_count(&mcu) != 3 ||
+        mcu.program_counter != 6 || ram[0] != 0 || ram[1] != 0 || r17 != 0 ||
+        mcu.data_memory[0x0200] != 0x42) {
+      fprintf(stderr,
+              "%s FAILED: round[%d], state[%s], cycles[%llu], pc[%u], "
+              "ram[%02x %02x], r17[%u]\n",
+              __func__, round, mcu_state_to_string(mcu.state),
+              (unsigned long long)mcu_get_cycle_count(&mcu), mcu.program_counter,
+              ram[0], ram[1], r17);
+      mcu_snapshot_free(&snapshot);
+      mcu_cleanup(&mcu);
+      return 0;
+    }
+  }
+
+  mcu_snapshot_free(&snapshot);
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+static int run_countdown_job(mcu_farm_instance_t *instance, void *context) {
+  microcontroller_t *mcu = &instance->mcu;
+  uint32_t start = (uint32_t)instance->index + 1;
+  (void)context;
+
+  // Cada instância conta a partir de um valor diferente: 3 ciclos por volta
+  if (mcu_write_register(mcu, 16, start) < 0 || mcu_run(mcu) < 0 ||
+      mcu_run_cycles(mcu, 10000) < 0) {
+    return -1;
+  }
+
+  fprintf(mcu->output, "instancia %d: %llu ciclos\n", instance->index,
+          (unsigned long long)mcu_get_cycle_count(mcu));
+  return mcu_get_cycle_count(mcu) == 3 * start ? 0 : -1;
+}
+
+int test_should_run_instances_in_farm() {
+  // loop: dec r16; brne loop; break
+  const uint16_t program[] = {0x950A, 0xF7F1, 0x9598};
+  mcu_config_t config;
+  mcu_farm_t farm;
+  char expected[64];
+
+  if (mcu_get_config_by_type(MCU_AVR_ATMEGA328P, &config) < 0 ||
+      mcu_farm_init(&farm, &config, 32, 4) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  if (mcu_farm_load_firmware_buffer(&farm, (const uint8_t *)program,
+                                    sizeof(program)) < 0) {
+    fprintf(stderr, "%s FAILED: load\n", __func__);
+    mcu_farm_cleanup(&farm);
+    return 0;
+  }
+
+  int failures = mcu_farm_run(&farm, run_countdown_job, NULL);
+
+  for (int i = 0; i < farm.instance_count; i++) {
+    const char *output = mcu_farm_output(&farm, i, NULL);
+    snprintf(expected, sizeof(expected), "instancia %d: %d ciclos\n", i,
+             3 * (i + 1));
+
+    if (failures != 0 || !output || !strstr(output, expected) ||
+        farm.instances[i].mcu.memory != farm.instances[0].mcu.memory) {
+      fprintf(stderr, "%s FAILED: failures[%d], instance[%d], output[%s]\n",
+              __func__, failures, i, output ? output : "(null)");
+      mcu_farm_cleanup(&farm);
+      return 0;
+    }
+  }
+
+  mcu_farm_cleanup(&farm);
+  return 1;
+}
+
+int test_should_run_thumb_program() {
+  // movs r0, #0; movs r1, #10; loop: adds r0, r1; subs r1, #1; bne loop
+  // bl triple; movw r2, #0x100; movt r2, #0x2000; str r0, [r2]
+  // ldr r3, [r2]; bkpt
+  // triple: push {r4, lr}; movs r4, #3; muls r0, r4; pop {r4, pc}
+  const uint16_t code[] = {0x2000, 0x210A, 0x1840, 0x3901, 0xD1FC, 0xF000,
+                           0xF807, 0xF240, 0x1200, 0xF2C2, 0x0200, 0x6010,
+                           0x6813, 0xBE00, 0xB510, 0x2403, 0x4360, 0xBD10};
+  uint64_t expected_cycles = 2 + 10 * 2 + 9 * 3 + 1 + 3 + (3 + 1 + 1 + 5) +
+                             2 + 2 + 2 + 1;
+  microcontroller_t mcu;
+  uint32_t r0 = 0, r3 = 0, sp = 0;
+  uint8_t ram[4] = {0};
+
+  if (!setup_arm(&mcu, code, sizeof(code) / sizeof(code[0]))) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, 0, &r0);
+  mcu_read_register(&mcu, 3, &r3);
+  mcu_read_register(&mcu, ARM_REG_SP, &sp);
+  mcu_read_memory(&mcu, 0x20000100, ram, 4);
+
+  if (mcu.state != MCU_STATE_HALTED || r0 != 165 || r3 != 165 ||
+      ram[0] != 165 || sp != 0x20005000 ||
+      mcu_get_cycle_count(&mcu) != expected_cycles) {
+    fprintf(stderr,
+            "%s FAILED: state[%s], r0[%u], r3[%u], ram[%u], sp[0x%08x], "
+            "cycles[%llu], expected.cycles[%llu]\n",
+            __func__, mcu_state_to_string(mcu.state), r0, r3, ram[0], sp,
+            (unsigned long long)mcu_get_cycle_count(&mcu),
+            (unsigned long long)expected_cycles);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+typedef struct {
+  uint32_t offset;
+  uint32_t value;
+  int writes;
+} gpio_probe_t;
+
+static void record_gpio_write(microcontroller_t *mcu, uint32_t offset,
+                              uint32_t value, int size, void *context) {
+  gpio_probe_t *probe = context;
+  (void)mcu;
+  (void)size;
+  probe->offset = offset;
+  probe->value = value;
+  probe->writes++;
+}
+
+int test_should_write_peripheral_and_follow_it_block() {
+  // movw r1, #0x0800; movt r1, #0x4001; movs r0, #0x20
+  // str r0, [r1, #12]; cmp r0, #0x20; ite eq; movs r2, #1; movs r2, #2
+  // bkpt
+  const uint16_t code[] = {0xF640, 0x0100, 0xF2C4, 0x0101, 0x2020, 0x60C8,
+                           0x2820, 0xBF0C, 0x2201, 0x2202, 0xBE00};
+  gpio_probe_t probe = {0};
+  microcontroller_t mcu;
+  uint32_t r2 = 0;
+
+  if (!setup_arm(&mcu, code, sizeof(code) / sizeof(code[0])) ||
+      arm_map_region(&mcu, 0x40010800, 0x400, NULL, record_gpio_write,
+                     &probe) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, 2, &r2);
+
+  if (mcu.state != MCU_STATE_HALTED || probe.writes != 1 ||
+      probe.offset != 0x0C || probe.value != 0x20 || r2 != 1) {
+    fprintf(stderr,
+            "%s FAILED: state[%s], writes[%d], offset[0x%x], value[0x%x], "
+            "r2[%u]\n",
+            __func__, mcu_state_to_string(mcu.state), probe.writes,
+            probe.offset, probe.value, r2);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_translate_pic_banks() {
+  // movlw 5; movwf 0x20; bsf STATUS, RP0; movlw 0x11; movwf 0x20 (0xA0)
+  // movwf 0x70 (RAM comum); bcf STATUS, RP0
+  // loop: decfsz 0x20, f; goto loop; sleep
+  const uint16_t program[] = {0x3005, 0x00A0, 0x1683, 0x3011, 0x00A0,
+                              0x00F0, 0x1283, 0x0BA0, 0x2807, 0x0063};
+  uint64_t expected_cycles = 7 * 4 + 4 * (4 + 8) + (4 + 4) + 4;
+  microcontroller_t mcu;
+  uint8_t bank0 = 0xFF, bank1 = 0, common = 0;
+
+  if (!setup_pic(&mcu, program, 10)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_memory(&mcu, pic_file_address(&mcu, 0x20), &bank0, 1);
+  mcu_read_memory(&mcu, pic_file_address(&mcu, 0xA0), &bank1, 1);
+  mcu_read_memory(&mcu, pic_file_address(&mcu, 0x170), &common, 1);
+
+  if (mcu.state != MCU_STATE_HALTED || bank0 != 0 || bank1 != 0x11 ||
+      common != 0x11 || mcu_get_cycle_count(&mcu) != expected_cycles) {
+    fprintf(stderr,
+            "%s FAILED: state[%s], bank0[%u], bank1[%u], common[%u], "
+            "cycles[%llu], expected.cycles[%llu]\n",
+            __func__, mcu_state_to_string(mcu.state), bank0, bank1, common,
+            (unsigned long long)mcu_get_cycle_count(&mcu),
+            (unsigned long long)expected_cycles);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_use_pic_table_and_indirect_access() {
+  // movlw 0x10; movwf FSR; bsf STATUS, IRP; movlw 2; call table
+  // movwf INDF (0x110); addwf INDF, w; sleep
+  // table: addwf PCL, f; retlw 0x0A; retlw 0x0B; retlw 0x0C
+  const uint16_t program[] = {0x3010, 0x0084, 0x1783, 0x3002, 0x2008, 0x0080,
+                              0x0700, 0x0063, 0x0782, 0x340A, 0x340B, 0x340C};
+  uint64_t expected_cycles = 4 * 4 + 8 + 8 + 8 + 4 + 4 + 4;
+  microcontroller_t mcu;
+  uint32_t w = 0;
+  uint8_t stored = 0;
+
+  if (!setup_pic(&mcu, program, 12)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 1000);
+  mcu_read_register(&mcu, PIC_REG_W, &w);
+  mcu_read_memory(&mcu, pic_file_address(&mcu, 0x110), &stored, 1);
+
+  if (mcu.state != MCU_STATE_HALTED || stored != 0x0C || w != 0x18 ||
+      mcu_get_cycle_count(&mcu) != expected_cycles) {
+    fprintf(stderr,
+            "%s FAILED: state[%s], stored[%u], w[%u], cycles[%llu], "
+            "expected.cycles[%llu]\n",
+            __func__, mcu_state_to_string(mcu.state), stored, w,
+            (unsigned long long)mcu_get_cycle_count(&mcu),
+            (unsigned long long)expected_cycles);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_disassemble_through_core_ops() {
+  const uint16_t program[] = {0xE00A, 0x950A, 0xF7F1, 0x9598};
+  const char *expected[] = {"ldi r16, 0x0a", "dec r16", "brbc 1, 0x0002", "break"};
+  microcontroller_t mcu;
+  char text[64];
+  uint32_t w = 0;
+
+  if (!setup_avr(&mcu, program, 4)) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    if (mcu_disassemble(&mcu, i * 2, text, sizeof(text)) != 2 ||
+        strcmp(text, expected[i]) != 0) {
+      fprintf(stderr, "%s FAILED: 0x%02x = \"%s\"\n", __func__, i * 2, text);
+      mcu_cleanup(&mcu);
+      return 0;
+    }
+  }
+  mcu_cleanup(&mcu);
+
+  // movlw 0x2A; sleep: W sai de registers.pic pela tabela do núcleo
+  const uint16_t pic_program[] = {0x302A, 0x0063};
+  if (!setup_pic(&mcu, pic_program, 2)) {
+    fprintf(stderr, "%s FAILED: setup pic\n", __func__);
+    return 0;
+  }
+
+  mcu_run_cycles(&mcu, 100);
+  if (mcu_read_register(&mcu, PIC_REG_W, &w) < 0 || w != 0x2A ||
+      mcu_disassemble(&mcu, 0, text, sizeof(text)) != 2 ||
+      strcmp(text, "movlw 0x2a") != 0) {
+    fprintf(stderr, "%s FAILED: W = 0x%02x, \"%s\"\n", __func__, w, text);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_log_pin_changes_through_async_logger() {
+  pin_manager_t manager;
+  FILE *out = tmpfile();
+  char text[1024] = {0};
+
+  if (!out || pin_manager_init(&manager, 4, out) < 0 ||
+      pin_start_monitoring(&manager, 1) < 0 || mcu_log_start() < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  pin_set_state(&manager, 1, PIN_HIGH);
+  pin_update_from_register(&manager, 0, 0);
+  MCU_LOG(MCU_LOG_TRACE, out, "trace descartado\n");
+  mcu_log_stop();
+
+  rewind(out);
+  size_t length = fread(text, 1, sizeof(text) - 1, out);
+  text[length] = '\0';
+  pin_manager_cleanup(&manager);
+  fclose(out);
+
+  if (!strstr(text, "[MONITOR] Pino 1 mudou de LOW para HIGH") ||
+      strstr(text, "trace descartado") || mcu_log_running()) {
+    fprintf(stderr, "%s FAILED: output[%s]\n", __func__, text);
+    return 0;
+  }
+
+  return 1;
+}
+
+int test_should_replay_recorded_inputs_from_snapshots() {
+  // loop: lds r16, 0x0200; add r17, r16; rjmp loop (5 ciclos por volta)
+  const uint16_t program[] = {0x9100, 0x0200, 0x0F10, 0xCFFC};
+  const char *path = "build/test_replay.bin";
+  microcontroller_t mcu, copy;
+  mcu_recording_t recording, loaded;
+  uint64_t cycles[10];
+  uint32_t sums[10], r17 = 0;
+
+  if (!setup_avr(&mcu, program, 4) || mcu_recording_init(&recording, 100) < 0 ||
+      mcu_record_start(&mcu, &recording) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  // A cada 3 trechos o host escreve uma nova "amostra" em 0x0200
+  for (int i = 0; i < 10; i++) {
+    uint8_t sample = (uint8_t)(i + 1);
+    mcu_record_run(&mcu, 50);
+    if (i % 3 == 0) {
+      mcu_write_memory(&mcu, 0x0200, &sample, 1);
+    }
+    cycles[i] = mcu_get_cycle_count(&mcu);
+    mcu_read_register(&mcu, 17, &sums[i]);
+  }
+  mcu_record_stop(&mcu);
+
+  // Para trás (restaura snapshot), para frente (segue do ponto atual) e
+  // com uma escrita do host que precisa ser ignorada durante o replay
+  const int order[] = {4, 1, 2, 7};
+  uint8_t noise = 99;
+  for (int i = 0; i < 4; i++) {
+    int k = order[i];
+    if (mcu_replay_seek(&mcu, &recording, cycles[k]) < 0 ||
+        mcu_read_register(&mcu, 17, &r17) < 0 || r17 != sums[k] ||
+        mcu_get_cycle_count(&mcu) != cycles[k]) {
+      fprintf(stderr, "%s FAILED: seek[%d] r17[%u], expected.r17[%u]\n",
+              __func__, k, r17, sums[k]);
+      mcu_recording_free(&recording);
+      mcu_cleanup(&mcu);
+      return 0;
+    }
+    mcu_write_memory(&mcu, 0x0200, &noise, 1);
+  }
+  mcu_replay_stop(&mcu);
+
+  int saved = mcu_recording_save(&recording, path);
+  mcu_recording_free(&recording);
+  mcu_cleanup(&mcu);
+  if (saved < 0) {
+    fprintf(stderr, "%s FAILED: could not save %s\n", __func__, path);
+    remove(path);
+    return 0;
+  }
+
+  // Só o journal vai para o arquivo: o replay parte de um MCU recém-iniciado.
+  // A primeira carga é descartada pela segunda, na mesma gravação.
+  int result = 0;
+  mcu_recording_init(&loaded, 100);
+  if (!setup_avr(&copy, program, 4) ||
+      mcu_recording_load(&loaded, &copy, path) < 0 ||
+      mcu_recording_load(&loaded, &copy, path) < 0 ||
+      mcu_replay_seek(&copy, &loaded, cycles[9]) < 0 ||
+      mcu_read_register(&copy, 17, &r17) < 0 || r17 != sums[9] ||
+      loaded.checkpoint_count < 2) {
+    fprintf(stderr, "%s FAILED: loaded r17[%u], expected.r17[%u]\n", __func__,
+            r17, sums[9]);
+    goto out;
+  }
+  mcu_replay_stop(&copy);
+  mcu_recording_free(&loaded);
+  mcu_cleanup(&copy);
+
+  // Cabeçalho anunciando um journal maior que o arquivo é recusado
+  FILE *file = fopen(path, "r+b");
+  const uint8_t huge[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  int corrupted = file && fseek(file, 20, SEEK_SET) == 0 &&
+                  fwrite(huge, 1, sizeof(huge), file) == sizeof(huge);
+  if (file) {
+    fclose(file);
+  }
+  mcu_recording_init(&loaded, 100);
+  result = corrupted && setup_avr(&copy, program, 4) &&
+           mcu_recording_load(&loaded, &copy, path) < 0;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: oversized journal accepted\n", __func__);
+  }
+
+out:
+  mcu_replay_stop(&copy);
+  mcu_recording_free(&loaded);
+  mcu_cleanup(&copy);
+  remove(path);
+  return result;
+}
+
+// Envia um pacote RSP e roda o servidor até a resposta chegar
+static int gdb_exchange(mcu_gdb_t *gdb, int fd, const char *packet, char *reply, size_t size) {
+  char frame[512];
+  unsigned checksum = 0;
+  size_t received = 0;
+
+  for (const char *p = packet; *p; p++) {
+    checksum += (unsigned char)*p;
+  }
+  int length = snprintf(frame, sizeof(frame), "$%s#%02x", packet, checksum & 0xFF);
+  if (send(fd, frame, length, 0) != length) {
+    return 0;
+  }
+
+  for (int round = 0; round < 1000; round++) {
+    if (mcu_gdb_poll(gdb, 10) < 0) {
+      return 0;
+    }
+    ssize_t n = recv(fd, frame + received, sizeof(frame) - 1 - received, MSG_DONTWAIT);
+    if (n > 0) {
+      received += n;
+    }
+    frame[received] = '\0';
+
+    char *start = strchr(frame, '$');
+    char *end = start ? strchr(start, '#') : NULL;
+    if (end && end + 2 < frame + received) {
+      snprintf(reply, size, "%.*s", (int)(end - start - 1), start + 1);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int test_should_debug_over_gdb_remote_protocol() {
+  // ldi r16, 10; loop: dec r16; brne loop; sbi PORTB, 5; sbi PORTB, 4;
+  // sbi PORTB, 3; break
+  const uint16_t program[] = {0xE00A, 0x950A, 0xF7F1, 0x9A2D,
+                              0x9A2C, 0x9A2B, 0x9598};
+  // Pacote e resposta esperada, em ordem
+  const char *script[][2] = {
+      {"?", "S05"},
+      {"Z0,2,2", "OK"},
+      {"c", "S05"},
+      {"p22", "02000000"},
+      {"s", "S05"},
+      {"p10", "09"},
+      {"M800200,2:abcd", "OK"},
+      {"m800200,2", "abcd"},
+      {"m0,4", "0ae00a95"},
+      {"z0,2,2", "OK"},
+      {"Z4,800025,1", "OK"},
+      {"c", "T05awatch:800025;"},
+      {"p10", "00"},
+      {"z4,800025,1", "OK"},
+      {"Z2,800025,1", "OK"},
+      {"c", "T05watch:800025;"},
+      {"z2,800025,1", "OK"},
+      {"Z3,800025,1", "OK"},
+      {"c", "T05rwatch:800025;"},
+      {"z3,800025,1", "OK"},
+      {"c", "S05"},
+  };
+  microcontroller_t mcu;
+  mcu_gdb_t gdb;
+  char reply[256] = "";
+  int fd = -1;
+
+  if (!setup_avr(&mcu, program, 7) || mcu_gdb_listen_tcp(&gdb, &mcu, 0) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  struct sockaddr_in address = {0};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(gdb.port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    fprintf(stderr, "%s FAILED: connect\n", __func__);
+    mcu_gdb_close(&gdb);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  for (size_t i = 0; i < sizeof(script) / sizeof(script[0]); i++) {
+    if (!gdb_exchange(&gdb, fd, script[i][0], reply, sizeof(reply)) ||
+        strcmp(reply, script[i][1]) != 0) {
+      fprintf(stderr, "%s FAILED: %s -> \"%s\", expected \"%s\"\n", __func__,
+              script[i][0], reply, script[i][1]);
+      close(fd);
+      mcu_gdb_close(&gdb);
+      mcu_cleanup(&mcu);
+      return 0;
+    }
+  }
+
+  // Checksum com dígitos que não são hexadecimais: só um "-", sem resposta
+  char nak[16] = "";
+  ssize_t received = 0;
+  send(fd, "$?#zz", 5, 0);
+  for (int round = 0; round < 100 && received <= 0; round++) {
+    mcu_gdb_poll(&gdb, 10);
+    received = recv(fd, nak, sizeof(nak) - 1, MSG_DONTWAIT);
+  }
+  if (received != 1 || nak[0] != '-') {
+    fprintf(stderr, "%s FAILED: bad checksum -> \"%.*s\"\n", __func__,
+            received > 0 ? (int)received : 0, nak);
+    close(fd);
+    mcu_gdb_close(&gdb);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+
+  // kill não tem resposta: o servidor só encerra a conexão
+  send(fd, "$k#6b", 5, 0);
+  int connected = 1;
+  for (int round = 0; round < 100 && connected == 1; round++) {
+    connected = mcu_gdb_poll(&gdb, 10);
+  }
+  close(fd);
+  mcu_gdb_close(&gdb);
+  mcu_cleanup(&mcu);
+
+  if (connected != 0) {
+    fprintf(stderr, "%s FAILED: still connected after kill\n", __func__);
+    return 0;
+  }
+
+  return 1;
+}
+
+int test_should_profile_blocks_and_samples() {
+  // main: ldi r17, 5; call: rcall delay; dec r17; brne call; break
+  // delay: ldi r16, 4; loop: dec r16; brne loop; ret
+  const uint16_t program[] = {0xE015, 0xD003, 0x951A, 0xF7E9, 0x9598,
+                              0xE004, 0x950A, 0xF7F1, 0x9508};
+  char main_name[] = "main";
+  char delay_name[] = "delay";
+  const firmware_symbol_t symbols[] = {{0, 10, main_name}, {10, 8, delay_name}};
+  microcontroller_t mcu;
+  mcu_profile_t profile;
+  char collapsed[512] = "";
+  char report[1024] = "";
+
+  if (!setup_avr(&mcu, program, 9) ||
+      mcu_profile_start(&profile, &mcu, MCU_PROFILE_BLOCKS, 0) < 0 ||
+      mcu_profile_set_symbols(&profile, symbols, 2) < 0 ||
+      mcu_profile_run(&profile, 1000) < 0) {
+    fprintf(stderr, "%s FAILED: blocks run\n", __func__);
+    return 0;
+  }
+
+  FILE *out = tmpfile();
+  mcu_profile_write_collapsed(&profile, out);
+  rewind(out);
+  collapsed[fread(collapsed, 1, sizeof(collapsed) - 1, out)] = '\0';
+  fclose(out);
+  out = tmpfile();
+  mcu_profile_report(&profile, out);
+  rewind(out);
+  report[fread(report, 1, sizeof(report) - 1, out)] = '\0';
+  fclose(out);
+
+  // 5 chamadas de 16 ciclos cada (ldi, 3 voltas, dec/brne final, ret)
+  if (strstr(collapsed, "main;delay 80\n") == NULL ||
+      (strncmp(collapsed, "main ", 5) != 0 && strstr(collapsed, "\nmain ") == NULL)) {
+    fprintf(stderr, "%s FAILED: collapsed stacks:\n%s", __func__, collapsed);
+    return 0;
+  }
+  if (profile.entries[5] != 5 || profile.total != mcu.cycle_count ||
+      strstr(report, "delay") == NULL) {
+    fprintf(stderr, "%s FAILED: entries %llu, total %llu/%llu\n%s", __func__,
+            (unsigned long long)profile.entries[5],
+            (unsigned long long)profile.total,
+            (unsigned long long)mcu.cycle_count, report);
+    return 0;
+  }
+  mcu_profile_free(&profile);
+  mcu_cleanup(&mcu);
+
+  if (!setup_avr(&mcu, program, 9) ||
+      mcu_profile_start(&profile, &mcu, MCU_PROFILE_SAMPLING, 3) < 0) {
+    fprintf(stderr, "%s FAILED: sampling setup\n", __func__);
+    return 0;
+  }
+  mcu_run_cycles(&mcu, 1000);
+
+  uint64_t delay_samples = 0;
+  for (int slot = 5; slot < 9; slot++) {
+    delay_samples += profile.hits[slot];
+  }
+  if (profile.total != mcu.cycle_count / 3 || delay_samples * 2 < profile.total) {
+    fprintf(stderr, "%s FAILED: %llu samples (%llu in delay) after %llu cycles\n",
+            __func__, (unsigned long long)profile.total,
+            (unsigned long long)delay_samples,
+            (unsigned long long)mcu.cycle_count);
+    return 0;
+  }
+  mcu_profile_free(&profile);
+  mcu_cleanup(&mcu);
+  return 1;
+}
+
+int test_should_find_pins_by_name_after_renames() {
+  pin_manager_t manager;
+  pin_t *pin = NULL;
+  char name[16];
+
+  if (pin_manager_init(&manager, 300, NULL) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  for (int i = 0; i < 300; i++) {
+    snprintf(name, sizeof(name), "NET%d", i);
+    pin_configure(&manager, i, PIN_INPUT, name);
+  }
+  // Renomeia metade e repete um nome num pino de número maior
+  for (int i = 0; i < 300; i += 2) {
+    snprintf(name, sizeof(name), "BUS%d", i / 2);
+    pin_configure(&manager, i, PIN_OUTPUT, name);
+  }
+  pin_configure(&manager, 299, PIN_INPUT, "NET1");
+
+  for (int i = 0; i < 299; i++) {
+    snprintf(name, sizeof(name), i % 2 ? "NET%d" : "BUS%d", i % 2 ? i : i / 2);
+    if (pin_get_by_name(&manager, name, &pin) < 0 || pin->pin_number != i) {
+      fprintf(stderr, "%s FAILED: %s\n", __func__, name);
+      pin_manager_cleanup(&manager);
+      return 0;
+    }
+  }
+
+  // Sem o pino 1, o nome repetido passa para o 299
+  pin_configure(&manager, 1, PIN_INPUT, NULL);
+  if (pin_get_by_name(&manager, "NET0", &pin) == 0 ||
+      pin_get_by_name(&manager, "NET1", &pin) < 0 || pin->pin_number != 299) {
+    fprintf(stderr, "%s FAILED: duplicated name\n", __func__);
+    pin_manager_cleanup(&manager);
+    return 0;
+  }
+
+  pin_manager_cleanup(&manager);
+  return 1;
+}
+
+int test_should_update_only_changed_register_bits() {
+  pin_manager_t manager;
+  uint32_t value = 0;
+
+  if (pin_manager_init(&manager, 48, NULL) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  // GPIOA com um pino por bit; o pino 40 divide o bit 3 com o pino 3
+  for (int i = 0; i < 32; i++) {
+    pin_configure(&manager, i, PIN_OUTPUT, NULL);
+    pin_set_register_mapping(&manager, i, 0x4001080C, i);
+  }
+  pin_configure(&manager, 40, PIN_OUTPUT, NULL);
+  pin_set_register_mapping(&manager, 40, 0x4001080C, 3);
+  // Remapeado para outro registrador: deixa de seguir GPIOA
+  pin_configure(&manager, 41, PIN_OUTPUT, NULL);
+  pin_set_register_mapping(&manager, 41, 0x4001080C, 5);
+  pin_set_register_mapping(&manager, 41, 0x40010C0C, 5);
+
+  int updated = pin_update_register_change(&manager, 0x4001080C, 0, 0x80000028);
+  // Estado alterado por fora num bit que não mudou não é revisitado
+  pin_set_state(&manager, 0, PIN_HIGH);
+  int unchanged = pin_update_register_change(&manager, 0x4001080C, 0x80000028, 0x80000028);
+  int mapped = pin_update_to_register(&manager, 0x4001080C, &value);
+
+  if (updated != 4 || unchanged != 0 || mapped != 33 || value != 0x80000029 ||
+      manager.pins[40].state != PIN_HIGH || manager.pins[41].state != PIN_LOW) {
+    fprintf(stderr,
+            "%s FAILED: updated %d, unchanged %d, mapped %d, value 0x%08x\n",
+            __func__, updated, unchanged, mapped, value);
+    pin_manager_cleanup(&manager);
+    return 0;
+  }
+
+  pin_manager_cleanup(&manager);
+  return 1;
+}
+
+int test_should_pack_port_state_into_words() {
+  pin_manager_t manager;
+  uint32_t value = 0;
+
+  if (pin_manager_init(&manager, 8, NULL) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+  for (int i = 0; i < 8; i++) {
+    pin_set_register_mapping(&manager, i, 0x25, i);
+  }
+
+  // Nibble baixo como saída; a escrita da porta toda só dirige esses bits
+  int directions = pin_set_register_directions(&manager, 0x25, 0x0F);
+  int updated = pin_update_register_change(&manager, 0x25, 0x00, 0xFF);
+  pin_set_state(&manager, 7, PIN_HIGH);
+  pin_update_to_register(&manager, 0x25, &value);
+
+  const pin_register_t *port = &manager.registers[0];
+  if (directions != 4 || updated != 4 || value != 0x8F ||
+      port->high != 0x8F || port->output != 0x0F ||
+      manager.pins[3].state != PIN_HIGH || manager.pins[4].state != PIN_LOW ||
+      manager.pins[3].direction != PIN_OUTPUT) {
+    fprintf(stderr,
+            "%s FAILED: directions %d, updated %d, value 0x%02x, high 0x%02x, "
+            "output 0x%02x\n",
+            __func__, directions, updated, value, port->high, port->output);
+    pin_manager_cleanup(&manager);
+    return 0;
+  }
+
+  pin_manager_cleanup(&manager);
+  return 1;
+}
+
+int test_should_drive_pin_configured_after_mapping() {
+  pin_manager_t manager;
+
+  if (pin_manager_init(&manager, 8, NULL) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  // Mapeado como entrada e só depois configurado como saída
+  pin_set_register_mapping(&manager, 0, 0x25, 0);
+  pin_configure(&manager, 0, PIN_OUTPUT, "PB0");
+  int updated = pin_update_from_register(&manager, 0x25, 0x01);
+
+  int result = updated == 1 && manager.pins[0].state == PIN_HIGH &&
+               manager.registers[0].output == 0x01;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: updated %d, state %d, output 0x%02x\n",
+            __func__, updated, manager.pins[0].state, manager.registers[0].output);
+  }
+  pin_manager_cleanup(&manager);
+  return result;
+}
+
+int test_should_journal_monitored_pin_changes() {
+  // sbi DDRB, 5; sbi PORTB, 5; cbi PORTB, 5; break
+  const uint16_t program[] = {0x9A25, 0x9A2D, 0x982D, 0x9598};
+  microcontroller_t mcu;
+  pin_manager_t manager;
+  pin_change_t changes[4];
+
+  if (!setup_avr(&mcu, program, 4) ||
+      pin_start_monitoring(&mcu.pin_manager, 18) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+  mcu_run_cycles(&mcu, 100);
+
+  int count = pin_get_monitored_changes(&mcu.pin_manager, changes, 4);
+  if (count != 2 || changes[0].pin_number != 18 ||
+      changes[0].new_state != PIN_HIGH || changes[1].old_state != PIN_HIGH ||
+      changes[1].new_state != PIN_LOW || changes[1].cycle <= changes[0].cycle ||
+      pin_get_monitored_changes(&mcu.pin_manager, changes, 4) != 0) {
+    fprintf(stderr, "%s FAILED: %d changes\n", __func__, count);
+    mcu_cleanup(&mcu);
+    return 0;
+  }
+  mcu_cleanup(&mcu);
+
+  // Diário cheio: as mudanças mais novas são descartadas e contadas
+  FILE *out = tmpfile();
+  if (!out || pin_manager_init(&manager, 1, out) < 0) {
+    fprintf(stderr, "%s FAILED: manager setup\n", __func__);
+    return 0;
+  }
+  pin_start_monitoring(&manager, 0);
+  for (int i = 0; i < PIN_CHANGE_JOURNAL_SIZE + 6; i++) {
+    pin_toggle(&manager, 0);
+  }
+
+  int drained = 0;
+  while ((count = pin_get_monitored_changes(&manager, changes, 4)) > 0) {
+    drained += count;
+  }
+  uint64_t dropped = pin_take_dropped_changes(&manager);
+  pin_manager_cleanup(&manager);
+  mcu_log_flush();
+  fclose(out);
+
+  if (drained != PIN_CHANGE_JOURNAL_SIZE || dropped != 6) {
+    fprintf(stderr, "%s FAILED: drained %d, dropped %llu\n", __func__, drained,
+            (unsigned long long)dropped);
+    return 0;
+  }
+
+  return 1;
+}
+
+int test_should_share_register_bit_between_pins() {
+  pin_manager_t manager;
+  pin_change_t changes[4];
+  uint32_t value = 0;
+
+  FILE *out = tmpfile();
+  if (!out || pin_manager_init(&manager, 3, out) < 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+
+  // Pinos 2 e 0 no mesmo bit, mapeados nessa ordem; só o 2 é monitorado
+  pin_set_register_mapping(&manager, 2, 0x25, 0);
+  pin_set_register_mapping(&manager, 0, 0x25, 0);
+  pin_configure(&manager, 0, PIN_OUTPUT, NULL);
+  pin_configure(&manager, 2, PIN_OUTPUT, NULL);
+  pin_start_monitoring(&manager, 2);
+
+  int updated = pin_update_from_register(&manager, 0x25, 1);
+  int count = pin_get_monitored_changes(&manager, changes, 4);
+  int journaled = updated == 2 && count == 1 && changes[0].pin_number == 2;
+
+  // Um nível externo no pino 2, já como entrada, não muda o banco: o nível
+  // é do pino 0, antes e depois de refazer os bancos
+  pin_update_from_register(&manager, 0x25, 0);
+  pin_set_direction(&manager, 2, PIN_INPUT);
+  pin_set_state(&manager, 2, PIN_HIGH);
+  pin_update_to_register(&manager, 0x25, &value);
+  uint32_t before = value;
+  pin_manager_resync(&manager);
+  pin_update_to_register(&manager, 0x25, &value);
+  int owned = before == 0 && value == 0;
+
+  pin_manager_cleanup(&manager);
+  mcu_log_flush();
+  fclose(out);
+
+  if (!journaled || !owned) {
+    fprintf(stderr, "%s FAILED: updated[%d], changes[%d], bank[%u/%u]\n",
+            __func__, updated, count, before, value);
+    return 0;
+  }
+
+  return 1;
+}
+
+#define PIN_QUEUE_TEST_EVENTS 200000
+
+static void *pin_queue_producer(void *context) {
+  pin_queue_t *queue = context;
+  for (uint64_t i = 0; i < PIN_QUEUE_TEST_EVENTS; i++) {
+    pin_event_t event = {i, (int)(i % 28), i & 1 ? PIN_HIGH : PIN_LOW};
+    while (!pin_queue_push(queue, &event)) {
+    }
+  }
+  pin_queue_publish(queue);
+  return NULL;
+}
+
+int test_should_pass_pin_events_between_threads() {
+  // sbi DDRB, 5; sbi PORTB, 5; cbi PORTB, 5; break
+  const uint16_t program[] = {0x9A25, 0x9A2D, 0x982D, 0x9598};
+  pin_queue_t queue;
+  pin_queue_t crossings;
+  pin_event_t events[64];
+  pthread_t producer;
+  uint64_t expected = 0;
+  int ordered = 1;
+
+  if (pin_queue_init(&queue, 256, 16) < 0 ||
+      pthread_create(&producer, NULL, pin_queue_producer, &queue) != 0) {
+    fprintf(stderr, "%s FAILED: setup\n", __func__);
+    return 0;
+  }
+  while (expected < PIN_QUEUE_TEST_EVENTS) {
+    size_t count = pin_queue_pop(&queue, events, 64);
+    for (size_t i = 0; i < count; i++, expected++) {
+      ordered &= events[i].cycle == expected &&
+                 events[i].pin_number == (int)(expected % 28);
+    }
+  }
+  pthread_join(producer, NULL);
+
+  if (!ordered || pin_queue_peek(&queue) != NULL) {
+    fprintf(stderr, "%s FAILED: events out of order\n", __func__);
+    pin_queue_cleanup(&queue);
+    return 0;
+  }
+  pin_queue_cleanup(&queue);
+
+  // MCU: bordas de PB5 saem, um cruzamento entra em PB0 quando vence
+  microcontroller_t mcu;
+  mcu_recording_t recording;
+  pin_event_t crossing = {2, 13, PIN_HIGH};
+  pin_event_t late = {1000, 14, PIN_HIGH};
+  if (pin_queue_init(&queue, 16, 0) < 0 || pin_queue_init(&crossings, 16, 0) < 0 ||
+      !setup_avr(&mcu, program, 4) || mcu_recording_init(&recording, 100) < 0 ||
+      mcu_record_start(&mcu, &recording) < 0) {
+    fprintf(stderr, "%s FAILED: mcu setup\n", __func__);
+    return 0;
+  }
+  pin_manager_set_queues(&mcu.pin_manager, &queue, &crossings);
+  pin_queue_push(&crossings, &crossing);
+  pin_queue_push(&crossings, &late);
+  pin_queue_publish(&crossings);
+  mcu_run_cycles(&mcu, 100);
+
+  size_t count = pin_queue_pop(&queue, events, 64);
+  int result = count == 2 && events[0].pin_number == 18 &&
+               events[0].state == PIN_HIGH && events[1].state == PIN_LOW &&
+               mcu.pin_manager.pins[13].state == PIN_HIGH &&
+               mcu.pin_manager.pins[14].state == PIN_LOW &&
+               pin_queue_peek(&crossings) != NULL;
+  if (!result) {
+    fprintf(stderr, "%s FAILED: %zu edges, PB0 %s\n", __func__, count,
+            pin_state_to_string(mcu.pin_manager.pins[13].state));
+  }
+
+  // O cruzamento aplicado entrou na gravação como entrada do host
+  if (result && recording.journal_size == 0) {
+    fprintf(stderr, "%s FAILED: crossing not journaled\n", __func__);
+    result = 0;
+  }
+
+  mcu_record_stop(&mcu);
+  mcu_recording_free(&recording);
+  mcu_cleanup(&mcu);
+  pin_queue_cleanup(&queue);
+  pin_queue_cleanup(&crossings);
+  return result;
+}
+
+int main(void) {
+  if (!test_should_count_cycles_of_countdown_loop()) {
+    return 1;
+  }
+
+  if (!test_should_call_subroutine_and_set_carry()) {
+    return 1;
+  }
+
+  if (!test_should_skip_past_last_flash_word()) {
+    return 1;
+  }
+
+  if (!test_should_run_until_emulated_time()) {
+    return 1;
+  }
+
+  if (!test_should_dispatch_events_in_cycle_order()) {
+    return 1;
+  }
+
+  if (!test_should_drive_pins_through_io_registers()) {
+    return 1;
+  }
+
+  if (!test_should_stop_at_breakpoints_and_watchpoints()) {
+    return 1;
+  }
+
+  if (!test_should_load_intel_hex_file()) {
+    return 1;
+  }
+
+  if (!test_should_place_elf_segments()) {
+    return 1;
+  }
+
+  if (!test_should_restore_snapshot_of_running_mcu()) {
+    return 1;
+  }
+
+  if (!test_should_run_instances_in_farm()) {
+    return 1;
+  }
+
+  if (!test_should_run_thumb_program()) {
+    return 1;
+  }
+
+  if (!test_should_write_peripheral_and_follow_it_block()) {
+    return 1;
+  }
+
+  if (!test_should_translate_pic_banks()) {
+    return 1;
+  }
+
+  if (!test_should_use_pic_table_and_indirect_access()) {
+    return 1;
+  }
+
+  if (!test_should_disassemble_through_core_ops()) {
+    return 1;
+  }
+
+  if (!test_should_log_pin_changes_through_async_logger()) {
+    return 1;
+  }
+
+  if (!test_should_replay_recorded_inputs_from_snapshots()) {
+    return 1;
+  }
+
+  if (!test_should_debug_over_gdb_remote_protocol()) {
+    return 1;
+  }
+
+  if (!test_should_profile_blocks_and_samples()) {
+    return 1;
+  }
+
+  if (!test_should_find_pins_by_name_after_renames()) {
+    return 1;
+  }
+
+  if (!test_should_update_only_changed_register_bits()) {
+    return 1;
+  }
+
+  if (!test_should_pack_port_state_into_words()) {
+    return 1;
+  }
+
+  if (!test_should_drive_pin_configured_after_mapping()) {
+    return 1;
+  }
+
+  if (!test_should_journal_monitored_pin_changes()) {
+    return 1;
+  }
+
+  if (!test_should_share_register_bit_between_pins()) {
+    return 1;
+  }
+
+  if (!test_should_pass_pin_events_between_threads()) {
+    return 1;
+  }
+
+  printf("==== [test_microcontroller] TESTS PASSED ====\n");
+
+  return 0;
+}